@@ -0,0 +1,321 @@
+/*
+ * HOST EMULATOR: Arduino.h - just enough Arduino to run sketches on Linux
+ *
+ * What this gives you:
+ * - millis(), micros(), delay(), random(), analogRead() and friends
+ * - A small String class (the parts our sketches use)
+ * - Print/Stream so Serial.print() works like on the board
+ * - HardwareSerial on top of pseudo-terminals (see HardwareSerial.h)
+ *
+ * Think of it like a flight simulator for your sketch:
+ * - The sketch code is EXACTLY the same as on the ESP32
+ * - Only the "hardware" underneath is pretend
+ * - Anything the sketch doesn't touch (WiFi, GPIO registers) isn't here
+ *
+ * Build a sketch for your PC (from the sketch's folder):
+ *   g++ -std=gnu++17 -O2 -x c++ -I ../Host-Emulator -include Arduino.h \
+ *       02_uart_communication.c -x none ../Host-Emulator/host_main.cpp -o sketch
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+
+// Pin and print constants (same values as the ESP32 core)
+#define HIGH            1
+#define LOW             0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+#define DEC             10
+#define HEX             16
+#define OCT             8
+#define BIN             2
+#define A0              36
+#define SERIAL_8N1      0x800001c
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+/*
+ * PART 1: Time
+ * millis()/micros() count from program start, like from power-on.
+ * delay() keeps the emulated UARTs running while the sketch "waits",
+ * the same way the ESP32's UART driver keeps receiving during delay().
+ */
+void hostPollUarts();   // Defined in HardwareSerial.h
+
+inline uint64_t hostNanos()
+{
+    static uint64_t start = 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    if (start == 0) start = now;
+    return now - start;
+}
+
+inline unsigned long millis() { return (unsigned long)(hostNanos() / 1000000ull); }
+inline unsigned long micros() { return (unsigned long)(hostNanos() / 1000ull); }
+
+inline void delay(unsigned long ms)
+{
+    uint64_t until = hostNanos() + (uint64_t)ms * 1000000ull;
+    do {
+        hostPollUarts();
+        usleep(200);    // 0.2 ms steps: fine enough for UART idle timeouts
+    } while (hostNanos() < until);
+}
+
+inline void delayMicroseconds(unsigned int us) { usleep(us); }
+
+/*
+ * PART 2: Random numbers and fake analog pins
+ */
+inline void randomSeed(unsigned long seed) { srand((unsigned)seed); }
+inline long random(long max) { return max > 0 ? rand() % max : 0; }
+inline long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// Mid-scale 12-bit reading with a little noise
+inline int analogRead(uint8_t pin) { (void)pin; return 2048 + (int)random(-20, 21); }
+
+// GPIO does nothing on a PC
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+
+// Critical sections: onReceive() callbacks run on the sketch's own thread
+// here (from delay() and the Serial calls), so there is nothing to lock
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    0
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+
+/*
+ * PART 3: String - a thin wrapper around std::string
+ * Numbers are formatted like the Arduino core (floats with 2 decimals).
+ */
+class String {
+public:
+    String(const char* s = "") : text(s ? s : "") {}
+    String(const std::string& s) : text(s) {}
+    String(char c) : text(1, c) {}
+    String(int v, unsigned char base = DEC) : text(formatSigned(v, base)) {}
+    String(unsigned int v, unsigned char base = DEC) : text(formatUnsigned(v, base)) {}
+    String(long v, unsigned char base = DEC) : text(formatSigned(v, base)) {}
+    String(unsigned long v, unsigned char base = DEC) : text(formatUnsigned(v, base)) {}
+    String(double v, unsigned char decimals = 2) : text(formatFloat(v, decimals)) {}
+
+    unsigned int length() const { return (unsigned int)text.size(); }
+    const char* c_str() const { return text.c_str(); }
+    char charAt(unsigned int i) const { return i < text.size() ? text[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    bool startsWith(const String& prefix) const { return text.compare(0, prefix.text.size(), prefix.text) == 0; }
+    bool endsWith(const String& suffix) const
+    {
+        return text.size() >= suffix.text.size() &&
+               text.compare(text.size() - suffix.text.size(), suffix.text.size(), suffix.text) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const
+    {
+        size_t pos = text.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from) const { return from < text.size() ? String(text.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from > to) { unsigned int t = from; from = to; to = t; }
+        if (from >= text.size()) return String();
+        return String(text.substr(from, to - from));
+    }
+    void trim()
+    {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        size_t last = text.find_last_not_of(" \t\r\n");
+        text = (first == std::string::npos) ? std::string() : text.substr(first, last - first + 1);
+    }
+
+    long toInt() const { return strtol(text.c_str(), NULL, 10); }
+    float toFloat() const { return (float)atof(text.c_str()); }
+
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator==(const char* other) const { return text == (other ? other : ""); }
+    bool operator!=(const String& other) const { return text != other.text; }
+
+    String& operator+=(const String& other) { text += other.text; return *this; }
+    String& operator+=(const char* s) { text += s ? s : ""; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+    String& operator+=(int v) { return *this += String(v); }
+    String& operator+=(unsigned int v) { return *this += String(v); }
+    String& operator+=(long v) { return *this += String(v); }
+    String& operator+=(unsigned long v) { return *this += String(v); }
+    String& operator+=(double v) { return *this += String(v); }
+
+    friend String operator+(String a, const String& b) { return a += b; }
+
+private:
+    std::string text;
+
+    static std::string formatUnsigned(unsigned long v, unsigned char base)
+    {
+        char buf[8 * sizeof(long) + 1];
+        char* p = &buf[sizeof(buf) - 1];
+        *p = '\0';
+        if (base < 2) base = 10;
+        do {
+            unsigned digit = (unsigned)(v % base);
+            *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+            v /= base;
+        } while (v);
+        return std::string(p);
+    }
+    static std::string formatSigned(long v, unsigned char base)
+    {
+        if (v < 0 && base == DEC) return "-" + formatUnsigned(0ul - (unsigned long)v, base);
+        return formatUnsigned((unsigned long)v, base);
+    }
+    static std::string formatFloat(double v, unsigned char decimals)
+    {
+        if (isnan(v)) return "nan";
+        if (isinf(v)) return "inf";
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        return std::string(buf);
+    }
+};
+
+/*
+ * PART 4: Print and Stream
+ * Everything ends up in write(buffer, size) - one call per print().
+ */
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) { return write(&b, 1); }
+    virtual size_t write(const uint8_t* data, size_t size) = 0;
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+    size_t write(const char* data, size_t size) { return write((const uint8_t*)data, size); }
+    virtual void flush() {}
+    virtual int availableForWrite() { return 128; }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char v, int base = DEC) { return print(String((unsigned long)v, (unsigned char)base)); }
+    size_t print(int v, int base = DEC) { return print(String((long)v, (unsigned char)base)); }
+    size_t print(unsigned int v, int base = DEC) { return print(String((unsigned long)v, (unsigned char)base)); }
+    size_t print(long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(long long v, int base = DEC) { return print(String((long)v, (unsigned char)base)); }
+    size_t print(unsigned long long v, int base = DEC) { return print(String((unsigned long)v, (unsigned char)base)); }
+    size_t print(double v, int digits = 2) { return print(String(v, (unsigned char)digits)); }
+
+    size_t println() { return write((const uint8_t*)"\r\n", 2); }
+    template<typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    template<typename T> size_t println(const T& v, int format) { size_t n = print(v, format); return n + println(); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms) { timeout_ms = ms; }
+
+    // Waits up to the timeout for 'length' bytes, like the Arduino core
+    size_t readBytes(uint8_t* buffer, size_t length)
+    {
+        size_t count = 0;
+        unsigned long start = millis();
+        while (count < length) {
+            int c = read();
+            if (c < 0) {
+                if (millis() - start >= timeout_ms) break;
+                delay(1);
+                continue;
+            }
+            buffer[count++] = (uint8_t)c;
+        }
+        return count;
+    }
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+
+    size_t readBytesUntil(char terminator, char* buffer, size_t length)
+    {
+        size_t count = 0;
+        unsigned long start = millis();
+        while (count < length) {
+            int c = read();
+            if (c < 0) {
+                if (millis() - start >= timeout_ms) break;
+                delay(1);
+                continue;
+            }
+            if (c == terminator) break;
+            buffer[count++] = (char)c;
+        }
+        return count;
+    }
+
+    String readStringUntil(char terminator)
+    {
+        std::string s;
+        unsigned long start = millis();
+        for (;;) {
+            int c = read();
+            if (c < 0) {
+                if (millis() - start >= timeout_ms) break;
+                delay(1);
+                continue;
+            }
+            if (c == terminator) break;
+            s += (char)c;
+        }
+        return String(s);
+    }
+
+    String readString()
+    {
+        std::string s;
+        unsigned long start = millis();
+        while (millis() - start < timeout_ms) {
+            int c = read();
+            if (c < 0) {
+                delay(1);
+                continue;
+            }
+            s += (char)c;
+            start = millis();   // Timeout counts from the last byte
+        }
+        return String(s);
+    }
+
+protected:
+    unsigned long timeout_ms = 1000;
+};
+
+/*
+ * PART 5: The ESP object
+ */
+struct EspClass {
+    void restart() { fflush(stdout); exit(0); }
+    uint32_t getFreeHeap() { return 280000; }   // Typical free heap on a fresh ESP32
+};
+inline EspClass ESP;
+
+#include "HardwareSerial.h"
@@ -0,0 +1,376 @@
+/*
+ * HOST EMULATOR: HardwareSerial.h - ESP32 UARTs on top of pseudo-terminals
+ *
+ * What this gives you:
+ * - The HardwareSerial surface our sketches use: begin(), available(),
+ *   read(), readBytes(), write(), print(), availableForWrite(),
+ *   setRxBufferSize(), setTxBufferSize(), setRxTimeout() and onReceive()
+ * - Serial (UART0) on stdin/stdout
+ * - UART1/UART2 on a pseudo-terminal (pty) that other programs can open,
+ *   e.g. uart_replay to stream recorded GPS/sensor traffic
+ * - Or on a socketpair with openLoopback(), for tests inside one program
+ * - Baud-rate pacing: bytes can't arrive or leave faster than baud / 10
+ *   per second, just like on the real wire
+ *
+ * Think of it like a patch panel:
+ * - On the board, GPIO 16/17 go to the GPS module
+ * - Here, /dev/pts/N goes to whatever program you plug into it
+ *
+ * Environment variables:
+ *   HOST_UART1=/dev/ttyUSB0   Use an existing tty (real adapter, other pty)
+ *   HOST_UART_PACING=0        No baud-rate limit (find the parser's ceiling)
+ *   HOST_RUN_SECONDS=10       Exit after 10 s and print UART statistics
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include <fcntl.h>
+#include <termios.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <functional>
+#include <vector>
+
+#define HOST_UART_MAX_PORTS     8
+#define HOST_UART_FIFO_SIZE     128         // ESP32 hardware FIFO depth
+#define HOST_UART_BITS_PER_BYTE 10          // 8N1: start + 8 data + stop
+
+typedef std::function<void(void)> OnReceiveCb;
+
+class HardwareSerial;
+inline HardwareSerial* hostUartPorts[HOST_UART_MAX_PORTS];
+inline int hostUartCount = 0;
+
+void hostUartReport();
+
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int uart_nr) : uart_nr(uart_nr)
+    {
+        if (hostUartCount < HOST_UART_MAX_PORTS) hostUartPorts[hostUartCount++] = this;
+        if (uart_nr == 0) {         // Serial = the terminal you started the program from
+            fd_in = STDIN_FILENO;
+            fd_out = STDOUT_FILENO;
+        }
+        const char* pacing_env = getenv("HOST_UART_PACING");
+        pacing = !(pacing_env && pacing_env[0] == '0');
+    }
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1,
+               bool invert = false, unsigned long timeout_ms = 20000UL, uint8_t rxfifo_full_thrhd = 120)
+    {
+        (void)config; (void)rxPin; (void)txPin; (void)invert; (void)timeout_ms;
+        this->baud = baud ? baud : 115200;
+        fifo_threshold = rxfifo_full_thrhd;
+        rx.assign(rx_capacity, 0);
+        rx_head = rx_count = 0;
+
+        if (uart_nr == 0) {
+            fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+            pacing = false;         // USB CDC is not limited by the baud rate
+        } else if (fd_in < 0) {
+            openDevice();
+        }
+
+        last_credit_ns = last_rx_ns = tx_free_ns = hostNanos();
+        started = true;
+
+        static bool report_registered = false;
+        if (!report_registered) {
+            atexit(hostUartReport);
+            report_registered = true;
+        }
+    }
+
+    void end()
+    {
+        if (uart_nr != 0 && fd_in >= 0) close(fd_in);
+        if (keep_fd >= 0) close(keep_fd);
+        fd_in = fd_out = keep_fd = -1;
+        started = false;
+    }
+
+    // Like the ESP32 core: only works BEFORE begin()
+    size_t setRxBufferSize(size_t size)
+    {
+        if (started) return 0;
+        rx_capacity = size > HOST_UART_FIFO_SIZE ? size : HOST_UART_FIFO_SIZE + 1;
+        return rx_capacity;
+    }
+
+    // TX ring buffer behind the FIFO, drained "by the interrupt" in the
+    // background. 0 (the default) = write() waits for room in the FIFO.
+    size_t setTxBufferSize(size_t size)
+    {
+        if (started) return 0;
+        tx_capacity = HOST_UART_FIFO_SIZE + (size > HOST_UART_FIFO_SIZE ? size : 0);
+        return size;
+    }
+
+    bool setRxTimeout(uint8_t symbols)
+    {
+        rx_timeout_symbols = symbols;
+        return true;
+    }
+
+    void onReceive(OnReceiveCb function, bool onlyOnTimeout = false)
+    {
+        on_receive = function;
+        only_on_timeout = onlyOnTimeout;
+    }
+
+    int available() override
+    {
+        poll();
+        return (int)rx_count;
+    }
+
+    int peek() override
+    {
+        poll();
+        return rx_count ? rx[rx_head] : -1;
+    }
+
+    int read() override
+    {
+        poll();
+        if (rx_count == 0) return -1;
+        uint8_t b = rx[rx_head];
+        rx_head = (rx_head + 1) % rx.size();
+        rx_count--;
+        return b;
+    }
+
+    size_t write(const uint8_t* data, size_t size) override
+    {
+        if (fd_out < 0) return size;        // Not connected: bytes fall on the floor
+
+        if (pacing && started) {
+            // FIFO + TX ring hold tx_capacity bytes; beyond that write() blocks like on the board
+            uint64_t now = hostNanos();
+            if (tx_free_ns < now) tx_free_ns = now;
+            uint64_t fifo_ns = tx_capacity * nsPerByte();
+            if (tx_free_ns - now > fifo_ns) {
+                uint64_t wait = tx_free_ns - now - fifo_ns;
+                usleep((useconds_t)(wait / 1000));
+            }
+            tx_free_ns += size * nsPerByte();
+        }
+
+        size_t sent = 0;
+        int retries = 0;
+        while (sent < size) {
+            ssize_t n = ::write(fd_out, data + sent, size - sent);
+            if (n > 0) {
+                sent += (size_t)n;
+                continue;
+            }
+            if (n < 0 && errno == EAGAIN && ++retries < 100) {
+                usleep(1000);               // Receiver is slow - wait a little
+                continue;
+            }
+            tx_dropped += size - sent;      // Nobody listening on the other end
+            break;
+        }
+        bytes_tx += size;
+        return size;
+    }
+    using Print::write;
+
+    // Free space in the TX FIFO + ring buffer: writing this much never blocks
+    int availableForWrite() override
+    {
+        if (!pacing || !started) return (int)tx_capacity;
+        uint64_t now = hostNanos();
+        uint64_t queued = tx_free_ns > now ? (tx_free_ns - now) / nsPerByte() : 0;
+        return queued >= tx_capacity ? 0 : (int)(tx_capacity - queued);
+    }
+
+    void flush() override
+    {
+        while (pacing && hostNanos() < tx_free_ns) {
+            usleep(100);
+        }
+    }
+
+    operator bool() const { return true; }
+
+    /*
+     * Host-only extras
+     */
+
+    // Connect this UART to one end of a socketpair; returns the other end
+    // (the "device"). Call BEFORE begin().
+    int openLoopback()
+    {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return -1;
+        fcntl(sv[0], F_SETFL, O_NONBLOCK);
+        fd_in = fd_out = sv[0];
+        snprintf(path, sizeof(path), "socketpair");
+        return sv[1];
+    }
+
+    void setPacing(bool on) { pacing = on; }
+    const char* devicePath() const { return path; }
+
+    // Move bytes from the OS into the RX buffer (at most baud / 10 per second
+    // when pacing) and fire onReceive() like the ESP32 UART driver would
+    void poll()
+    {
+        if (fd_in < 0 || !started || in_poll) return;
+        in_poll = true;
+
+        uint64_t now = hostNanos();
+        size_t room = rx.size() - rx_count;
+        if (pacing) {
+            credit += (double)(now - last_credit_ns) / nsPerByte();
+            if (credit > HOST_UART_FIFO_SIZE) credit = HOST_UART_FIFO_SIZE;
+            last_credit_ns = now;
+            if (room > (size_t)credit) room = (size_t)credit;
+        }
+
+        while (room > 0) {
+            size_t tail = (rx_head + rx_count) % rx.size();
+            size_t chunk = rx.size() - tail < room ? rx.size() - tail : room;
+            ssize_t n = ::read(fd_in, &rx[tail], chunk);
+            if (n <= 0) break;
+            rx_count += (size_t)n;
+            room -= (size_t)n;
+            bytes_rx += (uint64_t)n;
+            if (pacing) credit -= (double)n;
+            last_rx_ns = now;
+            idle_reported = false;
+        }
+        if (rx_count == rx.size()) rx_full_events++;    // Sketch isn't keeping up
+
+        if (on_receive) {
+            bool fifo_full = !only_on_timeout && rx_count >= fifo_threshold;
+            bool idle = rx_count > 0 && !idle_reported &&
+                        now - last_rx_ns >= (uint64_t)rx_timeout_symbols * nsPerByte();
+            if (fifo_full || idle) {
+                if (idle) idle_reported = true;
+                callbacks++;
+                on_receive();
+            }
+        }
+        in_poll = false;
+    }
+
+    void report(FILE* out) const
+    {
+        double seconds = hostNanos() / 1e9;
+        fprintf(out, "[host] UART%d %-12s rx %8llu bytes (%7.0f B/s)  tx %8llu bytes  "
+                     "callbacks %6llu  rx-full %6llu  tx-dropped %llu\n",
+                uart_nr, path, (unsigned long long)bytes_rx, seconds > 0 ? bytes_rx / seconds : 0.0,
+                (unsigned long long)bytes_tx, (unsigned long long)callbacks,
+                (unsigned long long)rx_full_events, (unsigned long long)tx_dropped);
+    }
+
+    int portNumber() const { return uart_nr; }
+
+private:
+    int uart_nr;
+    int fd_in = -1;
+    int fd_out = -1;
+    int keep_fd = -1;               // Our own handle on the pty slave (avoids EIO)
+    char path[64] = "";
+    bool started = false;
+    bool pacing = true;
+    bool in_poll = false;
+    unsigned long baud = 115200;
+
+    std::vector<uint8_t> rx;
+    size_t rx_capacity = 256;       // ESP32 core default
+    size_t rx_head = 0;
+    size_t rx_count = 0;
+    double credit = 0;
+    uint64_t last_credit_ns = 0;
+    uint64_t last_rx_ns = 0;
+    uint64_t tx_free_ns = 0;
+    size_t tx_capacity = HOST_UART_FIFO_SIZE;   // FIFO + TX ring (none by default)
+
+    OnReceiveCb on_receive;
+    bool only_on_timeout = false;
+    bool idle_reported = true;
+    uint8_t rx_timeout_symbols = 2; // ESP32 core default
+    uint8_t fifo_threshold = 120;
+
+    uint64_t bytes_rx = 0;
+    uint64_t bytes_tx = 0;
+    uint64_t callbacks = 0;
+    uint64_t rx_full_events = 0;
+    uint64_t tx_dropped = 0;
+
+    uint64_t nsPerByte() const { return HOST_UART_BITS_PER_BYTE * 1000000000ull / baud; }
+
+    static void makeRaw(int fd, unsigned long baud)
+    {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) < 0) return;
+        cfmakeraw(&tio);
+        speed_t speed = baud >= 921600 ? B921600 : baud >= 115200 ? B115200 : baud >= 57600 ? B57600 :
+                        baud >= 38400 ? B38400 : baud >= 19200 ? B19200 : B9600;
+        cfsetspeed(&tio, speed);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    void openDevice()
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "HOST_UART%d", uart_nr);
+        const char* existing = getenv(name);
+
+        if (existing) {
+            // A real USB-serial adapter, or a pty made by another program
+            fd_in = fd_out = open(existing, O_RDWR | O_NOCTTY | O_NONBLOCK);
+            if (fd_in < 0) {
+                fprintf(stderr, "[host] UART%d: cannot open %s: %s\n", uart_nr, existing, strerror(errno));
+                return;
+            }
+            if (isatty(fd_in)) makeRaw(fd_in, baud);
+            snprintf(path, sizeof(path), "%s", existing);
+        } else {
+            // Make a new pty: we keep the master, other programs open the slave
+            int master = posix_openpt(O_RDWR | O_NOCTTY);
+            if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+                fprintf(stderr, "[host] UART%d: no pseudo-terminal available\n", uart_nr);
+                return;
+            }
+            snprintf(path, sizeof(path), "%s", ptsname(master));
+            keep_fd = open(path, O_RDWR | O_NOCTTY);
+            if (keep_fd >= 0) makeRaw(keep_fd, baud);
+            fcntl(master, F_SETFL, O_NONBLOCK);
+            fd_in = fd_out = master;
+        }
+        fprintf(stderr, "[host] UART%d -> %s (%lu baud%s)\n", uart_nr, path, baud, pacing ? "" : ", no pacing");
+    }
+};
+
+inline HardwareSerial Serial(0);
+
+inline void hostUartReport()
+{
+    for (int i = 0; i < hostUartCount; i++) {
+        if (hostUartPorts[i]->portNumber() != 0) hostUartPorts[i]->report(stderr);
+    }
+}
+
+// Called from delay() and between loop() runs - our "UART interrupt"
+inline void hostPollUarts()
+{
+    for (int i = 0; i < hostUartCount; i++) {
+        hostUartPorts[i]->poll();
+    }
+
+    static double run_seconds = -1;
+    if (run_seconds < 0) {
+        const char* env = getenv("HOST_RUN_SECONDS");
+        run_seconds = env ? atof(env) : 0;
+    }
+    if (run_seconds > 0 && hostNanos() / 1e9 >= run_seconds) {
+        fflush(stdout);
+        exit(0);
+    }
+}
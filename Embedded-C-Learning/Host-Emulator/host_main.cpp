@@ -0,0 +1,21 @@
+/*
+ * HOST EMULATOR: main() for Arduino sketches
+ *
+ * On the board, the Arduino core calls setup() once and then loop()
+ * forever. This file does the same on your PC, and keeps the emulated
+ * UARTs moving between loop() runs.
+ */
+
+#include "Arduino.h"
+
+void setup();
+void loop();
+
+int main()
+{
+    setup();
+    for (;;) {
+        loop();
+        hostPollUarts();
+    }
+}
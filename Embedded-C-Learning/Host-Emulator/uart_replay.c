@@ -0,0 +1,438 @@
+/*
+ * HOST EMULATOR: uart_replay - stream recorded serial traffic into a UART
+ *
+ * What it does:
+ * - REPLAY: sends a recording into a serial device (the pty printed by a
+ *   host-built sketch, a real /dev/ttyUSB0, ...) at real speed, N times
+ *   faster, or as fast as the receiver can take it
+ * - RECORD: captures traffic from a real device with timestamps, so it
+ *   can be replayed later with the original timing
+ *
+ * Think of it like a tape recorder for your serial port:
+ * - Record the GPS module once, outdoors, with a real fix
+ * - Play it back at your desk as often as you like
+ * - Fast-forward to find out how much data your parser can handle
+ *
+ * Recording formats (picked by file extension):
+ *   .urec  Timestamped capture made with -r:
+ *          "UREC" | baud (u32) | records of [delta_us (u32) | length (u16) | bytes]
+ *   .hex   Text file of hex bytes ("00 0A 08 ..."); '#' starts a comment
+ *   other  Raw bytes, e.g. an NMEA log (.nmea)
+ * All numbers are little-endian.
+ *
+ * Build and use (with a sketch built against this folder):
+ *   gcc -O2 -o uart_replay uart_replay.c
+ *   ./sketch                    # prints: [host] UART1 -> /dev/pts/5 (9600 baud)
+ *   ./uart_replay -b 9600 /dev/pts/5 recordings/gps_neo6m.nmea            # real time
+ *   ./uart_replay -b 9600 -s 10 -n 5 /dev/pts/5 recordings/gps_neo6m.nmea # 10x, 5 times
+ *   ./uart_replay -s 0 -n 100 /dev/pts/5 recordings/gps_neo6m.nmea        # parser ceiling
+ *   ./uart_replay -r -b 9600 -t 60 /dev/ttyUSB0 capture.urec              # record 60 s
+ *
+ * The emulated UART still runs at the sketch's baud rate, so anything
+ * faster than -s 1 just piles up in the pty. For -s above 1, and for the
+ * ceiling (-s 0), start the sketch with HOST_UART_PACING=0 so the
+ * emulated UART doesn't limit the rate. The replay then blocks whenever the
+ * sketch falls behind, and the bytes/sec it reports is what the parser
+ * (plus everything else in loop()) can really sustain.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+
+#define BITS_PER_BYTE   10          // 8N1
+#define WIRE_CHUNK      16          // Bytes written per pacing step
+#define UREC_MAGIC      "UREC"
+
+// One piece of the recording: 'length' bytes at 'data', due 'at_ns' after start
+typedef struct {
+    uint64_t at_ns;
+    size_t   offset;
+    size_t   length;
+} chunk_t;
+
+typedef struct {
+    uint8_t* data;
+    size_t   size;
+    chunk_t* chunks;
+    size_t   chunk_count;
+    int      timed;                 // 1 = chunks carry recorded timestamps
+    uint32_t recorded_baud;
+} recording_t;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+void on_signal(int sig)
+{
+    (void)sig;
+    stop_requested = 1;
+}
+
+uint64_t nanos_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void sleep_until(uint64_t deadline)
+{
+    struct timespec ts = { (time_t)(deadline / 1000000000ull), (long)(deadline % 1000000000ull) };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+speed_t baud_to_speed(uint32_t baud)
+{
+    switch (baud) {
+        case 1200:   return B1200;
+        case 2400:   return B2400;
+        case 4800:   return B4800;
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default:     return B9600;
+    }
+}
+
+int open_serial(const char* path, uint32_t baud)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (isatty(fd)) {
+        struct termios tio;
+        tcgetattr(fd, &tio);
+        cfmakeraw(&tio);                // No echo, no \n -> \r\n translation
+        cfsetspeed(&tio, baud_to_speed(baud));
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+/*
+ * PART 1: Loading recordings
+ */
+uint8_t* read_whole_file(const char* path, size_t* size)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t* data = malloc(length > 0 ? (size_t)length : 1);
+    *size = data ? fread(data, 1, (size_t)length, f) : 0;
+    fclose(f);
+    return data;
+}
+
+int ends_with(const char* s, const char* suffix)
+{
+    size_t a = strlen(s);
+    size_t b = strlen(suffix);
+    return a >= b && strcmp(s + a - b, suffix) == 0;
+}
+
+// Hex text -> bytes, in place ("00 0A 08" -> 0x00 0x0A 0x08)
+size_t parse_hex(uint8_t* text, size_t size)
+{
+    size_t out = 0;
+    int high = -1;
+    for (size_t i = 0; i < size; i++) {
+        uint8_t c = text[i];
+        if (c == '#') {                     // Comment until end of line
+            while (i < size && text[i] != '\n') i++;
+            continue;
+        }
+        int nibble = (c >= '0' && c <= '9') ? c - '0' :
+                     (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                     (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+        if (nibble < 0) continue;           // Spaces, newlines, commas
+        if (high < 0) {
+            high = nibble;
+        } else {
+            text[out++] = (uint8_t)((high << 4) | nibble);
+            high = -1;
+        }
+    }
+    return out;
+}
+
+int load_recording(const char* path, recording_t* rec)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->data = read_whole_file(path, &rec->size);
+    if (!rec->data) return -1;
+
+    if (ends_with(path, ".urec")) {
+        if (rec->size < 8 || memcmp(rec->data, UREC_MAGIC, 4) != 0) {
+            fprintf(stderr, "%s is not a UREC recording\n", path);
+            return -1;
+        }
+        rec->timed = 1;
+        rec->recorded_baud = (uint32_t)rec->data[4] | (uint32_t)rec->data[5] << 8 |
+                             (uint32_t)rec->data[6] << 16 | (uint32_t)rec->data[7] << 24;
+
+        // First pass counts records, second pass fills them in
+        for (int pass = 0; pass < 2; pass++) {
+            size_t pos = 8;
+            size_t count = 0;
+            uint64_t at_ns = 0;
+            while (pos + 6 <= rec->size) {
+                const uint8_t* p = &rec->data[pos];
+                uint32_t delta_us = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+                size_t length = (size_t)p[4] | (size_t)p[5] << 8;
+                if (pos + 6 + length > rec->size) break;   // Torn last record
+                at_ns += (uint64_t)delta_us * 1000ull;
+                if (pass == 1) {
+                    rec->chunks[count].at_ns = at_ns;
+                    rec->chunks[count].offset = pos + 6;
+                    rec->chunks[count].length = length;
+                }
+                count++;
+                pos += 6 + length;
+            }
+            if (pass == 0) {
+                rec->chunks = calloc(count ? count : 1, sizeof(chunk_t));
+                if (!rec->chunks) return -1;
+            }
+            rec->chunk_count = count;
+        }
+        return 0;
+    }
+
+    if (ends_with(path, ".hex")) {
+        rec->size = parse_hex(rec->data, rec->size);
+    }
+
+    // Untimed: one chunk, paced by the baud rate
+    rec->chunks = calloc(1, sizeof(chunk_t));
+    if (!rec->chunks) return -1;
+    rec->chunks[0].length = rec->size;
+    rec->chunk_count = 1;
+    return 0;
+}
+
+/*
+ * PART 2: Replay
+ */
+typedef struct {
+    uint64_t bytes;
+    uint64_t lines;
+    uint64_t blocked_ns;            // Time spent waiting for the receiver
+} replay_stats_t;
+
+// Blocking write; time spent blocked = receiver is slower than we are
+int write_all(int fd, const uint8_t* data, size_t length, replay_stats_t* stats)
+{
+    while (length > 0 && !stop_requested) {
+        uint64_t before = nanos_now();
+        ssize_t n = write(fd, data, length);
+        stats->blocked_ns += nanos_now() - before;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "write failed: %s\n", strerror(errno));
+            return -1;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            stats->lines += data[i] == '\n';
+        }
+        stats->bytes += (uint64_t)n;
+        data += n;
+        length -= (size_t)n;
+    }
+    return 0;
+}
+
+int replay(int fd, const recording_t* rec, uint32_t baud, double speed, long loops, replay_stats_t* stats)
+{
+    // speed 0 = no pacing at all; otherwise bytes go out at (baud / 10) * speed per second
+    double ns_per_byte = speed > 0 ? BITS_PER_BYTE * 1e9 / baud / speed : 0;
+    uint64_t start = nanos_now();
+    uint64_t deadline = start;
+
+    for (long loop = 0; (loops == 0 || loop < loops) && !stop_requested; loop++) {
+        uint64_t loop_start = nanos_now();
+
+        for (size_t c = 0; c < rec->chunk_count && !stop_requested; c++) {
+            const chunk_t* chunk = &rec->chunks[c];
+            const uint8_t* data = rec->data + chunk->offset;
+
+            if (rec->timed && speed > 0) {
+                // Keep the recorded gaps (scaled by speed)
+                uint64_t due = loop_start + (uint64_t)(chunk->at_ns / speed);
+                if (due > deadline) deadline = due;
+            }
+
+            size_t step = speed > 0 ? WIRE_CHUNK : 4096;
+            for (size_t pos = 0; pos < chunk->length && !stop_requested; pos += step) {
+                size_t n = chunk->length - pos < step ? chunk->length - pos : step;
+                if (speed > 0) {
+                    deadline += (uint64_t)(n * ns_per_byte);
+                    sleep_until(deadline);
+                }
+                if (write_all(fd, data + pos, n, stats) < 0) return -1;
+            }
+        }
+    }
+
+    uint64_t elapsed = nanos_now() - start;
+    double seconds = elapsed / 1e9;
+    printf("Sent %llu bytes, %llu lines in %.2f s\n",
+           (unsigned long long)stats->bytes, (unsigned long long)stats->lines, seconds);
+    printf("  %.0f bytes/s (%.0f baud equivalent), %.0f lines/s\n",
+           stats->bytes / seconds, stats->bytes * BITS_PER_BYTE / seconds, stats->lines / seconds);
+    if (speed == 0) {
+        printf("  Receiver ceiling: the sketch consumed %.0f bytes/s (blocked %.0f%% of the time)\n",
+               stats->bytes / seconds, 100.0 * stats->blocked_ns / elapsed);
+    }
+    return 0;
+}
+
+/*
+ * PART 3: Record
+ */
+void put_le32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+int record(int fd, const char* device, const char* path, uint32_t baud, double seconds)
+{
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        fprintf(stderr, "Cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    uint8_t header[8];
+    memcpy(header, UREC_MAGIC, 4);
+    put_le32(&header[4], baud);
+    fwrite(header, 1, sizeof(header), out);
+
+    printf("Recording %s at %u baud into %s (Ctrl-C to stop)\n", device, (unsigned)baud, path);
+
+    uint64_t start = nanos_now();
+    uint64_t last = start;
+    uint64_t bytes = 0;
+    uint32_t records = 0;
+    struct pollfd pfd = { fd, POLLIN, 0 };
+
+    while (!stop_requested && (seconds <= 0 || nanos_now() - start < (uint64_t)(seconds * 1e9))) {
+        if (poll(&pfd, 1, 100) <= 0) continue;
+
+        uint8_t buffer[4096];
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) continue;
+
+        uint64_t now = nanos_now();
+        uint8_t rec_header[6];
+        put_le32(rec_header, (uint32_t)((now - last) / 1000ull));
+        rec_header[4] = (uint8_t)n;
+        rec_header[5] = (uint8_t)(n >> 8);
+        fwrite(rec_header, 1, sizeof(rec_header), out);
+        fwrite(buffer, 1, (size_t)n, out);
+
+        last = now;
+        bytes += (uint64_t)n;
+        records++;
+    }
+
+    fclose(out);
+    printf("Recorded %llu bytes in %u reads over %.1f s\n",
+           (unsigned long long)bytes, (unsigned)records, (nanos_now() - start) / 1e9);
+    return 0;
+}
+
+void usage(void)
+{
+    printf("usage: uart_replay [-b baud] [-s speed] [-n loops] DEVICE FILE\n");
+    printf("       uart_replay -r [-b baud] [-t seconds] DEVICE FILE.urec\n");
+    printf("  -b baud     line speed used for pacing (default 9600, or the one in a .urec)\n");
+    printf("  -s speed    1 = real time, 10 = 10x faster, 0 = as fast as the receiver takes it\n");
+    printf("  -n loops    play the recording this many times (0 = forever, default 1)\n");
+    printf("  -r          record from DEVICE into FILE instead of replaying\n");
+    printf("  -t seconds  stop recording after this long (default: until Ctrl-C)\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t baud = 0;
+    double speed = 1.0;
+    long loops = 1;
+    int recording = 0;
+    double seconds = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:s:n:rt:h")) != -1) {
+        switch (opt) {
+            case 'b': baud = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 's': speed = atof(optarg); break;
+            case 'n': loops = strtol(optarg, NULL, 10); break;
+            case 'r': recording = 1; break;
+            case 't': seconds = atof(optarg); break;
+            default:  usage(); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (argc - optind != 2 || speed < 0) {
+        usage();
+        return 2;
+    }
+    const char* device = argv[optind];
+    const char* file = argv[optind + 1];
+
+    signal(SIGINT, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    recording_t rec;
+    if (!recording) {
+        if (load_recording(file, &rec) < 0) return 1;
+        if (baud == 0) baud = rec.recorded_baud ? rec.recorded_baud : 9600;
+        printf("Loaded %s: %zu bytes%s\n", file, rec.size,
+               rec.timed ? " with recorded timing" : "");
+    } else if (baud == 0) {
+        baud = 9600;
+    }
+
+    int fd = open_serial(device, baud);
+    if (fd < 0) return 1;
+
+    int result;
+    if (recording) {
+        result = record(fd, device, file, baud, seconds);
+    } else {
+        replay_stats_t stats = {0};
+        if (speed == 0)
+            printf("Replaying into %s at %u baud, speed unlimited\n", device, (unsigned)baud);
+        else
+            printf("Replaying into %s at %u baud, speed x%.1f\n", device, (unsigned)baud, speed);
+        result = replay(fd, &rec, baud, speed, loops, &stats);
+        free(rec.data);
+        free(rec.chunks);
+    }
+
+    close(fd);
+    return result < 0 ? 1 : 0;
+}
@@ -5,6 +5,9 @@
  * - How to send and receive data over UART/Serial
  * - Communicating with sensors, GPS modules, other microcontrollers
  * - Data parsing and protocol handling
+ * - Binary framed protocols (sync, length, type, payload, CRC-16, COBS)
+ * - DMA-style receive: ping-pong buffers + idle-line detection
+ * - Buffered output: build a line in a buffer, send it with one write
  * - Real-world serial communication examples
  * 
  * UART = Universal Asynchronous Receiver Transmitter
@@ -35,23 +38,171 @@ HardwareSerial SensorSerial(2);  // Use UART2 for sensor
 
 // Data buffers for received messages
 char gps_buffer[128];
-char sensor_buffer[64];
 char command_buffer[32];
 
+// Binary sensor protocol (host version with benchmark: 05_binary_frame_protocol.c)
+// Wire format: 0x00 | COBS( LEN | TYPE | PAYLOAD[LEN] | CRC16_HI | CRC16_LO )
+#define FRAME_SYNC          0x00    // Start of every frame (never appears inside COBS data)
+#define FRAME_MAX_PAYLOAD   250     // Keeps the whole body inside one COBS block
+#define FRAME_HEADER_SIZE   2       // LEN + TYPE
+#define FRAME_CRC_SIZE      2       // CRC-16/CCITT, big-endian
+#define FRAME_BODY_MAX      (FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD + FRAME_CRC_SIZE)
+#define FRAME_MAX_ENCODED(len)  ((len) + FRAME_HEADER_SIZE + FRAME_CRC_SIZE + 3)
+
+// Message types
+#define MSG_TEMPERATURE     0x01    // int16  temperature in 0.01 °C
+#define MSG_HUMIDITY        0x02    // uint16 humidity in 0.01 %
+#define MSG_PRESSURE        0x03    // uint32 pressure in Pa (= 0.01 hPa)
+#define MSG_ALL             0x04    // temperature + humidity + pressure (8 bytes)
+#define MSG_STATUS          0x05    // uint8 sensor status flags
+#define MSG_READ_REQUEST    0x10    // uint8 message type we want the sensor to send
+
+typedef void (*FrameHandler)(uint8_t type, const uint8_t* payload, uint8_t length);
+
+// Incremental decoder state - each received byte is un-stuffed once into
+// 'body' and the handler gets a pointer into it (no payload copies)
+typedef struct {
+    uint8_t  body[FRAME_BODY_MAX];
+    uint16_t count;         // Body bytes decoded so far
+    uint16_t expected;      // Total body bytes (known once LEN arrives)
+    uint8_t  code;          // Current COBS block code
+    uint8_t  remaining;     // Data bytes left in the current COBS block
+    bool     in_frame;
+    FrameHandler handler;
+    uint32_t frames_ok;
+    uint32_t crc_errors;
+    uint32_t framing_errors;
+} FrameDecoder;
+
+// Encoder state: the current COBS block and where its code byte goes
+typedef struct {
+    uint8_t* out;
+    uint8_t* code_ptr;
+    uint8_t  code;
+} CobsWriter;
+
+void onSensorFrame(uint8_t type, const uint8_t* payload, uint8_t length);
+FrameDecoder sensorDecoder = { {0}, 0, 0, 0, 0, false, onSensorFrame, 0, 0, 0 };
+
+// CRC-16 lookup table (512 bytes), filled once in setup() - see 06_crc_engine.c
+uint16_t crc16_table[256];
+
+// DMA-style receive (host version with benchmark: 07_uart_dma_receive.c)
+// The UART driver calls our onReceive() callback when its FIFO holds 120 bytes
+// or when the line has been idle for RX_IDLE_SYMBOLS character times. The
+// callback moves everything into one of two ping-pong buffers; loop() parses
+// whole buffers instead of calling read() for every byte.
+#define RX_DMA_BUFFER_SIZE  256     // Size of EACH ping-pong buffer
+#define RX_IDLE_SYMBOLS     10      // setRxTimeout(): idle for 10 chars = flush
+#define UART_FIFO_FULL      120     // onReceive() also fires at this FIFO level
+#define UART_RX_RING_SIZE   1024    // Driver ring buffer behind the FIFO
+
+typedef struct {
+    uint8_t  buffers[2][RX_DMA_BUFFER_SIZE];
+    volatile uint16_t length[2];
+    volatile bool     ready[2];     // true = filled, waiting for loop()
+    uint8_t  fill_index;            // Changed by the callback, or by rxRelease() for a pending flush
+    uint8_t  parse_index;           // Only changed by loop()
+    bool     flush_pending;         // Idle flush found loop() busy - rxRelease() does it
+    uint32_t full_handoffs;
+    uint32_t idle_flushes;
+    uint32_t overruns;              // Both buffers busy - data dropped
+} RxPingPong;
+
+RxPingPong gpsRx;
+RxPingPong sensorRx;
+portMUX_TYPE rxMux = portMUX_INITIALIZER_UNLOCKED;  // Guards handoffs between callback and loop()
+
+// Buffered serial output (host version with benchmark: 08_buffered_serial_writer.c)
+// A report line is built in a stack buffer (no snprintf, no String) and sent
+// with ONE Serial.write(). Serial gets a 1 KB TX ring buffer, so the UART
+// interrupt drains it in the background instead of loop() waiting ~20 ms
+// for a status block to trickle out of the 128-byte FIFO at 115200 baud.
+#define LOG_RECORD_MAX      128     // Longest single record
+#define SERIAL_TX_BUFFER    1024    // Driver TX ring buffer for Serial
+#define LOG_MAX_DECIMALS    4
+
+typedef struct {
+    char     text[LOG_RECORD_MAX];
+    uint16_t length;
+    bool     truncated;             // Text didn't fit - the line was cut short
+} LogRecord;
+
+typedef struct {
+    uint32_t records;
+    uint32_t bytes;
+    uint32_t dropped;               // TX buffer full - whole record skipped
+    uint32_t blocked_us;            // Time loop() spent inside Serial.write()
+    uint32_t max_blocked_us;
+} SerialTxStats;
+
+SerialTxStats serialTx;
+
+// Function prototypes (the Arduino IDE generates these for us, but
+// writing them out lets the sketch also build with Host-Emulator on a PC)
+void handleSerialCommands();
+void processCommand(char* command);
+void requestGPSData();
+void handleGPSData();
+void gpsConsume(const uint8_t* data, size_t length);
+void parseGPSData(char* gps_sentence);
+void parseGPGGA(char* sentence);
+void parseGPRMC(char* sentence);
+void requestSensorData();
+void requestTemperature();
+void sendSensorRequest(uint8_t wanted_type);
+void handleSensorData();
+void onGPSReceive();
+void onSensorReceive();
+bool rxHandoff(RxPingPong* rx);
+void rxFill(RxPingPong* rx, HardwareSerial& port);
+bool rxTake(RxPingPong* rx, const uint8_t** data, size_t* length);
+void rxRelease(RxPingPong* rx);
+void crc16TableInit();
+uint16_t crc16Ccitt(uint16_t crc, const uint8_t* data, size_t length);
+void cobsPut(CobsWriter* w, uint8_t b);
+size_t frameEncode(uint8_t type, const uint8_t* payload, uint8_t length, uint8_t* out);
+bool frameStore(FrameDecoder* d, uint8_t b);
+void frameDecoderFeed(FrameDecoder* d, const uint8_t* data, size_t length);
+uint16_t getLE16(const uint8_t* p);
+void sendPeriodicUpdates();
+void recordReset(LogRecord* r);
+void recordAppend(LogRecord* r, const char* s, size_t n);
+void recordText(LogRecord* r, const char* s);
+void recordChar(LogRecord* r, char c);
+char* u32ToDigits(uint32_t v, char* end);
+void recordU32(LogRecord* r, uint32_t v);
+void recordI32(LogRecord* r, int32_t v);
+void recordFixed(LogRecord* r, float value, uint8_t decimals);
+void recordEnd(LogRecord* r);
+bool serialSend(const LogRecord* r);
+void logDataToSerial();
+void sendBinaryData();
+void printUARTTroubleshootingGuide();
+
 void setup() {
     // Initialize main serial (USB connection to computer)
+    Serial.setTxBufferSize(SERIAL_TX_BUFFER);  // Must be set before begin()
     Serial.begin(115200);
     while(!Serial) delay(10);  // Wait for serial to be ready
     
     Serial.println("=== ESP32 UART Communication Examples ===");
     Serial.println();
     
+    crc16TableInit();  // Frame CRCs use a lookup table: 1 lookup per byte instead of 8 shifts
+    
     // Initialize GPS serial port (9600 baud is common for GPS)
+    GPSSerial.setRxBufferSize(UART_RX_RING_SIZE);  // Must be set before begin()
     GPSSerial.begin(9600, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
+    GPSSerial.setRxTimeout(RX_IDLE_SYMBOLS);
+    GPSSerial.onReceive(onGPSReceive, false);      // FIFO-full AND idle timeout
     Serial.println("GPS Serial initialized (9600 baud)");
     
     // Initialize sensor serial port (38400 baud for faster sensor)
+    SensorSerial.setRxBufferSize(UART_RX_RING_SIZE);
     SensorSerial.begin(38400, SERIAL_8N1, SENSOR_RX_PIN, SENSOR_TX_PIN);
+    SensorSerial.setRxTimeout(RX_IDLE_SYMBOLS);
+    SensorSerial.onReceive(onSensorReceive, false);
     Serial.println("Sensor Serial initialized (38400 baud)");
     
     Serial.println("Type commands in Serial Monitor:");
@@ -146,22 +297,40 @@ void requestGPSData() {
 }
 
 void handleGPSData() {
+    const uint8_t* data;
+    size_t length;
+    
+    // Parse every buffer the receive callback has handed over
+    while(rxTake(&gpsRx, &data, &length)) {
+        gpsConsume(data, length);
+        rxRelease(&gpsRx);
+    }
+}
+
+// Split a received buffer into sentences: memchr() finds each '\n' and the
+// bytes before it are appended with one memcpy(). A sentence cut in half by
+// a buffer boundary is simply finished by the next buffer.
+void gpsConsume(const uint8_t* data, size_t length) {
     static uint8_t gps_index = 0;
     
-    while(GPSSerial.available()) {
-        char c = GPSSerial.read();
+    while(length > 0) {
+        const uint8_t* newline = (const uint8_t*)memchr(data, '\n', length);
+        size_t chunk = newline ? (size_t)(newline - data) : length;
         
-        if(c == '\n') {  // End of GPS sentence
-            gps_buffer[gps_index] = '\0';
-            
-            if(gps_index > 0) {
-                parseGPSData(gps_buffer);
-                gps_index = 0;
-            }
-        }
-        else if(gps_index < sizeof(gps_buffer) - 1) {
-            gps_buffer[gps_index++] = c;
-        }
+        size_t space = sizeof(gps_buffer) - 1 - gps_index;
+        size_t copy = chunk < space ? chunk : space;  // Over-long sentences get cut
+        memcpy(&gps_buffer[gps_index], data, copy);
+        gps_index += copy;
+        
+        if(!newline) break;  // Rest of the sentence is still on its way
+        
+        if(gps_index > 0 && gps_buffer[gps_index - 1] == '\r') gps_index--;
+        gps_buffer[gps_index] = '\0';
+        if(gps_index > 0) parseGPSData(gps_buffer);
+        gps_index = 0;
+        
+        data += chunk + 1;
+        length -= chunk + 1;
     }
 }
 
@@ -226,8 +395,8 @@ void parseGPRMC(char* sentence) {
 void requestSensorData() {
     Serial.println("Requesting sensor data...");
     
-    // Send command to sensor (custom protocol)
-    SensorSerial.println("READ_ALL");
+    // Ask the sensor for one MSG_ALL frame
+    sendSensorRequest(MSG_ALL);
     
     Serial.println("Sensor request sent. Waiting for response...");
 }
@@ -236,111 +405,346 @@ void requestTemperature() {
     Serial.println("Requesting temperature only...");
     
     // Send specific temperature request
-    SensorSerial.println("READ_TEMP");
+    sendSensorRequest(MSG_TEMPERATURE);
+}
+
+void sendSensorRequest(uint8_t wanted_type) {
+    uint8_t frame[FRAME_MAX_ENCODED(1)];
+    size_t size = frameEncode(MSG_READ_REQUEST, &wanted_type, 1, frame);
+    SensorSerial.write(frame, size);
 }
 
 void handleSensorData() {
-    static uint8_t sensor_index = 0;
+    const uint8_t* data;
+    size_t length;
     
-    while(SensorSerial.available()) {
-        char c = SensorSerial.read();
+    // The frame decoder takes whole buffers; frames go to onSensorFrame()
+    while(rxTake(&sensorRx, &data, &length)) {
+        frameDecoderFeed(&sensorDecoder, data, length);
+        rxRelease(&sensorRx);
+    }
+}
+
+/*
+ * Ping-pong receive buffers
+ * The callback only touches buffers[fill_index], loop() only touches
+ * buffers[parse_index]. A buffer changes owner when it is full or when
+ * the line goes idle - like a DMA "transfer complete" or "idle" interrupt.
+ */
+void onGPSReceive() {
+    rxFill(&gpsRx, GPSSerial);
+}
+
+void onSensorReceive() {
+    rxFill(&sensorRx, SensorSerial);
+}
+
+// Give the filling buffer to loop(); false if loop() still owns the other one
+// (then we keep appending - a buffer is only dropped when it is full).
+// Call with rxMux held.
+bool rxHandoff(RxPingPong* rx) {
+    uint8_t next = rx->fill_index ^ 1;
+    if(rx->ready[next]) {
+        if(rx->length[rx->fill_index] == RX_DMA_BUFFER_SIZE) {
+            rx->overruns++;                // Parser too slow and no room left - drop it
+            rx->length[rx->fill_index] = 0;
+        }
+        return false;
+    }
+    rx->ready[rx->fill_index] = true;
+    rx->fill_index = next;
+    return true;
+}
+
+void rxFill(RxPingPong* rx, HardwareSerial& port) {
+    size_t received = 0;
+    int available;
+    
+    portENTER_CRITICAL(&rxMux);
+    rx->flush_pending = false;             // We're running: the idle check below covers it
+    portEXIT_CRITICAL(&rxMux);
+    
+    while((available = port.available()) > 0) {
+        uint8_t index = rx->fill_index;
+        uint16_t used = rx->length[index];
+        size_t space = RX_DMA_BUFFER_SIZE - used;
+        size_t n = port.readBytes(&rx->buffers[index][used], (size_t)available < space ? available : space);
         
-        if(c == '\n') {  // End of sensor message
-            sensor_buffer[sensor_index] = '\0';
-            
-            if(sensor_index > 0) {
-                parseSensorData(sensor_buffer);
-                sensor_index = 0;
-            }
+        rx->length[index] = used + n;
+        received += n;
+        if(rx->length[index] == RX_DMA_BUFFER_SIZE) {
+            portENTER_CRITICAL(&rxMux);
+            if(rxHandoff(rx)) rx->full_handoffs++;
+            portEXIT_CRITICAL(&rxMux);
         }
-        else if(sensor_index < sizeof(sensor_buffer) - 1) {
-            sensor_buffer[sensor_index++] = c;
+    }
+    
+    // Fewer bytes than the FIFO threshold means the idle timeout woke us:
+    // hand over the partial buffer so short messages aren't left waiting.
+    // If loop() still owns the other buffer, the line may stay quiet and
+    // never call us again - so rxRelease() finishes the flush instead.
+    if(received < UART_FIFO_FULL && rx->length[rx->fill_index] > 0) {
+        portENTER_CRITICAL(&rxMux);
+        if(rxHandoff(rx)) {
+            rx->idle_flushes++;
+        } else {
+            rx->flush_pending = true;
         }
+        portEXIT_CRITICAL(&rxMux);
     }
 }
 
-void parseSensorData(char* sensor_message) {
-    Serial.print("Sensor: ");
-    Serial.println(sensor_message);
+bool rxTake(RxPingPong* rx, const uint8_t** data, size_t* length) {
+    uint8_t index = rx->parse_index;
+    if(!rx->ready[index]) return false;
     
-    // Parse different sensor message types
-    if(strncmp(sensor_message, "TEMP:", 5) == 0) {
-        float temperature = atof(&sensor_message[5]);
-        Serial.print("  → Temperature: ");
-        Serial.print(temperature);
-        Serial.println("°C");
-    }
-    else if(strncmp(sensor_message, "HUMIDITY:", 9) == 0) {
-        float humidity = atof(&sensor_message[9]);
-        Serial.print("  → Humidity: ");
-        Serial.print(humidity);
-        Serial.println("%");
+    *data = rx->buffers[index];
+    *length = rx->length[index];
+    return true;
+}
+
+void rxRelease(RxPingPong* rx) {
+    uint8_t index = rx->parse_index;
+    portENTER_CRITICAL(&rxMux);
+    rx->length[index] = 0;
+    rx->ready[index] = false;              // Buffer goes back to the callback
+    rx->parse_index = index ^ 1;
+    if(rx->flush_pending) {                // Idle flush the callback couldn't do
+        rx->flush_pending = false;
+        if(rxHandoff(rx)) rx->idle_flushes++;
     }
-    else if(strncmp(sensor_message, "PRESSURE:", 9) == 0) {
-        float pressure = atof(&sensor_message[9]);
-        Serial.print("  → Pressure: ");
-        Serial.print(pressure);
-        Serial.println(" hPa");
+    portEXIT_CRITICAL(&rxMux);
+}
+
+/*
+ * Binary frame codec
+ * CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) seals LEN, TYPE and PAYLOAD.
+ */
+void crc16TableInit() {
+    // crc16_table[i] = what 8 bitwise CRC steps do to byte value i
+    for(uint16_t i = 0; i < 256; i++) {
+        uint16_t crc = i << 8;
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+        crc16_table[i] = crc;
     }
-    else if(strncmp(sensor_message, "ALL:", 4) == 0) {
-        parseAllSensorData(&sensor_message[4]);
+}
+
+uint16_t crc16Ccitt(uint16_t crc, const uint8_t* data, size_t length) {
+    while(length--) {
+        crc = (crc << 8) ^ crc16_table[(crc >> 8) ^ *data++];
     }
-    else {
-        Serial.println("  → Unknown sensor message format");
+    return crc;
+}
+
+// COBS writer: zeros are replaced by block lengths, so 0x00 only ever means "sync"
+void cobsPut(CobsWriter* w, uint8_t b) {
+    if(b != 0) {
+        *w->out++ = b;
+        if(++w->code != 0xFF) return;  // Block not full yet
     }
+    *w->code_ptr = w->code;            // Close block (zero is implied unless full)
+    w->code_ptr = w->out++;
+    w->code = 1;
 }
 
-void parseAllSensorData(char* data) {
-    // Example format: "25.3,60.1,1013.2" (temp,humidity,pressure)
-    Serial.println("  → Parsing all sensor data:");
-    
-    char* temp_str = strtok(data, ",");
-    char* humid_str = strtok(NULL, ",");
-    char* pressure_str = strtok(NULL, ",");
+size_t frameEncode(uint8_t type, const uint8_t* payload, uint8_t length, uint8_t* out) {
+    if(length > FRAME_MAX_PAYLOAD) return 0;
+    
+    uint8_t header[FRAME_HEADER_SIZE] = { length, type };
+    uint16_t crc = crc16Ccitt(0xFFFF, header, sizeof(header));
+    crc = crc16Ccitt(crc, payload, length);
+    
+    out[0] = FRAME_SYNC;
+    CobsWriter w = { out + 2, out + 1, 1 };
+    cobsPut(&w, length);
+    cobsPut(&w, type);
+    for(uint8_t i = 0; i < length; i++) {
+        cobsPut(&w, payload[i]);
+    }
+    cobsPut(&w, crc >> 8);
+    cobsPut(&w, crc & 0xFF);
+    *w.code_ptr = w.code;
     
-    if(temp_str) {
-        Serial.print("    Temperature: ");
-        Serial.print(temp_str);
-        Serial.println("°C");
+    return w.out - out;
+}
+
+// Returns true when the frame is finished (delivered or dropped)
+bool frameStore(FrameDecoder* d, uint8_t b) {
+    d->body[d->count++] = b;
+    
+    if(d->count == 1) {
+        if(b > FRAME_MAX_PAYLOAD) {    // Impossible length - garbage on the line
+            d->framing_errors++;
+            return true;
+        }
+        d->expected = b + FRAME_HEADER_SIZE + FRAME_CRC_SIZE;
+        return false;
     }
+    if(d->count < d->expected) return false;
     
-    if(humid_str) {
-        Serial.print("    Humidity: ");
-        Serial.print(humid_str);
-        Serial.println("%");
+    uint8_t length = d->body[0];
+    uint16_t received = (d->body[length + 2] << 8) | d->body[length + 3];
+    if(crc16Ccitt(0xFFFF, d->body, length + FRAME_HEADER_SIZE) != received) {
+        d->crc_errors++;
+        return true;
     }
     
-    if(pressure_str) {
-        Serial.print("    Pressure: ");
-        Serial.print(pressure_str);
-        Serial.println(" hPa");
+    d->frames_ok++;
+    d->handler(d->body[1], &d->body[FRAME_HEADER_SIZE], length);
+    return true;
+}
+
+// Works with one byte (from read()) or a whole buffer at a time
+void frameDecoderFeed(FrameDecoder* d, const uint8_t* data, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        uint8_t b = data[i];
+        
+        if(b == FRAME_SYNC) {          // New frame starts - resynchronize
+            if(d->in_frame && d->count > 0) d->framing_errors++;
+            d->in_frame = true;
+            d->count = 0;
+            d->remaining = 0;
+            d->code = 0xFF;            // No implied zero before the first block
+            continue;
+        }
+        if(!d->in_frame) continue;     // Noise between frames
+        
+        bool done;
+        if(d->remaining == 0) {        // COBS code byte
+            done = (d->code != 0xFF) && frameStore(d, 0);
+            d->code = b;
+            d->remaining = b - 1;
+        } else {
+            d->remaining--;
+            done = frameStore(d, b);
+        }
+        if(done) d->in_frame = false;  // Wait for the next sync byte
     }
 }
 
+// Little-endian fields are read straight out of the decoder's buffer
+uint16_t getLE16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+uint32_t getLE32(const uint8_t* p) { return getLE16(p) | ((uint32_t)getLE16(p + 2) << 16); }
+
+void onSensorFrame(uint8_t type, const uint8_t* payload, uint8_t length) {
+    switch(type) {
+        case MSG_TEMPERATURE:
+            if(length < 2) break;
+            Serial.print("Sensor → Temperature: ");
+            Serial.print((int16_t)getLE16(payload) / 100.0);
+            Serial.println("°C");
+            return;
+        case MSG_HUMIDITY:
+            if(length < 2) break;
+            Serial.print("Sensor → Humidity: ");
+            Serial.print(getLE16(payload) / 100.0);
+            Serial.println("%");
+            return;
+        case MSG_PRESSURE:
+            if(length < 4) break;
+            Serial.print("Sensor → Pressure: ");
+            Serial.print(getLE32(payload) / 100.0);
+            Serial.println(" hPa");
+            return;
+        case MSG_ALL:
+            if(length < 8) break;
+            Serial.println("Sensor → All sensor data:");
+            Serial.print("    Temperature: ");
+            Serial.print((int16_t)getLE16(&payload[0]) / 100.0);
+            Serial.println("°C");
+            Serial.print("    Humidity: ");
+            Serial.print(getLE16(&payload[2]) / 100.0);
+            Serial.println("%");
+            Serial.print("    Pressure: ");
+            Serial.print(getLE32(&payload[4]) / 100.0);
+            Serial.println(" hPa");
+            return;
+        case MSG_STATUS:
+            if(length < 1) break;
+            Serial.print("Sensor → Status flags: 0x");
+            Serial.println(payload[0], HEX);
+            return;
+    }
+    Serial.print("Sensor → Unknown frame type 0x");
+    Serial.println(type, HEX);
+}
+
 /*
  * EXAMPLE 4: Periodic Status Updates
  */
 void sendPeriodicUpdates() {
     static uint32_t last_update = 0;
+    static uint32_t last_records = 0;
     const uint32_t UPDATE_INTERVAL = 30000;  // 30 seconds
     
     if(millis() - last_update >= UPDATE_INTERVAL) {
-        Serial.println("=== Periodic Status Update ===");
-        Serial.print("System uptime: ");
-        Serial.print(millis() / 1000);
-        Serial.println(" seconds");
+        // Each line is built in a buffer and sent with one write
+        LogRecord r;
         
-        Serial.print("Free heap: ");
-        Serial.print(ESP.getFreeHeap());
-        Serial.println(" bytes");
+        recordReset(&r);
+        recordText(&r, "=== Periodic Status Update ===");
+        recordEnd(&r);
+        recordText(&r, "System uptime: ");
+        recordU32(&r, millis() / 1000);
+        recordText(&r, " seconds");
+        recordEnd(&r);
+        serialSend(&r);
+        
+        recordReset(&r);
+        recordText(&r, "Free heap: ");
+        recordU32(&r, ESP.getFreeHeap());
+        recordText(&r, " bytes");
+        recordEnd(&r);
+        serialSend(&r);
         
         // Send status to connected devices
         GPSSerial.println("$PMTK301,2*2E");  // Example GPS status request
-        SensorSerial.println("STATUS");        // Request sensor status
+        sendSensorRequest(MSG_STATUS);         // Request sensor status
+        
+        recordReset(&r);
+        recordText(&r, "Sensor frames: ");
+        recordU32(&r, sensorDecoder.frames_ok);
+        recordText(&r, " ok, ");
+        recordU32(&r, sensorDecoder.crc_errors);
+        recordText(&r, " CRC errors, ");
+        recordU32(&r, sensorDecoder.framing_errors);
+        recordText(&r, " framing errors");
+        recordEnd(&r);
+        serialSend(&r);
         
-        Serial.println("Status update complete.");
-        Serial.println();
+        recordReset(&r);
+        recordText(&r, "RX buffers (GPS/sensor): ");
+        recordU32(&r, gpsRx.full_handoffs + gpsRx.idle_flushes);
+        recordChar(&r, '/');
+        recordU32(&r, sensorRx.full_handoffs + sensorRx.idle_flushes);
+        recordText(&r, ", overruns: ");
+        recordU32(&r, gpsRx.overruns);
+        recordChar(&r, '/');
+        recordU32(&r, sensorRx.overruns);
+        recordEnd(&r);
+        serialSend(&r);
         
+        // How the output path itself is doing
+        uint32_t elapsed = millis() - last_update;
+        recordReset(&r);
+        recordText(&r, "Serial out: ");
+        recordFixed(&r, (serialTx.records - last_records) * 1000.0f / elapsed, 1);
+        recordText(&r, " records/s, ");
+        recordU32(&r, serialTx.dropped);
+        recordText(&r, " dropped, blocked ");
+        recordU32(&r, serialTx.blocked_us);
+        recordText(&r, " us (worst ");
+        recordU32(&r, serialTx.max_blocked_us);
+        recordText(&r, " us)");
+        recordEnd(&r);
+        recordText(&r, "Status update complete.");
+        recordEnd(&r);
+        recordEnd(&r);
+        serialSend(&r);
+        
+        last_records = serialTx.records;
         last_update = millis();
     }
 }
@@ -348,19 +752,156 @@ void sendPeriodicUpdates() {
 /*
  * EXAMPLE 5: Data Logging Over UART
  */
+
+// Record builder: text goes straight into the buffer, no snprintf/String.
+// The same code is in Module3 02_uart_communication.c and Module5
+// 02_hardware_timers.c (sketches don't share files) - keep them identical.
+
+// "00" "01" ... "99": two digits per division halves the divides
+const char digitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+const uint32_t pow10Table[LOG_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000 };
+
+void recordReset(LogRecord* r) {
+    r->length = 0;
+    r->truncated = false;
+}
+
+void recordAppend(LogRecord* r, const char* s, size_t n) {
+    // Always keep room for \r\n (length can't pass LOG_RECORD_MAX - 2 here)
+    size_t room = r->length < LOG_RECORD_MAX - 2 ? (LOG_RECORD_MAX - 2) - r->length : 0;
+    if(n > room) {
+        n = room;
+        r->truncated = true;
+    }
+    memcpy(r->text + r->length, s, n);
+    r->length += n;
+}
+
+void recordText(LogRecord* r, const char* s) {
+    recordAppend(r, s, strlen(s));
+}
+
+void recordChar(LogRecord* r, char c) {
+    recordAppend(r, &c, 1);
+}
+
+// Writes the digits of v so they END at 'end'; returns where they start
+char* u32ToDigits(uint32_t v, char* end) {
+    char* p = end;
+    while(v >= 100) {
+        uint32_t pair = (v % 100) * 2;
+        v /= 100;
+        *--p = digitPairs[pair + 1];
+        *--p = digitPairs[pair];
+    }
+    if(v >= 10) {
+        *--p = digitPairs[v * 2 + 1];
+        *--p = digitPairs[v * 2];
+    } else {
+        *--p = '0' + v;
+    }
+    return p;
+}
+
+void recordU32(LogRecord* r, uint32_t v) {
+    char buf[10];
+    char* start = u32ToDigits(v, buf + sizeof(buf));
+    recordAppend(r, start, buf + sizeof(buf) - start);
+}
+
+void recordI32(LogRecord* r, int32_t v) {
+    if(v < 0) {
+        recordChar(r, '-');
+        recordU32(r, 0u - (uint32_t)v);
+    } else {
+        recordU32(r, v);
+    }
+}
+
+// Same text as Serial.print(value, decimals), without the float printing code.
+// No double math - the ESP32 FPU only does float, doubles run in software.
+// The whole part and the fraction of a float are both exact, and the fraction
+// is scaled with integers (32.32 fixed point), so rounding matches exactly.
+void recordFixed(LogRecord* r, float value, uint8_t decimals) {
+    if(isnan(value)) { recordText(r, "nan"); return; }
+    if(isinf(value)) { recordText(r, "inf"); return; }
+    if(decimals > LOG_MAX_DECIMALS) decimals = LOG_MAX_DECIMALS;
+    
+    float magnitude = fabsf(value);
+    if(magnitude > 4294967040.0f) { recordText(r, "ovf"); return; }  // Same limit as Print
+    
+    uint32_t scale = pow10Table[decimals];
+    uint32_t whole = (uint32_t)magnitude;
+    uint32_t frac32 = (uint32_t)((magnitude - (float)whole) * 4294967296.0f);
+    uint32_t fraction = (uint32_t)(((uint64_t)frac32 * scale + 0x80000000u) >> 32);  // Round half away from zero
+    if(fraction == scale) {                         // 0.99996 -> "1.0000"
+        fraction = 0;
+        whole++;
+    }
+    
+    char buf[16];
+    char* end = buf + sizeof(buf);
+    char* p = end;
+    if(decimals > 0) {
+        char* frac_end = p;
+        p = u32ToDigits(fraction, p);
+        while(frac_end - p < decimals) *--p = '0';  // 0.05 -> "05"
+        *--p = '.';
+    }
+    p = u32ToDigits(whole, p);
+    if(value < 0 && (whole | fraction) != 0) *--p = '-';  // No "-0.00"
+    recordAppend(r, p, end - p);
+}
+
+// A record can hold several lines: the next \r\n must still fit
+void recordEnd(LogRecord* r) {
+    if(r->length > LOG_RECORD_MAX - 2) {
+        r->length = LOG_RECORD_MAX - 2;
+        r->truncated = true;
+    }
+    r->text[r->length++] = '\r';
+    r->text[r->length++] = '\n';
+}
+
+// One write per record. If the TX buffer can't take the WHOLE record we skip
+// it and count it - half a line is worse than no line, and waiting here
+// would stall the GPS and sensor parsing in loop().
+bool serialSend(const LogRecord* r) {
+    if(Serial.availableForWrite() < r->length) {
+        serialTx.dropped++;
+        return false;
+    }
+    uint32_t start = micros();
+    Serial.write((const uint8_t*)r->text, r->length);
+    uint32_t blocked = micros() - start;
+    
+    serialTx.blocked_us += blocked;
+    if(blocked > serialTx.max_blocked_us) serialTx.max_blocked_us = blocked;
+    serialTx.records++;
+    serialTx.bytes += r->length;
+    return true;
+}
+
 void logDataToSerial() {
     // Create CSV-format data log
-    Serial.print(millis());
-    Serial.print(",");
+    LogRecord r;
+    recordReset(&r);
+    recordU32(&r, millis());
+    recordChar(&r, ',');
     
     // Simulate sensor readings
     float temperature = 25.0 + (random(-50, 50) / 10.0);
     float humidity = 60.0 + (random(-200, 200) / 10.0);
     
-    Serial.print(temperature);
-    Serial.print(",");
-    Serial.print(humidity);
-    Serial.println();
+    recordFixed(&r, temperature, 2);
+    recordChar(&r, ',');
+    recordFixed(&r, humidity, 2);
+    recordEnd(&r);
+    serialSend(&r);
 }
 
 /*
@@ -368,26 +909,34 @@ void logDataToSerial() {
  */
 void sendBinaryData() {
     // Sometimes you need to send binary data (not text)
-    uint8_t binary_packet[] = {
-        0xAA,           // Start marker
-        0x05,           // Data length
-        0x12, 0x34,     // Temperature (big-endian)
-        0x56, 0x78,     // Humidity (big-endian)
-        0x9A,           // Checksum
-        0x55            // End marker
+    // Fixed-point fields: 25.30 °C → 2530, 60.10 % → 6010, 1013.20 hPa → 101320 Pa
+    int16_t temperature = 2530;
+    uint16_t humidity = 6010;
+    uint32_t pressure = 101320;
+    
+    uint8_t payload[8] = {
+        (uint8_t)temperature, (uint8_t)(temperature >> 8),     // Little-endian
+        (uint8_t)humidity,    (uint8_t)(humidity >> 8),
+        (uint8_t)pressure,    (uint8_t)(pressure >> 8),
+        (uint8_t)(pressure >> 16), (uint8_t)(pressure >> 24)
     };
     
-    Serial.println("Sending binary packet:");
-    for(uint8_t i = 0; i < sizeof(binary_packet); i++) {
+    uint8_t frame[FRAME_MAX_ENCODED(sizeof(payload))];
+    size_t size = frameEncode(MSG_ALL, payload, sizeof(payload), frame);
+    
+    Serial.print("Sending binary frame (");
+    Serial.print(size);
+    Serial.println(" bytes, text would be 21):");
+    for(uint8_t i = 0; i < size; i++) {
         Serial.print("0x");
-        if(binary_packet[i] < 0x10) Serial.print("0");
-        Serial.print(binary_packet[i], HEX);
+        if(frame[i] < 0x10) Serial.print("0");
+        Serial.print(frame[i], HEX);
         Serial.print(" ");
-        
-        // Actually send the byte
-        SensorSerial.write(binary_packet[i]);
     }
     Serial.println();
+    
+    // Send the whole frame in one call
+    SensorSerial.write(frame, size);
 }
 
 /*
@@ -417,8 +966,8 @@ void printUARTTroubleshootingGuide() {
     Serial.println("Solutions:");
     Serial.println("1. Add flow control (RTS/CTS)");
     Serial.println("2. Increase buffer sizes");
-    Serial.println("3. Process received data faster");
-    Serial.println("4. Add checksums for error detection");
+    Serial.println("3. Process received data faster (whole buffers, not bytes)");
+    Serial.println("4. Add CRCs for error detection (see sendBinaryData)");
     Serial.println();
 }
 
@@ -452,6 +1001,7 @@ void printUARTTroubleshootingGuide() {
  * 2. ESP32 has multiple UART ports (Serial, Serial1, Serial2)
  * 3. Different devices use different baud rates and protocols
  * 4. Data can be text-based (ASCII) or binary
+ *    - Binary frames need a sync byte, a length and a CRC to be reliable
  * 5. Parsing received data requires careful string/buffer handling
  * 6. Real protocols like NMEA (GPS) have specific formats
  * 7. Error handling and troubleshooting are essential
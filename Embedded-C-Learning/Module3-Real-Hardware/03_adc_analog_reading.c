@@ -6,6 +6,13 @@
  * - Converting ADC values to real-world measurements
  * - Reading temperature, light, potentiometer, battery voltage
  * - ADC resolution, reference voltage, and calibration
+ * - Oversampling: a timer fills a sample ring, loop() averages 256 samples
+ *   into one 16-bit result - without ever calling delay()
+ * - Filtering the results: a median against spikes, an EMA against noise
+ * - A calibration table: raw counts -> real millivolts with one array read,
+ *   fixing the ESP32 ADC's dead zone and its knee above ~2.4V
+ * - A scan sequencer: all four sensors sampled on one timer, each at its
+ *   own rate, stored as timestamped frames taken at the same moment
  * 
  * ADC = Analog-to-Digital Converter
  * Think of it like a voltage meter that gives you numbers:
@@ -32,6 +39,107 @@
 #define TEMP_SENSOR_OFFSET_C    50  // TMP36: 500mV at 0°C
 #define VOLTAGE_DIVIDER_RATIO   2.0 // For battery voltage measurement
 
+// ADC calibration table (host version with benchmark: 12_adc_calibration_lut.c)
+// The ESP32 ADC is NOT a straight line: it reads 0 below ~100mV and flattens
+// above ~2.4V. These points were measured with a multimeter: the average raw
+// reading (x 16, to keep the fraction) for a known input voltage.
+// Typical values for 11dB attenuation - measure your own board for best results!
+struct AdcCalPoint {
+    uint16_t code_x16;      // Average raw reading x 16
+    uint16_t millivolts;    // What the multimeter said
+};
+
+const AdcCalPoint adcCalibration[] = {
+    { 1173,  150}, { 6793,  400}, {13552,  700}, {20331, 1000},
+    {27148, 1300}, {33985, 1600}, {40874, 1900}, {47788, 2200},
+    {52416, 2400}, {55640, 2550}, {58384, 2700}, {60038, 2800},
+    {61573, 2900}, {63021, 3000}, {64127, 3080}, {65056, 3150},
+};
+const int ADC_CAL_POINTS = sizeof(adcCalibration) / sizeof(adcCalibration[0]);
+
+uint16_t adcMillivoltsLut[ADC_RESOLUTION];  // Raw code -> millivolts, 8 KB, built in setup()
+
+// Oversampling pipeline (host version with synthetic signals: 10_adc_oversampling.c)
+// Timer -> scan sequencer -> frame ring -> boxcar decimator -> result with a ready flag
+#define SAMPLE_RATE_HZ          1024    // Timer-triggered scans per second
+#define SAMPLE_PERIOD_US        (1000000 / SAMPLE_RATE_HZ)  // 976 us
+#define SAMPLE_RING_SIZE        1024    // Power of two: 1 second of frames
+#define OVERSAMPLE_EXTRA_BITS   4       // 4^4 = 256 samples -> 4 extra bits
+#define OVERSAMPLE_RATIO        (1 << (2 * OVERSAMPLE_EXTRA_BITS))
+#define OVERSAMPLED_MAX_VALUE   (ADC_MAX_VALUE << OVERSAMPLE_EXTRA_BITS)  // 16-bit: 65520
+
+// Scan sequencer (host version with a simulated ADC: 13_adc_scan_sequencer.c)
+// Every timer tick is one scan; each channel is converted every "divider"
+// ticks, at tick "phase" - so the slow channels never pile up on one tick
+#define SCAN_TEMP       0
+#define SCAN_LIGHT      1
+#define SCAN_POT        2
+#define SCAN_BATTERY    3
+#define SCAN_CHANNELS   4
+
+struct ScanChannel {
+    uint8_t pin;
+    uint16_t divider;       // 1 = every tick, 16 = every 16th tick...
+    uint16_t phase;         // 0 .. divider-1
+};
+
+const ScanChannel scanChannels[SCAN_CHANNELS] = {
+    {TEMP_SENSOR_PIN,        1,   0},   // 1024 Hz - feeds the oversampler
+    {LIGHT_SENSOR_PIN,      16,   5},   //   64 Hz
+    {POTENTIOMETER_PIN,     32,  11},   //   32 Hz
+    {BATTERY_VOLTAGE_PIN, 1024, 519},   //    1 Hz - a battery doesn't change fast
+};
+
+// One frame from the ring: every channel's value and when it was converted
+struct ScanFrame {
+    uint32_t tick;                          // Scan number since start
+    uint32_t timeUs;                        // micros() at the start of the scan
+    uint8_t fresh;                          // Bit c = channel c converted in this scan
+    uint16_t raw[SCAN_CHANNELS];
+    uint32_t sampleTimeUs[SCAN_CHANNELS];   // Held values: when they were really taken
+};
+
+hw_timer_t *sampleTimer = NULL;
+TaskHandle_t samplerTaskHandle = NULL;
+
+// Sampler task state
+uint16_t scanCountdown[SCAN_CHANNELS];  // Ticks until each channel is due again
+uint16_t scanHeld[SCAN_CHANNELS];       // Last value of each channel
+uint32_t scanTick = 0;
+
+// Channel-major frame ring: scanSamples[channel][frame]. A filter reads one
+// row in order, a "what are all sensors reading now" report reads one column.
+// Written by the sampler task (head) and loop() (tail) - nobody else
+uint16_t scanSamples[SCAN_CHANNELS][SAMPLE_RING_SIZE];
+uint32_t scanFrameTick[SAMPLE_RING_SIZE];
+uint32_t scanFrameTime[SAMPLE_RING_SIZE];
+uint8_t scanFrameFresh[SAMPLE_RING_SIZE];
+volatile uint32_t sampleHead = 0;       // Next frame the sampler writes
+volatile uint32_t sampleTail = 0;       // Next frame loop() reads
+volatile uint32_t samplesDropped = 0;   // Ring full, or a timer tick was missed
+
+// Decimator state: sum-and-dump over OVERSAMPLE_RATIO samples
+uint32_t boxcarSum = 0;
+uint32_t boxcarCount = 0;
+
+struct OversampledReading {
+    uint16_t value;         // 0-65520 for 0-3.3V (12-bit reading x 16)
+    uint16_t filtered;      // Same scale, after the median + EMA filters
+    uint32_t sequence;      // Counts results - shows if a reader missed some
+    bool ready;             // Set when a new result is published, reader clears it
+};
+
+OversampledReading tempReading = {0, 0, 0, false};
+
+// Filters on the oversampled results (host version with benchmark: 11_digital_filters.c)
+// Median of 5 drops spikes, then a fixed-point EMA with alpha = 1/4 (a shift, no float)
+#define RESULT_MEDIAN_WINDOW    5
+#define RESULT_EMA_SHIFT        2
+uint16_t medianHistory[RESULT_MEDIAN_WINDOW];
+int medianCount = 0;
+int medianPos = 0;
+uint32_t emaValueQ8 = 0;    // EMA with 8 fraction bits: value x 256
+
 void setup() {
     Serial.begin(115200);
     while(!Serial) delay(10);
@@ -62,49 +170,249 @@ void setup() {
     Serial.println("- Battery voltage divider on GPIO 35");
     Serial.println();
     
+    buildAdcCalibration();
+    startOversampling();
+    
     delay(1000);
 }
 
 void loop() {
+    // Empty the sample ring into the decimator - takes microseconds, never waits
+    runOversamplingPipeline();
+    
+    // Print a full sensor report every 5 seconds
+    static unsigned long lastCycle = 0;
+    if (lastCycle == 0 || millis() - lastCycle >= 5000) {
+        lastCycle = millis();
+        runSensorCycle();
+    }
+}
+
+void runSensorCycle() {
     Serial.println("=== Sensor Reading Cycle ===");
     
-    // Read all sensors
-    readTemperatureSensor();
-    delay(100);
-    
-    readLightSensor(); 
-    delay(100);
-    
-    readPotentiometer();
-    delay(100);
+    // All sensors from ONE scan frame - taken within microseconds of each other,
+    // not 100 ms apart like separate analogRead() calls with delays in between
+    ScanFrame frame;
+    if (!getLatestFrame(&frame)) {
+        Serial.println("No scan frame yet");
+        return;
+    }
+    printFrameTiming(&frame);
     
-    readBatteryVoltage();
-    delay(100);
+    readTemperatureSensor(frame.raw[SCAN_TEMP]);
+    readLightSensor(frame.raw[SCAN_LIGHT]);
+    readPotentiometer(frame.raw[SCAN_POT]);
+    readBatteryVoltage(frame.raw[SCAN_BATTERY]);
     
     // Advanced examples
-    demonstrateAveraging();
-    delay(100);
+    demonstrateAveraging(frame.raw[SCAN_TEMP]);
+    demonstrateCalibration(frame.raw[SCAN_POT]);
     
-    demonstrateCalibration();
+    Serial.println();
+    Serial.println("Next reading in 5 seconds (sampling keeps running meanwhile)...");
+}
+
+/*
+ * OVERSAMPLING PIPELINE
+ * 
+ * Step 1: A hardware timer fires 1024 times per second.
+ * analogRead() takes a lock inside the ADC driver, and an interrupt is not
+ * allowed to wait for a lock - so the ISR only wakes a small, high priority
+ * sampler task, which does the actual reading.
+ */
+void IRAM_ATTR sampleTimerISR() {
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(samplerTaskHandle, &higherPriorityWoken);
+    if (higherPriorityWoken) {
+        portYIELD_FROM_ISR();  // Run the sampler right after this ISR
+    }
+}
+
+// Step 2: The sampler task scans the channels that are due and stores one frame
+void samplerTask(void *parameter) {
+    while (true) {
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // Sleep until the timer fires
+        if (ticks > 1) {
+            samplesDropped += ticks - 1;  // We were too slow for some ticks
+        }
+        
+        uint32_t head = sampleHead;
+        bool full = head - sampleTail >= SAMPLE_RING_SIZE;
+        uint32_t slot = head & (SAMPLE_RING_SIZE - 1);
+        uint32_t now = micros();
+        uint8_t fresh = 0;
+        
+        for (int c = 0; c < SCAN_CHANNELS; c++) {
+            if (scanCountdown[c] == 0) {
+                // Due: convert it - even if the ring is full, so held values stay current
+                scanHeld[c] = analogRead(scanChannels[c].pin);
+                scanCountdown[c] = scanChannels[c].divider - 1;
+                fresh |= 1 << c;
+            } else {
+                scanCountdown[c]--;
+            }
+            if (!full) scanSamples[c][slot] = scanHeld[c];
+        }
+        
+        if (full) {
+            samplesDropped++;  // Ring full - loop() hasn't emptied it for a second
+        } else {
+            scanFrameTick[slot] = scanTick;
+            scanFrameTime[slot] = now;
+            scanFrameFresh[slot] = fresh;
+            sampleHead = head + 1;  // Publish AFTER the whole frame is stored
+        }
+        scanTick++;
+    }
+}
+
+void startOversampling() {
+    for (int c = 0; c < SCAN_CHANNELS; c++) {
+        scanCountdown[c] = scanChannels[c].phase;  // First conversion at tick == phase
+    }
     
+    // Priority 3 (loop() runs at 1) so a busy loop() can't delay sampling
+    xTaskCreatePinnedToCore(samplerTask, "ADC sampler", 2048, NULL, 3, &samplerTaskHandle, 0);
+    
+    sampleTimer = timerBegin(0, 80, true);  // Timer 0, prescaler 80 (1MHz), count up
+    timerAttachInterrupt(sampleTimer, &sampleTimerISR, true);
+    timerAlarmWrite(sampleTimer, SAMPLE_PERIOD_US, true);  // 976 us, auto-reload
+    timerAlarmEnable(sampleTimer);
+    
+    Serial.print("Oversampling started: ");
+    Serial.print(SAMPLE_RATE_HZ);
+    Serial.print(" Hz, ");
+    Serial.print(OVERSAMPLE_RATIO);
+    Serial.print(" samples per result, ");
+    Serial.print(12 + OVERSAMPLE_EXTRA_BITS);
+    Serial.println("-bit results");
+    Serial.println("Scan rates: temperature 1024 Hz, light 64 Hz, potentiometer 32 Hz, battery 1 Hz");
+}
+
+// Step 2b: Read one frame. A held value was converted "age" ticks earlier,
+// at its position in that scan - the schedule is fixed, so we can work it out
+void readFrame(uint32_t index, ScanFrame *frame) {
+    uint32_t slot = index & (SAMPLE_RING_SIZE - 1);
+    frame->tick = scanFrameTick[slot];
+    frame->timeUs = scanFrameTime[slot];
+    frame->fresh = scanFrameFresh[slot];
+    
+    for (int c = 0; c < SCAN_CHANNELS; c++) {
+        frame->raw[c] = scanSamples[c][slot];
+        
+        const ScanChannel &ch = scanChannels[c];
+        if (frame->tick < ch.phase) {
+            frame->sampleTimeUs[c] = 0;  // Not converted yet
+            continue;
+        }
+        uint32_t age = (frame->tick - ch.phase) % ch.divider;
+        uint32_t sourceTick = frame->tick - age;
+        uint32_t order = 0;  // Channels converted before this one in the source scan
+        for (int j = 0; j < c; j++) {
+            if (sourceTick >= scanChannels[j].phase && (sourceTick - scanChannels[j].phase) % scanChannels[j].divider == 0) {
+                order++;
+            }
+        }
+        frame->sampleTimeUs[c] = frame->timeUs - age * SAMPLE_PERIOD_US + order * 10;  // ~10 us per analogRead
+    }
+}
+
+// The newest complete frame - safe while the sampler runs: it only ever
+// writes the slot AFTER head - 1, and wraps around a second later
+bool getLatestFrame(ScanFrame *frame) {
+    uint32_t head = sampleHead;
+    if (head == 0) {
+        return false;
+    }
+    readFrame(head - 1, frame);
+    return true;
+}
+
+void printFrameTiming(const ScanFrame *frame) {
+    const char *names[SCAN_CHANNELS] = {"temperature", "light", "potentiometer", "battery"};
+    
+    Serial.print("Scan frame #");
+    Serial.print(frame->tick);
+    Serial.print(" at ");
+    Serial.print(frame->timeUs);
+    Serial.println(" us - sample ages:");
+    for (int c = 0; c < SCAN_CHANNELS; c++) {
+        Serial.print("  ");
+        Serial.print(names[c]);
+        Serial.print(": ");
+        if (frame->tick < scanChannels[c].phase) {
+            Serial.println("no sample yet");  // Its first conversion is still to come
+            continue;
+        }
+        Serial.print((int32_t)(frame->timeUs - frame->sampleTimeUs[c]));
+        Serial.println((frame->fresh >> c) & 1 ? " us (fresh)" : " us (held)");
+    }
     Serial.println();
-    Serial.println("Waiting 5 seconds before next reading...");
-    delay(5000);
+}
+
+// Median of the last 5 results, then EMA - all integer math
+uint16_t filterResult(uint16_t value) {
+    medianHistory[medianPos] = value;
+    medianPos = (medianPos + 1) % RESULT_MEDIAN_WINDOW;
+    if (medianCount < RESULT_MEDIAN_WINDOW) medianCount++;
+    
+    uint16_t sorted[RESULT_MEDIAN_WINDOW];
+    for (int i = 0; i < medianCount; i++) {
+        uint16_t v = medianHistory[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    uint32_t median = sorted[(medianCount - 1) / 2];
+    
+    if (medianCount == 1) {
+        emaValueQ8 = median << 8;  // First result: start right there, not at 0
+    } else {
+        // y += (x - y) / 4, with signed math so falling values work too
+        emaValueQ8 += ((int32_t)(median << 8) - (int32_t)emaValueQ8) >> RESULT_EMA_SHIFT;
+    }
+    return (emaValueQ8 + 128) >> 8;
+}
+
+// Step 3: loop() drains the temperature row and sums blocks of 256 samples (a boxcar filter)
+// Averaging 4^n samples gives n extra bits - the ADC noise acts as dither
+void runOversamplingPipeline() {
+    uint32_t head = sampleHead;  // Snapshot once - new samples wait for next time
+    uint32_t tail = sampleTail;
+    
+    while (tail != head) {
+        boxcarSum += scanSamples[SCAN_TEMP][tail & (SAMPLE_RING_SIZE - 1)];  // One ring row
+        tail++;
+        
+        if (++boxcarCount == OVERSAMPLE_RATIO) {
+            // 256 x 12-bit = 20-bit sum; keep 16 bits, rounded to nearest
+            tempReading.value = (boxcarSum + (1 << (OVERSAMPLE_EXTRA_BITS - 1))) >> OVERSAMPLE_EXTRA_BITS;
+            tempReading.filtered = filterResult(tempReading.value);
+            tempReading.sequence++;
+            tempReading.ready = true;  // Step 4: publish
+            boxcarSum = 0;
+            boxcarCount = 0;
+        }
+    }
+    sampleTail = tail;  // Hand the slots back to the sampler
 }
 
 /*
  * EXAMPLE 1: Temperature Sensor (TMP36)
  */
-void readTemperatureSensor() {
+void readTemperatureSensor(int raw_adc) {
     Serial.println("--- Temperature Sensor (TMP36) ---");
     
-    // Read raw ADC value
-    int raw_adc = analogRead(TEMP_SENSOR_PIN);
+    // Raw ADC value from the scan frame
     Serial.print("Raw ADC: ");
     Serial.println(raw_adc);
     
-    // Convert to voltage (mV)
-    float voltage_mv = (raw_adc * ADC_REFERENCE_MV) / ADC_MAX_VALUE;
+    // Convert to voltage (mV) - calibrated, one table lookup
+    float voltage_mv = adcToMillivolts(raw_adc);
     Serial.print("Voltage: ");
     Serial.print(voltage_mv);
     Serial.println(" mV");
@@ -133,16 +441,15 @@ void readTemperatureSensor() {
 /*
  * EXAMPLE 2: Light Sensor (LDR - Light Dependent Resistor)
  */
-void readLightSensor() {
+void readLightSensor(int raw_adc) {
     Serial.println("--- Light Sensor (LDR) ---");
     
-    // Read raw ADC value
-    int raw_adc = analogRead(LIGHT_SENSOR_PIN);
+    // Raw ADC value from the scan frame
     Serial.print("Raw ADC: ");
     Serial.println(raw_adc);
     
     // Convert to voltage
-    float voltage_v = (raw_adc * 3.3) / ADC_MAX_VALUE;
+    float voltage_v = adcToVoltage(raw_adc);
     Serial.print("Voltage: ");
     Serial.print(voltage_v);
     Serial.println(" V");
@@ -173,16 +480,15 @@ void readLightSensor() {
 /*
  * EXAMPLE 3: Potentiometer (Variable Resistor)
  */
-void readPotentiometer() {
+void readPotentiometer(int raw_adc) {
     Serial.println("--- Potentiometer ---");
     
-    // Read raw ADC value
-    int raw_adc = analogRead(POTENTIOMETER_PIN);
+    // Raw ADC value from the scan frame
     Serial.print("Raw ADC: ");
     Serial.println(raw_adc);
     
     // Convert to voltage
-    float voltage_v = (raw_adc * 3.3) / ADC_MAX_VALUE;
+    float voltage_v = adcToVoltage(raw_adc);
     Serial.print("Voltage: ");
     Serial.print(voltage_v);
     Serial.println(" V");
@@ -210,16 +516,16 @@ void readPotentiometer() {
 /*
  * EXAMPLE 4: Battery Voltage Monitoring
  */
-void readBatteryVoltage() {
+void readBatteryVoltage(int raw_adc) {
     Serial.println("--- Battery Voltage Monitor ---");
     
-    // Read raw ADC value
-    int raw_adc = analogRead(BATTERY_VOLTAGE_PIN);
+    // Raw ADC value from the scan frame
     Serial.print("Raw ADC: ");
     Serial.println(raw_adc);
     
     // Convert to voltage at ADC pin
-    float adc_voltage = (raw_adc * 3.3) / ADC_MAX_VALUE;
+    // (a full Li-ion gives 2.1V here - right where the uncalibrated ADC starts to bend)
+    float adc_voltage = adcToVoltage(raw_adc);
     Serial.print("ADC pin voltage: ");
     Serial.print(adc_voltage);
     Serial.println(" V");
@@ -255,57 +561,63 @@ void readBatteryVoltage() {
 }
 
 /*
- * EXAMPLE 5: Noise Reduction Through Averaging
+ * EXAMPLE 5: Noise Reduction Through Oversampling
  */
-void demonstrateAveraging() {
+void demonstrateAveraging(int single) {
     Serial.println("--- Noise Reduction Example ---");
     
-    const int num_samples = 10;
-    int total = 0;
-    
-    Serial.print("Taking ");
-    Serial.print(num_samples);
-    Serial.println(" samples of temperature sensor:");
-    
-    // Take multiple readings
-    for(int i = 0; i < num_samples; i++) {
-        int reading = analogRead(TEMP_SENSOR_PIN);
-        total += reading;
-        
-        Serial.print("Sample ");
-        Serial.print(i + 1);
-        Serial.print(": ");
-        Serial.println(reading);
-        
-        delay(50);  // Small delay between samples
+    // One plain reading (from the scan frame), for comparison
+    Serial.print("Single reading: ");
+    Serial.print(single);
+    Serial.println(" (12-bit)");
+    
+    // The latest oversampled result - no waiting, the timer has been sampling all along
+    float average;
+    if (!readADCOversampled(&average)) {
+        Serial.println("No new oversampled result yet");
+        Serial.println();
+        return;
     }
     
-    // Calculate average
-    float average = total / (float)num_samples;
-    Serial.print("Average: ");
-    Serial.println(average);
-    
-    // Convert averaged reading to temperature
-    float voltage_mv = (average * ADC_REFERENCE_MV) / ADC_MAX_VALUE;
+    Serial.print("Oversampled result #");
+    Serial.print(tempReading.sequence);
+    Serial.print(": ");
+    Serial.print(tempReading.value);
+    Serial.print(" (16-bit) = ");
+    Serial.print(average, 4);
+    Serial.println(" in 12-bit steps");
+    
+    // Convert both readings to temperature
+    float single_c = (adcToMillivolts(single) - 500.0) / 10.0;
+    float voltage_mv = oversampledToMillivolts(tempReading.value);
     float temperature_c = (voltage_mv - 500.0) / 10.0;
     
-    Serial.print("Averaged temperature: ");
-    Serial.print(temperature_c);
+    Serial.print("Single temperature: ");
+    Serial.print(single_c, 3);
+    Serial.println(" °C");
+    Serial.print("Oversampled temperature: ");
+    Serial.print(temperature_c, 3);
+    Serial.println(" °C");
+    
+    Serial.print("Filtered (median 5 + EMA 1/4): ");
+    Serial.print(tempReading.filtered);
+    Serial.print(" = ");
+    Serial.print((oversampledToMillivolts(tempReading.filtered) - 500.0) / 10.0, 3);
     Serial.println(" °C");
     
-    Serial.println("Note: Averaging reduces noise and gives more stable readings.");
+    Serial.print("Samples dropped so far: ");
+    Serial.println(samplesDropped);
+    
+    Serial.println("Note: 256 samples averaged = 4 extra bits (0.005 °C steps instead of 0.08 °C).");
     Serial.println();
 }
 
 /*
  * EXAMPLE 6: Sensor Calibration
  */
-void demonstrateCalibration() {
+void demonstrateCalibration(int raw_reading) {
     Serial.println("--- Sensor Calibration Example ---");
     
-    // Read raw potentiometer value
-    int raw_reading = analogRead(POTENTIOMETER_PIN);
-    
     Serial.print("Raw potentiometer reading: ");
     Serial.println(raw_reading);
     
@@ -315,23 +627,22 @@ void demonstrateCalibration() {
     Serial.print(simple_percentage);
     Serial.println(" %");
     
-    // Method 2: Calibrated mapping (account for real min/max values)
-    // In reality, potentiometer might not reach exact 0 and 4095
-    const int calibrated_min = 50;    // Actual minimum reading
-    const int calibrated_max = 4000;  // Actual maximum reading
-    
-    float calibrated_percentage = ((raw_reading - calibrated_min) * 100.0) / 
-                                 (calibrated_max - calibrated_min);
-    
-    // Constrain to 0-100%
-    if(calibrated_percentage < 0) calibrated_percentage = 0;
-    if(calibrated_percentage > 100) calibrated_percentage = 100;
+    // Method 2: Calibration table (account for the real ADC curve)
+    // The wiper voltage is what tells the position - and the table gives
+    // real millivolts, even in the dead zone and the knee near 3.3V
+    uint16_t wiper_mv = adcToMillivolts(raw_reading);
+    uint32_t calibrated_tenths = ((uint32_t)wiper_mv * 1000 + ADC_REFERENCE_MV / 2) / ADC_REFERENCE_MV;
     
     Serial.print("Calibrated mapping: ");
-    Serial.print(calibrated_percentage);
+    Serial.print(wiper_mv);
+    Serial.print(" mV = ");
+    Serial.print(calibrated_tenths / 10);
+    Serial.print(".");
+    Serial.print(calibrated_tenths % 10);
     Serial.println(" %");
     
     Serial.println("Note: Calibration accounts for real-world sensor limitations.");
+    Serial.println("(At mid travel the simple mapping is off by ~5% - the ADC curve, not the pot.)");
     Serial.println();
 }
 
@@ -339,26 +650,69 @@ void demonstrateCalibration() {
  * UTILITY FUNCTIONS
  */
 
-// Function to convert ADC reading to voltage
-float adcToVoltage(int adc_reading) {
-    return (adc_reading * 3.3) / ADC_MAX_VALUE;
+// Function to build the calibration table from the measured points
+// Straight lines between the points, the end lines extended past the first
+// and last point. Integer math only - runs once in setup()
+void buildAdcCalibration() {
+    int seg = 0;
+    for (int code = 0; code < ADC_RESOLUTION; code++) {
+        int32_t x = code * 16;
+        // Move to the next segment once we pass its start (codes only go up)
+        while (seg + 2 < ADC_CAL_POINTS && adcCalibration[seg + 1].code_x16 <= x) {
+            seg++;
+        }
+        int32_t x0 = adcCalibration[seg].code_x16;
+        int32_t x1 = adcCalibration[seg + 1].code_x16;
+        int32_t y0 = adcCalibration[seg].millivolts;
+        int32_t y1 = adcCalibration[seg + 1].millivolts;
+        int32_t dx = x1 - x0;
+        int32_t num = (y1 - y0) * (x - x0);
+        int32_t mv = y0 + (num >= 0 ? (num + dx / 2) / dx : (num - dx / 2) / dx);  // Rounded
+        
+        adcMillivoltsLut[code] = constrain(mv, (int32_t)0, (int32_t)ADC_REFERENCE_MV);
+    }
+    
+    Serial.print("ADC calibration table built from ");
+    Serial.print(ADC_CAL_POINTS);
+    Serial.print(" points: code 2048 = ");
+    Serial.print(adcMillivoltsLut[2048]);
+    Serial.println(" mV (the simple formula says 1650 mV)");
 }
 
-// Function to take multiple samples and return average
-float readADCAverage(uint8_t pin, uint8_t samples) {
-    long total = 0;
-    
-    for(uint8_t i = 0; i < samples; i++) {
-        total += analogRead(pin);
-        delay(10);
+// Function to convert a raw ADC reading to millivolts - one array read
+uint16_t adcToMillivolts(int adc_reading) {
+    return adcMillivoltsLut[constrain(adc_reading, 0, ADC_MAX_VALUE)];
+}
+
+// Same for oversampled 16-bit values (raw x 16): interpolate between two entries
+uint16_t oversampledToMillivolts(uint16_t value_x16) {
+    uint32_t i = value_x16 >> OVERSAMPLE_EXTRA_BITS;
+    if (i >= ADC_MAX_VALUE) {
+        return adcMillivoltsLut[ADC_MAX_VALUE];
     }
-    
-    return total / (float)samples;
+    int32_t y0 = adcMillivoltsLut[i];
+    int32_t y1 = adcMillivoltsLut[i + 1];
+    int32_t frac = value_x16 & ((1 << OVERSAMPLE_EXTRA_BITS) - 1);
+    return y0 + (((y1 - y0) * frac + 8) >> OVERSAMPLE_EXTRA_BITS);
 }
 
-// Function to map value with custom constraints
-float mapFloat(float value, float in_min, float in_max, float out_min, float out_max) {
-    return (value - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+// Function to convert ADC reading to voltage
+// (calibrated table + a multiply - the old version divided by 4095 every time)
+float adcToVoltage(int adc_reading) {
+    return adcToMillivolts(adc_reading) * 0.001f;
+}
+
+// Function to get the newest oversampled temperature reading, in 12-bit steps
+// with a fraction (0.0 - 4095.0). Replaces the old readADCAverage(), which took
+// its samples with delay(10) in between and blocked loop() the whole time.
+// Returns false if no new result was published since the last call.
+bool readADCOversampled(float *average) {
+    if (!tempReading.ready) {
+        return false;
+    }
+    tempReading.ready = false;
+    *average = tempReading.value / (float)(1 << OVERSAMPLE_EXTRA_BITS);
+    return true;
 }
 
 /*
@@ -370,7 +724,7 @@ void printADCTroubleshootingGuide() {
     
     Serial.println("Problem: Readings are noisy/unstable");
     Serial.println("Solutions:");
-    Serial.println("1. Take multiple samples and average them");
+    Serial.println("1. Oversample: average many timer-driven samples (see EXAMPLE 5)");
     Serial.println("2. Add capacitor across sensor (100nF - 1µF)");
     Serial.println("3. Use shorter wires to sensor");
     Serial.println("4. Keep analog wires away from digital switching signals");
@@ -426,11 +780,15 @@ void printADCTroubleshootingGuide() {
  * 1. ADC converts analog voltages (0-3.3V) to digital numbers (0-4095)
  * 2. Different sensors require different conversion formulas
  * 3. Voltage dividers let you measure higher voltages safely
- * 4. Averaging multiple readings reduces noise
- * 5. Calibration improves accuracy for real-world sensors
+ * 4. Averaging multiple readings reduces noise - oversampling 4^n readings
+ *    even adds n bits, if a timer collects them instead of delay()
+ * 5. Calibration improves accuracy for real-world sensors - a table built
+ *    from a few measured points fixes the curve AND is faster than the formula
  * 6. ESP32 ADC has configurable resolution and attenuation
  * 7. Proper wiring and grounding are crucial for clean readings
  * 8. Always verify readings with known test conditions
+ * 9. Sample all channels from one timer and read them as one frame -
+ *    values you combine should come from the same moment
  * 
  * Next: PWM - Controlling motors, LEDs, servos with analog-like output!
  */
\ No newline at end of file
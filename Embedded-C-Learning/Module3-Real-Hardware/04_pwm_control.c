@@ -6,6 +6,14 @@
  * - Controlling LED brightness, motor speed, servo position
  * - PWM frequency, duty cycle, and resolution concepts
  * - Real applications: dimming, motor control, audio generation
+ * - A color engine: integer HSV -> RGB with tables, gamma correction and
+ *   dithering, so color fades look smooth and even
+ * - A fade engine: a hardware timer moves all fades and patterns at once,
+ *   loop() just says "fade to X in Y ms" and carries on
+ * - A tone sequencer: songs as small note tables, played by the same timer
+ *   on one or two buzzers while loop() keeps running
+ * - A servo motion planner: smooth trapezoid / S-curve moves, planned once
+ *   into a buffer, with two servos starting and stopping together
  * 
  * PWM = Pulse Width Modulation
  * Think of it like a light switch that turns on/off very fast:
@@ -17,12 +25,18 @@
  * NOTE: This code runs on ESP32 with Arduino IDE
  */
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>     // Fade and tone command queues
+#include <driver/ledc.h>        // ledc_timer_set(): write a tone's clock divider directly
+
 // PWM pin definitions (ESP32 can do PWM on most GPIO pins)
 #define LED_PIN         2   // Built-in LED
 #define EXTERNAL_LED    4   // External LED
 #define MOTOR_PIN       5   // DC motor control
 #define SERVO_PIN       18  // Servo motor signal
+#define SERVO2_PIN      26  // Optional second servo (e.g. tilt of a pan/tilt head)
 #define BUZZER_PIN      19  // Buzzer for audio
+#define BUZZER2_PIN     25  // Optional second buzzer (bass voice)
 #define RGB_RED_PIN     21  // Red LED in RGB LED
 #define RGB_GREEN_PIN   22  // Green LED in RGB LED  
 #define RGB_BLUE_PIN    23  // Blue LED in RGB LED
@@ -33,15 +47,209 @@
 #define PWM_CHANNEL_0   0       // PWM channel for LED
 #define PWM_CHANNEL_1   1       // PWM channel for motor
 #define PWM_CHANNEL_2   2       // PWM channel for servo
-#define PWM_CHANNEL_3   3       // PWM channel for buzzer
+#define PWM_CHANNEL_3   3       // PWM channel for servo 2 (shares the 50 Hz timer 1 with servo 1)
 #define PWM_CHANNEL_4   4       // PWM channel for RGB red
 #define PWM_CHANNEL_5   5       // PWM channel for RGB green
 #define PWM_CHANNEL_6   6       // PWM channel for RGB blue
 
 // Servo control constants
-#define SERVO_MIN_PULSE_MS  0.5   // 0.5ms pulse = 0 degrees
-#define SERVO_MAX_PULSE_MS  2.5   // 2.5ms pulse = 180 degrees
+#define SERVO_MIN_PULSE_US  500   // 0.5ms pulse = 0 degrees
+#define SERVO_MAX_PULSE_US  2500  // 2.5ms pulse = 180 degrees
 #define SERVO_FREQUENCY     50    // 50 Hz = 20ms period
+#define SERVO_PERIOD_US     20000
+
+// Color engine (host version with benchmark: 14_color_engine.c)
+// Hue runs 0-1535: 6 sectors of 256 steps, so sector = hue >> 8 and the
+// position inside it = hue & 255 - no divides, no if/else per color
+#define HUE_STEPS_PER_SECTOR    256
+#define HUE_RANGE               (6 * HUE_STEPS_PER_SECTOR)  // One full circle
+#define RGB_REFRESH_MS          4       // 250 Hz - fast enough that dithering doesn't flicker
+
+struct RgbColor {
+    uint8_t r, g, b;
+};
+
+struct HsvColor {
+    uint16_t hue;       // 0 - HUE_RANGE-1 (0 = red, 512 = green, 1024 = blue)
+    uint8_t sat;        // 0 = white, 255 = full color
+    uint8_t val;        // 0 = off, 255 = full brightness
+};
+
+// In each sector a channel is zero, full, rising or falling. The four
+// levels sit in one 32-bit word, one byte each, so a level is picked with
+// a shift by 8 x level. One word per sector holds the R, G and B shifts.
+#define LEVEL_ZERO  0
+#define LEVEL_FULL  1
+#define LEVEL_RISE  2
+#define LEVEL_FALL  3
+#define SECTOR_SHAPE(r, g, b)   ((8 * (r)) | (8 * (g)) << 8 | (8 * (b)) << 16)
+
+const uint32_t sectorShifts[6] = {
+    SECTOR_SHAPE(LEVEL_FULL, LEVEL_RISE, LEVEL_ZERO),   // Red -> yellow
+    SECTOR_SHAPE(LEVEL_FALL, LEVEL_FULL, LEVEL_ZERO),   // Yellow -> green
+    SECTOR_SHAPE(LEVEL_ZERO, LEVEL_FULL, LEVEL_RISE),   // Green -> cyan
+    SECTOR_SHAPE(LEVEL_ZERO, LEVEL_FALL, LEVEL_FULL),   // Cyan -> blue
+    SECTOR_SHAPE(LEVEL_RISE, LEVEL_ZERO, LEVEL_FULL),   // Blue -> magenta
+    SECTOR_SHAPE(LEVEL_FULL, LEVEL_ZERO, LEVEL_FALL),   // Magenta -> red
+};
+
+uint8_t sineTable[256];     // One sine wave, 0-255 - for breathing effects
+uint16_t gammaTable[256];   // Brightness -> PWM x 256 (8.8 fixed point), gamma 2.2
+uint8_t ditherError[3];     // Leftover PWM fraction of the R, G, B channels
+
+// Fade engine (host version with simulated LEDC: 15_pwm_fade_engine.c)
+// Timer ISR -> fade task -> every active channel moves one step per tick.
+// loop() sends commands through a queue and never waits on a ramp.
+#define FADE_CHANNELS       8       // LEDC channels 0-7 (this sketch uses 0-6)
+#define FADE_TICK_HZ        500     // 2 ms per step
+#define EASE_SEGMENTS       64      // Ease tables: 65 points, interpolated
+#define EASE_ONE            32768   // 1.0 in the ease tables (Q15)
+#define PATTERN_FOREVER     0xFFFF
+
+enum Ease {
+    EASE_LINEAR,        // Constant speed
+    EASE_IN,            // Starts slow, ends fast
+    EASE_OUT,           // Starts fast, ends slow
+    EASE_IN_OUT,        // S-curve: gentle start AND stop - good for motors
+    EASE_SINE,          // Half a cosine - the most natural "breathing"
+    EASE_COUNT
+};
+
+// One step of a pattern: fade to duty in durationMs (same duty = hold)
+struct PatternStep {
+    uint16_t duty;
+    uint16_t durationMs;    // 0 = jump
+    uint8_t curve;          // Ease
+};
+
+// Called in the fade task when a fade or pattern ends - keep it short
+typedef void (*FadeDoneCallback)(uint8_t channel);
+
+struct FadeChannel {
+    bool active;
+    uint8_t curve;
+    uint32_t dutyQ16;           // Current duty x 65536 - fractions of a step add up
+    int32_t incrementQ16;       // Linear fades: added every tick
+    uint16_t start, target;
+    uint32_t progress;          // Curved fades: 0 .. 2^32 over the fade
+    uint32_t progressStep;
+    uint32_t ticksLeft;
+    uint32_t written;           // Last value given to ledcWrite()
+    const PatternStep *pattern; // Pattern player: current list, or NULL
+    uint16_t patternLength;
+    uint16_t patternIndex;
+    uint16_t repeatsLeft;
+    FadeDoneCallback done;
+};
+
+enum FadeCommandType { FADE_CMD_FADE, FADE_CMD_PATTERN, FADE_CMD_STOP };
+
+struct FadeCommand {
+    uint8_t type;               // FadeCommandType
+    uint8_t channel;
+    uint16_t target;
+    uint16_t durationMs;
+    uint8_t curve;
+    const PatternStep *pattern; // Must stay valid while playing - use const tables
+    uint16_t length;
+    uint16_t repeats;
+    FadeDoneCallback done;
+};
+
+uint16_t easeTable[EASE_COUNT][EASE_SEGMENTS + 1];
+FadeChannel fadeChannels[FADE_CHANNELS];   // Only the fade task touches these
+QueueHandle_t fadeCommandQueue = NULL;
+hw_timer_t *fadeTimer = NULL;
+TaskHandle_t fadeTaskHandle = NULL;
+volatile uint32_t fadeBusyMask = 0;         // Bit per channel: fade or pattern running
+portMUX_TYPE fadeBusyMux = portMUX_INITIALIZER_UNLOCKED;  // loop() (core 1) and the fade task (core 0) both change it
+volatile uint16_t fadeDuty[FADE_CHANNELS];  // Current duty, for printing
+
+// Tone sequencer (host version with WAV output: 16_tone_sequencer.c)
+// Ticked by the fade task. Every voice needs its own LEDC timer, because a
+// note changes the timer's clock divider: two channels share one timer
+// (channel 3 shared timer 1 with the servo!), so the voices use channels
+// 8 and 10 = low-speed timers 0 and 1.
+#define TONE_VOICES         2
+#define TONE_RESOLUTION     10          // Divider fits for ~76 Hz .. 78 kHz
+#define TONE_GAP_MS         50          // Silence before the next note (C C = two notes)
+#define LEDC_CLOCK_HZ       80000000
+#define SONG_FOREVER        0xFFFF
+
+const uint8_t toneChannel[TONE_VOICES] = {8, 10};
+const ledc_timer_t toneTimer[TONE_VOICES] = {LEDC_TIMER_0, LEDC_TIMER_1};
+const uint8_t tonePin[TONE_VOICES] = {BUZZER_PIN, BUZZER2_PIN};
+
+// One note = 2 bytes: MIDI note number (60 = C4, 0 = rest), length in 1/16 notes
+struct ToneNote {
+    uint8_t note;
+    uint8_t length;     // 4 = quarter, 8 = half
+};
+
+struct ToneVoice {
+    const ToneNote *song;
+    uint16_t length;
+    uint16_t index;             // Next note to start
+    uint16_t repeatsLeft;
+    bool active;
+    bool sounding;
+    uint32_t ticksPerUnitQ8;    // Tempo: ticks per 1/16 note x 256
+    uint32_t startTick;         // Tick of the current song pass
+    uint32_t units;             // 1/16 notes before the next note
+    uint32_t releaseTick;       // Note off (start of the gap)
+    uint32_t nextTick;          // Next note starts
+};
+
+struct ToneCommand {
+    uint8_t voice;
+    const ToneNote *song;       // Must stay valid while playing - use const tables
+    uint16_t length;            // 0 = stop the voice
+    uint16_t repeats;
+    uint32_t ticksPerUnitQ8;
+    uint32_t startTick;
+};
+
+uint32_t toneDivider[128];                  // LEDC clock divider per note (10.8 fixed point), 0 = can't play
+ToneVoice toneVoices[TONE_VOICES];          // Only the fade task touches these
+QueueHandle_t toneCommandQueue = NULL;
+volatile uint32_t toneTickCount = 0;        // Sequencer clock (2 ms ticks)
+uint32_t toneNextEvent = 0;                 // Nothing to do before this tick
+volatile uint32_t toneBusyMask = 0;         // Bit per voice: song playing
+portMUX_TYPE toneBusyMux = portMUX_INITIALIZER_UNLOCKED;  // Changed on both cores, like fadeBusyMask
+volatile uint8_t toneCurrentNote[TONE_VOICES];  // Sounding note, for printing
+
+// Servo motion planner (host version with simulated PWM: 17_servo_motion_planner.c)
+// A move is planned ONCE into a buffer of pulse widths, one per 20 ms servo
+// frame; the fade task copies the next value out every 10th tick. Both
+// servos follow the same shape, so they start and stop together.
+#define SERVO_AXES          2
+#define MOTION_MAX_FRAMES   1024        // Longest move: 20 s (4 KB buffer)
+#define MOTION_FRAME_TICKS  (FADE_TICK_HZ / SERVO_FREQUENCY)   // 10 fade ticks per frame
+#define PROFILE_ONE         65536       // 1.0 in the motion shape (Q16)
+
+enum MotionProfile {
+    PROFILE_TRAPEZOID,  // Accelerate, cruise, brake
+    PROFILE_SCURVE      // Minimum jerk: acceleration ramps too - no knocks
+};
+
+struct MotionMove {
+    uint16_t target[SERVO_AXES];    // LEDC counts (16-bit at 50 Hz)
+    uint8_t profile;                // MotionProfile
+};
+
+const uint8_t servoChannel[SERVO_AXES] = {PWM_CHANNEL_2, PWM_CHANNEL_3};
+uint32_t servoMaxSpeed[SERVO_AXES];         // Counts per frame x 256 (Q8)
+uint32_t servoMaxAccel[SERVO_AXES];         // Counts per frame^2 x 256
+uint16_t servoPosition[SERVO_AXES];         // Where the planned moves end
+int servoTargetAngle[SERVO_AXES];           // Last angles asked for by loop()
+uint16_t motionDuty[SERVO_AXES][MOTION_MAX_FRAMES];  // Tick-indexed pulse buffer
+uint32_t motionShape[MOTION_MAX_FRAMES + 1];         // s(k), shared by both servos
+uint16_t motionFrames = 0;                  // Frames in the current move
+uint16_t motionFrame = 0;                   // Next frame to play
+QueueHandle_t motionQueue = NULL;
+volatile uint32_t motionSent = 0;           // Moves queued (only loop() writes)
+volatile uint32_t motionDone = 0;           // Moves finished (only the fade task writes)
+volatile uint16_t servoDuty[SERVO_AXES];    // Current pulse, for printing
 
 void setup() {
     Serial.begin(115200);
@@ -52,6 +260,10 @@ void setup() {
     
     // Configure PWM channels
     setupPWMChannels();
+    buildColorTables();
+    startToneSequencer();
+    startMotionPlanner();
+    startFadeEngine();
     
     Serial.println("PWM Configuration:");
     Serial.print("- Frequency: ");
@@ -105,7 +317,7 @@ void setupPWMChannels() {
     ledcSetup(PWM_CHANNEL_0, PWM_FREQUENCY, PWM_RESOLUTION);
     ledcSetup(PWM_CHANNEL_1, PWM_FREQUENCY, PWM_RESOLUTION);
     ledcSetup(PWM_CHANNEL_2, SERVO_FREQUENCY, 16);  // Higher resolution for servo
-    ledcSetup(PWM_CHANNEL_3, PWM_FREQUENCY, PWM_RESOLUTION);
+    ledcSetup(PWM_CHANNEL_3, SERVO_FREQUENCY, 16);  // Second servo, same timer
     ledcSetup(PWM_CHANNEL_4, PWM_FREQUENCY, PWM_RESOLUTION);
     ledcSetup(PWM_CHANNEL_5, PWM_FREQUENCY, PWM_RESOLUTION);
     ledcSetup(PWM_CHANNEL_6, PWM_FREQUENCY, PWM_RESOLUTION);
@@ -114,7 +326,7 @@ void setupPWMChannels() {
     ledcAttachPin(LED_PIN, PWM_CHANNEL_0);
     ledcAttachPin(MOTOR_PIN, PWM_CHANNEL_1);
     ledcAttachPin(SERVO_PIN, PWM_CHANNEL_2);
-    ledcAttachPin(BUZZER_PIN, PWM_CHANNEL_3);
+    ledcAttachPin(SERVO2_PIN, PWM_CHANNEL_3);
     ledcAttachPin(RGB_RED_PIN, PWM_CHANNEL_4);
     ledcAttachPin(RGB_GREEN_PIN, PWM_CHANNEL_5);
     ledcAttachPin(RGB_BLUE_PIN, PWM_CHANNEL_6);
@@ -122,6 +334,618 @@ void setupPWMChannels() {
     Serial.println("PWM channels configured successfully!");
 }
 
+/*
+ * FADE ENGINE
+ * 
+ * A hardware timer fires 500 times per second. ledcWrite() isn't meant to
+ * be called from an interrupt, so the ISR only wakes the fade task, which
+ * applies new commands, moves every active channel one step, ticks the
+ * tone sequencer and - every 10th tick - plays the next servo frame.
+ */
+void IRAM_ATTR fadeTimerISR() {
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(fadeTaskHandle, &higherPriorityWoken);
+    if (higherPriorityWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void fadeTask(void *parameter) {
+    uint8_t frameCountdown = MOTION_FRAME_TICKS;
+    while (true) {
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // Sleep until the timer fires
+        
+        FadeCommand cmd;
+        while (xQueueReceive(fadeCommandQueue, &cmd, 0) == pdTRUE) {
+            applyFadeCommand(&cmd);
+        }
+        ToneCommand tone;
+        while (xQueueReceive(toneCommandQueue, &tone, 0) == pdTRUE) {
+            applyToneCommand(&tone);
+        }
+        // Missed a tick? Catch up, so fades and songs keep their length
+        while (ticks-- > 0) {
+            fadeTick();
+            toneTick();
+            if (--frameCountdown == 0) {
+                frameCountdown = MOTION_FRAME_TICKS;
+                motionTick();
+            }
+        }
+    }
+}
+
+void startFadeEngine() {
+    // Ease tables: the only float math in the fade engine, once at startup
+    for (int i = 0; i <= EASE_SEGMENTS; i++) {
+        float p = (float)i / EASE_SEGMENTS;
+        float v[EASE_COUNT] = {p, p * p, 1 - (1 - p) * (1 - p), p * p * (3 - 2 * p), 0.5f - 0.5f * cosf(PI * p)};
+        for (int e = 0; e < EASE_COUNT; e++) {
+            easeTable[e][i] = (uint16_t)lroundf(v[e] * EASE_ONE);
+        }
+    }
+    
+    fadeCommandQueue = xQueueCreate(16, sizeof(FadeCommand));
+    xTaskCreatePinnedToCore(fadeTask, "PWM fades", 2048, NULL, 3, &fadeTaskHandle, 0);
+    
+    fadeTimer = timerBegin(0, 80, true);  // Timer 0, prescaler 80 (1MHz), count up
+    timerAttachInterrupt(fadeTimer, &fadeTimerISR, true);
+    timerAlarmWrite(fadeTimer, 1000000 / FADE_TICK_HZ, true);  // 2000 us, auto-reload
+    timerAlarmEnable(fadeTimer);
+    
+    Serial.println("Fade engine started: 500 steps per second on 8 channels");
+}
+
+// --- Called from loop(): queue a command, return at once ---
+
+// |= and &= ~ are read-modify-write: without the lock, one core can undo
+// the other's change and waitForFade() never returns
+void setFadeBusy(uint8_t channel, bool busy) {
+    portENTER_CRITICAL(&fadeBusyMux);
+    if (busy) fadeBusyMask |= 1UL << channel;
+    else fadeBusyMask &= ~(1UL << channel);
+    portEXIT_CRITICAL(&fadeBusyMux);
+}
+
+void fadeTo(uint8_t channel, uint16_t target, uint16_t durationMs, uint8_t curve, FadeDoneCallback done = NULL) {
+    FadeCommand cmd = {FADE_CMD_FADE, channel, target, durationMs, curve, NULL, 0, 0, done};
+    setFadeBusy(channel, true);  // Busy from now on, not from the next tick
+    xQueueSend(fadeCommandQueue, &cmd, portMAX_DELAY);
+}
+
+void playPattern(uint8_t channel, const PatternStep *steps, uint16_t length, uint16_t repeats, FadeDoneCallback done = NULL) {
+    FadeCommand cmd = {FADE_CMD_PATTERN, channel, 0, 0, 0, steps, length, repeats, done};
+    setFadeBusy(channel, true);
+    xQueueSend(fadeCommandQueue, &cmd, portMAX_DELAY);
+}
+
+void stopFade(uint8_t channel) {
+    FadeCommand cmd = {FADE_CMD_STOP, channel, 0, 0, 0, NULL, 0, 0, NULL};
+    xQueueSend(fadeCommandQueue, &cmd, portMAX_DELAY);
+}
+
+bool isFading(uint8_t channel) {
+    return (fadeBusyMask >> channel) & 1;
+}
+
+// Wait for a channel's fade to finish. Not a busy delay() loop: the fade
+// engine does the work, we only look in every 250 ms to print progress.
+void waitForFade(uint8_t channel) {
+    while (isFading(channel)) {
+        Serial.print("  ... PWM value ");
+        Serial.println(fadeDuty[channel]);
+        delay(250);  // Stands in for "the rest of your program"
+    }
+}
+
+// --- Inside the fade task ---
+
+void applyFadeCommand(const FadeCommand *cmd) {
+    FadeChannel &c = fadeChannels[cmd->channel];
+    switch (cmd->type) {
+        case FADE_CMD_FADE:
+            c.pattern = NULL;
+            startChannelFade(cmd->channel, cmd->target, cmd->durationMs, cmd->curve, cmd->done);
+            break;
+        case FADE_CMD_PATTERN:
+            c.pattern = cmd->pattern;
+            c.patternLength = cmd->length;
+            c.patternIndex = 0;
+            c.repeatsLeft = cmd->repeats;
+            startPatternStep(cmd->channel, cmd->done);
+            break;
+        case FADE_CMD_STOP:
+            c.active = false;
+            c.pattern = NULL;
+            setFadeBusy(cmd->channel, false);
+            break;
+    }
+}
+
+void startChannelFade(uint8_t channel, uint16_t target, uint16_t durationMs, uint8_t curve, FadeDoneCallback done) {
+    FadeChannel &c = fadeChannels[channel];
+    uint32_t ticks = ((uint32_t)durationMs * FADE_TICK_HZ + 500) / 1000;
+    
+    c.start = (c.dutyQ16 + 0x8000) >> 16;  // From wherever we are now
+    c.target = target;
+    c.curve = curve;
+    c.done = done;
+    
+    if (ticks == 0) {
+        c.dutyQ16 = (uint32_t)target << 16;  // Jump on the next tick
+        c.ticksLeft = 1;
+    } else {
+        c.ticksLeft = ticks;
+        // Fixed-point increment: (target - now) x 65536 / ticks
+        int32_t delta = ((int32_t)target - (int32_t)c.start) * 65536;
+        c.incrementQ16 = delta / (int32_t)ticks;
+        c.progress = 0;
+        c.progressStep = (uint32_t)(0xFFFFFFFFUL / ticks);
+    }
+    c.active = true;
+    setFadeBusy(channel, true);
+}
+
+void startPatternStep(uint8_t channel, FadeDoneCallback done) {
+    FadeChannel &c = fadeChannels[channel];
+    const PatternStep &step = c.pattern[c.patternIndex];
+    startChannelFade(channel, step.duty, step.durationMs, step.curve, done);
+}
+
+// One engine step for all channels
+void fadeTick() {
+    for (int ch = 0; ch < FADE_CHANNELS; ch++) {
+        FadeChannel &c = fadeChannels[ch];
+        if (!c.active) continue;
+        
+        if (--c.ticksLeft == 0) {
+            c.dutyQ16 = (uint32_t)c.target << 16;  // Land exactly on the target
+        } else if (c.curve == EASE_LINEAR) {
+            c.dutyQ16 += c.incrementQ16;
+        } else {
+            // Curve: look up how far along we should be (0 - 32768)
+            c.progress += c.progressStep;
+            uint32_t index = c.progress >> 26;
+            int32_t frac = (c.progress >> 11) & 0x7FFF;
+            int32_t a = easeTable[c.curve][index];
+            int32_t pos = a + (((easeTable[c.curve][index + 1] - a) * frac) >> 15);
+            int32_t delta = (int32_t)c.target - c.start;
+            // 64 bits: a fade down makes delta * pos negative (no shifting that)
+            c.dutyQ16 = (uint32_t)((int64_t)c.start * 65536 + (int64_t)delta * pos * 2);
+        }
+        
+        uint32_t duty = (c.dutyQ16 + 0x8000) >> 16;
+        if (duty != c.written) {  // Only touch the hardware when it changes
+            c.written = duty;
+            fadeDuty[ch] = duty;
+            ledcWrite(ch, duty);
+        }
+        
+        if (c.ticksLeft == 0) {
+            finishChannelFade(ch);
+        }
+    }
+}
+
+// A fade ended: next pattern step, or done (callback)
+void finishChannelFade(uint8_t channel) {
+    FadeChannel &c = fadeChannels[channel];
+    c.active = false;
+    
+    if (c.pattern != NULL) {
+        if (++c.patternIndex == c.patternLength) {
+            c.patternIndex = 0;
+            if (c.repeatsLeft != PATTERN_FOREVER && c.repeatsLeft-- <= 1) {
+                c.pattern = NULL;  // Played the last repeat
+            }
+        }
+        if (c.pattern != NULL) {
+            startPatternStep(channel, c.done);
+            return;
+        }
+    }
+    
+    setFadeBusy(channel, false);
+    if (c.done != NULL) {
+        FadeDoneCallback done = c.done;
+        c.done = NULL;
+        done(channel);
+    }
+}
+
+/*
+ * TONE SEQUENCER
+ * 
+ * A note's start tick is "song start + sixteenths so far x ticks per
+ * sixteenth", never "previous note + its length", so rounding never adds
+ * up. Most ticks nothing starts or stops: toneTick() compares one number
+ * and returns.
+ */
+void startToneSequencer() {
+    // Divider per note: f = 80 MHz / (divider / 256) / 1024. The only
+    // float math of the sequencer, once at startup - a note is a lookup.
+    for (int note = 1; note < 128; note++) {
+        double hz = 440.0 * pow(2.0, (note - 69) / 12.0);
+        uint32_t divider = (uint32_t)lround(LEDC_CLOCK_HZ * 256.0 / (hz * (1 << TONE_RESOLUTION)));
+        toneDivider[note] = (divider >= 256 && divider < 1024UL * 256) ? divider : 0;
+    }
+    toneDivider[0] = 0;
+    
+    for (int v = 0; v < TONE_VOICES; v++) {
+        ledcSetup(toneChannel[v], 1000, TONE_RESOLUTION);  // Sets up the timer; notes change the divider
+        ledcAttachPin(tonePin[v], toneChannel[v]);
+        ledcWrite(toneChannel[v], 0);
+    }
+    toneCommandQueue = xQueueCreate(8, sizeof(ToneCommand));
+}
+
+// --- Called from loop(): queue a command, return at once ---
+
+// Play a song on a voice. Songs given the same startTick (see toneNow())
+// stay in sync to the last note; 0 = start on the next tick.
+// Same lock as setFadeBusy(): loop() sets the bit, the fade task clears it
+void setToneBusy(uint8_t voice, bool busy) {
+    portENTER_CRITICAL(&toneBusyMux);
+    if (busy) toneBusyMask |= 1UL << voice;
+    else toneBusyMask &= ~(1UL << voice);
+    portEXIT_CRITICAL(&toneBusyMux);
+}
+
+void playSong(uint8_t voice, const ToneNote *song, uint16_t length, uint16_t bpm,
+              uint16_t repeats = 1, uint32_t startTick = 0) {
+    ToneCommand cmd;
+    cmd.voice = voice;
+    cmd.song = song;
+    cmd.length = length;
+    cmd.repeats = repeats;
+    // A 1/16 note is 60 / bpm / 4 seconds: ticks x 256, rounded
+    cmd.ticksPerUnitQ8 = ((uint32_t)FADE_TICK_HZ * 60 * 256 + bpm * 2) / (bpm * 4);
+    cmd.startTick = startTick;
+    if (length > 0) setToneBusy(voice, true);
+    xQueueSend(toneCommandQueue, &cmd, portMAX_DELAY);
+}
+
+void stopSong(uint8_t voice) {
+    playSong(voice, NULL, 0, 120);
+}
+
+bool isSongPlaying(uint8_t voice) {
+    return (toneBusyMask >> voice) & 1;
+}
+
+uint32_t toneNow() {
+    return toneTickCount;
+}
+
+void printNoteName(uint8_t note) {
+    static const char *names[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+    Serial.print(names[note % 12]);
+    Serial.print(note / 12 - 1);
+}
+
+// Wait for a song to end, printing each note as it starts
+void waitForSong(uint8_t voice) {
+    uint8_t shown = 0;
+    while (isSongPlaying(voice)) {
+        uint8_t note = toneCurrentNote[voice];
+        if (note != shown && note != 0) {
+            Serial.print("Playing note: ");
+            printNoteName(note);
+            Serial.print(" (");
+            Serial.print(LEDC_CLOCK_HZ / 4 / toneDivider[note]);  // = 80 MHz x 256 / (divider x 1024)
+            Serial.println(" Hz)");
+        }
+        shown = note;
+        delay(10);
+    }
+}
+
+// --- Inside the fade task ---
+
+// LEDC output for one voice: new divider + 50% duty, or silence
+void toneWrite(uint8_t voice, uint8_t note) {
+    toneCurrentNote[voice] = note;
+    if (note == 0) {
+        ledcWrite(toneChannel[voice], 0);
+        return;
+    }
+    ledc_timer_set(LEDC_LOW_SPEED_MODE, toneTimer[voice], toneDivider[note], TONE_RESOLUTION, LEDC_APB_CLK);
+    ledcWrite(toneChannel[voice], 1 << (TONE_RESOLUTION - 1));
+}
+
+void applyToneCommand(const ToneCommand *cmd) {
+    ToneVoice &v = toneVoices[cmd->voice];
+    if (v.sounding) toneWrite(cmd->voice, 0);
+    v.sounding = false;
+    v.active = cmd->length > 0;
+    if (!v.active) {
+        setToneBusy(cmd->voice, false);
+        updateToneNextEvent();
+        return;
+    }
+    
+    v.song = cmd->song;
+    v.length = cmd->length;
+    v.index = 0;
+    v.repeatsLeft = cmd->repeats;
+    v.ticksPerUnitQ8 = cmd->ticksPerUnitQ8;
+    // Start tick already gone (or 0)? Start on the next tick
+    v.startTick = (int32_t)(cmd->startTick - toneTickCount) > 0 ? cmd->startTick : toneTickCount + 1;
+    v.units = 0;
+    v.nextTick = v.startTick;
+    updateToneNextEvent();
+}
+
+uint32_t toneUnitsToTicks(const ToneVoice &v, uint32_t units) {
+    return (units * v.ticksPerUnitQ8 + 128) >> 8;
+}
+
+void startToneNote(uint8_t voice) {
+    ToneVoice &v = toneVoices[voice];
+    const ToneNote &n = v.song[v.index++];
+    
+    uint32_t begin = v.startTick + toneUnitsToTicks(v, v.units);
+    v.units += n.length;
+    v.nextTick = v.startTick + toneUnitsToTicks(v, v.units);
+    
+    // The gap comes out of the note's own time, so the tempo stays exact
+    uint32_t gap = TONE_GAP_MS * FADE_TICK_HZ / 1000;
+    if (gap > (v.nextTick - begin) / 4) gap = (v.nextTick - begin) / 4;
+    v.releaseTick = v.nextTick - gap;
+    
+    v.sounding = n.note != 0 && toneDivider[n.note] != 0;
+    if (v.sounding) toneWrite(voice, n.note);
+}
+
+void updateToneNextEvent() {
+    uint32_t soonest = toneTickCount + 0x7FFFFFFF;
+    for (int i = 0; i < TONE_VOICES; i++) {
+        ToneVoice &v = toneVoices[i];
+        if (!v.active) continue;
+        uint32_t when = v.sounding ? v.releaseTick : v.nextTick;
+        if ((int32_t)(when - soonest) < 0) soonest = when;
+    }
+    toneNextEvent = soonest;
+}
+
+void toneTick() {
+    toneTickCount++;
+    if ((int32_t)(toneTickCount - toneNextEvent) < 0) return;  // Nothing starts or stops
+    
+    for (int i = 0; i < TONE_VOICES; i++) {
+        ToneVoice &v = toneVoices[i];
+        if (!v.active) continue;
+        
+        if (v.sounding && toneTickCount == v.releaseTick) {
+            toneWrite(i, 0);
+            v.sounding = false;
+        }
+        if (toneTickCount == v.nextTick) {
+            if (v.index == v.length) {
+                v.index = 0;
+                if (v.repeatsLeft != SONG_FOREVER && --v.repeatsLeft == 0) {
+                    v.active = false;
+                    setToneBusy(i, false);
+                    continue;
+                }
+                v.startTick = toneTickCount;  // New pass: count from here
+                v.units = 0;
+            }
+            startToneNote(i);
+        }
+    }
+    updateToneNextEvent();
+}
+
+/*
+ * SERVO MOTION PLANNER
+ * 
+ * Everything is in LEDC counts (16-bit at 50 Hz: 0.305 us, ~1/36 degree).
+ * The planner finds the shortest move length T (in frames) that keeps
+ * every servo inside its speed and acceleration limits, works out ONE
+ * shape s(k) going 0 -> 1, and fills the buffer with start + distance x s(k).
+ * 
+ * Trapezoid, Ta frames of acceleration:
+ *   k <= Ta:       s = k^2 / (2 Ta (T - Ta))
+ *   cruise:        s = (2k - Ta) / (2 (T - Ta))
+ *   k >= T - Ta:   s = 1 - (T - k)^2 / (2 Ta (T - Ta))
+ * S-curve: s = 10u^3 - 15u^4 + 6u^5 (u = k/T), peak speed 1.875 D/T,
+ * peak acceleration 5.77 D/T^2.
+ */
+uint16_t angleToCounts(int angle) {
+    angle = constrain(angle, 0, 180);
+    uint32_t us = SERVO_MIN_PULSE_US + (uint32_t)angle * (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US) / 180;
+    return (us * 65536 + SERVO_PERIOD_US / 2) / SERVO_PERIOD_US;
+}
+
+int countsToAngle(uint16_t counts) {
+    int32_t us = ((int32_t)counts * SERVO_PERIOD_US + 32768) >> 16;
+    return constrain((us - SERVO_MIN_PULSE_US) * 180 / (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US), 0, 180);
+}
+
+// Limits in degrees/s and degrees/s^2 (call before the engine starts)
+// 1 degree = 36.4 counts; lower bounds keep every move inside the buffer
+void setServoLimits(uint8_t axis, uint32_t degPerSec, uint32_t degPerSec2) {
+    degPerSec = max(degPerSec, (uint32_t)20);
+    degPerSec2 = max(degPerSec2, (uint32_t)100);
+    servoMaxSpeed[axis] = (uint64_t)degPerSec * 2000 * 65536 * 256 / (180ULL * SERVO_PERIOD_US * SERVO_FREQUENCY);
+    servoMaxAccel[axis] = (uint64_t)degPerSec2 * 2000 * 65536 * 256 /
+                          (180ULL * SERVO_PERIOD_US * SERVO_FREQUENCY * SERVO_FREQUENCY);
+}
+
+void startMotionPlanner() {
+    for (int a = 0; a < SERVO_AXES; a++) {
+        setServoLimits(a, 300, 1500);  // A hobby servo can do ~600 deg/s - stay gentle
+        servoTargetAngle[a] = 90;
+        servoPosition[a] = angleToCounts(90);
+        servoDuty[a] = servoPosition[a];
+        ledcWrite(servoChannel[a], servoPosition[a]);  // Start centered
+    }
+    motionQueue = xQueueCreate(8, sizeof(MotionMove));
+}
+
+// --- Called from loop(): queue a move, return at once ---
+
+void moveServos(const int angles[SERVO_AXES], uint8_t profile) {
+    MotionMove move;
+    for (int a = 0; a < SERVO_AXES; a++) {
+        servoTargetAngle[a] = angles[a];
+        move.target[a] = angleToCounts(angles[a]);
+    }
+    move.profile = profile;
+    motionSent++;
+    xQueueSend(motionQueue, &move, portMAX_DELAY);  // Full (8 moves)? Wait for room
+}
+
+bool isServoMoving() {
+    return motionSent != motionDone;
+}
+
+// Wait for every queued move to finish, printing where the servos are
+void waitForServos() {
+    while (isServoMoving()) {
+        Serial.print("  ... servo angles: ");
+        Serial.print(countsToAngle(servoDuty[0]));
+        Serial.print(", ");
+        Serial.println(countsToAngle(servoDuty[1]));
+        delay(200);
+    }
+}
+
+// --- Inside the fade task ---
+
+uint32_t divCeil(uint64_t a, uint64_t b) {
+    return (a + b - 1) / b;
+}
+
+uint32_t isqrtCeil(uint32_t n) {
+    uint32_t r = 0, bit = 1UL << 30;
+    uint32_t x = n;
+    while (bit > x) bit >>= 2;
+    while (bit) {  // Digit-by-digit square root
+        if (x >= r + bit) {
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (r * r < n) ? r + 1 : r;
+}
+
+// Shortest T and shared Ta that keep every servo inside its limits
+uint32_t planTrapezoid(const uint32_t dist[], uint32_t *accelFrames) {
+    uint32_t T = 0, Ta = 0;
+    for (int a = 0; a < SERVO_AXES; a++) {
+        uint64_t d = (uint64_t)dist[a] << 8;
+        if (d == 0) continue;
+        uint32_t v = servoMaxSpeed[a], acc = servoMaxAccel[a];
+        // Accelerate until top speed - or until halfway, for short moves
+        uint32_t ta = min(divCeil(v, acc), isqrtCeil(divCeil(d, acc)));
+        if (ta == 0) ta = 1;
+        uint32_t rest = max(ta, max(divCeil(d, v), divCeil(d, (uint64_t)acc * ta)));
+        Ta = max(Ta, ta);
+        T = max(T, ta + rest);
+    }
+    if (T == 0) return 0;
+    if (T < 2 * Ta) T = 2 * Ta;
+    
+    // The shared Ta can push the shorter move over its limit: stretch T until both fit
+    for (int a = 0; a < SERVO_AXES; a++) {
+        uint64_t d = (uint64_t)dist[a] << 8;
+        while (d > (uint64_t)servoMaxSpeed[a] * (T - Ta) || d > (uint64_t)servoMaxAccel[a] * Ta * (T - Ta)) {
+            T++;
+        }
+    }
+    *accelFrames = Ta;
+    return T;
+}
+
+uint32_t planSCurve(const uint32_t dist[]) {
+    uint32_t T = 0;
+    for (int a = 0; a < SERVO_AXES; a++) {
+        uint64_t d = (uint64_t)dist[a] << 8;
+        if (d == 0) continue;
+        uint32_t bySpeed = divCeil(d * 15, (uint64_t)servoMaxSpeed[a] * 8);                // 1.875 D / v
+        uint32_t byAccel = isqrtCeil(divCeil(d * 5913, (uint64_t)servoMaxAccel[a] * 1024)); // 5.774 = 5913/1024
+        T = max(T, max(bySpeed, byAccel));
+    }
+    return T;
+}
+
+// Plan a move into the buffer; returns its length in frames (0 = already there)
+uint16_t planMotion(const MotionMove &move) {
+    uint32_t dist[SERVO_AXES];
+    int32_t delta[SERVO_AXES];
+    for (int a = 0; a < SERVO_AXES; a++) {
+        delta[a] = (int32_t)move.target[a] - servoPosition[a];
+        dist[a] = abs(delta[a]);
+    }
+    
+    uint32_t Ta = 0;
+    uint32_t T = (move.profile == PROFILE_TRAPEZOID) ? planTrapezoid(dist, &Ta) : planSCurve(dist);
+    if (T == 0) return 0;
+    if (T > MOTION_MAX_FRAMES) T = MOTION_MAX_FRAMES;  // Can't happen with setServoLimits()
+    
+    // The shape, once for both servos
+    if (move.profile == PROFILE_TRAPEZOID) {
+        uint64_t denom = 2ULL * Ta * (T - Ta);
+        for (uint32_t k = 1; k <= T; k++) {
+            if (k <= Ta) {
+                motionShape[k] = ((uint64_t)k * k * PROFILE_ONE + denom / 2) / denom;
+            } else if (k < T - Ta) {
+                motionShape[k] = ((uint64_t)(2 * k - Ta) * PROFILE_ONE + (T - Ta)) / (2ULL * (T - Ta));
+            } else {
+                uint64_t r = T - k;
+                motionShape[k] = PROFILE_ONE - (r * r * PROFILE_ONE + denom / 2) / denom;
+            }
+        }
+    } else {
+        for (uint32_t k = 1; k <= T; k++) {
+            int64_t u = ((uint64_t)k * PROFILE_ONE + T / 2) / T;  // Q16
+            int64_t u2 = (u * u) >> 16;
+            int64_t u3 = (u2 * u) >> 16;
+            motionShape[k] = (u3 * (10 * PROFILE_ONE - 15 * u + 6 * u2) + PROFILE_ONE / 2) >> 16;
+        }
+    }
+    motionShape[T] = PROFILE_ONE;  // Land exactly on the target
+    
+    // Each servo: start + distance x s(k), into the frame-indexed buffer
+    for (int a = 0; a < SERVO_AXES; a++) {
+        int32_t start = servoPosition[a];
+        for (uint32_t k = 1; k <= T; k++) {
+            motionDuty[a][k - 1] = start + ((delta[a] * (int32_t)motionShape[k] + 32768) >> 16);
+        }
+        servoPosition[a] = move.target[a];
+    }
+    return T;
+}
+
+// One servo frame (every 20 ms). The next move is planned on the frame the
+// last one ends, so moves chain without a pause.
+void motionTick() {
+    if (motionFrames > 0 && motionFrame == motionFrames) {
+        motionDone++;  // The last frame went out 20 ms ago
+        motionFrames = motionFrame = 0;
+    }
+    while (motionFrame == motionFrames) {
+        MotionMove move;
+        if (xQueueReceive(motionQueue, &move, 0) != pdTRUE) return;
+        motionFrames = planMotion(move);
+        motionFrame = 0;
+        if (motionFrames == 0) motionDone++;  // Already there
+    }
+    for (int a = 0; a < SERVO_AXES; a++) {
+        uint16_t duty = motionDuty[a][motionFrame];
+        if (duty != servoDuty[a]) {
+            servoDuty[a] = duty;
+            ledcWrite(servoChannel[a], duty);
+        }
+    }
+    motionFrame++;
+}
+
 /*
  * EXAMPLE 1: LED Brightness Control
  */
@@ -129,35 +953,18 @@ void ledBrightnessControl() {
     Serial.println("--- LED Brightness Control ---");
     Serial.println("Demonstrating PWM duty cycle effects:");
     
-    // Fade up from 0% to 100%
-    Serial.println("Fading LED up (0% to 100%)...");
-    for(int brightness = 0; brightness <= 255; brightness += 5) {
-        ledcWrite(PWM_CHANNEL_0, brightness);
-        
-        float percentage = (brightness * 100.0) / 255.0;
-        Serial.print("Brightness: ");
-        Serial.print(percentage, 1);
-        Serial.print("% (PWM value: ");
-        Serial.print(brightness);
-        Serial.println(")");
-        
-        delay(100);
-    }
+    // Fade up from 0% to 100% - one command, the fade engine does the rest
+    // (the old loop: 52 x ledcWrite + delay(100), in steps of 5 you could see)
+    Serial.println("Fading LED up (0% to 100%) in 2.6 s, S-curve...");
+    fadeTo(PWM_CHANNEL_0, 255, 2600, EASE_IN_OUT);
+    waitForFade(PWM_CHANNEL_0);
     
     delay(500);
     
     // Fade down from 100% to 0%
-    Serial.println("Fading LED down (100% to 0%)...");
-    for(int brightness = 255; brightness >= 0; brightness -= 5) {
-        ledcWrite(PWM_CHANNEL_0, brightness);
-        
-        float percentage = (brightness * 100.0) / 255.0;
-        Serial.print("Brightness: ");
-        Serial.print(percentage, 1);
-        Serial.println("%");
-        
-        delay(100);
-    }
+    Serial.println("Fading LED down (100% to 0%) in 2.6 s, linear...");
+    fadeTo(PWM_CHANNEL_0, 0, 2600, EASE_LINEAR);
+    waitForFade(PWM_CHANNEL_0);
     
     Serial.println("LED brightness control complete!");
     Serial.println();
@@ -186,23 +993,19 @@ void motorSpeedControl() {
         Serial.print(speed);
         Serial.println(")");
         
-        ledcWrite(PWM_CHANNEL_1, speed);
+        fadeTo(PWM_CHANNEL_1, speed, 300, EASE_LINEAR);  // Soft change, no current spike
         delay(2000);
     }
     
-    // Gradual acceleration and deceleration
-    Serial.println("Demonstrating smooth acceleration...");
-    for(int speed = 0; speed <= 255; speed += 3) {
-        ledcWrite(PWM_CHANNEL_1, speed);
-        delay(50);
-    }
-    
-    delay(1000);
-    
-    Serial.println("Demonstrating smooth deceleration...");
-    for(int speed = 255; speed >= 0; speed -= 3) {
-        ledcWrite(PWM_CHANNEL_1, speed);
-        delay(50);
+    // Gradual acceleration, then deceleration started by the completion
+    // callback - the fade task chains them, loop() just waits to move on
+    Serial.println("Demonstrating smooth acceleration (then deceleration)...");
+    fadeTo(PWM_CHANNEL_1, 0, 0, EASE_LINEAR);
+    fadeTo(PWM_CHANNEL_1, 255, 4300, EASE_IN_OUT, onMotorAtFullSpeed);
+    waitForFade(PWM_CHANNEL_1);
+    while (fadeDuty[PWM_CHANNEL_1] != 0 || isFading(PWM_CHANNEL_1)) {
+        waitForFade(PWM_CHANNEL_1);
+        delay(10);
     }
     
     Serial.println("Motor control complete!");
@@ -216,7 +1019,8 @@ void servoPositionControl() {
     Serial.println("--- Servo Motor Position Control ---");
     Serial.println("Moving servo to different angles:");
     
-    // Move to specific angles
+    // Move to specific angles - servo 2 mirrors servo 1. All 7 moves go
+    // into the queue at once; the planner plays them back to back.
     int angles[] = {0, 45, 90, 135, 180, 90, 0};
     
     for(int i = 0; i < 7; i++) {
@@ -226,45 +1030,31 @@ void servoPositionControl() {
         Serial.print(angle);
         Serial.println(" degrees");
         
-        setServoAngle(angle);
-        delay(1000);
+        int both[SERVO_AXES] = {angle, 180 - angle};
+        moveServos(both, PROFILE_TRAPEZOID);
     }
+    waitForServos();
     
     // Smooth sweep
-    Serial.println("Smooth servo sweep (0° to 180° to 0°):");
-    
-    // Sweep from 0 to 180
-    for(int angle = 0; angle <= 180; angle += 2) {
-        setServoAngle(angle);
-        delay(50);
-    }
-    
-    delay(500);
-    
-    // Sweep from 180 to 0
-    for(int angle = 180; angle >= 0; angle -= 2) {
-        setServoAngle(angle);
-        delay(50);
-    }
+    Serial.println("Smooth servo sweep (0° to 180° to 0°), S-curve:");
+    setServoAngle(180, PROFILE_SCURVE);
+    setServoAngle(0, PROFILE_SCURVE);
+    waitForServos();
     
     Serial.println("Servo control complete!");
     Serial.println();
 }
 
-void setServoAngle(int angle) {
-    // Constrain angle to valid range
-    if(angle < 0) angle = 0;
-    if(angle > 180) angle = 180;
-    
-    // Calculate pulse width in microseconds
-    // 0° = 500µs, 180° = 2500µs
-    int pulse_width_us = map(angle, 0, 180, 500, 2500);
-    
-    // Convert to PWM value for 16-bit resolution at 50Hz
-    // Period = 20ms = 20000µs
-    int pwm_value = map(pulse_width_us, 0, 20000, 0, 65535);
-    
-    ledcWrite(PWM_CHANNEL_2, pwm_value);
+// Runs in the fade task when the acceleration ends
+void onMotorAtFullSpeed(uint8_t channel) {
+    startChannelFade(channel, 0, 4300, EASE_IN_OUT, NULL);  // We ARE the fade task: start directly
+}
+
+// Move servo 1 (servo 2 stays where it was asked to be). Planned, not a
+// jump: the servo accelerates, cruises and brakes within its limits.
+void setServoAngle(int angle, uint8_t profile = PROFILE_TRAPEZOID) {
+    int both[SERVO_AXES] = {angle, servoTargetAngle[1]};
+    moveServos(both, profile);
 }
 
 /*
@@ -274,42 +1064,14 @@ void audioToneGeneration() {
     Serial.println("--- Audio Tone Generation ---");
     Serial.println("Playing musical scale using PWM...");
     
-    // Musical notes (frequencies in Hz)
-    struct Note {
-        const char* name;
-        int frequency;
+    // Musical notes: C4 D4 E4 F4 G4 A4 B4 C5, quarter notes at 120 bpm
+    // (500 ms each, the last 50 ms silent)
+    static const ToneNote scale[] = {
+        {60, 4}, {62, 4}, {64, 4}, {65, 4}, {67, 4}, {69, 4}, {71, 4}, {72, 4}
     };
     
-    Note scale[] = {
-        {"C4", 262},
-        {"D4", 294}, 
-        {"E4", 330},
-        {"F4", 349},
-        {"G4", 392},
-        {"A4", 440},
-        {"B4", 494},
-        {"C5", 523}
-    };
-    
-    for(int i = 0; i < 8; i++) {
-        Serial.print("Playing note: ");
-        Serial.print(scale[i].name);
-        Serial.print(" (");
-        Serial.print(scale[i].frequency);
-        Serial.println(" Hz)");
-        
-        // Setup PWM frequency for this note
-        ledcSetup(PWM_CHANNEL_3, scale[i].frequency, 8);
-        ledcAttachPin(BUZZER_PIN, PWM_CHANNEL_3);
-        
-        // 50% duty cycle for square wave audio
-        ledcWrite(PWM_CHANNEL_3, 128);
-        delay(500);
-        
-        // Stop the tone
-        ledcWrite(PWM_CHANNEL_3, 0);
-        delay(100);
-    }
+    playSong(0, scale, 8, 120);
+    waitForSong(0);
     
     // Play a simple melody
     Serial.println("Playing simple melody...");
@@ -321,19 +1083,26 @@ void audioToneGeneration() {
 
 void playMelody() {
     // Simple melody: "Twinkle, Twinkle, Little Star" (first line)
-    int melody[] = {262, 262, 392, 392, 440, 440, 392};  // C C G G A A G
-    int durations[] = {500, 500, 500, 500, 500, 500, 1000}; // Note lengths in ms
+    static const ToneNote melody[] = {
+        {60, 4}, {60, 4}, {67, 4}, {67, 4}, {69, 4}, {69, 4}, {67, 8}  // C C G G A A G
+    };
+    // Bass line for the second buzzer (silent if it isn't connected)
+    static const ToneNote bass[] = {
+        {48, 8}, {48, 8}, {53, 8}, {48, 8}                           // C3 C3 F3 C3
+    };
     
-    for(int i = 0; i < 7; i++) {
-        ledcSetup(PWM_CHANNEL_3, melody[i], 8);
-        ledcAttachPin(BUZZER_PIN, PWM_CHANNEL_3);
-        ledcWrite(PWM_CHANNEL_3, 128);  // 50% duty cycle
-        
-        delay(durations[i]);
-        
-        ledcWrite(PWM_CHANNEL_3, 0);  // Stop note
-        delay(50);  // Brief pause between notes
-    }
+    // Same start tick -> both voices stay in sync to the last note
+    uint32_t start = toneNow() + 10;
+    playSong(0, melody, 7, 120, 1, start);
+    playSong(1, bass, 4, 120, 1, start);
+    
+    // loop() is free while the song plays: breathe the LED meanwhile
+    static const PatternStep breathe[] = {
+        {255, 1000, EASE_SINE},
+        {0,   1000, EASE_SINE},
+    };
+    playPattern(PWM_CHANNEL_0, breathe, 2, 2);
+    waitForSong(0);
 }
 
 /*
@@ -390,40 +1159,68 @@ void setRGBColor(int red, int green, int blue) {
     ledcWrite(PWM_CHANNEL_6, blue);
 }
 
+// Set the RGB LED through the gamma table, with temporal dithering:
+// each channel keeps the fraction PWM couldn't show and adds it next time,
+// so over many refreshes the average is the exact 16-bit gamma value.
+// Call it every RGB_REFRESH_MS while a color is showing.
+void showRGB(RgbColor color) {
+    uint8_t levels[3] = {color.r, color.g, color.b};
+    for (int c = 0; c < 3; c++) {
+        uint32_t sum = gammaTable[levels[c]] + ditherError[c];
+        ditherError[c] = sum & 0xFF;
+        ledcWrite(PWM_CHANNEL_4 + c, sum >> 8);
+    }
+}
+
 void colorFadeDemo() {
-    Serial.println("Fading through rainbow colors...");
+    Serial.println("Fading through rainbow colors (gamma corrected)...");
     
-    // Rainbow color cycle
-    for(int hue = 0; hue < 360; hue += 5) {
-        int red, green, blue;
-        hsvToRgb(hue, 255, 255, &red, &green, &blue);
-        
-        setRGBColor(red, green, blue);
-        delay(50);
-    }
-}
-
-// Convert HSV (Hue, Saturation, Value) to RGB
-void hsvToRgb(int h, int s, int v, int* r, int* g, int* b) {
-    int c = (v * s) / 255;
-    int x = c * (60 - abs((h % 120) - 60)) / 60;
-    int m = v - c;
-    
-    if(h < 60) {
-        *r = c; *g = x; *b = 0;
-    } else if(h < 120) {
-        *r = x; *g = c; *b = 0;
-    } else if(h < 180) {
-        *r = 0; *g = c; *b = x;
-    } else if(h < 240) {
-        *r = 0; *g = x; *b = c;
-    } else if(h < 300) {
-        *r = x; *g = 0; *b = c;
-    } else {
-        *r = c; *g = 0; *b = x;
+    // Rainbow color cycle: 768 refreshes x 4 ms = about 3 seconds
+    for(int hue = 0; hue < HUE_RANGE; hue += 2) {
+        HsvColor hsv = {(uint16_t)hue, 255, 255};
+        showRGB(hsvToRgb(hsv));
+        delay(RGB_REFRESH_MS);
     }
+}
+
+// Build the lookup tables once - the only float math in the color engine
+void buildColorTables() {
+    for (int i = 0; i < 256; i++) {
+        sineTable[i] = (uint8_t)lroundf(128 + 127 * sinf(2 * PI * i / 256));
+        gammaTable[i] = (uint16_t)lroundf(powf(i / 255.0f, 2.2f) * 255 * 256);
+    }
+    Serial.print("Color tables built: PWM for 50% brightness = ");
+    Serial.print(gammaTable[128] >> 8);
+    Serial.println(" (your eye sees 56/255 as half)");
+}
+
+// Convert HSV (Hue, Saturation, Value) to RGB - integer only, no branches
+// (x + 128) * 257 >> 16 is x / 255 rounded, exact for all 16-bit x
+RgbColor hsvToRgb(HsvColor in) {
+    uint32_t sector = in.hue >> 8;
+    uint32_t frac = in.hue & (HUE_STEPS_PER_SECTOR - 1);
+    uint32_t chroma = (((uint32_t)in.val * in.sat + 128) * 257) >> 16;
+    uint32_t rise = (chroma * frac + 128) >> 8;
+    uint32_t m = in.val - chroma;  // The "white" part
+    
+    uint32_t levels = (chroma << (8 * LEVEL_FULL)) | (rise << (8 * LEVEL_RISE)) |
+                      ((chroma - rise) << (8 * LEVEL_FALL));
+    uint32_t shifts = sectorShifts[sector];
     
-    *r += m; *g += m; *b += m;
+    // The uint8_t cast drops the other levels' bytes (level + m is never > 255)
+    RgbColor out = {
+        (uint8_t)((levels >> (shifts & 0xFF)) + m),
+        (uint8_t)((levels >> ((shifts >> 8) & 0xFF)) + m),
+        (uint8_t)((levels >> (shifts >> 16)) + m),
+    };
+    return out;
+}
+
+// Convert a whole frame at once - for LED strips (WS2812 etc.) with many pixels
+void hsvFrameToRgb(const HsvColor *in, RgbColor *out, int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = hsvToRgb(in[i]);
+    }
 }
 
 /*
@@ -432,44 +1229,35 @@ void hsvToRgb(int h, int s, int v, int* r, int* g, int* b) {
 void pwmEffectsDemo() {
     Serial.println("--- PWM Effects Demo ---");
     
-    // Breathing effect
-    Serial.println("Breathing effect on LED...");
-    for(int cycle = 0; cycle < 3; cycle++) {
-        // Breathe in
-        for(int brightness = 0; brightness <= 255; brightness += 3) {
-            ledcWrite(PWM_CHANNEL_0, brightness);
-            delay(20);
-        }
-        // Breathe out
-        for(int brightness = 255; brightness >= 0; brightness -= 3) {
-            ledcWrite(PWM_CHANNEL_0, brightness);
-            delay(20);
-        }
-    }
-    
-    // Pulsing motor effect
-    Serial.println("Pulsing motor effect...");
-    for(int pulse = 0; pulse < 5; pulse++) {
-        ledcWrite(PWM_CHANNEL_1, 200);  // Fast
-        delay(200);
-        ledcWrite(PWM_CHANNEL_1, 100);  // Slow
-        delay(200);
-        ledcWrite(PWM_CHANNEL_1, 0);    // Stop
-        delay(300);
-    }
+    // Breathing LED and pulsing motor as patterns: both start at once and
+    // play in the background while loop() runs the rainbow below
+    static const PatternStep breathing[] = {
+        {255, 1650, EASE_SINE},     // Breathe in
+        {0,   1650, EASE_SINE},     // Breathe out
+    };
+    static const PatternStep motorPulse[] = {
+        {200,  20, EASE_LINEAR},    // Fast (20 ms soft edge)
+        {200, 180, EASE_LINEAR},    // Hold
+        {100,  20, EASE_LINEAR},    // Slow
+        {100, 180, EASE_LINEAR},
+        {0,    20, EASE_LINEAR},    // Stop
+        {0,   280, EASE_LINEAR},
+    };
+    Serial.println("Breathing effect on LED + pulsing motor (in the background)...");
+    playPattern(PWM_CHANNEL_0, breathing, 2, 3);
+    playPattern(PWM_CHANNEL_1, motorPulse, 6, 5);
     
-    // RGB rainbow cycle
+    // RGB rainbow cycle - meanwhile, in the foreground
     Serial.println("RGB rainbow cycle...");
-    for(int i = 0; i < 360; i += 10) {
-        int r, g, b;
-        hsvToRgb(i, 255, 128, &r, &g, &b);  // Half brightness
-        setRGBColor(r, g, b);
-        delay(100);
+    for(int hue = 0; hue < HUE_RANGE; hue += 2) {
+        HsvColor hsv = {(uint16_t)hue, 255, 128};  // Half brightness - as the eye sees it
+        showRGB(hsvToRgb(hsv));
+        delay(RGB_REFRESH_MS);
     }
     
-    // Turn everything off
-    ledcWrite(PWM_CHANNEL_0, 0);  // LED off
-    ledcWrite(PWM_CHANNEL_1, 0);  // Motor off
+    // Let the patterns finish, then turn everything off
+    waitForFade(PWM_CHANNEL_0);
+    waitForFade(PWM_CHANNEL_1);
     setRGBColor(0, 0, 0);         // RGB off
     
     Serial.println("PWM effects demo complete!");
@@ -489,12 +1277,11 @@ void setPWMPercentage(int channel, float percentage) {
     ledcWrite(channel, pwm_value);
 }
 
-// Function to create custom PWM waveform
-void customPWMPattern(int channel, int pattern[], int length, int delay_ms) {
-    for(int i = 0; i < length; i++) {
-        ledcWrite(channel, pattern[i]);
-        delay(delay_ms);
-    }
+// Function to play a custom PWM waveform - queued, returns at once
+// Each step fades (or holds, same duty again) for its own time; the steps
+// array must stay valid while it plays, so make it static const
+void customPWMPattern(uint8_t channel, const PatternStep pattern[], uint16_t length, uint16_t repeats) {
+    playPattern(channel, pattern, length, repeats);
 }
 
 /*
@@ -540,8 +1327,15 @@ void customPWMPattern(int channel, int pattern[], int length, int delay_ms) {
  * 4. PWM controls LED brightness, motor speed, servo position
  * 5. Different applications need different PWM frequencies
  * 6. Audio generation uses PWM at audible frequencies (20Hz-20kHz)
- * 7. RGB LEDs use 3 PWM channels for millions of color combinations
+ * 7. RGB LEDs use 3 PWM channels for millions of color combinations -
+ *    convert colors with integer tables, and gamma-correct what you show
  * 8. Proper hardware design (drivers, resistors) is essential for safety
+ * 9. Fades belong to a timer, not to delay() loops: one tick moves every
+ *    channel, and loop() stays free for everything else
+ * 10. Songs are note tables played by the same timer; a precomputed divider
+ *     table makes every note a lookup
+ * 11. Plan servo moves once (speed and acceleration limits), then play the
+ *     pulse buffer frame by frame - several servos in sync
  * 
  * Next Module: Communication Protocols - I2C, SPI, and advanced UART!
  */
\ No newline at end of file
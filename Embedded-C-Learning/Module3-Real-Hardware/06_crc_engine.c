@@ -0,0 +1,531 @@
+/*
+ * MODULE 3 - LESSON 6: CRC Engine - Fast Error Detection
+ *
+ * What you'll learn:
+ * - What a CRC really computes (polynomial division, bit by bit)
+ * - How a 256-entry lookup table does 8 bits per step
+ * - How "slice-by-8" does 8 BYTES per step with 8 tables
+ * - How CPUs with SSE4.2 compute CRC-32C with a single instruction
+ * - How PCLMULQDQ (carry-less multiply) "folds" 64 bytes at a time
+ * - How to pick the fastest version at runtime and measure GB/s
+ *
+ * Think of a CRC like a fingerprint of your data:
+ * - Change ONE bit anywhere and the fingerprint changes
+ * - The receiver computes its own fingerprint and compares
+ * - Much stronger than adding the bytes up (a "checksum")
+ *
+ * CRCs in this lesson:
+ *   CRC-8        poly 0x07,       init 0x00        (sensor bytes, small packets)
+ *   CRC-16/CCITT poly 0x1021,     init 0xFFFF      (our UART frames, lesson 5)
+ *   CRC-32       poly 0x04C11DB7, reflected        (Ethernet, ZIP, PNG, SD logs)
+ *   CRC-32C      poly 0x1EDC6F41, reflected        (iSCSI, ext4, SSE4.2 instruction)
+ *
+ * The CRC-32/32C functions work like zlib's crc32(): start with 0 and
+ * pass the previous result back in to continue over more data.
+ *
+ * This file runs on your PC (x86-64 for the hardware paths):
+ *   gcc -O2 -o crc_engine 06_crc_engine.c && ./crc_engine
+ * On an ESP32 the table versions are the ones to use (see 02_uart_communication.c
+ * and the SD card logger in Module 4).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC_HAVE_X86 1
+#else
+#define CRC_HAVE_X86 0
+#endif
+
+#define CRC32_POLY_REFLECTED    0xEDB88320u     // 0x04C11DB7 bit-reversed
+#define CRC32C_POLY_REFLECTED   0x82F63B78u     // 0x1EDC6F41 bit-reversed
+
+/*
+ * PART 1: Bitwise versions - the definition, one bit at a time
+ * Slow, but tiny and obviously correct. Every faster version is
+ * checked against these.
+ */
+uint8_t crc8_bitwise(uint8_t crc, const uint8_t* data, size_t length)
+{
+    while (length--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t crc16_bitwise(uint16_t crc, const uint8_t* data, size_t length)
+{
+    while (length--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Reflected CRC-32: data enters LSB first, so we shift RIGHT
+static uint32_t crc32_reflected_bitwise(uint32_t poly, uint32_t crc, const uint8_t* data, size_t length)
+{
+    crc = ~crc;
+    while (length--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (poly & (0u - (crc & 1)));  // Branch-free: mask is 0 or poly
+        }
+    }
+    return ~crc;
+}
+
+uint32_t crc32_bitwise(uint32_t crc, const uint8_t* data, size_t length)
+{
+    return crc32_reflected_bitwise(CRC32_POLY_REFLECTED, crc, data, length);
+}
+
+uint32_t crc32c_bitwise(uint32_t crc, const uint8_t* data, size_t length)
+{
+    return crc32_reflected_bitwise(CRC32C_POLY_REFLECTED, crc, data, length);
+}
+
+/*
+ * PART 2: Table versions - 8 bits per lookup
+ * table[i] = "what the 8 bitwise steps do to byte value i".
+ * The slice-by-8 tables extend this: slice[k][i] is the effect of byte
+ * value i followed by k zero bytes, so 8 independent lookups can be
+ * XORed together to process 8 bytes at once.
+ */
+static uint8_t  crc8_table[256];
+static uint16_t crc16_table[256];
+static uint32_t crc32_slice[8][256];    // crc32_slice[0] is the plain 256-entry table
+static uint32_t crc32c_slice[8][256];
+
+static void build_reflected_slices(uint32_t poly, uint32_t slice[8][256])
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (poly & (0u - (crc & 1)));
+        }
+        slice[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t prev = slice[k - 1][i];
+            slice[k][i] = (prev >> 8) ^ slice[0][prev & 0xFF];
+        }
+    }
+}
+
+void crc_tables_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint8_t value = (uint8_t)i;
+        crc8_table[i] = crc8_bitwise(0, &value, 1);
+        crc16_table[i] = crc16_bitwise(0, &value, 1);
+    }
+    build_reflected_slices(CRC32_POLY_REFLECTED, crc32_slice);
+    build_reflected_slices(CRC32C_POLY_REFLECTED, crc32c_slice);
+}
+
+uint8_t crc8_table_driven(uint8_t crc, const uint8_t* data, size_t length)
+{
+    while (length--) {
+        crc = crc8_table[crc ^ *data++];
+    }
+    return crc;
+}
+
+uint16_t crc16_table_driven(uint16_t crc, const uint8_t* data, size_t length)
+{
+    while (length--) {
+        crc = (uint16_t)((crc << 8) ^ crc16_table[(crc >> 8) ^ *data++]);
+    }
+    return crc;
+}
+
+static uint32_t crc32_reflected_table(const uint32_t table[256], uint32_t crc, const uint8_t* data, size_t length)
+{
+    crc = ~crc;
+    while (length--) {
+        crc = (crc >> 8) ^ table[(crc ^ *data++) & 0xFF];
+    }
+    return ~crc;
+}
+
+uint32_t crc32_table_driven(uint32_t crc, const uint8_t* data, size_t length)
+{
+    return crc32_reflected_table(crc32_slice[0], crc, data, length);
+}
+
+uint32_t crc32c_table_driven(uint32_t crc, const uint8_t* data, size_t length)
+{
+    return crc32_reflected_table(crc32c_slice[0], crc, data, length);
+}
+
+/*
+ * PART 3: Slice-by-8 - 8 bytes, 8 independent lookups per step
+ * The lookups don't depend on each other, so the CPU runs them in parallel.
+ */
+static inline uint32_t load_le32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t crc32_reflected_slice8(const uint32_t slice[8][256], uint32_t crc, const uint8_t* data, size_t length)
+{
+    crc = ~crc;
+    while (length >= 8) {
+        uint32_t one = load_le32(data) ^ crc;
+        uint32_t two = load_le32(data + 4);
+        crc = slice[7][one & 0xFF] ^ slice[6][(one >> 8) & 0xFF] ^
+              slice[5][(one >> 16) & 0xFF] ^ slice[4][one >> 24] ^
+              slice[3][two & 0xFF] ^ slice[2][(two >> 8) & 0xFF] ^
+              slice[1][(two >> 16) & 0xFF] ^ slice[0][two >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = (crc >> 8) ^ slice[0][(crc ^ *data++) & 0xFF];
+    }
+    return ~crc;
+}
+
+uint32_t crc32_slice_by_8(uint32_t crc, const uint8_t* data, size_t length)
+{
+    return crc32_reflected_slice8(crc32_slice, crc, data, length);
+}
+
+uint32_t crc32c_slice_by_8(uint32_t crc, const uint8_t* data, size_t length)
+{
+    return crc32_reflected_slice8(crc32c_slice, crc, data, length);
+}
+
+#if CRC_HAVE_X86
+/*
+ * PART 4: SSE4.2 crc32 instruction - CRC-32C in hardware
+ * One instruction eats 8 bytes. It ONLY computes the Castagnoli
+ * polynomial, which is why CRC-32C is popular for storage formats.
+ */
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(uint32_t crc, const uint8_t* data, size_t length)
+{
+    uint64_t state = ~crc;
+    while (length && ((uintptr_t)data & 7)) {     // Align to 8 bytes
+        state = _mm_crc32_u8((uint32_t)state, *data++);
+        length--;
+    }
+    while (length >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, data, 8);
+        state = _mm_crc32_u64(state, chunk);
+        data += 8;
+        length -= 8;
+    }
+    while (length--) {
+        state = _mm_crc32_u8((uint32_t)state, *data++);
+    }
+    return ~(uint32_t)state;
+}
+
+/*
+ * PART 5: PCLMULQDQ folding - CRC-32 (IEEE) 64 bytes per step
+ * A CRC is the remainder of a polynomial division. Carry-less multiply
+ * lets us "fold" 128 bits of remainder forward over the next 512 bits
+ * with two multiplies + XOR, instead of walking through them byte by
+ * byte. At the end a Barrett reduction shrinks 128 bits to 32.
+ * (Constants for the reflected 0x04C11DB7 polynomial, as in the Intel
+ * white paper "Fast CRC Computation Using PCLMULQDQ".)
+ */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc32_fold_pclmul(uint32_t crc, const uint8_t* data, size_t length)
+{
+    // Requires length >= 64 and a multiple of 16; 'crc' is the raw (inverted) state
+    static const uint64_t k1k2[2] = { 0x0154442bd4, 0x01c6e41596 };
+    static const uint64_t k3k4[2] = { 0x01751997d0, 0x00ccaa009e };
+    static const uint64_t k5k0[2] = { 0x0163cd6124, 0x0000000000 };
+    static const uint64_t poly[2] = { 0x01db710641, 0x01f7011641 };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128((const __m128i*)(data + 0x00));
+    x2 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+    x3 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+    x4 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    x0 = _mm_loadu_si128((const __m128i*)k1k2);
+    data += 64;
+    length -= 64;
+
+    // Fold 4 x 128 bits forward over each new 64-byte block
+    while (length >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(data + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(data + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(data + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(data + 0x30)));
+        data += 64;
+        length -= 64;
+    }
+
+    // Fold the 4 lanes into one 128-bit value
+    x0 = _mm_loadu_si128((const __m128i*)k3k4);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // Remaining 16-byte blocks
+    while (length >= 16) {
+        x2 = _mm_loadu_si128((const __m128i*)data);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        data += 16;
+        length -= 16;
+    }
+
+    // 128 -> 64 bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_loadl_epi64((const __m128i*)k5k0);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction 64 -> 32 bits
+    x0 = _mm_loadu_si128((const __m128i*)poly);
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+uint32_t crc32_pclmul(uint32_t crc, const uint8_t* data, size_t length)
+{
+    if (length < 64) return crc32_slice_by_8(crc, data, length);
+
+    size_t folded = length & ~(size_t)15;
+    crc = ~crc32_fold_pclmul(~crc, data, folded);
+    return crc32_slice_by_8(crc, data + folded, length - folded);   // 0..15 byte tail
+}
+#endif
+
+/*
+ * PART 6: Runtime selection
+ * The same program runs on any x86-64 CPU: we ask the CPU which
+ * instructions it has ONCE, then call through a function pointer.
+ */
+typedef uint32_t (*crc32_fn_t)(uint32_t crc, const uint8_t* data, size_t length);
+
+crc32_fn_t crc32_update = crc32_slice_by_8;     // Portable defaults
+crc32_fn_t crc32c_update = crc32c_slice_by_8;
+const char* crc32_impl_name = "slice-by-8";
+const char* crc32c_impl_name = "slice-by-8";
+
+void crc_engine_init(void)
+{
+    crc_tables_init();
+
+#if CRC_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) {
+        crc32_update = crc32_pclmul;
+        crc32_impl_name = "PCLMUL folding";
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        crc32c_update = crc32c_sse42;
+        crc32c_impl_name = "SSE4.2 crc32";
+    }
+#endif
+}
+
+/*
+ * DEMO 1: Check values - the standard "123456789" test
+ */
+void check_values_demo(void)
+{
+    printf("=== Check Values (\"123456789\") ===\n");
+
+    const uint8_t* check = (const uint8_t*)"123456789";
+    printf("CRC-8        bitwise 0x%02X  table 0x%02X        (expect 0xF4)\n",
+           crc8_bitwise(0, check, 9), crc8_table_driven(0, check, 9));
+    printf("CRC-16/CCITT bitwise 0x%04X  table 0x%04X    (expect 0x29B1)\n",
+           crc16_bitwise(0xFFFF, check, 9), crc16_table_driven(0xFFFF, check, 9));
+    printf("CRC-32       bitwise 0x%08X  runtime 0x%08X (expect 0xCBF43926)\n",
+           crc32_bitwise(0, check, 9), crc32_update(0, check, 9));
+    printf("CRC-32C      bitwise 0x%08X  runtime 0x%08X (expect 0xE3069283)\n\n",
+           crc32c_bitwise(0, check, 9), crc32c_update(0, check, 9));
+}
+
+/*
+ * DEMO 2: Cross-check every fast version against the bitwise definition
+ * Random lengths and misaligned start addresses hit all the tail paths.
+ */
+int cross_check_demo(void)
+{
+    printf("=== Cross-Check Against Bitwise ===\n");
+
+    uint8_t buffer[4096 + 16];
+    int failures = 0;
+    srand(1234);
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)rand();
+    }
+
+    for (int round = 0; round < 2000; round++) {
+        size_t offset = (size_t)(rand() % 16);
+        size_t length = (size_t)(round < 300 ? round : rand() % 4096);
+        const uint8_t* p = buffer + offset;
+        uint32_t seed = (uint32_t)rand();
+
+        uint32_t ref32 = crc32_bitwise(seed, p, length);
+        uint32_t ref32c = crc32c_bitwise(seed, p, length);
+        uint16_t ref16 = crc16_bitwise((uint16_t)seed, p, length);
+        uint8_t ref8 = crc8_bitwise((uint8_t)seed, p, length);
+
+        failures += crc32_table_driven(seed, p, length) != ref32;
+        failures += crc32_slice_by_8(seed, p, length) != ref32;
+        failures += crc32_update(seed, p, length) != ref32;
+        failures += crc32c_table_driven(seed, p, length) != ref32c;
+        failures += crc32c_slice_by_8(seed, p, length) != ref32c;
+        failures += crc32c_update(seed, p, length) != ref32c;
+        failures += crc16_table_driven((uint16_t)seed, p, length) != ref16;
+        failures += crc8_table_driven((uint8_t)seed, p, length) != ref8;
+    }
+
+    // Chaining: CRC of (A then B) == CRC of A continued over B
+    uint32_t whole = crc32_update(0, buffer, 3000);
+    uint32_t split = crc32_update(crc32_update(0, buffer, 1234), buffer + 1234, 3000 - 1234);
+    failures += whole != split;
+
+    printf("2000 random buffers x 8 implementations: %s (%d mismatches)\n\n",
+           failures ? "FAILED" : "all match", failures);
+    return failures;
+}
+
+/*
+ * DEMO 3: Benchmark GB/s per variant
+ */
+double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+typedef uint32_t (*crc_bench_fn_t)(uint32_t crc, const uint8_t* data, size_t length);
+
+// Small wrappers so CRC-8/16 fit the same benchmark loop
+static uint32_t bench_crc8_bitwise(uint32_t c, const uint8_t* d, size_t n) { return crc8_bitwise((uint8_t)c, d, n); }
+static uint32_t bench_crc8_table(uint32_t c, const uint8_t* d, size_t n) { return crc8_table_driven((uint8_t)c, d, n); }
+static uint32_t bench_crc16_bitwise(uint32_t c, const uint8_t* d, size_t n) { return crc16_bitwise((uint16_t)c, d, n); }
+static uint32_t bench_crc16_table(uint32_t c, const uint8_t* d, size_t n) { return crc16_table_driven((uint16_t)c, d, n); }
+
+void benchmark_variant(const char* name, crc_bench_fn_t fn, const uint8_t* data, size_t length)
+{
+    volatile uint32_t sink = 0;
+    uint32_t passes = 0;
+    double start = seconds_now();
+    double elapsed;
+
+    do {                                        // Run for at least 0.2 s
+        sink ^= fn(passes, data, length);
+        passes++;
+        elapsed = seconds_now() - start;
+    } while (elapsed < 0.2);
+
+    double gbps = (double)length * passes / elapsed / 1e9;
+    printf("  %-28s %8.3f GB/s\n", name, gbps);
+}
+
+void benchmark_demo(void)
+{
+    printf("=== Benchmark (1 MB buffer) ===\n");
+
+    const size_t length = 1 << 20;
+    uint8_t* data = malloc(length);
+    if (!data) return;
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)(i * 131 + (i >> 7));
+    }
+
+    benchmark_variant("CRC-8 bitwise", bench_crc8_bitwise, data, length);
+    benchmark_variant("CRC-8 table", bench_crc8_table, data, length);
+    benchmark_variant("CRC-16 bitwise", bench_crc16_bitwise, data, length);
+    benchmark_variant("CRC-16 table", bench_crc16_table, data, length);
+    benchmark_variant("CRC-32 bitwise", crc32_bitwise, data, length);
+    benchmark_variant("CRC-32 table", crc32_table_driven, data, length);
+    benchmark_variant("CRC-32 slice-by-8", crc32_slice_by_8, data, length);
+#if CRC_HAVE_X86
+    if (crc32_update == crc32_pclmul) benchmark_variant("CRC-32 PCLMUL folding", crc32_pclmul, data, length);
+#endif
+    benchmark_variant("CRC-32C bitwise", crc32c_bitwise, data, length);
+    benchmark_variant("CRC-32C table", crc32c_table_driven, data, length);
+    benchmark_variant("CRC-32C slice-by-8", crc32c_slice_by_8, data, length);
+#if CRC_HAVE_X86
+    if (crc32c_update == crc32c_sse42) benchmark_variant("CRC-32C SSE4.2", crc32c_sse42, data, length);
+#endif
+    printf("Runtime choice: CRC-32 = %s, CRC-32C = %s\n\n", crc32_impl_name, crc32c_impl_name);
+
+    free(data);
+}
+
+int main(void)
+{
+    printf("CRC Engine - Bitwise, Table, Slice-by-8 and Hardware CRCs\n");
+    printf("=========================================================\n\n");
+
+    crc_engine_init();
+
+    check_values_demo();
+    int failures = cross_check_demo();
+    benchmark_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. A CRC is a polynomial remainder - bitwise code shows the math\n");
+    printf("2. A 256-entry table replaces 8 shift/XOR steps with 1 lookup\n");
+    printf("3. Slice-by-8 uses 8 KB of tables to process 8 bytes per step\n");
+    printf("4. SSE4.2 has a CRC-32C instruction; PCLMUL folds 64 bytes per step\n");
+    printf("5. Check the CPU once at startup and call the best version\n");
+
+    return failures ? 1 : 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. CRCs detect all single-bit errors and all burst errors up to their width
+ * 2. Table-driven CRC is the sweet spot on microcontrollers (256-1024 bytes ROM)
+ * 3. Slice-by-8 trades 8 KB of tables for ~4x more speed on big CPUs
+ * 4. Hardware instructions are fastest but only for specific polynomials
+ * 5. Always check a new CRC against the "123456789" check value
+ * 6. Runtime dispatch keeps ONE binary working on old and new CPUs
+ *
+ * Next: Receiving whole buffers instead of one byte at a time!
+ */
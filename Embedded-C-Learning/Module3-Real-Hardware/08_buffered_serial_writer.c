@@ -0,0 +1,671 @@
+/*
+ * MODULE 3 - LESSON 8: Buffered Serial Output - One Write Per Record
+ *
+ * What you'll learn:
+ * - Why ten Serial.print() calls per line stall loop() at 115200 baud
+ * - How to build a whole record in a small stack buffer first
+ * - Fast integer and fixed-point to text conversion (no snprintf)
+ * - How a software TX queue + "pump" lets the UART drain in the
+ *   background while loop() keeps running
+ * - How to measure records/second and time blocked inside loop()
+ *
+ * Think of it like posting letters:
+ * - Serial.print() per field = walking to the post box for every word
+ * - A record buffer = write the whole letter, post it once
+ * - A TX queue = a mail tray; the postman (UART) empties it on his
+ *   own schedule and you only come back to refill it
+ * - If the tray is full you skip a letter and count it, instead of
+ *   standing at the post box waiting
+ *
+ * This program runs on Linux. A thread plays the ESP32 UART: a 128-byte
+ * TX FIFO that drains at 115200 baud. Like the Arduino core with its
+ * default settings, a write() that doesn't fit in the FIFO waits for room.
+ *   gcc -O2 -pthread -o serial_writer 08_buffered_serial_writer.c -lm && ./serial_writer
+ *
+ * The same record builder and TX queue are used in 02_uart_communication.c
+ * (logDataToSerial, sendPeriodicUpdates).
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// UART settings we are simulating
+#define UART_BAUD               115200
+#define UART_BITS_PER_BYTE      10          // 8N1
+#define UART_BYTES_PER_SEC      (UART_BAUD / UART_BITS_PER_BYTE)
+#define UART_FIFO_SIZE          128         // ESP32 hardware TX FIFO
+
+// Output path settings
+#define RECORD_MAX              128         // Longest single record (one line)
+#define TX_QUEUE_SIZE           1024        // Software TX queue in RAM
+#define TX_PUMP_MIN             32          // Wait for this much FIFO room before writing
+
+#define TEST_SECONDS            2           // How long each loop() scenario runs
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * PART 1: Record builder - text straight into a stack buffer
+ * Every append is bounds-checked; if the record doesn't fit it is marked
+ * truncated and the extra text is dropped (the line still ends in \r\n).
+ */
+typedef struct {
+    char     text[RECORD_MAX];
+    uint16_t length;
+    bool     truncated;
+} record_t;
+
+// "00" "01" ... "99": converting two digits per division halves the divides
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const uint32_t pow10_table[] = { 1, 10, 100, 1000, 10000 };
+#define RECORD_MAX_DECIMALS     4
+
+void rec_reset(record_t* r)
+{
+    r->length = 0;
+    r->truncated = false;
+}
+
+static void rec_append(record_t* r, const char* s, size_t n)
+{
+    size_t room = (RECORD_MAX - 2) - r->length;     // Always keep room for \r\n
+    if (n > room) {
+        n = room;
+        r->truncated = true;
+    }
+    memcpy(r->text + r->length, s, n);
+    r->length += (uint16_t)n;
+}
+
+void rec_text(record_t* r, const char* s)
+{
+    rec_append(r, s, strlen(s));
+}
+
+void rec_char(record_t* r, char c)
+{
+    rec_append(r, &c, 1);
+}
+
+// Writes the digits of v right-aligned so they END at 'end'; returns the start
+static char* u32_to_digits(uint32_t v, char* end)
+{
+    char* p = end;
+    while (v >= 100) {
+        uint32_t pair = (v % 100) * 2;
+        v /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (v >= 10) {
+        *--p = digit_pairs[v * 2 + 1];
+        *--p = digit_pairs[v * 2];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    return p;
+}
+
+void rec_u32(record_t* r, uint32_t v)
+{
+    char buf[10];
+    char* start = u32_to_digits(v, buf + sizeof(buf));
+    rec_append(r, start, (size_t)(buf + sizeof(buf) - start));
+}
+
+void rec_i32(record_t* r, int32_t v)
+{
+    if (v < 0) {
+        rec_char(r, '-');
+        rec_u32(r, 0u - (uint32_t)v);
+    } else {
+        rec_u32(r, (uint32_t)v);
+    }
+}
+
+// Fixed-point text like Serial.print(value, decimals): rounds half away from
+// zero, prints "nan", "inf" and "ovf" for values it can't show
+void rec_fixed(record_t* r, float value, uint8_t decimals)
+{
+    if (isnan(value)) { rec_text(r, "nan"); return; }
+    if (isinf(value)) { rec_text(r, "inf"); return; }
+    if (decimals > RECORD_MAX_DECIMALS) decimals = RECORD_MAX_DECIMALS;
+
+    // float * 10^4 is exact in a double, so the only rounding is ours
+    uint32_t scale = pow10_table[decimals];
+    double scaled = fabs((double)value) * scale + 0.5;
+    if (scaled >= 4294967295.0) { rec_text(r, "ovf"); return; }
+
+    uint32_t fixed = (uint32_t)scaled;
+    uint32_t whole = fixed / scale;
+    uint32_t fraction = fixed - whole * scale;
+
+    char buf[16];
+    char* end = buf + sizeof(buf);
+    char* p = end;
+    if (decimals > 0) {
+        char* frac_end = p;
+        p = u32_to_digits(fraction, p);
+        while (frac_end - p < decimals) *--p = '0';     // 0.05 -> "05"
+        *--p = '.';
+    }
+    p = u32_to_digits(whole, p);
+    if (value < 0 && fixed != 0) *--p = '-';            // No "-0.00"
+    rec_append(r, p, (size_t)(end - p));
+}
+
+void rec_end(record_t* r)
+{
+    r->text[r->length++] = '\r';
+    r->text[r->length++] = '\n';
+}
+
+/*
+ * PART 2: Simulated ESP32 UART transmitter
+ * A thread takes bytes out of the 128-byte FIFO at the baud rate.
+ * uart_write() copies what fits and WAITS for the rest - the same thing
+ * HardwareSerial::write() does when no TX ring buffer is configured.
+ */
+typedef struct {
+    uint8_t  fifo[UART_FIFO_SIZE];
+    size_t   head;              // Next byte to go out on the wire
+    size_t   count;
+    uint64_t bytes_sent;
+    uint64_t write_calls;
+    bool     running;
+    pthread_mutex_t lock;
+    pthread_cond_t  space;
+    pthread_t thread;
+} uart_tx_t;
+
+static void* uart_tx_thread(void* arg)
+{
+    uart_tx_t* u = (uart_tx_t*)arg;
+    const uint64_t ns_per_byte = 1000000000ull / UART_BYTES_PER_SEC;
+    uint64_t wire_time = now_ns();
+
+    pthread_mutex_lock(&u->lock);
+    while (u->running) {
+        pthread_mutex_unlock(&u->lock);
+        struct timespec step = { 0, 200000 };           // Look every 0.2 ms
+        nanosleep(&step, NULL);
+        pthread_mutex_lock(&u->lock);
+
+        // Shift out every byte whose wire time has passed
+        uint64_t now = now_ns();
+        if (u->count == 0) wire_time = now;             // Line idle: no credit builds up
+        while (u->count > 0 && wire_time + ns_per_byte <= now) {
+            u->head = (u->head + 1) % UART_FIFO_SIZE;
+            u->count--;
+            u->bytes_sent++;
+            wire_time += ns_per_byte;
+        }
+        pthread_cond_broadcast(&u->space);
+    }
+    pthread_mutex_unlock(&u->lock);
+    return NULL;
+}
+
+void uart_tx_start(uart_tx_t* u)
+{
+    memset(u, 0, sizeof(*u));
+    pthread_mutex_init(&u->lock, NULL);
+    pthread_cond_init(&u->space, NULL);
+    u->running = true;
+    pthread_create(&u->thread, NULL, uart_tx_thread, u);
+}
+
+void uart_tx_stop(uart_tx_t* u)
+{
+    pthread_mutex_lock(&u->lock);
+    u->running = false;
+    pthread_mutex_unlock(&u->lock);
+    pthread_join(u->thread, NULL);
+    pthread_mutex_destroy(&u->lock);
+    pthread_cond_destroy(&u->space);
+}
+
+// Serial.write(): blocks until every byte is in the FIFO
+void uart_write(uart_tx_t* u, const void* data, size_t n)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    pthread_mutex_lock(&u->lock);
+    u->write_calls++;
+    while (n > 0) {
+        while (u->count == UART_FIFO_SIZE) pthread_cond_wait(&u->space, &u->lock);
+        size_t tail = (u->head + u->count) % UART_FIFO_SIZE;
+        u->fifo[tail] = *bytes++;
+        u->count++;
+        n--;
+    }
+    pthread_mutex_unlock(&u->lock);
+}
+
+// Serial.availableForWrite(): bytes that fit without waiting
+size_t uart_available_for_write(uart_tx_t* u)
+{
+    pthread_mutex_lock(&u->lock);
+    size_t room = UART_FIFO_SIZE - u->count;
+    pthread_mutex_unlock(&u->lock);
+    return room;
+}
+
+// The naive way: Serial.print() for every field
+void uart_print(uart_tx_t* u, const char* s) { uart_write(u, s, strlen(s)); }
+
+void uart_print_u32(uart_tx_t* u, uint32_t v)
+{
+    char buf[12];
+    int n = snprintf(buf, sizeof(buf), "%u", (unsigned)v);
+    uart_write(u, buf, (size_t)n);
+}
+
+void uart_print_float(uart_tx_t* u, float v, int decimals)
+{
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%.*f", decimals, (double)v);
+    uart_write(u, buf, (size_t)n);
+}
+
+/*
+ * PART 3: Software TX queue - whole records in, UART drains in the background
+ * Records are queued all-or-nothing, so a full queue drops a whole line
+ * (and counts it) instead of sending half a line.
+ */
+typedef struct {
+    uint8_t  data[TX_QUEUE_SIZE];
+    size_t   head;              // Oldest queued byte
+    size_t   count;
+    uint32_t records;
+    uint32_t dropped;
+    size_t   high_water;        // Deepest the queue has been
+} tx_queue_t;
+
+bool tx_queue_record(tx_queue_t* q, const record_t* r)
+{
+    if (r->length > TX_QUEUE_SIZE - q->count) {
+        q->dropped++;
+        return false;
+    }
+    size_t tail = (q->head + q->count) % TX_QUEUE_SIZE;
+    size_t first = TX_QUEUE_SIZE - tail;
+    if (first > r->length) first = r->length;
+    memcpy(q->data + tail, r->text, first);
+    memcpy(q->data, r->text + first, r->length - first);   // Wrapped part (often 0 bytes)
+    q->count += r->length;
+    q->records++;
+    if (q->count > q->high_water) q->high_water = q->count;
+    return true;
+}
+
+// Call once per loop(): hands the UART only what fits in its FIFO right now,
+// so it never blocks. Small gaps in the FIFO are left alone until at least
+// TX_PUMP_MIN bytes are free, so the queue goes out in a few big writes.
+size_t tx_queue_pump(tx_queue_t* q, uart_tx_t* u)
+{
+    size_t moved = 0;
+    while (q->count > 0) {
+        size_t room = uart_available_for_write(u);
+        if (room == 0 || (room < TX_PUMP_MIN && room < q->count)) break;
+        size_t n = TX_QUEUE_SIZE - q->head;             // Up to the end of the array
+        if (n > q->count) n = q->count;
+        if (n > room) n = room;
+        uart_write(u, q->data + q->head, n);
+        q->head = (q->head + n) % TX_QUEUE_SIZE;
+        q->count -= n;
+        moved += n;
+    }
+    return moved;
+}
+
+/*
+ * PART 4: The records from 02_uart_communication.c, both ways
+ */
+typedef struct {
+    uint32_t uptime_ms;
+    float    temperature;
+    float    humidity;
+    uint32_t frames_ok, crc_errors, framing_errors;
+    uint32_t gps_buffers, sensor_buffers;
+} report_data_t;
+
+// logDataToSerial(), the original way: 6 print calls per line
+void log_line_prints(uart_tx_t* u, const report_data_t* d)
+{
+    uart_print_u32(u, d->uptime_ms);
+    uart_print(u, ",");
+    uart_print_float(u, d->temperature, 2);
+    uart_print(u, ",");
+    uart_print_float(u, d->humidity, 2);
+    uart_print(u, "\r\n");
+}
+
+void log_line_record(record_t* r, const report_data_t* d)
+{
+    rec_reset(r);
+    rec_u32(r, d->uptime_ms);
+    rec_char(r, ',');
+    rec_fixed(r, d->temperature, 2);
+    rec_char(r, ',');
+    rec_fixed(r, d->humidity, 2);
+    rec_end(r);
+}
+
+// sendPeriodicUpdates(), the original way: 17 print calls, ~200 bytes
+void status_prints(uart_tx_t* u, const report_data_t* d)
+{
+    uart_print(u, "=== Periodic Status Update ===\r\n");
+    uart_print(u, "System uptime: ");
+    uart_print_u32(u, d->uptime_ms / 1000);
+    uart_print(u, " seconds\r\n");
+    uart_print(u, "Sensor frames: ");
+    uart_print_u32(u, d->frames_ok);
+    uart_print(u, " ok, ");
+    uart_print_u32(u, d->crc_errors);
+    uart_print(u, " CRC errors, ");
+    uart_print_u32(u, d->framing_errors);
+    uart_print(u, " framing errors\r\n");
+    uart_print(u, "RX buffers (GPS/sensor): ");
+    uart_print_u32(u, d->gps_buffers);
+    uart_print(u, "/");
+    uart_print_u32(u, d->sensor_buffers);
+    uart_print(u, "\r\n");
+    uart_print(u, "Status update complete.\r\n\r\n");
+}
+
+// Same text as status_prints(), queued as one record per line
+void status_records(tx_queue_t* q, const report_data_t* d)
+{
+    record_t r;
+
+    rec_reset(&r);
+    rec_text(&r, "=== Periodic Status Update ===");
+    rec_end(&r);
+    rec_text(&r, "System uptime: ");
+    rec_u32(&r, d->uptime_ms / 1000);
+    rec_text(&r, " seconds");
+    rec_end(&r);
+    tx_queue_record(q, &r);
+
+    rec_reset(&r);
+    rec_text(&r, "Sensor frames: ");
+    rec_u32(&r, d->frames_ok);
+    rec_text(&r, " ok, ");
+    rec_u32(&r, d->crc_errors);
+    rec_text(&r, " CRC errors, ");
+    rec_u32(&r, d->framing_errors);
+    rec_text(&r, " framing errors");
+    rec_end(&r);
+    tx_queue_record(q, &r);
+
+    rec_reset(&r);
+    rec_text(&r, "RX buffers (GPS/sensor): ");
+    rec_u32(&r, d->gps_buffers);
+    rec_char(&r, '/');
+    rec_u32(&r, d->sensor_buffers);
+    rec_end(&r);
+    rec_text(&r, "Status update complete.");
+    rec_end(&r);
+    rec_end(&r);
+    tx_queue_record(q, &r);
+}
+
+void make_report(report_data_t* d, uint32_t n)
+{
+    d->uptime_ms = 1000 + n * 10;
+    d->temperature = 25.0f + (float)((int)(n % 100) - 50) / 10.0f;
+    d->humidity = 60.0f + (float)((int)(n % 400) - 200) / 10.0f;
+    d->frames_ok = n * 3;
+    d->crc_errors = n / 97;
+    d->framing_errors = n / 331;
+    d->gps_buffers = n * 2 + 1;
+    d->sensor_buffers = n + 7;
+}
+
+/*
+ * DEMO 1: The record builder prints exactly what printf would
+ */
+void formatting_demo(void)
+{
+    printf("=== DEMO 1: Record builder vs snprintf ===\n");
+
+    // Integers: every boundary where the digit count changes, plus random values
+    uint32_t int_errors = 0;
+    for (uint64_t v = 1; v <= UINT32_MAX; v *= 10) {
+        uint32_t tests[3] = { (uint32_t)v - 1, (uint32_t)v, (uint32_t)v + 1 };
+        for (int i = 0; i < 3; i++) {
+            record_t r;
+            char ref[32];
+            rec_reset(&r);
+            rec_i32(&r, -(int32_t)(tests[i] & 0x7FFFFFFF));
+            rec_u32(&r, tests[i]);
+            r.text[r.length] = '\0';
+            snprintf(ref, sizeof(ref), "%d", -(int32_t)(tests[i] & 0x7FFFFFFF));
+            snprintf(ref + strlen(ref), sizeof(ref) - strlen(ref), "%u", (unsigned)tests[i]);
+            if (strcmp(r.text, ref) != 0) int_errors++;
+        }
+    }
+    srand(1);
+    for (int i = 0; i < 1000000; i++) {
+        uint32_t v = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+        record_t r;
+        char ref[16];
+        rec_reset(&r);
+        rec_u32(&r, v);
+        r.text[r.length] = '\0';
+        snprintf(ref, sizeof(ref), "%u", (unsigned)v);
+        if (strcmp(r.text, ref) != 0) int_errors++;
+    }
+    printf("Integers: %u mismatches (digit-count edges + 1,000,000 random)\n", (unsigned)int_errors);
+
+    // Fixed point: printf rounds exact ties (x.xx5) to even, Serial.print and
+    // rec_fixed round them away from zero - count those separately
+    uint32_t float_errors = 0, ties = 0;
+    for (int i = 0; i < 1000000; i++) {
+        float v = ((float)rand() / (float)RAND_MAX - 0.5f) * 20000.0f;
+        int decimals = i % 4;
+        record_t r;
+        char ref[48];
+        rec_reset(&r);
+        rec_fixed(&r, v, (uint8_t)decimals);
+        r.text[r.length] = '\0';
+        snprintf(ref, sizeof(ref), "%.*f", decimals, (double)v);
+        if (strcmp(ref, "-0") == 0 || strncmp(ref, "-0.", 3) == 0) {
+            if (strspn(ref + 1, "0.") == strlen(ref + 1)) memmove(ref, ref + 1, strlen(ref));
+        }
+        if (strcmp(r.text, ref) != 0) {
+            double scaled = fabs((double)v) * pow10_table[decimals];
+            if (scaled - floor(scaled) == 0.5) ties++;
+            else float_errors++;
+        }
+    }
+    printf("Floats:   %u mismatches, %u exact ties rounded away from zero (1,000,000 random)\n",
+           (unsigned)float_errors, (unsigned)ties);
+
+    // Speed: one logDataToSerial() line built with snprintf vs the record builder
+    report_data_t d;
+    const int rounds = 2000000;
+    volatile uint32_t sink = 0;
+    char line[RECORD_MAX];
+
+    uint64_t start = now_ns();
+    for (int i = 0; i < rounds; i++) {
+        make_report(&d, (uint32_t)i);
+        sink += (uint32_t)snprintf(line, sizeof(line), "%u,%.2f,%.2f\r\n",
+                                   (unsigned)d.uptime_ms, (double)d.temperature, (double)d.humidity);
+    }
+    uint64_t snprintf_ns = now_ns() - start;
+
+    start = now_ns();
+    for (int i = 0; i < rounds; i++) {
+        record_t r;
+        make_report(&d, (uint32_t)i);
+        log_line_record(&r, &d);
+        sink += r.length;
+    }
+    uint64_t record_ns = now_ns() - start;
+
+    printf("Format one CSV line: snprintf %.0f ns, record builder %.0f ns (%.1fx faster)\n\n",
+           (double)snprintf_ns / rounds, (double)record_ns / rounds,
+           (double)snprintf_ns / (double)(record_ns ? record_ns : 1));
+    (void)sink;
+}
+
+/*
+ * DEMO 2: loop() with logging - print chains vs queued records
+ * Each loop() pass does ~50 us of "real work". A CSV line is logged
+ * every 'log_interval_us' and a status block every 500 ms. We measure
+ * how long loop() is stuck inside the UART and how many records got out.
+ */
+typedef struct {
+    uint64_t loops;
+    uint64_t records;           // Records handed to the output path
+    uint32_t dropped;           // Records the TX queue had no room for
+    uint64_t blocked_ns;        // Time spent inside write/pump calls
+    uint64_t worst_loop_ns;     // Longest single loop() pass
+    uint64_t bytes_on_wire;
+    uint64_t write_calls;
+    size_t   queue_high_water;
+} loop_result_t;
+
+static void busy_work(uint64_t ns)
+{
+    uint64_t until = now_ns() + ns;
+    while (now_ns() < until) { }
+}
+
+loop_result_t run_loop(bool queued, uint32_t log_interval_us)
+{
+    uart_tx_t uart;
+    tx_queue_t queue;
+    loop_result_t res = {0};
+    memset(&queue, 0, sizeof(queue));
+    uart_tx_start(&uart);
+
+    uint64_t start = now_ns();
+    uint64_t end = start + (uint64_t)TEST_SECONDS * 1000000000ull;
+    uint64_t next_log = start, next_status = start;
+    uint32_t n = 0;
+
+    while (now_ns() < end) {
+        uint64_t loop_start = now_ns();
+        busy_work(50000);
+
+        uint64_t t0 = now_ns();
+        report_data_t d;
+        if (loop_start >= next_log) {
+            make_report(&d, n++);
+            if (queued) {
+                record_t r;
+                log_line_record(&r, &d);
+                tx_queue_record(&queue, &r);
+            } else {
+                log_line_prints(&uart, &d);
+            }
+            res.records++;
+            next_log += (uint64_t)log_interval_us * 1000u;
+            if (next_log < loop_start) next_log = loop_start;     // Don't try to catch up
+        }
+        if (loop_start >= next_status) {
+            make_report(&d, n);
+            if (queued) status_records(&queue, &d);
+            else status_prints(&uart, &d);
+            res.records += 3;
+            next_status += 500000000ull;
+        }
+        if (queued) tx_queue_pump(&queue, &uart);
+        uint64_t t1 = now_ns();
+
+        res.blocked_ns += t1 - t0;
+        if (t1 - loop_start > res.worst_loop_ns) res.worst_loop_ns = t1 - loop_start;
+        res.loops++;
+    }
+
+    uart_tx_stop(&uart);
+    res.dropped = queue.dropped;
+    res.records -= queue.dropped;
+    res.bytes_on_wire = uart.bytes_sent;
+    res.write_calls = uart.write_calls;
+    res.queue_high_water = queue.high_water;
+    return res;
+}
+
+void print_loop_result(const char* name, loop_result_t r)
+{
+    double seconds = TEST_SECONDS;
+    printf("  %-16s %7.0f records/s  blocked %5.1f%%  worst loop %6.2f ms  "
+           "%6.0f loops/s  %6.0f writes/s  dropped %u\n",
+           name, r.records / seconds,
+           100.0 * (double)r.blocked_ns / (seconds * 1e9),
+           (double)r.worst_loop_ns / 1e6, r.loops / seconds,
+           r.write_calls / seconds, (unsigned)r.dropped);
+}
+
+void loop_demo(void)
+{
+    printf("=== DEMO 2: loop() logging at %d baud (wire: %d bytes/s) ===\n",
+           UART_BAUD, UART_BYTES_PER_SEC);
+
+    printf("Normal load: one CSV line every 10 ms + status block every 500 ms\n");
+    loop_result_t prints = run_loop(false, 10000);
+    loop_result_t records = run_loop(true, 10000);
+    print_loop_result("Serial.print x N", prints);
+    print_loop_result("queued records", records);
+    printf("  TX queue high-water mark: %zu of %d bytes\n\n", records.queue_high_water, TX_QUEUE_SIZE);
+
+    printf("Overload: one CSV line every 1 ms (about 2x what the wire can carry)\n");
+    prints = run_loop(false, 1000);
+    records = run_loop(true, 1000);
+    print_loop_result("Serial.print x N", prints);
+    print_loop_result("queued records", records);
+    printf("  Print chains slow loop() down to the wire speed; the queue keeps\n");
+    printf("  loop() running and drops whole lines (counted) instead\n\n");
+}
+
+int main(void)
+{
+    printf("Buffered Serial Output - Records, TX Queue, Background Drain\n");
+    printf("============================================================\n\n");
+
+    formatting_demo();
+    loop_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. Each Serial.print() is a call into the UART driver - fields add up\n");
+    printf("2. Build the line in a buffer, then send it with ONE write\n");
+    printf("3. Two digits per division makes integer printing cheap\n");
+    printf("4. A TX queue + availableForWrite() means loop() never waits for the wire\n");
+    printf("5. When output is faster than the baud rate, something must give -\n");
+    printf("   drop whole records and count them, don't stall the control loop\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. At 115200 baud the UART sends ~11.5 bytes per millisecond
+ * 2. The TX FIFO is only 128 bytes - a 200-byte status block blocks loop()
+ * 3. Format into a stack buffer; the snprintf engine is big and slow
+ * 4. Queue whole records, pump with availableForWrite() - no blocking
+ * 5. Measure blocked time and worst-case loop time, not just "it prints"
+ *
+ * Next: Parsing numbers just as fast as we print them!
+ */
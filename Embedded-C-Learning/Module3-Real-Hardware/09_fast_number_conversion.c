@@ -0,0 +1,1101 @@
+/*
+ * MODULE 3 - LESSON 9: Fast Number Conversion - Text <-> Numbers Without libc
+ *
+ * What you'll learn:
+ * - Why atof(), String::toFloat() and String(float) are slow (and big)
+ * - Integer printing two digits at a time
+ * - Fixed-decimal printing for sensor values ("23.45")
+ * - Shortest float printing (the Ryu algorithm): the fewest digits that
+ *   still read back as EXACTLY the same float
+ * - SWAR parsing: checking and converting 8 digits with a few 64-bit
+ *   operations instead of a loop
+ * - How to PROVE the routines are right: exhaustive tests against libc
+ *
+ * Think of it like a cashier counting money:
+ * - The slow way: count every coin one by one (one digit per loop)
+ * - The fast way: count stacks of 8 coins at once (SWAR)
+ * - Shortest printing = giving change with the fewest coins that still
+ *   adds up to exactly the right amount
+ *
+ * SWAR = "SIMD Within A Register": treat one 64-bit number as 8 bytes
+ * and work on all 8 at once with normal +, *, &, >> operations.
+ *
+ * This program runs on Linux (and the routines themselves are plain C99
+ * with 32/64-bit integers, so they also build for the ESP32):
+ *   gcc -O2 -o fastnum 09_fast_number_conversion.c -lm && ./fastnum
+ *   ./fastnum --exhaustive    # every one of the 2^32 floats (~30 minutes)
+ *
+ * The sketches use the pieces they need: parseGPSData() in
+ * Module4 03_uart_gps_advanced.c, createWebPage() in 04_wifi_bluetooth.c.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <float.h>
+#include <time.h>
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * PART 1: Integer formatting - two digits per division
+ * Each function writes into 'out' (no terminator) and returns the length.
+ */
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const uint32_t pow10_u32[10] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// How many decimal digits v has (1 for 0)
+static int decimal_length(uint32_t v)
+{
+    int n = 1;
+    while (n < 10 && v >= pow10_u32[n]) n++;
+    return n;
+}
+
+// Writes exactly 'n' digits of v, right-aligned, ending at out + n
+static void write_digits(char* out, uint32_t v, int n)
+{
+    char* p = out + n;
+    while (n >= 2) {
+        uint32_t pair = (v % 100) * 2;
+        v /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+        n -= 2;
+    }
+    if (n) *--p = (char)('0' + v % 10);
+}
+
+size_t format_u32(char* out, uint32_t v)
+{
+    int n = decimal_length(v);
+    write_digits(out, v, n);
+    return (size_t)n;
+}
+
+size_t format_i32(char* out, int32_t v)
+{
+    if (v < 0) {
+        out[0] = '-';
+        return 1 + format_u32(out + 1, 0u - (uint32_t)v);
+    }
+    return format_u32(out, (uint32_t)v);
+}
+
+/*
+ * PART 2: Fixed-decimal formatting for sensor values
+ * format_fixed_i32(2345, 2) -> "23.45": the value is ALREADY scaled (like
+ * the centi-degrees in our binary frames), so no float math at all.
+ * format_fixed_float() scales a float the same way Serial.print(v, d) does:
+ * round half away from zero, "nan"/"inf"/"ovf" for values it can't show.
+ */
+#define FIXED_MAX_DECIMALS  9
+
+size_t format_fixed_i32(char* out, int32_t scaled, int decimals)
+{
+    size_t n = 0;
+    uint32_t v = (uint32_t)scaled;
+    if (scaled < 0) {
+        out[n++] = '-';
+        v = 0u - v;
+    }
+    if (decimals <= 0) return n + format_u32(out + n, v);
+    if (decimals > FIXED_MAX_DECIMALS) decimals = FIXED_MAX_DECIMALS;
+
+    uint32_t whole = v / pow10_u32[decimals];
+    uint32_t fraction = v - whole * pow10_u32[decimals];
+    n += format_u32(out + n, whole);
+    out[n++] = '.';
+    write_digits(out + n, fraction, decimals);      // Keeps leading zeros: "05"
+    return n + (size_t)decimals;
+}
+
+size_t format_fixed_float(char* out, float value, int decimals)
+{
+    if (isnan(value)) { memcpy(out, "nan", 3); return 3; }
+    if (isinf(value)) { memcpy(out, "inf", 3); return 3; }
+    if (decimals < 0) decimals = 0;
+    if (decimals > 4) decimals = 4;
+
+    // float * 10^4 is exact in a double, so the + 0.5 is the only rounding
+    double scaled = fabs((double)value) * pow10_u32[decimals] + 0.5;
+    if (scaled >= 4294967295.0) { memcpy(out, "ovf", 3); return 3; }
+    uint32_t fixed = (uint32_t)scaled;
+
+    size_t n = 0;
+    if (value < 0 && fixed != 0) out[n++] = '-';    // No "-0.00"
+    uint32_t whole = fixed / pow10_u32[decimals];
+    n += format_u32(out + n, whole);
+    if (decimals > 0) {
+        out[n++] = '.';
+        write_digits(out + n, fixed - whole * pow10_u32[decimals], decimals);
+        n += (size_t)decimals;
+    }
+    return n;
+}
+
+/*
+ * PART 3: Shortest float printing (Ryu, by Ulf Adams, 2018)
+ *
+ * Every float is the middle of a small interval: any decimal number
+ * inside that interval reads back as the same float. Ryu finds the
+ * decimal with the FEWEST digits inside the interval, using only integer
+ * math: the interval ends are multiplied by a power of 5 (from a table)
+ * and shifted, then digits are removed while both ends still differ.
+ *
+ * The two power-of-5 tables are computed once at startup (like the CRC
+ * table in 06_crc_engine.c) with a tiny big-number routine. On a
+ * microcontroller you'd paste the 79 numbers in as constants.
+ */
+#define FLOAT_MANTISSA_BITS     23
+#define FLOAT_EXPONENT_BITS     8
+#define FLOAT_BIAS              127
+#define POW5_INV_BITCOUNT       59
+#define POW5_BITCOUNT           61
+#define POW5_INV_TABLE_SIZE     31
+#define POW5_TABLE_SIZE         48
+
+static uint64_t pow5_inv_split[POW5_INV_TABLE_SIZE];   // ~2^k / 5^i, rounded up
+static uint64_t pow5_split[POW5_TABLE_SIZE];           // 5^i, top 61 bits
+
+// Bit length of 5^e (e >= 0); log10 helpers - exact for the ranges we use
+static int32_t pow5bits(int32_t e)   { return (int32_t)(((uint32_t)e * 1217359u) >> 19) + 1; }
+static uint32_t log10_pow2(int32_t e) { return ((uint32_t)e * 78913u) >> 18; }
+static uint32_t log10_pow5(int32_t e) { return ((uint32_t)e * 732923u) >> 20; }
+
+// Big numbers for the table setup: 6 x 32-bit limbs, least significant first
+#define BIG_LIMBS 6
+typedef struct { uint32_t limb[BIG_LIMBS]; } big_t;
+
+static void big_mul_small(big_t* a, uint32_t m)
+{
+    uint64_t carry = 0;
+    for (int i = 0; i < BIG_LIMBS; i++) {
+        uint64_t t = (uint64_t)a->limb[i] * m + carry;
+        a->limb[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+}
+
+static int big_bit(const big_t* a, int bit) { return (a->limb[bit / 32] >> (bit % 32)) & 1; }
+
+static int big_cmp(const big_t* a, const big_t* b)
+{
+    for (int i = BIG_LIMBS - 1; i >= 0; i--) {
+        if (a->limb[i] != b->limb[i]) return a->limb[i] < b->limb[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+static void big_sub(big_t* a, const big_t* b)
+{
+    uint64_t borrow = 0;
+    for (int i = 0; i < BIG_LIMBS; i++) {
+        uint64_t t = (uint64_t)a->limb[i] - b->limb[i] - borrow;
+        a->limb[i] = (uint32_t)t;
+        borrow = (t >> 63) & 1;
+    }
+}
+
+static void big_shl1(big_t* a, int in_bit)
+{
+    for (int i = BIG_LIMBS - 1; i > 0; i--) a->limb[i] = (a->limb[i] << 1) | (a->limb[i - 1] >> 31);
+    a->limb[0] = (a->limb[0] << 1) | (uint32_t)in_bit;
+}
+
+// Bits [from, from + 64) of a
+static uint64_t big_bits64(const big_t* a, int from)
+{
+    uint64_t v = 0;
+    for (int i = 63; i >= 0; i--) {
+        int bit = from + i;
+        v = (v << 1) | (uint64_t)(bit >= 0 && bit < 32 * BIG_LIMBS ? big_bit(a, bit) : 0);
+    }
+    return v;
+}
+
+void ryu_tables_init(void)
+{
+    big_t pow5 = { { 1 } };
+    for (int i = 0; i < POW5_TABLE_SIZE; i++) {
+        // 5^i normalized to exactly POW5_BITCOUNT bits
+        pow5_split[i] = big_bits64(&pow5, pow5bits(i) - POW5_BITCOUNT);
+
+        if (i < POW5_INV_TABLE_SIZE) {
+            // floor(2^(pow5bits(i) - 1 + 59) / 5^i) + 1, by binary long division
+            int top = pow5bits(i) - 1 + POW5_INV_BITCOUNT;
+            big_t rem = { { 0 } };
+            uint64_t quotient = 0;
+            for (int bit = top; bit >= 0; bit--) {
+                big_shl1(&rem, bit == top);
+                quotient <<= 1;
+                if (big_cmp(&rem, &pow5) >= 0) {
+                    big_sub(&rem, &pow5);
+                    quotient |= 1;
+                }
+            }
+            pow5_inv_split[i] = quotient + 1;
+        }
+        big_mul_small(&pow5, 5);
+    }
+}
+
+// (m * factor) >> shift, with shift > 32, using only 32x32->64 multiplies
+static uint32_t mul_shift32(uint32_t m, uint64_t factor, int32_t shift)
+{
+    uint64_t bits0 = (uint64_t)m * (uint32_t)factor;
+    uint64_t bits1 = (uint64_t)m * (uint32_t)(factor >> 32);
+    uint64_t sum = (bits0 >> 32) + bits1;
+    return (uint32_t)(sum >> (shift - 32));
+}
+
+static uint32_t pow5_factor(uint32_t v)
+{
+    uint32_t count = 0;
+    while (v % 5 == 0) {
+        v /= 5;
+        count++;
+    }
+    return count;
+}
+
+static bool multiple_of_pow5(uint32_t v, uint32_t p) { return pow5_factor(v) >= p; }
+static bool multiple_of_pow2(uint32_t v, uint32_t p) { return (v & ((1u << p) - 1)) == 0; }
+
+typedef struct {
+    uint32_t mantissa;      // Decimal digits, e.g. 12345
+    int32_t  exponent;      // Power of ten: 12345e-3 = 12.345
+} decimal_t;
+
+// The core of Ryu: shortest decimal for a finite, non-zero float
+static decimal_t float_to_decimal(uint32_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    int32_t e2;
+    uint32_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;      // Subnormal
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int32_t)ieee_exponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = (1u << FLOAT_MANTISSA_BITS) | ieee_mantissa;
+    }
+    const bool even = (m2 & 1) == 0;
+    const bool accept_bounds = even;                        // Ties read back as even
+
+    // The interval [mm, mp] around mv = 4 * m2 (times 2^e2)
+    const uint32_t mv = 4 * m2;
+    const uint32_t mp = 4 * m2 + 2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    const uint32_t mm = 4 * m2 - 1 - mm_shift;              // Closer below a power of 2
+
+    // Convert all three to decimal: vr/vp/vm = mv/mp/mm * 2^e2 / 10^e10
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vm_trailing_zeros = false, vr_trailing_zeros = false;
+    uint8_t last_removed_digit = 0;
+    if (e2 >= 0) {
+        const uint32_t q = log10_pow2(e2);
+        e10 = (int32_t)q;
+        const int32_t k = POW5_INV_BITCOUNT + pow5bits((int32_t)q) - 1;
+        const int32_t i = -e2 + (int32_t)q + k;
+        vr = mul_shift32(mv, pow5_inv_split[q], i);
+        vp = mul_shift32(mp, pow5_inv_split[q], i);
+        vm = mul_shift32(mm, pow5_inv_split[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            // We'll remove at least one digit: remember it for rounding
+            const int32_t l = POW5_INV_BITCOUNT + pow5bits((int32_t)(q - 1)) - 1;
+            last_removed_digit = (uint8_t)(mul_shift32(mv, pow5_inv_split[q - 1], -e2 + (int32_t)q - 1 + l) % 10);
+        }
+        if (q <= 9) {
+            // Only here can the exact result end in zeros
+            if (mv % 5 == 0) vr_trailing_zeros = multiple_of_pow5(mv, q);
+            else if (accept_bounds) vm_trailing_zeros = multiple_of_pow5(mm, q);
+            else vp -= multiple_of_pow5(mp, q);
+        }
+    } else {
+        const uint32_t q = log10_pow5(-e2);
+        e10 = (int32_t)q + e2;
+        const int32_t i = -e2 - (int32_t)q;
+        const int32_t k = pow5bits(i) - POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = mul_shift32(mv, pow5_split[i], j);
+        vp = mul_shift32(mp, pow5_split[i], j);
+        vm = mul_shift32(mm, pow5_split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - (pow5bits(i + 1) - POW5_BITCOUNT);
+            last_removed_digit = (uint8_t)(mul_shift32(mv, pow5_split[i + 1], j) % 10);
+        }
+        if (q <= 1) {
+            vr_trailing_zeros = true;
+            if (accept_bounds) vm_trailing_zeros = mm_shift == 1;
+            else --vp;
+        } else if (q < 31) {
+            vr_trailing_zeros = multiple_of_pow2(mv, q - 1);
+        }
+    }
+
+    // Remove digits while the interval ends still differ
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        // Rare path: exact zeros decide how to round
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = (uint8_t)(vr % 10);
+            vr /= 10; vp /= 10; vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = (uint8_t)(vr % 10);
+                vr /= 10; vp /= 10; vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+            last_removed_digit = 4;                         // Exactly halfway: round to even
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed_digit >= 5);
+    } else {
+        // Common path
+        while (vp / 10 > vm / 10) {
+            last_removed_digit = (uint8_t)(vr % 10);
+            vr /= 10; vp /= 10; vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || last_removed_digit >= 5);
+    }
+
+    decimal_t d = { output, e10 + removed };
+    return d;
+}
+
+/*
+ * Shortest text for any float, always readable by strtof()/parse_float():
+ *   12.5, 0.001, 100000000, 1e+10, 1.5e-07, -0, inf, nan
+ * Plain notation when the decimal point is at most 5 places left of the
+ * first digit or 9 right of it, otherwise scientific. At most 15 chars.
+ */
+#define FORMAT_SHORTEST_MAX 16
+
+size_t format_float_shortest(char* out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const bool sign = (bits >> 31) != 0;
+    const uint32_t ieee_mantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    const uint32_t ieee_exponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+
+    size_t n = 0;
+    if (ieee_exponent == 0xFF) {
+        if (ieee_mantissa) { memcpy(out, "nan", 3); return 3; }
+        if (sign) out[n++] = '-';
+        memcpy(out + n, "inf", 3);
+        return n + 3;
+    }
+    if (sign) out[n++] = '-';
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        out[n++] = '0';
+        return n;
+    }
+
+    decimal_t d = float_to_decimal(ieee_mantissa, ieee_exponent);
+    const int olength = decimal_length(d.mantissa);
+    const int sci = d.exponent + olength - 1;               // Exponent in d.ddd x 10^sci
+
+    if (sci >= -5 && sci < 9) {
+        if (d.exponent >= 0) {                              // 1200 = 12e2
+            write_digits(out + n, d.mantissa, olength);
+            n += (size_t)olength;
+            for (int i = 0; i < d.exponent; i++) out[n++] = '0';
+        } else if (sci >= 0) {                              // 12.34 = 1234e-2
+            uint32_t scale = pow10_u32[-d.exponent];
+            uint32_t whole = d.mantissa / scale;
+            n += format_u32(out + n, whole);
+            out[n++] = '.';
+            write_digits(out + n, d.mantissa - whole * scale, -d.exponent);
+            n += (size_t)(-d.exponent);
+        } else {                                            // 0.00123 = 123e-5
+            out[n++] = '0';
+            out[n++] = '.';
+            for (int i = -1; i > sci; i--) out[n++] = '0';
+            write_digits(out + n, d.mantissa, olength);
+            n += (size_t)olength;
+        }
+        return n;
+    }
+
+    // Scientific: d[.ddd]e+XX
+    char digits[10];
+    write_digits(digits, d.mantissa, olength);
+    out[n++] = digits[0];
+    if (olength > 1) {
+        out[n++] = '.';
+        memcpy(out + n, digits + 1, (size_t)olength - 1);
+        n += (size_t)olength - 1;
+    }
+    out[n++] = 'e';
+    out[n++] = sci < 0 ? '-' : '+';
+    int e = sci < 0 ? -sci : sci;
+    out[n++] = digit_pairs[e * 2];
+    out[n++] = digit_pairs[e * 2 + 1];
+    return n;
+}
+
+/*
+ * PART 4: SWAR decimal parsing
+ * Load 8 characters into one uint64_t (little-endian: first char in the
+ * LOW byte, like the ESP32 and x86). Then:
+ * - A byte is a digit if its high nibble is 3 AND adding 6 keeps it 3
+ *   ('0'..'9' = 0x30..0x39, 0x39 + 6 = 0x3F, but ':' + 6 = 0x40)
+ * - Three multiply-and-shift steps turn 8 digits into a number:
+ *   pairs (x10), then quads (x100), then all eight (x10000)
+ */
+static const uint64_t pow10_u64[9] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+};
+
+static uint64_t load8(const char* p, const char* end)
+{
+    uint64_t v = 0;
+    size_t avail = (size_t)(end - p);
+    memcpy(&v, p, avail < 8 ? avail : 8);   // Bytes past the end read as 0 (not a digit)
+    return v;
+}
+
+// How many of the 8 loaded characters, from the first, are digits
+static unsigned swar_digit_count(uint64_t v)
+{
+    uint64_t high = v & 0xF0F0F0F0F0F0F0F0ull;
+    uint64_t plus6 = (v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull;
+    uint64_t bad = (high ^ 0x3030303030303030ull) | (plus6 ^ 0x3030303030303030ull);
+    return bad ? (unsigned)__builtin_ctzll(bad) / 8 : 8;
+}
+
+// Value of the first n (1..8) digit characters in v
+static uint32_t swar_digits_value(uint64_t v, unsigned n)
+{
+    if (n < 8) v <<= 8 * (8 - n);           // Right-align: the zero bytes become leading zeros
+    v = ((v & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+    v = ((v & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+    return (uint32_t)(((v & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32);
+}
+
+// Unsigned integer. Returns characters used (0 = no digits or overflow).
+size_t parse_u32(const char* s, size_t len, uint32_t* out)
+{
+    const char* p = s;
+    const char* end = s + len;
+    uint64_t value = 0;
+    for (;;) {
+        uint64_t chunk = load8(p, end);
+        unsigned n = swar_digit_count(chunk);
+        if (n == 0) break;
+        value = value * pow10_u64[n] + swar_digits_value(chunk, n);
+        if (value > UINT32_MAX) return 0;
+        p += n;
+        if (n < 8) break;
+    }
+    *out = (uint32_t)value;
+    return (size_t)(p - s);
+}
+
+// Up to 19 significant digits go into 'mantissa'; the rest only move the
+// decimal point (integer part) or are dropped (fraction) and set 'inexact'
+typedef struct {
+    uint64_t mantissa;
+    int      digits;        // Significant digits in mantissa
+    int32_t  exponent;      // mantissa x 10^exponent
+    bool     inexact;       // Some non-zero digit didn't fit
+} digit_run_t;
+
+#define PARSE_MAX_DIGITS 19
+
+static const char* scan_digits(const char* p, const char* end, digit_run_t* r, bool fraction, bool* any)
+{
+    // Leading zeros carry no information (but in a fraction they move the point)
+    if (r->digits == 0) {
+        while (p < end && *p == '0') {
+            if (fraction) r->exponent--;
+            p++;
+            *any = true;
+        }
+    }
+    for (;;) {
+        uint64_t chunk = load8(p, end);
+        unsigned n = swar_digit_count(chunk);
+        if (n == 0) break;
+        *any = true;
+
+        unsigned take = n;
+        if (r->digits + (int)take > PARSE_MAX_DIGITS) take = (unsigned)(PARSE_MAX_DIGITS - r->digits);
+        if (take > 0) {
+            r->mantissa = r->mantissa * pow10_u64[take] + swar_digits_value(chunk, take);
+            r->digits += (int)take;
+            if (fraction) r->exponent -= (int32_t)take;
+        }
+        for (unsigned i = take; i < n; i++) {               // Digits that didn't fit
+            if (!fraction) r->exponent++;
+            if (p[i] != '0') r->inexact = true;
+        }
+        p += n;
+        if (n < 8) break;
+    }
+    return p;
+}
+
+// Exact powers of ten in a double (10^22 is the last one)
+static const double pow10_f64[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static bool match_word(const char* p, const char* end, const char* word)
+{
+    size_t n = strlen(word);
+    if ((size_t)(end - p) < n) return false;
+    for (size_t i = 0; i < n; i++) {
+        if ((p[i] | 0x20) != word[i]) return false;         // Case-insensitive
+    }
+    return true;
+}
+
+static float strtof_fallback(const char* s, size_t n)
+{
+    char buf[64];
+    char* text = n < sizeof(buf) ? buf : (char*)malloc(n + 1);
+    if (!text) return NAN;
+    memcpy(text, s, n);
+    text[n] = '\0';
+    float f = strtof(text, NULL);
+    if (text != buf) free(text);
+    return f;
+}
+
+/*
+ * Float parser: [+-]digits[.digits][e[+-]digits], or inf/nan.
+ * Correctly rounded, same result as strtof(). Returns characters used,
+ * 0 if there is no number.
+ *
+ * Fast path (almost every real input): the digits fit in a double exactly
+ * and the power of ten does too, so ONE correctly rounded double multiply
+ * or divide gives the nearest double. Rounding that to float is only
+ * wrong if the double landed exactly halfway between two floats - then
+ * (and for huge/long inputs) we ask strtof().
+ */
+size_t parse_float(const char* s, size_t len, float* out)
+{
+    const char* p = s;
+    const char* end = s + len;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (match_word(p, end, "inf")) {
+        *out = negative ? -INFINITY : INFINITY;
+        p += 3;
+        if (match_word(p, end, "inity")) p += 5;
+        return (size_t)(p - s);
+    }
+    if (match_word(p, end, "nan")) {
+        *out = NAN;
+        return (size_t)(p + 3 - s);
+    }
+
+    digit_run_t r = { 0, 0, 0, false };
+    bool any = false;
+    p = scan_digits(p, end, &r, false, &any);
+    if (p < end && *p == '.') p = scan_digits(p + 1, end, &r, true, &any);
+    if (!any) return 0;
+
+    // Exponent: only consumed if digits follow the 'e'
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool exp_negative = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            exp_negative = *q == '-';
+            q++;
+        }
+        if (q < end && *q >= '0' && *q <= '9') {
+            int32_t e = 0;
+            while (q < end && *q >= '0' && *q <= '9') {
+                if (e < 100000) e = e * 10 + (*q - '0');
+                q++;
+            }
+            r.exponent += exp_negative ? -e : e;
+            p = q;
+        }
+    }
+    size_t used = (size_t)(p - s);
+
+    if (r.mantissa == 0) {
+        *out = negative ? -0.0f : 0.0f;
+        return used;
+    }
+
+    if (!r.inexact && r.mantissa <= (1ull << 53) && r.exponent >= -22 && r.exponent <= 22) {
+        double d = (double)r.mantissa;
+        d = r.exponent < 0 ? d / pow10_f64[-r.exponent] : d * pow10_f64[r.exponent];
+        float f = (float)d;
+        bool exact_or_safe = (double)f == d;
+        if (!exact_or_safe && !isinf(f)) {
+            float other = nextafterf(f, d > (double)f ? INFINITY : -INFINITY);
+            exact_or_safe = d != ((double)f + (double)other) / 2;   // Not a float midpoint
+        }
+        if (exact_or_safe) {
+            *out = negative ? -f : f;
+            return used;
+        }
+    }
+
+    *out = strtof_fallback(s, used);                        // Rare: let libc do the hard case
+    return used;
+}
+
+/*
+ * Fixed-point parser for sensor text: "23.456" with decimals = 2 -> 2346.
+ * Extra fraction digits round half away from zero. No float math at all.
+ * decimals: 0..8. Returns characters used, 0 if there is no number or it
+ * doesn't fit in an int32_t.
+ */
+size_t parse_fixed(const char* s, size_t len, int decimals, int32_t* out)
+{
+    if (decimals < 0) decimals = 0;
+    if (decimals > 8) decimals = 8;
+    const char* p = s;
+    const char* end = s + len;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint32_t whole = 0;
+    size_t n = parse_u32(p, (size_t)(end - p), &whole);
+    if (n == 0 && !(p < end && *p == '.')) return 0;
+    p += n;
+
+    uint64_t value = (uint64_t)whole * pow10_u32[decimals];
+    if (p < end && *p == '.') {
+        p++;
+        uint64_t chunk = load8(p, end);
+        unsigned digits = swar_digit_count(chunk);
+        if (digits == 8) {
+            while (p + digits < end && p[digits] >= '0' && p[digits] <= '9') digits++;   // Long fraction
+        }
+        if (n == 0 && digits == 0) return 0;
+        unsigned use = digits < (unsigned)decimals ? digits : (unsigned)decimals;
+        if (use > 0) {
+            value += (uint64_t)swar_digits_value(chunk, use) * pow10_u32[decimals - (int)use];
+        }
+        if (digits > (unsigned)decimals && p[decimals] >= '5') value++;   // Round the rest
+        p += digits;
+    }
+    if (value > (uint64_t)INT32_MAX + negative) return 0;
+    *out = negative ? (int32_t)(0u - (uint32_t)value) : (int32_t)value;
+    return (size_t)(p - s);
+}
+
+/*
+ * DEMO 1: Correctness - compare against libc, exhaustively where we can
+ */
+typedef struct {
+    uint64_t checked;
+    uint64_t failed;
+} check_t;
+
+static void check_report(const char* what, check_t c)
+{
+    printf("  %-50s %10llu checked, %llu failed %s\n", what,
+           (unsigned long long)c.checked, (unsigned long long)c.failed, c.failed ? "<-- BUG" : "");
+}
+
+// Decimal odometer: counts "0", "1", ... "99999999" as text, no libc
+static int odometer_next(char* digits, int* len)
+{
+    int i = *len - 1;
+    while (i >= 0 && digits[i] == '9') digits[i--] = '0';
+    if (i >= 0) {
+        digits[i]++;
+        return 1;
+    }
+    memmove(digits + 1, digits, (size_t)*len);
+    digits[0] = '1';
+    (*len)++;
+    return 1;
+}
+
+static bool same_float(float a, float b)
+{
+    if (isnan(a) || isnan(b)) return isnan(a) && isnan(b);
+    uint32_t x, y;
+    memcpy(&x, &a, 4);
+    memcpy(&y, &b, 4);
+    return x == y;
+}
+
+// Shortest digits libc can find: try %.0e, %.1e, ... until strtof reads back f
+static int libc_shortest_digits(float f, char* digits)
+{
+    char buf[48];
+    for (int precision = 0; precision < 9; precision++) {
+        snprintf(buf, sizeof(buf), "%.*e", precision, (double)f);
+        if (same_float(strtof(buf, NULL), f)) {
+            int n = 0;
+            for (char* c = buf; *c && *c != 'e'; c++) {
+                if (*c >= '0' && *c <= '9') digits[n++] = *c;
+            }
+            digits[n] = '\0';
+            return precision + 1;
+        }
+    }
+    return 9;
+}
+
+static int our_digits(const char* text, size_t n, char* digits)
+{
+    // Significant digits only: no sign, point, exponent or leading zeros
+    int count = 0;
+    bool started = false;
+    for (size_t i = 0; i < n && text[i] != 'e'; i++) {
+        char c = text[i];
+        if (c < '0' || c > '9') continue;
+        if (c == '0' && !started) continue;
+        started = true;
+        digits[count++] = c;
+    }
+    while (count > 1 && digits[count - 1] == '0') count--;     // 1200 -> "12"
+    digits[count] = '\0';
+    return count;
+}
+
+void correctness_demo(bool exhaustive)
+{
+    printf("=== DEMO 1: Correctness (%s) ===\n", exhaustive ? "exhaustive" : "quick");
+    char text[64], ref[64];
+
+    // Integers: format and parse every number 0 .. 9,999,999 (all of uint32 in
+    // exhaustive mode), against a decimal odometer - no libc involved at all
+    check_t fmt = { 0, 0 }, parse = { 0, 0 };
+    char odo[16] = "0";
+    int odo_len = 1;
+    uint64_t limit = exhaustive ? 0x100000000ull : 10000000ull;
+    for (uint64_t v = 0; v < limit; v++) {
+        size_t n = format_u32(text, (uint32_t)v);
+        fmt.checked++;
+        if ((int)n != odo_len || memcmp(text, odo, n) != 0) fmt.failed++;
+        uint32_t back = 0;
+        parse.checked++;
+        if (parse_u32(odo, (size_t)odo_len, &back) != (size_t)odo_len || back != v) parse.failed++;
+        odometer_next(odo, &odo_len);
+    }
+    check_report(exhaustive ? "format_u32 / parse_u32, every uint32" : "format_u32 / parse_u32, 0..9,999,999", fmt);
+    parse.checked += 1;
+    uint32_t dummy;
+    if (parse_u32("4294967296", 10, &dummy) != 0) parse.failed++;            // Overflow is refused
+    check_report("  (parse side, plus overflow refused)", parse);
+
+    // Fixed-point formatting: every scaled value -10^6 .. 10^6, 0-4 decimals
+    check_t fixed = { 0, 0 };
+    int32_t fixed_limit = exhaustive ? 100000000 : 1000000;
+    for (int decimals = 0; decimals <= 4; decimals++) {
+        for (int32_t v = -fixed_limit; v <= fixed_limit; v++) {
+            size_t n = format_fixed_i32(text, v, decimals);
+            text[n] = '\0';
+            uint32_t mag = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+            if (decimals == 0) snprintf(ref, sizeof(ref), "%d", (int)v);
+            else snprintf(ref, sizeof(ref), "%s%u.%0*u", v < 0 ? "-" : "",
+                          (unsigned)(mag / pow10_u32[decimals]), decimals, (unsigned)(mag % pow10_u32[decimals]));
+            fixed.checked++;
+            if (strcmp(text, ref) != 0) fixed.failed++;
+
+            int32_t back = 0;
+            fixed.checked++;
+            if (parse_fixed(text, n, decimals, &back) != n || back != v) fixed.failed++;
+        }
+    }
+    check_report(exhaustive ? "format_fixed_i32 / parse_fixed, +-10^8, 0-4 dec"
+                            : "format_fixed_i32 / parse_fixed, +-10^6, 0-4 dec", fixed);
+
+    // Float fixed-decimal: every float in two whole binades (sensor range),
+    // printf rounds exact ties to even, we (like Serial.print) away from zero
+    check_t ffixed = { 0, 0 };
+    uint64_t ties = 0;
+    const float binade_start[2] = { 16.0f, 512.0f };
+    for (int b = 0; b < 2; b++) {
+        uint32_t first, last;
+        float top = binade_start[b] * 2;
+        memcpy(&first, &binade_start[b], 4);
+        memcpy(&last, &top, 4);
+        for (uint32_t bits = first; bits < last; bits++) {
+            float f;
+            memcpy(&f, &bits, 4);
+            for (int sign = 0; sign < 2; sign++) {
+                float v = sign ? -f : f;
+                int decimals = (int)(bits % 5);
+                size_t n = format_fixed_float(text, v, decimals);
+                text[n] = '\0';
+                snprintf(ref, sizeof(ref), "%.*f", decimals, (double)v);
+                ffixed.checked++;
+                if (strcmp(text, ref) != 0) {
+                    double scaled = fabs((double)v) * pow10_u32[decimals];
+                    if (scaled - floor(scaled) == 0.5) ties++;
+                    else ffixed.failed++;
+                }
+            }
+        }
+    }
+    check_report("format_fixed_float, all of [16,32) + [512,1024)", ffixed);
+    printf("  %-50s %10llu exact ties rounded away from zero (like Serial.print)\n", "", (unsigned long long)ties);
+
+    // Shortest floats: quick mode samples every 4099th bit pattern and checks
+    // against libc's shortest; exhaustive mode checks ALL 2^32 floats read
+    // back exactly through both parse_float() and strtof()
+    check_t shortest = { 0, 0 }, longer = { 0, 0 }, roundtrip = { 0, 0 };
+    uint64_t step = exhaustive ? 1 : 4099;
+    uint64_t shown = 0;
+    for (uint64_t bits = 0; bits <= UINT32_MAX; bits += step) {
+        uint32_t b32 = (uint32_t)bits;
+        float f;
+        memcpy(&f, &b32, 4);
+        size_t n = format_float_shortest(text, f);
+        text[n] = '\0';
+
+        float ours = 0, theirs = strtof(text, NULL);
+        roundtrip.checked++;
+        if (parse_float(text, n, &ours) != n || !same_float(ours, f) || !same_float(theirs, f)) {
+            roundtrip.failed++;
+            if (shown++ < 5) printf("  round trip failed: bits 0x%08X -> \"%s\"\n", (unsigned)b32, text);
+        }
+
+        if (!exhaustive && isfinite(f) && f != 0) {
+            char mine[16], libc[16];
+            int our_len = our_digits(text, n, mine);
+            int libc_len = libc_shortest_digits(f, libc);
+            shortest.checked++;
+            if (our_len > libc_len) longer.failed++;            // Never longer than libc
+            else if (our_len == libc_len && strcmp(mine, libc) != 0) shortest.failed++;
+        }
+    }
+    check_report(exhaustive ? "format_float_shortest -> parse_float, ALL floats"
+                            : "format_float_shortest -> parse_float, 1/4099 floats", roundtrip);
+    if (!exhaustive) {
+        longer.checked = shortest.checked;
+        check_report("  never more digits than libc's shortest", longer);
+        check_report("  same digits as libc when equally short", shortest);
+    }
+
+    // Parsing sensor-style text, against strtof: every "-999.999".."999.999"
+    check_t sensor = { 0, 0 };
+    for (int32_t v = -999999; v <= 999999; v++) {
+        int n = snprintf(text, sizeof(text), "%s%d.%03d", v < 0 ? "-" : "", abs(v) / 1000, abs(v) % 1000);
+        float ours = 0;
+        sensor.checked++;
+        if (parse_float(text, (size_t)n, &ours) != (size_t)n || !same_float(ours, strtof(text, NULL))) sensor.failed++;
+    }
+    // And NMEA coordinates with 5 decimals: "DDMM.MMMMM"
+    for (uint32_t v = 0; v < 18000u * 100000u; v += 997) {
+        int n = snprintf(text, sizeof(text), "%u.%05u", (unsigned)(v / 100000), (unsigned)(v % 100000));
+        float ours = 0;
+        sensor.checked++;
+        if (parse_float(text, (size_t)n, &ours) != (size_t)n || !same_float(ours, strtof(text, NULL))) sensor.failed++;
+    }
+    check_report("parse_float vs strtof, sensor and NMEA text", sensor);
+
+    // Odd inputs: what gets consumed, and when we refuse
+    static const struct { const char* text; size_t used; } odd[] = {
+        { "12.5,N", 4 }, { ".5", 2 }, { "5.", 2 }, { "-0", 2 }, { "1e5", 3 }, { "1e", 1 },
+        { "1e+", 1 }, { "abc", 0 }, { ".", 0 }, { "-", 0 }, { "", 0 }, { "0000000000000000000000012.5", 27 },
+        { "3.14159265358979323846264338327950288", 37 }, { "1e-50", 5 }, { "1e50", 4 }, { "-inf", 4 },
+    };
+    check_t edge = { 0, 0 };
+    for (size_t i = 0; i < sizeof(odd) / sizeof(odd[0]); i++) {
+        float ours = 0;
+        char* stop;
+        float theirs = strtof(odd[i].text, &stop);
+        size_t used = parse_float(odd[i].text, strlen(odd[i].text), &ours);
+        edge.checked++;
+        if (used != odd[i].used || (used && !same_float(ours, theirs))) {
+            edge.failed++;
+            printf("  \"%s\": used %zu (want %zu)\n", odd[i].text, used, odd[i].used);
+        }
+    }
+    check_report("parse_float edge cases", edge);
+    printf("\n");
+}
+
+/*
+ * DEMO 2: Speed against libc
+ */
+#define BENCH_VALUES 4096
+
+static float bench_floats[BENCH_VALUES];
+static char bench_text[BENCH_VALUES][24];
+static size_t bench_len[BENCH_VALUES];
+
+static double bench(const char* name, double libc_ns, uint64_t elapsed, uint64_t ops)
+{
+    double ns = (double)elapsed / (double)ops;
+    if (libc_ns > 0) printf("  %-44s %7.1f ns  (%.1fx faster)\n", name, ns, libc_ns / ns);
+    else printf("  %-44s %7.1f ns\n", name, ns);
+    return ns;
+}
+
+void benchmark_demo(void)
+{
+    printf("=== DEMO 2: Speed against libc (ns per number) ===\n");
+    const int rounds = 200;
+    const uint64_t ops = (uint64_t)rounds * BENCH_VALUES;
+    char text[64];
+    volatile uint64_t sink = 0;
+
+    // Typical sensor values: -40.00 .. 85.00 with 2 decimals
+    srand(7);
+    for (int i = 0; i < BENCH_VALUES; i++) {
+        bench_floats[i] = (float)(rand() % 12501 - 4000) / 100.0f;
+        bench_len[i] = (size_t)snprintf(bench_text[i], sizeof(bench_text[i]), "%.2f", (double)bench_floats[i]);
+    }
+
+    printf("Formatting a sensor value with 2 decimals:\n");
+    uint64_t t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) sink += (uint64_t)snprintf(text, sizeof(text), "%.2f", (double)bench_floats[i]);
+    double libc = bench("snprintf(\"%.2f\")", 0, now_ns() - t, ops);
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) sink += format_fixed_float(text, bench_floats[i], 2);
+    bench("format_fixed_float(v, 2)", libc, now_ns() - t, ops);
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) sink += format_fixed_i32(text, (int32_t)lrintf(bench_floats[i] * 100), 2);
+    bench("format_fixed_i32(centi-units, 2)", libc, now_ns() - t, ops);
+
+    printf("Formatting with the fewest digits that read back exactly:\n");
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) sink += (uint64_t)snprintf(text, sizeof(text), "%.9g", (double)bench_floats[i]);
+    libc = bench("snprintf(\"%.9g\") (round-trips, not shortest)", 0, now_ns() - t, ops);
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) sink += format_float_shortest(text, bench_floats[i]);
+    bench("format_float_shortest", libc, now_ns() - t, ops);
+
+    printf("Parsing sensor text (\"-12.34\"):\n");
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) sink += (uint64_t)(atof(bench_text[i]) * 100);
+    libc = bench("atof", 0, now_ns() - t, ops);
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) sink += (uint64_t)(strtof(bench_text[i], NULL) * 100);
+    bench("strtof", libc, now_ns() - t, ops);
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) {
+            float f;
+            sink += parse_float(bench_text[i], bench_len[i], &f);
+        }
+    bench("parse_float", libc, now_ns() - t, ops);
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) {
+            int32_t v;
+            sink += parse_fixed(bench_text[i], bench_len[i], 2, &v);
+        }
+    bench("parse_fixed(..., 2) -> centi-units", libc, now_ns() - t, ops);
+
+    // NMEA coordinates and counters
+    for (int i = 0; i < BENCH_VALUES; i++) {
+        bench_len[i] = (size_t)snprintf(bench_text[i], sizeof(bench_text[i]), "%05u.%05u",
+                                        (unsigned)(rand() % 18000), (unsigned)(rand() % 100000));
+    }
+    printf("Parsing NMEA coordinates (\"04807.03800\"):\n");
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) sink += (uint64_t)atof(bench_text[i]);
+    libc = bench("atof", 0, now_ns() - t, ops);
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) {
+            float f;
+            sink += parse_float(bench_text[i], bench_len[i], &f);
+        }
+    bench("parse_float", libc, now_ns() - t, ops);
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) {
+            int32_t v;
+            sink += parse_fixed(bench_text[i], bench_len[i], 5, &v);
+        }
+    bench("parse_fixed(..., 5) (exact, no float at all)", libc, now_ns() - t, ops);
+
+    for (int i = 0; i < BENCH_VALUES; i++) {
+        bench_len[i] = (size_t)snprintf(bench_text[i], sizeof(bench_text[i]), "%u", (unsigned)rand() * 7u);
+    }
+    printf("Parsing unsigned integers:\n");
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) sink += (uint64_t)strtoul(bench_text[i], NULL, 10);
+    libc = bench("strtoul", 0, now_ns() - t, ops);
+    t = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_VALUES; i++) {
+            uint32_t v;
+            sink += parse_u32(bench_text[i], bench_len[i], &v);
+        }
+    bench("parse_u32 (SWAR)", libc, now_ns() - t, ops);
+    printf("\n");
+    (void)sink;
+}
+
+int main(int argc, char** argv)
+{
+    bool exhaustive = argc > 1 && strcmp(argv[1], "--exhaustive") == 0;
+
+    printf("Fast Number Conversion - Formatting and Parsing Without libc\n");
+    printf("============================================================\n\n");
+
+    ryu_tables_init();
+    correctness_demo(exhaustive);
+    benchmark_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. Printing integers two digits per division halves the slow divides\n");
+    printf("2. Sensor values are best kept as scaled integers - no float math to print\n");
+    printf("3. Ryu finds the SHORTEST text that reads back to the exact same float\n");
+    printf("4. SWAR checks and converts 8 digits with a handful of 64-bit operations\n");
+    printf("5. A fast path + a careful fallback is still 100%% correct\n");
+    printf("6. Test against a reference - exhaustively when the input space allows it\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. atof/strtof/printf handle every locale and format - you pay for all of it
+ * 2. Most numbers we print are fixed-point sensor values: int + '.' + digits
+ * 3. "Shortest round-trip" output keeps JSON/CSV small and still exact
+ * 4. A double holds 53 bits exactly: small mantissa x 10^e is ONE operation
+ * 5. Double-then-float rounding is only wrong exactly at a float midpoint
+ * 6. 2^32 floats is few enough to test every single one
+ *
+ * Next: ADC oversampling - getting more bits out of a noisy sensor!
+ */
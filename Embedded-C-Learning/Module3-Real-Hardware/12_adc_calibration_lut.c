@@ -0,0 +1,488 @@
+/*
+ * MODULE 3 - LESSON 12: ADC Calibration Tables - Straightening a Curved Sensor
+ *
+ * What you'll learn:
+ * - Why "raw * 3.3 / 4095" can be 100+ mV wrong on an ESP32
+ * - How to measure calibration points with a multimeter
+ * - Building a lookup table (LUT) from a few calibration points
+ * - Converting raw counts to millivolts - or straight to degrees - with
+ *   ONE array read, no float math, no divide
+ * - A tiny piecewise-linear table when 8 KB of RAM is too much
+ * - How much faster a table is than the float formula
+ *
+ * Think of it like a tailor's measuring tape that got stretched:
+ * - Near the start it's fine, near the end every "centimetre" is longer
+ * - You can't fix the tape, but you can compare it to a good ruler at a
+ *   few marks and write down a correction chart
+ * - From then on you just look up each reading in the chart
+ *
+ * The ESP32 ADC (11 dB attenuation) is exactly such a stretched tape:
+ * - Below ~0.1 V it reads 0 (a "dead zone")
+ * - In the middle the steps are fairly even, with a gentle bow
+ * - Above ~2.4 V it flattens: each step covers more and more millivolts
+ * - Full scale (4095) is reached around 3.1-3.2 V, NOT at 3.3 V
+ *
+ * This program runs on Linux. A model of a typical ESP32 ADC curve stands
+ * in for the real chip, and a "bench supply" sweep produces the points:
+ *   gcc -O2 -o adc_cal 12_adc_calibration_lut.c -lm && ./adc_cal
+ *
+ * The calibration points printed in DEMO 1 are the ones used by the LUT
+ * in 03_adc_analog_reading.c - measure your own board for best results.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define ADC_CODES               4096
+#define ADC_MAX_VALUE           4095
+#define ADC_REFERENCE_MV        3300
+#define MAX_CAL_POINTS          32
+
+// Piecewise-linear grid: one breakpoint every 128 codes -> 33 entries, 66 bytes
+#define GRID_SHIFT              7
+#define GRID_STEP               (1 << GRID_SHIFT)
+#define GRID_POINTS             (ADC_CODES / GRID_STEP + 1)
+
+/*
+ * PART 1: A model of the ESP32 ADC curve
+ * adc_code_center_mv(code) = the input voltage that reads exactly "code".
+ * Dead zone + offset, a gentle bow in the middle, compression at the top.
+ */
+double adc_code_center_mv(double code)
+{
+    double mv = 98.0 + 0.7 * code + 15.0 * sin(M_PI * code / ADC_MAX_VALUE);
+    if (code > 3300) {
+        double over = code - 3300;
+        mv += 0.00035 * over * over;        // The knee: steps get wider
+    }
+    return mv;
+}
+
+// Real-valued code for an input voltage (inverse of the curve, by bisection)
+double adc_code_for_mv(double mv)
+{
+    double lo = 0, hi = ADC_MAX_VALUE;
+    if (mv <= adc_code_center_mv(lo)) return 0;
+    if (mv >= adc_code_center_mv(hi)) return ADC_MAX_VALUE;
+    for (int i = 0; i < 60; i++) {
+        double mid = (lo + hi) / 2;
+        if (adc_code_center_mv(mid) < mv) lo = mid;
+        else hi = mid;
+    }
+    return (lo + hi) / 2;
+}
+
+uint64_t rng_state = 0x452821E638D01377ull;
+
+double rng_gaussian(void)
+{
+    double u[2];
+    for (int k = 0; k < 2; k++) {
+        rng_state ^= rng_state >> 12;
+        rng_state ^= rng_state << 25;
+        rng_state ^= rng_state >> 27;
+        u[k] = ((rng_state * 2685821657736338717ull) >> 11) * (1.0 / 9007199254740992.0);
+    }
+    if (u[0] < 1e-300) u[0] = 1e-300;
+    return sqrt(-2.0 * log(u[0])) * cos(2.0 * M_PI * u[1]);
+}
+
+// One noisy 12-bit reading
+int adc_read(double mv)
+{
+    long code = lround(adc_code_for_mv(mv) + 2.0 * rng_gaussian());
+    if (code < 0) code = 0;
+    if (code > ADC_MAX_VALUE) code = ADC_MAX_VALUE;
+    return (int)code;
+}
+
+/*
+ * PART 2: Calibration points
+ * Set a bench supply to a known voltage (check it with a multimeter), take
+ * 256 readings, write down the average code. The average has a fraction -
+ * keep it: we store codes x 16 (4 extra bits, like oversampling).
+ */
+typedef struct {
+    uint16_t code_x16;      // Average raw reading x 16
+    uint16_t millivolts;    // What the multimeter said
+} cal_point_t;
+
+int measure_calibration(cal_point_t* points)
+{
+    // More points where the curve bends
+    const int sweep_mv[] = {
+        150, 400, 700, 1000, 1300, 1600, 1900, 2200, 2400,
+        2550, 2700, 2800, 2900, 3000, 3080, 3150
+    };
+    int count = sizeof(sweep_mv) / sizeof(sweep_mv[0]);
+    for (int i = 0; i < count; i++) {
+        long sum = 0;
+        for (int k = 0; k < 256; k++) sum += adc_read(sweep_mv[i]);
+        points[i].code_x16 = (uint16_t)((sum + 8) / 16);
+        points[i].millivolts = (uint16_t)sweep_mv[i];
+    }
+    return count;
+}
+
+/*
+ * PART 3: Building the tables (done once, at startup)
+ * Between two calibration points we draw a straight line. Before the first
+ * and after the last point, the nearest line is extended. Only integer math,
+ * so the SAME code builds the table on the ESP32.
+ */
+int32_t interpolate_x16(const cal_point_t* points, int count, int32_t code_x16)
+{
+    // Find the segment: the last point with code <= ours (clamped to valid segments)
+    int seg = 0;
+    while (seg + 2 < count && points[seg + 1].code_x16 <= code_x16) seg++;
+
+    int32_t x0 = points[seg].code_x16, x1 = points[seg + 1].code_x16;
+    int32_t y0 = points[seg].millivolts, y1 = points[seg + 1].millivolts;
+    int32_t dx = x1 - x0;
+    int32_t num = (y1 - y0) * (code_x16 - x0);
+    // Round to nearest, for negative distances too (extrapolating below the first point)
+    int32_t step = num >= 0 ? (num + dx / 2) / dx : (num - dx / 2) / dx;
+    return y0 + step;
+}
+
+uint16_t clamp_mv(int32_t mv)
+{
+    if (mv < 0) return 0;
+    if (mv > ADC_REFERENCE_MV) return ADC_REFERENCE_MV;
+    return (uint16_t)mv;
+}
+
+// 4096 entries x 2 bytes = 8 KB: code -> millivolts
+void build_mv_lut(uint16_t* lut, const cal_point_t* points, int count)
+{
+    for (int code = 0; code < ADC_CODES; code++) {
+        lut[code] = clamp_mv(interpolate_x16(points, count, code * 16));
+    }
+}
+
+// 33 entries: the same curve, sampled every 128 codes
+void build_mv_grid(uint16_t* grid, const cal_point_t* points, int count)
+{
+    for (int i = 0; i < GRID_POINTS; i++) {
+        grid[i] = clamp_mv(interpolate_x16(points, count, i * GRID_STEP * 16));
+    }
+}
+
+/*
+ * PART 4: Conversions used for every sample
+ */
+
+// What the original sketch did: one float multiply and divide per sample
+float adc_to_voltage_float(int code)
+{
+    return (code * 3.3f) / ADC_MAX_VALUE;
+}
+
+// Two-point calibration: "calibrated_min/max" + mapFloat()
+float map_float(float value, float in_min, float in_max, float out_min, float out_max)
+{
+    return (value - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// The "correct but slow" float way: search the points, interpolate in float
+float cal_points_to_mv_float(const cal_point_t* points, int count, int code)
+{
+    float x = code * 16.0f;
+    int lo = 0, hi = count - 1;
+    while (hi - lo > 1) {                       // Binary search for the segment
+        int mid = (lo + hi) / 2;
+        if (points[mid].code_x16 <= x) lo = mid;
+        else hi = mid;
+    }
+    float t = (x - points[lo].code_x16) / (float)(points[hi].code_x16 - points[lo].code_x16);
+    float mv = points[lo].millivolts + t * (points[hi].millivolts - points[lo].millivolts);
+    return mv < 0 ? 0 : (mv > ADC_REFERENCE_MV ? ADC_REFERENCE_MV : mv);
+}
+
+// LUT: one array read
+static inline uint16_t lut_to_mv(const uint16_t* lut, int code)
+{
+    return lut[code];
+}
+
+// Grid: one shift, one mask, one multiply
+static inline uint16_t grid_to_mv(const uint16_t* grid, int code)
+{
+    int i = code >> GRID_SHIFT;
+    int frac = code & (GRID_STEP - 1);
+    int32_t y0 = grid[i];
+    int32_t y1 = grid[i + 1];
+    return (uint16_t)(y0 + (((y1 - y0) * frac + GRID_STEP / 2) >> GRID_SHIFT));
+}
+
+// Oversampled 16-bit values (code x 16): interpolate between two LUT entries
+static inline uint16_t lut_to_mv_x16(const uint16_t* lut, uint32_t code_x16)
+{
+    uint32_t i = code_x16 >> 4;
+    if (i >= ADC_MAX_VALUE) return lut[ADC_MAX_VALUE];
+    int32_t y0 = lut[i];
+    int32_t y1 = lut[i + 1];
+    return (uint16_t)(y0 + (((y1 - y0) * (int32_t)(code_x16 & 15) + 8) >> 4));
+}
+
+/*
+ * PART 5: Straight to engineering units
+ * A thermistor (NTC) is much more curved than the ADC: 10k at 25 °C in a
+ * divider with a 10k resistor. Compose "code -> mV -> ohms -> °C" ONCE into
+ * a table of centi-degrees. At run time: temperature = table[code].
+ */
+#define NTC_R25         10000.0
+#define NTC_BETA        3950.0
+#define NTC_R_FIXED     10000.0
+#define NTC_SUPPLY_MV   3300.0
+
+double ntc_celsius_from_mv(double mv)
+{
+    if (mv <= 1) mv = 1;
+    if (mv >= NTC_SUPPLY_MV - 1) mv = NTC_SUPPLY_MV - 1;
+    // NTC from 3.3V to the pin, fixed resistor from the pin to GND
+    double r_ntc = NTC_R_FIXED * (NTC_SUPPLY_MV - mv) / mv;
+    double inv_t = 1.0 / 298.15 + log(r_ntc / NTC_R25) / NTC_BETA;
+    return 1.0 / inv_t - 273.15;
+}
+
+void build_ntc_lut(int16_t* lut, const uint16_t* mv_lut)
+{
+    for (int code = 0; code < ADC_CODES; code++) {
+        double c = ntc_celsius_from_mv(mv_lut[code]);
+        if (c < -55) c = -55;
+        if (c > 150) c = 150;
+        lut[code] = (int16_t)lround(c * 100.0);
+    }
+}
+
+/*
+ * DEMO 1: Measure, build, and see how wrong the simple formulas are
+ */
+uint16_t mv_lut[ADC_CODES];
+uint16_t mv_grid[GRID_POINTS];
+int16_t ntc_lut[ADC_CODES];
+cal_point_t cal_points[MAX_CAL_POINTS];
+int cal_count;
+
+void calibration_demo(void)
+{
+    printf("=== DEMO 1: Calibration Points and Conversion Error ===\n");
+
+    cal_count = measure_calibration(cal_points);
+    build_mv_lut(mv_lut, cal_points, cal_count);
+    build_mv_grid(mv_grid, cal_points, cal_count);
+    build_ntc_lut(ntc_lut, mv_lut);
+
+    printf("Calibration points (256 readings each, code x 16 keeps the fraction):\n");
+    printf("    {code_x16, millivolts}\n");
+    for (int i = 0; i < cal_count; i++) {
+        printf("    {%5u, %4u},   // code %7.2f\n", cal_points[i].code_x16,
+               cal_points[i].millivolts, cal_points[i].code_x16 / 16.0);
+    }
+
+    // Two-point calibration the way demonstrateCalibration() does it:
+    // measure near both ends, draw ONE straight line through them
+    float two_min_code = cal_points[0].code_x16 / 16.0f;
+    float two_max_code = cal_points[cal_count - 1].code_x16 / 16.0f;
+    float two_min_mv = cal_points[0].millivolts;
+    float two_max_mv = cal_points[cal_count - 1].millivolts;
+
+    printf("\nError vs the true input voltage, sweeping 120-3150 mV (16 readings per step):\n");
+    printf("%-34s %12s %12s\n", "method", "RMS (mV)", "worst (mV)");
+
+    const char* names[] = {
+        "raw * 3.3 / 4095 (float)",
+        "two-point mapFloat (float)",
+        "calibration points (float search)",
+        "4096-entry LUT (integer)",
+        "33-point grid (integer)",
+    };
+    double sum_sq[5] = {0}, worst[5] = {0};
+    int n = 0;
+    for (int mv10 = 1200; mv10 <= 31500; mv10 += 7) {
+        double true_mv = mv10 / 10.0;
+        for (int k = 0; k < 16; k++) {
+            int code = adc_read(true_mv);
+            double result[5];
+            result[0] = adc_to_voltage_float(code) * 1000.0;
+            result[1] = map_float(code, two_min_code, two_max_code, two_min_mv, two_max_mv);
+            result[2] = cal_points_to_mv_float(cal_points, cal_count, code);
+            result[3] = lut_to_mv(mv_lut, code);
+            result[4] = grid_to_mv(mv_grid, code);
+            for (int m = 0; m < 5; m++) {
+                double e = result[m] - true_mv;
+                sum_sq[m] += e * e;
+                if (fabs(e) > worst[m]) worst[m] = fabs(e);
+            }
+            n++;
+        }
+    }
+    for (int m = 0; m < 5; m++) {
+        printf("%-34s %12.1f %12.1f\n", names[m], sqrt(sum_sq[m] / n), worst[m]);
+    }
+    printf("(The 2 LSB of ADC noise alone is ~1.5 mV RMS - no table can remove that,\n");
+    printf(" averaging can: see 10_adc_oversampling.c)\n\n");
+
+    // Same thing in the middle of the range, where the curve is gentle
+    printf("A few readings side by side:\n");
+    printf("%10s %8s %12s %12s %10s %10s\n", "true mV", "code", "raw*3.3/4095", "two-point", "LUT", "grid");
+    const int show_mv[] = {100, 500, 1500, 2500, 2900, 3100};
+    for (int i = 0; i < 6; i++) {
+        int code = (int)lround(adc_code_for_mv(show_mv[i]));
+        printf("%10d %8d %12.0f %12.0f %10u %10u\n", show_mv[i], code,
+               adc_to_voltage_float(code) * 1000.0,
+               map_float(code, two_min_code, two_max_code, two_min_mv, two_max_mv),
+               lut_to_mv(mv_lut, code), grid_to_mv(mv_grid, code));
+    }
+    printf("Below ~100 mV every input reads 0 - no calibration can see inside the dead zone.\n\n");
+}
+
+/*
+ * DEMO 2: Engineering units - thermistor temperature in one lookup
+ */
+void units_demo(void)
+{
+    printf("=== DEMO 2: Thermistor Temperature Straight From the Table ===\n");
+    printf("%10s %8s %14s %14s %14s\n", "true °C", "code", "naive °C", "LUT °C", "error °C");
+
+    const double temps[] = {-20, 0, 10, 25, 40, 60, 80, 100};
+    for (int i = 0; i < 8; i++) {
+        // Voltage the divider really produces at this temperature
+        double r_ntc = NTC_R25 * exp(NTC_BETA * (1.0 / (temps[i] + 273.15) - 1.0 / 298.15));
+        double mv = NTC_SUPPLY_MV * NTC_R_FIXED / (NTC_R_FIXED + r_ntc);
+        int code = (int)lround(adc_code_for_mv(mv));
+
+        // Naive: ideal ADC formula, then the thermistor formula (logs and divides!)
+        double naive = ntc_celsius_from_mv(adc_to_voltage_float(code) * 1000.0);
+        double lut = ntc_lut[code] / 100.0;
+        printf("%10.1f %8d %14.2f %14.2f %14.2f\n", temps[i], code, naive, lut, lut - temps[i]);
+    }
+    printf("One int16 read per sample: no log(), no divides, no float at all.\n\n");
+}
+
+/*
+ * DEMO 3: Conversions per second
+ */
+double nanos_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define BENCH_SAMPLES   (1 << 24)
+
+void benchmark_demo(void)
+{
+    printf("=== DEMO 3: Conversions per Second ===\n");
+
+    uint16_t* codes = malloc(BENCH_SAMPLES * sizeof(uint16_t));
+    for (int i = 0; i < BENCH_SAMPLES; i++) codes[i] = (uint16_t)(2048 + 2000 * sin(i * 0.0001));
+
+    float two_min_code = cal_points[0].code_x16 / 16.0f;
+    float two_max_code = cal_points[cal_count - 1].code_x16 / 16.0f;
+    float two_min_mv = cal_points[0].millivolts;
+    float two_max_mv = cal_points[cal_count - 1].millivolts;
+
+    printf("%-38s %14s\n", "conversion", "Mconv/s");
+    for (int m = 0; m < 7; m++) {
+        const char* name = "";
+        double checksum = 0;
+        double start = nanos_now();
+        switch (m) {
+        case 0:
+            name = "raw * 3.3 / 4095 (float)";
+            for (int i = 0; i < BENCH_SAMPLES; i++) checksum += adc_to_voltage_float(codes[i]);
+            break;
+        case 1:
+            name = "two-point mapFloat (float)";
+            for (int i = 0; i < BENCH_SAMPLES; i++) {
+                checksum += map_float(codes[i], two_min_code, two_max_code, two_min_mv, two_max_mv);
+            }
+            break;
+        case 2:
+            name = "calibration points (float search)";
+            for (int i = 0; i < BENCH_SAMPLES; i++) {
+                checksum += cal_points_to_mv_float(cal_points, cal_count, codes[i]);
+            }
+            break;
+        case 3:
+            name = "thermistor formula (float, log)";
+            for (int i = 0; i < BENCH_SAMPLES; i++) {
+                checksum += ntc_celsius_from_mv(adc_to_voltage_float(codes[i]) * 1000.0);
+            }
+            break;
+        case 4:
+            name = "4096-entry LUT -> mV";
+            for (int i = 0; i < BENCH_SAMPLES; i++) checksum += lut_to_mv(mv_lut, codes[i]);
+            break;
+        case 5:
+            name = "33-point grid -> mV";
+            for (int i = 0; i < BENCH_SAMPLES; i++) checksum += grid_to_mv(mv_grid, codes[i]);
+            break;
+        case 6:
+            name = "4096-entry LUT -> thermistor °C";
+            for (int i = 0; i < BENCH_SAMPLES; i++) checksum += ntc_lut[codes[i]];
+            break;
+        }
+        double seconds = (nanos_now() - start) / 1e9;
+        printf("%-38s %14.1f%s\n", name, BENCH_SAMPLES / seconds / 1e6, checksum == 0.5 ? " " : "");
+    }
+    printf("\nThe ESP32 has a single-precision FPU but no fast divide, and log() is a\n");
+    printf("library call - there the gap between formula and table is even bigger.\n\n");
+
+    // Check: oversampled (x16) lookups land between the neighbouring entries
+    int bad = 0;
+    for (uint32_t v = 0; v < ADC_CODES * 16; v++) {
+        uint16_t mv = lut_to_mv_x16(mv_lut, v);
+        uint32_t i = v >> 4;
+        uint16_t lo = mv_lut[i], hi = mv_lut[i < ADC_MAX_VALUE ? i + 1 : i];
+        if (mv < (lo < hi ? lo : hi) || mv > (lo > hi ? lo : hi)) bad++;
+    }
+    printf("Oversampled (code x 16) lookups outside their two LUT entries: %d of %d\n\n", bad, ADC_CODES * 16);
+
+    free(codes);
+}
+
+int main(void)
+{
+    printf("ADC Calibration Tables - Raw Counts to Millivolts and Degrees\n");
+    printf("=============================================================\n\n");
+
+    calibration_demo();
+    units_demo();
+    benchmark_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. The ESP32 ADC is not a straight line: dead zone, bow, and a knee at the top\n");
+    printf("2. A dozen measured points + straight lines between them fix most of the error\n");
+    printf("3. Build the table once at startup; every conversion is then one array read\n");
+    printf("4. Compose sensor formulas into the table: raw code -> degrees in one step\n");
+    printf("5. Short of RAM? A 33-point grid gets close with one multiply and a shift\n");
+    printf("6. Oversampled values interpolate between two neighbouring table entries\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. Check the ADC against a multimeter before trusting "raw * 3.3 / 4095"
+ * 2. Two-point calibration only fixes offset and gain, not curvature
+ * 3. Store calibration points as integers (code x 16, millivolts)
+ * 4. Tables trade a little memory for a lot of speed and zero float math
+ * 5. Integer interpolation with rounding is exact enough - check the error
+ * 6. Noise is a separate problem: calibrate the average, not single readings
+ *
+ * Next: Reading many channels at once - an ADC scan sequencer!
+ */
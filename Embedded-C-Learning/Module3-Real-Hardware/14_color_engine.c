@@ -0,0 +1,583 @@
+/*
+ * MODULE 3 - LESSON 14: Color Engine - Fast HSV to RGB, Gamma and Dithering
+ *
+ * What you'll learn:
+ * - How HSV (hue, saturation, value) maps onto the three LED colours
+ * - Integer hue units (1536 per circle) so the colour sector is a shift
+ *   and the position inside it is a mask - no "% 120", no "/ 60"
+ * - Branchless sector selection: look the shape up instead of six if/else
+ * - Gamma correction: why PWM 128 does NOT look half as bright
+ * - Temporal dithering: getting 16-bit smoothness out of 8-bit PWM
+ * - Converting a whole frame (a strip of LEDs) per call, 8 pixels at once
+ *   with SIMD on the host
+ *
+ * Think of the colour wheel like a clock with six hours:
+ * - At each "hour" one primary or secondary colour is exactly on
+ *   (red, yellow, green, cyan, blue, magenta)
+ * - Between two hours one channel slides up or down, the others stay put
+ * - So all you need is: which hour (sector) and how far past it (fraction)
+ * - With 256 steps per hour, sector = hue >> 8 and fraction = hue & 255
+ *
+ * Gamma: your eye is much more sensitive to changes in dim light than in
+ * bright light. PWM 64 (25%) already looks like "half brightness". A gamma
+ * table spends more of the PWM steps on the dark end so a fade LOOKS even.
+ *
+ * This program runs on Linux:
+ *   gcc -O2 -o color_engine 14_color_engine.c -lm && ./color_engine
+ *
+ * On the ESP32 the same engine drives the RGB LED in 04_pwm_control.c.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HAVE_SSE2 1
+#else
+#define HAVE_SSE2 0
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define HUE_STEPS_PER_SECTOR    256
+#define HUE_RANGE               (6 * HUE_STEPS_PER_SECTOR)     // 1536 = one full circle
+#define GAMMA                   2.2
+
+/*
+ * PART 1: The old conversion from 04_pwm_control.c (for comparison)
+ * Hue in degrees. A modulo, two divides and a six-way if/else per pixel.
+ */
+void hsv_to_rgb_old(int h, int s, int v, int* r, int* g, int* b)
+{
+    int c = (v * s) / 255;
+    int x = c * (60 - abs((h % 120) - 60)) / 60;
+    int m = v - c;
+
+    if (h < 60) {
+        *r = c; *g = x; *b = 0;
+    } else if (h < 120) {
+        *r = x; *g = c; *b = 0;
+    } else if (h < 180) {
+        *r = 0; *g = c; *b = x;
+    } else if (h < 240) {
+        *r = 0; *g = x; *b = c;
+    } else if (h < 300) {
+        *r = x; *g = 0; *b = c;
+    } else {
+        *r = c; *g = 0; *b = x;
+    }
+    *r += m; *g += m; *b += m;
+}
+
+// The textbook formula in double precision - the "truth" for error checks
+void hsv_to_rgb_reference(double hue_units, double s, double v, double rgb[3])
+{
+    double h = fmod(hue_units / HUE_STEPS_PER_SECTOR, 6.0);
+    double c = v * s / 255.0;
+    double x = c * (1.0 - fabs(fmod(h, 2.0) - 1.0));
+    double m = v - c;
+    double r = 0, g = 0, b = 0;
+    switch ((int)h) {
+    case 0: r = c; g = x; break;
+    case 1: r = x; g = c; break;
+    case 2: g = c; b = x; break;
+    case 3: g = x; b = c; break;
+    case 4: r = x; b = c; break;
+    default: r = c; b = x; break;
+    }
+    rgb[0] = r + m;
+    rgb[1] = g + m;
+    rgb[2] = b + m;
+}
+
+/*
+ * PART 2: The tables
+ * - hue_from_degrees: 360 entries, old-style degrees -> engine hue units
+ * - sector_shape: which of {0, full, rising, falling} each channel gets
+ * - sine_table: one full sine wave in 256 steps, for breathing and waves
+ * - gamma_table: 8-bit brightness -> 16-bit PWM value (8.8 fixed point)
+ */
+typedef struct {
+    uint8_t r, g, b;
+} rgb_t;
+
+typedef struct {
+    uint16_t hue;       // 0 .. HUE_RANGE-1
+    uint8_t sat;
+    uint8_t val;
+} hsv_t;
+
+enum { LEVEL_ZERO, LEVEL_FULL, LEVEL_RISE, LEVEL_FALL };
+
+// Sector:             R            G            B
+const uint8_t sector_shape[6][3] = {
+    {LEVEL_FULL, LEVEL_RISE, LEVEL_ZERO},   // 0: red -> yellow
+    {LEVEL_FALL, LEVEL_FULL, LEVEL_ZERO},   // 1: yellow -> green
+    {LEVEL_ZERO, LEVEL_FULL, LEVEL_RISE},   // 2: green -> cyan
+    {LEVEL_ZERO, LEVEL_FALL, LEVEL_FULL},   // 3: cyan -> blue
+    {LEVEL_RISE, LEVEL_ZERO, LEVEL_FULL},   // 4: blue -> magenta
+    {LEVEL_FULL, LEVEL_ZERO, LEVEL_FALL},   // 5: magenta -> red
+};
+
+uint32_t sector_shifts[6];      // sector_shape packed: 8 x level per channel, one byte each
+uint16_t hue_from_degrees[360];
+uint8_t sine_table[256];        // 128 + 127 * sin(2 pi i / 256)
+uint16_t gamma_table[256];      // 0 .. 65280 (255 x 256)
+
+void build_color_tables(void)
+{
+    for (int s = 0; s < 6; s++) {
+        sector_shifts[s] = 0;
+        for (int c = 0; c < 3; c++) {
+            sector_shifts[s] |= (uint32_t)(8 * sector_shape[s][c]) << (8 * c);
+        }
+    }
+    for (int d = 0; d < 360; d++) {
+        hue_from_degrees[d] = (uint16_t)((d * HUE_RANGE + 180) / 360);
+    }
+    for (int i = 0; i < 256; i++) {
+        sine_table[i] = (uint8_t)lround(128 + 127 * sin(2 * M_PI * i / 256));
+        gamma_table[i] = (uint16_t)lround(pow(i / 255.0, GAMMA) * 255 * 256);
+    }
+}
+
+/*
+ * PART 3: Scalar conversion - integer only, no branches on the colour
+ * x / 255 is done as (x + 128) * 257 >> 16, which rounds exactly like
+ * the real division for every x in 0..65535.
+ */
+static inline uint32_t div255_round(uint32_t x)
+{
+    return ((x + 128) * 257) >> 16;
+}
+
+static inline rgb_t hsv_to_rgb_fast(hsv_t in)
+{
+    uint32_t sector = in.hue >> 8;                      // 0..5
+    uint32_t frac = in.hue & (HUE_STEPS_PER_SECTOR - 1);
+    uint32_t chroma = div255_round((uint32_t)in.val * in.sat);
+    uint32_t rise = (chroma * frac + 128) >> 8;
+    uint32_t m = in.val - chroma;                       // The "white" part
+
+    // The four levels packed in one register, one byte each (byte 0 = zero):
+    // picking a level is a shift by 8 x LEVEL_..., no branch. The uint8_t
+    // cast drops the bytes above - level + m never carries (it is at most val)
+    uint32_t levels = (chroma << (8 * LEVEL_FULL)) | (rise << (8 * LEVEL_RISE)) |
+                      ((chroma - rise) << (8 * LEVEL_FALL));
+    uint32_t shifts = sector_shifts[sector];            // One table read per pixel
+    rgb_t out = {
+        (uint8_t)((levels >> (shifts & 0xFF)) + m),
+        (uint8_t)((levels >> ((shifts >> 8) & 0xFF)) + m),
+        (uint8_t)((levels >> (shifts >> 16)) + m),
+    };
+    return out;
+}
+
+// A whole frame: n LEDs in, n LEDs out
+void hsv_frame_scalar(const hsv_t* in, rgb_t* out, int n)
+{
+    for (int i = 0; i < n; i++) {
+        out[i] = hsv_to_rgb_fast(in[i]);
+    }
+}
+
+/*
+ * PART 4: The SIMD batch path - 8 pixels per step
+ * For SIMD the frame is stored "planar": all hues, then all saturations,
+ * then all values. Each step does the same math on 8 pixels in 16-bit lanes,
+ * and picks full/rise/fall/zero with compare masks instead of a table.
+ */
+typedef struct {
+    uint16_t* hue;
+    uint8_t* sat;
+    uint8_t* val;
+} hsv_planar_t;
+
+typedef struct {
+    uint8_t* r;
+    uint8_t* g;
+    uint8_t* b;
+} rgb_planar_t;
+
+void hsv_planar_scalar(hsv_planar_t in, rgb_planar_t out, int start, int n)
+{
+    for (int i = start; i < n; i++) {
+        hsv_t p = {in.hue[i], in.sat[i], in.val[i]};
+        rgb_t c = hsv_to_rgb_fast(p);
+        out.r[i] = c.r;
+        out.g[i] = c.g;
+        out.b[i] = c.b;
+    }
+}
+
+#if HAVE_SSE2
+static inline __m128i select16(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+void hsv_planar_sse2(hsv_planar_t in, rgb_planar_t out, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i k128 = _mm_set1_epi16(128);
+    const __m128i k257 = _mm_set1_epi16(257);
+    const __m128i k255 = _mm_set1_epi16(255);
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i hue = _mm_loadu_si128((const __m128i*)(in.hue + i));
+        __m128i sat = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(in.sat + i)), zero);
+        __m128i val = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(in.val + i)), zero);
+
+        __m128i sector = _mm_srli_epi16(hue, 8);
+        __m128i frac = _mm_and_si128(hue, k255);
+        // chroma = (v * s + 128) * 257 >> 16: mulhi keeps exactly the top 16 bits
+        __m128i chroma = _mm_mulhi_epu16(_mm_add_epi16(_mm_mullo_epi16(val, sat), k128), k257);
+        __m128i rise = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(chroma, frac), k128), 8);
+        __m128i fall = _mm_sub_epi16(chroma, rise);
+        __m128i m = _mm_sub_epi16(val, chroma);
+
+        __m128i s0 = _mm_cmpeq_epi16(sector, _mm_set1_epi16(0));
+        __m128i s1 = _mm_cmpeq_epi16(sector, _mm_set1_epi16(1));
+        __m128i s2 = _mm_cmpeq_epi16(sector, _mm_set1_epi16(2));
+        __m128i s3 = _mm_cmpeq_epi16(sector, _mm_set1_epi16(3));
+        __m128i s4 = _mm_cmpeq_epi16(sector, _mm_set1_epi16(4));
+        __m128i s5 = _mm_cmpeq_epi16(sector, _mm_set1_epi16(5));
+
+        // Same table as sector_shape, written as masks
+        __m128i r = select16(_mm_or_si128(s0, s5), chroma,
+                    select16(s1, fall, select16(s4, rise, zero)));
+        __m128i g = select16(_mm_or_si128(s1, s2), chroma,
+                    select16(s0, rise, select16(s3, fall, zero)));
+        __m128i b = select16(_mm_or_si128(s3, s4), chroma,
+                    select16(s2, rise, select16(s5, fall, zero)));
+
+        // Add the white part and pack 8 x 16-bit back to 8 x 8-bit
+        _mm_storel_epi64((__m128i*)(out.r + i), _mm_packus_epi16(_mm_add_epi16(r, m), zero));
+        _mm_storel_epi64((__m128i*)(out.g + i), _mm_packus_epi16(_mm_add_epi16(g, m), zero));
+        _mm_storel_epi64((__m128i*)(out.b + i), _mm_packus_epi16(_mm_add_epi16(b, m), zero));
+    }
+    hsv_planar_scalar(in, out, i, n);       // The last 0-7 pixels
+}
+#endif
+
+bool use_simd = HAVE_SSE2;      // Switch for the benchmark
+
+void hsv_frame_planar(hsv_planar_t in, rgb_planar_t out, int n)
+{
+#if HAVE_SSE2
+    if (use_simd) {
+        hsv_planar_sse2(in, out, n);
+        return;
+    }
+#endif
+    hsv_planar_scalar(in, out, 0, n);
+}
+
+/*
+ * PART 5: Gamma + temporal dithering
+ * The gamma table gives 8.8 fixed point: 255 x 256 steps instead of 255.
+ * PWM only takes the top 8 bits, so each channel keeps the leftover
+ * fraction and adds it to the next frame. Over 256 frames the average
+ * PWM value is exactly the 16-bit target - like a sigma-delta converter.
+ */
+typedef struct {
+    uint8_t error[3];           // Leftover fraction per colour, 0..255
+} dither_state_t;
+
+static inline uint8_t dither_channel(uint16_t target, uint8_t* error)
+{
+    uint32_t sum = (uint32_t)target + *error;
+    *error = (uint8_t)(sum & 0xFF);
+    return (uint8_t)(sum >> 8);
+}
+
+// Gamma-correct and dither a frame: out = PWM values for this refresh
+void gamma_dither_frame(const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                        dither_state_t* state, rgb_t* out, int n)
+{
+    for (int i = 0; i < n; i++) {
+        out[i].r = dither_channel(gamma_table[r[i]], &state[i].error[0]);
+        out[i].g = dither_channel(gamma_table[g[i]], &state[i].error[1]);
+        out[i].b = dither_channel(gamma_table[b[i]], &state[i].error[2]);
+    }
+}
+
+// Without dithering: just round the gamma value to 8 bits
+static inline uint8_t gamma_rounded(uint8_t level)
+{
+    uint32_t g = gamma_table[level] + 128;
+    return (uint8_t)(g > 0xFFFF ? 255 : g >> 8);
+}
+
+/*
+ * PART 6: A frame effect - a moving rainbow that breathes
+ * Hue runs along the strip, brightness follows the sine table. All table
+ * reads and adds; this is what a 60 LED strip would run every frame.
+ */
+void render_rainbow_frame(hsv_planar_t frame, int n, uint32_t time_step)
+{
+    uint8_t breath = sine_table[(time_step >> 1) & 255];
+    uint8_t val = (uint8_t)(64 + ((breath * 191) >> 8));
+    for (int i = 0; i < n; i++) {
+        frame.hue[i] = (uint16_t)((i * HUE_RANGE / n + time_step * 8) % HUE_RANGE);
+        frame.sat[i] = 255;
+        frame.val[i] = val;
+    }
+}
+
+/*
+ * DEMO 1: Accuracy - old conversion, fast conversion, SIMD batch
+ */
+void accuracy_demo(void)
+{
+    printf("=== DEMO 1: Accuracy Against the Exact Formula ===\n");
+
+    // Fast scalar vs double-precision reference, every hue, a grid of s/v
+    double worst_fast = 0, worst_old = 0, sum_sq_fast = 0, sum_sq_old = 0;
+    uint32_t count = 0;
+    for (int s = 0; s <= 255; s += 5) {
+        for (int v = 0; v <= 255; v += 5) {
+            for (int d = 0; d < 360; d++) {
+                double ref[3];
+                hsv_to_rgb_reference(hue_from_degrees[d], s, v, ref);
+
+                hsv_t p = {hue_from_degrees[d], (uint8_t)s, (uint8_t)v};
+                rgb_t fast = hsv_to_rgb_fast(p);
+                int old[3];
+                hsv_to_rgb_old(d, s, v, &old[0], &old[1], &old[2]);
+
+                const uint8_t fast_c[3] = {fast.r, fast.g, fast.b};
+                for (int c = 0; c < 3; c++) {
+                    double ef = fabs(fast_c[c] - ref[c]);
+                    double eo = fabs(old[c] - ref[c]);
+                    if (ef > worst_fast) worst_fast = ef;
+                    if (eo > worst_old) worst_old = eo;
+                    sum_sq_fast += ef * ef;
+                    sum_sq_old += eo * eo;
+                    count++;
+                }
+            }
+        }
+    }
+    printf("%-28s %10s %10s\n", "Conversion", "Max error", "RMS error");
+    printf("%-28s %10.2f %10.3f\n", "Old (degrees, divides)", worst_old, sqrt(sum_sq_old / count));
+    printf("%-28s %10.2f %10.3f\n", "Table + branchless", worst_fast, sqrt(sum_sq_fast / count));
+    printf("(in PWM steps; the old version truncates, the new one rounds)\n");
+
+    // SIMD must give bit-identical results for EVERY input
+    const int n = HUE_RANGE * 256;
+    hsv_planar_t in = {malloc(n * sizeof(uint16_t)), malloc(n), malloc(n)};
+    rgb_planar_t a = {malloc(n), malloc(n), malloc(n)};
+    rgb_planar_t b = {malloc(n), malloc(n), malloc(n)};
+    uint32_t mismatches = 0;
+    for (int v = 0; v < 256; v++) {
+        for (int i = 0; i < n; i++) {
+            in.hue[i] = (uint16_t)(i % HUE_RANGE);
+            in.sat[i] = (uint8_t)(i / HUE_RANGE);
+            in.val[i] = (uint8_t)v;
+        }
+        use_simd = false;
+        hsv_frame_planar(in, a, n);
+        use_simd = HAVE_SSE2;
+        hsv_frame_planar(in, b, n);
+        for (int i = 0; i < n; i++) {
+            if (a.r[i] != b.r[i] || a.g[i] != b.g[i] || a.b[i] != b.b[i]) mismatches++;
+        }
+    }
+    printf("Batch path vs scalar, all %d x 256 x 256 inputs: %u mismatches%s\n\n",
+           HUE_RANGE, mismatches, HAVE_SSE2 ? "" : " (no SSE2 here - both scalar)");
+
+    free(in.hue); free(in.sat); free(in.val);
+    free(a.r); free(a.g); free(a.b);
+    free(b.r); free(b.g); free(b.b);
+}
+
+/*
+ * DEMO 2: Gamma and dithering at the dark end
+ * Light output is proportional to PWM. We compare the average PWM value
+ * over 256 refreshes with the ideal gamma curve.
+ */
+void gamma_demo(void)
+{
+    printf("=== DEMO 2: Gamma Correction and Dithering ===\n");
+    printf("%-8s %10s %12s %14s %14s\n", "Level", "No gamma", "Ideal gamma", "Gamma rounded", "Gamma dither");
+
+    const uint8_t levels[] = {4, 8, 16, 24, 32, 48, 64, 128, 192, 255};
+    double worst_rounded = 0, worst_dither = 0;
+    for (int i = 0; i < (int)sizeof(levels); i++) {
+        uint8_t level = levels[i];
+        double ideal = pow(level / 255.0, GAMMA) * 255;
+        dither_state_t state = {{0, 0, 0}};
+        uint32_t sum = 0;
+        for (int frame = 0; frame < 256; frame++) {
+            sum += dither_channel(gamma_table[level], &state.error[0]);
+        }
+        double dithered = sum / 256.0;
+        uint8_t rounded = gamma_rounded(level);
+        printf("%-8u %10u %12.3f %14u %14.3f\n", level, level, ideal, rounded, dithered);
+
+        double er = fabs(rounded - ideal) / (ideal > 0 ? ideal : 1);
+        double ed = fabs(dithered - ideal) / (ideal > 0 ? ideal : 1);
+        if (er > worst_rounded) worst_rounded = er;
+        if (ed > worst_dither) worst_dither = ed;
+    }
+
+    // How many different brightness levels survive each method?
+    int distinct_rounded = 1, distinct_dither = 1;
+    for (int l = 1; l < 256; l++) {
+        if (gamma_rounded((uint8_t)l) != gamma_rounded((uint8_t)(l - 1))) distinct_rounded++;
+        if (gamma_table[l] != gamma_table[l - 1]) distinct_dither++;
+    }
+    printf("Worst brightness error in the table: rounded %.0f%%, dithered %.1f%%\n",
+           worst_rounded * 100, worst_dither * 100);
+    printf("Distinct brightness levels: rounded to 8 bits %d, dithered %d of 256\n",
+           distinct_rounded, distinct_dither);
+    printf("Rounded gamma turns the bottom of a fade into visible steps (0, 0, 1, 1, 2...).\n");
+    printf("Dithering needs a fast refresh (>= 200 Hz) or it flickers instead.\n\n");
+}
+
+/*
+ * DEMO 3: Speed - pixels per second
+ */
+double nanos_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define BENCH_PIXELS    4096
+#define BENCH_FRAMES    4000
+
+void benchmark_demo(void)
+{
+    printf("=== DEMO 3: Conversion Speed ===\n");
+
+    static uint16_t hue[BENCH_PIXELS], degrees[BENCH_PIXELS];
+    static uint8_t sat[BENCH_PIXELS], val[BENCH_PIXELS];
+    static uint8_t r[BENCH_PIXELS], g[BENCH_PIXELS], b[BENCH_PIXELS];
+    static hsv_t hsv[BENCH_PIXELS];
+    static rgb_t rgb[BENCH_PIXELS];
+    static dither_state_t dither[BENCH_PIXELS];
+    hsv_planar_t planar = {hue, sat, val};
+    rgb_planar_t out = {r, g, b};
+    uint32_t checksum = 0;
+
+    for (int i = 0; i < BENCH_PIXELS; i++) {
+        hue[i] = (uint16_t)((i * 37) % HUE_RANGE);
+        sat[i] = (uint8_t)(128 + (i & 127));
+        val[i] = (uint8_t)(i * 7);
+        hsv[i].hue = hue[i];
+        hsv[i].sat = sat[i];
+        hsv[i].val = val[i];
+        degrees[i] = (uint16_t)(hue[i] * 360 / HUE_RANGE);
+    }
+    const double pixels = (double)BENCH_PIXELS * BENCH_FRAMES;
+    printf("%-36s %14s\n", "Conversion", "Mpixels/s");
+
+    double start = nanos_now();
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        for (int i = 0; i < BENCH_PIXELS; i++) {
+            int cr, cg, cb;
+            hsv_to_rgb_old(degrees[i], sat[i], val[i] ^ (f & 1), &cr, &cg, &cb);
+            checksum += cr + cg + cb;
+        }
+    }
+    printf("%-36s %14.1f\n", "Old (degrees, divides, if/else)", pixels / (nanos_now() - start) * 1e3);
+
+    start = nanos_now();
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        hsv[f & (BENCH_PIXELS - 1)].val ^= 1;       // Keep the compiler honest
+        hsv_frame_scalar(hsv, rgb, BENCH_PIXELS);
+        checksum += rgb[f & (BENCH_PIXELS - 1)].g;
+    }
+    printf("%-36s %14.1f\n", "Table + branchless, frame", pixels / (nanos_now() - start) * 1e3);
+
+    use_simd = false;
+    start = nanos_now();
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        val[f & (BENCH_PIXELS - 1)] ^= 1;
+        hsv_frame_planar(planar, out, BENCH_PIXELS);
+        checksum += g[f & (BENCH_PIXELS - 1)];
+    }
+    printf("%-36s %14.1f\n", "Planar frame, scalar", pixels / (nanos_now() - start) * 1e3);
+
+#if HAVE_SSE2
+    use_simd = true;
+    start = nanos_now();
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        val[f & (BENCH_PIXELS - 1)] ^= 1;
+        hsv_frame_planar(planar, out, BENCH_PIXELS);
+        checksum += g[f & (BENCH_PIXELS - 1)];
+    }
+    printf("%-36s %14.1f\n", "Planar frame, SSE2 (8 at once)", pixels / (nanos_now() - start) * 1e3);
+#endif
+    use_simd = HAVE_SSE2;
+
+    start = nanos_now();
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        gamma_dither_frame(r, g, b, dither, rgb, BENCH_PIXELS);
+        checksum += rgb[f & (BENCH_PIXELS - 1)].b;
+    }
+    printf("%-36s %14.1f\n", "Gamma + dither, frame", pixels / (nanos_now() - start) * 1e3);
+
+    start = nanos_now();
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        render_rainbow_frame(planar, BENCH_PIXELS, (uint32_t)f);
+        hsv_frame_planar(planar, out, BENCH_PIXELS);
+        gamma_dither_frame(r, g, b, dither, rgb, BENCH_PIXELS);
+        checksum += rgb[f & (BENCH_PIXELS - 1)].r;
+    }
+    printf("%-36s %14.1f\n", "Rainbow effect: render+convert+gamma", pixels / (nanos_now() - start) * 1e3);
+
+    printf("(checksum %u)\n", checksum & 0xFFFF);
+    printf("One pixel at a time, the old code keeps up on a PC: its divides are by\n");
+    printf("constants (the compiler turns them into multiplies) and the branch\n");
+    printf("predictor learns the pattern. The table version is more accurate, takes\n");
+    printf("the same time for every colour, and converts 8 pixels per step in a batch.\n");
+    printf("A 60 LED strip at 200 frames/s needs only 12000 pixels/s - the cost that\n");
+    printf("matters on the ESP32 is float math and pow(), which the tables remove.\n\n");
+}
+
+int main(void)
+{
+    printf("Color Engine - Integer HSV to RGB, Gamma and Dithering\n");
+    printf("======================================================\n\n");
+
+    build_color_tables();
+    accuracy_demo();
+    gamma_demo();
+    benchmark_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. 256 hue steps per sector: sector = hue >> 8, fraction = hue & 255\n");
+    printf("2. A 6 x 3 shape table replaces the six-way if/else chain\n");
+    printf("3. Exact rounded /255 with an add, a multiply and a shift\n");
+    printf("4. Gamma tables make fades look even; 8.8 values keep the dark end smooth\n");
+    printf("5. Temporal dithering carries the fraction to the next refresh\n");
+    printf("6. Convert whole frames: planar arrays let SIMD do 8 pixels at once\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. Pick units that make the math easy: 1536 hue steps, not 360 degrees
+ * 2. Precompute anything that needs pow() or sin() - once, at startup
+ * 3. Branchless code runs at the same speed for every colour
+ * 4. Your eye is not linear - PWM values need gamma correction
+ * 5. Dithering trades refresh rate for extra brightness resolution
+ * 6. Check the fast path against the exact formula AND the batch path against the scalar one
+ *
+ * Next: A fade engine - smooth PWM ramps on many channels without delay()!
+ */
@@ -0,0 +1,548 @@
+/*
+ * MODULE 3 - LESSON 15: PWM Fade Engine - Smooth Ramps Without delay()
+ *
+ * What you'll learn:
+ * - Why "ledcWrite + delay(20)" fades freeze the whole program
+ * - A fade engine: one timer tick moves MANY channels a little bit
+ * - Fixed-point duty increments: fractions of a PWM step per tick
+ * - Easing curves (ease-in, ease-out, S-curve) from small tables
+ * - Completion callbacks: "tell me when the fade is done"
+ * - A pattern player: queue a list of steps, the engine plays them
+ * - Tick jitter: sleeping "for 2 ms" vs sleeping "until the next 2 ms mark"
+ *
+ * Think of it like a lighting desk in a theatre:
+ * - The old way: one stage hand turns one dimmer knob, slowly, and nobody
+ *   else can do anything until they are done
+ * - The fade engine: every fader has a small motor, and a clock tells all
+ *   motors "move one notch" 500 times per second
+ * - You just say "fader 3 to 80% in 2 seconds, S-curve" and walk away
+ * - A cue list (the pattern) says what happens next when a fade finishes
+ *
+ * Fixed-point: a fade from 0 to 255 in 2 seconds at 500 ticks/s moves
+ * 0.255 PWM steps per tick. We keep the duty x 65536, so the increment is
+ * the integer 16712 and the fractions add up exactly over the fade.
+ *
+ * This program runs on Linux. A simulated LEDC (the ESP32 PWM peripheral)
+ * records every duty write, and a loop (or the real clock) plays the timer:
+ *   gcc -O2 -o fade_engine 15_pwm_fade_engine.c -lm && ./fade_engine
+ *
+ * On the ESP32 the same engine runs in 04_pwm_control.c: a hardware timer
+ * wakes the fade task, loop() only sends commands.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FADE_CHANNELS           16          // The ESP32 LEDC has 16 channels
+#define FADE_TICK_HZ            500         // Engine updates per second (2 ms)
+#define EASE_SEGMENTS           64          // Ease tables: 65 points, interpolated
+#define EASE_ONE                32768       // 1.0 in the ease tables (Q15)
+
+/*
+ * PART 1: The simulated LEDC backend
+ * The engine calls a function pointer to set a duty, exactly where the
+ * ESP32 would call ledcWrite(). The simulation remembers every value.
+ */
+typedef struct {
+    void (*write)(void* ctx, int channel, uint32_t duty);
+    void* ctx;
+} pwm_backend_t;
+
+typedef struct {
+    uint32_t duty[FADE_CHANNELS];
+    uint32_t writes;
+    uint32_t tick;                          // Set by the test loop
+    uint32_t last_change_tick[FADE_CHANNELS];
+} ledc_sim_t;
+
+void ledc_sim_write(void* ctx, int channel, uint32_t duty)
+{
+    ledc_sim_t* sim = (ledc_sim_t*)ctx;
+    sim->duty[channel] = duty;
+    sim->last_change_tick[channel] = sim->tick;
+    sim->writes++;
+}
+
+/*
+ * PART 2: Easing curves
+ * ease(p) maps progress 0..1 to position 0..1. Stored as 65 points in Q15
+ * and interpolated, built once with float math at startup.
+ */
+typedef enum {
+    EASE_LINEAR,        // Constant speed - uses the increment fast path
+    EASE_IN,            // Starts slow, ends fast (p^2)
+    EASE_OUT,           // Starts fast, ends slow
+    EASE_IN_OUT,        // S-curve: slow - fast - slow (smoothstep)
+    EASE_SINE,          // Half a cosine: the gentlest start and stop
+    EASE_COUNT
+} ease_t;
+
+const char* ease_names[EASE_COUNT] = {"linear", "ease-in", "ease-out", "ease-in-out", "sine"};
+uint16_t ease_table[EASE_COUNT][EASE_SEGMENTS + 1];
+
+void build_ease_tables(void)
+{
+    for (int i = 0; i <= EASE_SEGMENTS; i++) {
+        double p = (double)i / EASE_SEGMENTS;
+        double v[EASE_COUNT] = {
+            p,
+            p * p,
+            1 - (1 - p) * (1 - p),
+            p * p * (3 - 2 * p),
+            0.5 - 0.5 * cos(M_PI * p),
+        };
+        for (int e = 0; e < EASE_COUNT; e++) {
+            ease_table[e][i] = (uint16_t)lround(v[e] * EASE_ONE);
+        }
+    }
+}
+
+// progress: 0 .. 2^32-1 = 0 .. almost 1. Returns 0 .. EASE_ONE
+static inline int32_t ease_lookup(ease_t curve, uint32_t progress)
+{
+    uint32_t index = progress >> 26;                    // Top 6 bits: segment
+    uint32_t frac = (progress >> 11) & 0x7FFF;          // Next 15 bits: position in it
+    int32_t a = ease_table[curve][index];
+    int32_t b = ease_table[curve][index + 1];
+    return a + (((b - a) * (int32_t)frac) >> 15);
+}
+
+/*
+ * PART 3: The fade engine
+ * Each channel: where it is (duty x 65536), where it goes, how many
+ * ticks are left. Linear fades add a fixed increment per tick; curved
+ * fades advance a progress counter and look the curve up.
+ */
+typedef struct {
+    uint16_t duty;          // Target duty of this step
+    uint16_t duration_ms;   // 0 = jump
+    uint8_t curve;          // ease_t
+} pattern_step_t;
+
+typedef void (*fade_done_fn)(int channel, void* ctx);
+
+typedef struct {
+    bool active;
+    uint8_t curve;
+    uint32_t duty_q16;          // Current duty x 65536
+    int32_t increment_q16;      // Linear fades: added every tick
+    uint16_t start, target;
+    uint32_t progress;          // Curved fades: 0 .. 2^32 over the fade
+    uint32_t progress_step;
+    uint32_t ticks_left;
+    uint32_t written;           // Last value sent to the backend
+
+    // Pattern player: the current list of steps, and what to do at the end
+    const pattern_step_t* pattern;
+    uint16_t pattern_length;
+    uint16_t pattern_index;
+    uint16_t repeats_left;      // 0xFFFF = forever
+
+    fade_done_fn done;
+    void* done_ctx;
+} fade_channel_t;
+
+typedef struct {
+    fade_channel_t channels[FADE_CHANNELS];
+    pwm_backend_t backend;
+    uint32_t ticks;
+    uint32_t skipped_writes;    // Ticks where the duty didn't change - no write
+} fade_engine_t;
+
+void fade_init(fade_engine_t* engine, pwm_backend_t backend)
+{
+    memset(engine, 0, sizeof(*engine));
+    engine->backend = backend;
+}
+
+static uint32_t ms_to_ticks(uint32_t ms)
+{
+    return (ms * FADE_TICK_HZ + 500) / 1000;
+}
+
+// Start a fade from wherever the channel is now. Replaces a running fade.
+void fade_start(fade_engine_t* engine, int ch, uint16_t target, uint32_t duration_ms,
+                ease_t curve, fade_done_fn done, void* ctx)
+{
+    fade_channel_t* c = &engine->channels[ch];
+    uint32_t ticks = ms_to_ticks(duration_ms);
+
+    c->start = (uint16_t)((c->duty_q16 + 0x8000) >> 16);
+    c->target = target;
+    c->curve = (uint8_t)curve;
+    c->done = done;
+    c->done_ctx = ctx;
+
+    if (ticks == 0) {
+        c->duty_q16 = (uint32_t)target << 16;   // Jump: next tick writes it and finishes
+        c->ticks_left = 1;
+        c->increment_q16 = 0;
+    } else {
+        c->ticks_left = ticks;
+        // Fixed-point increment: (target - now) x 65536 / ticks, rounded
+        int64_t delta = ((int64_t)target << 16) - c->duty_q16;
+        c->increment_q16 = (int32_t)((delta + (delta >= 0 ? ticks / 2 : -(int64_t)(ticks / 2))) / ticks);
+        c->progress = 0;
+        c->progress_step = (uint32_t)((1ull << 32) / ticks);
+    }
+    c->active = true;
+}
+
+static void pattern_start_step(fade_engine_t* engine, int ch);
+
+// Called inside the tick when a fade ends: next pattern step, or the callback
+static void fade_finished(fade_engine_t* engine, int ch)
+{
+    fade_channel_t* c = &engine->channels[ch];
+    c->active = false;
+
+    if (c->pattern != NULL) {
+        if (++c->pattern_index == c->pattern_length) {
+            c->pattern_index = 0;
+            if (c->repeats_left != 0xFFFF && c->repeats_left-- <= 1) {
+                c->pattern = NULL;              // Pattern complete
+            }
+        }
+        if (c->pattern != NULL) {
+            pattern_start_step(engine, ch);
+            return;
+        }
+    }
+    if (c->done != NULL) {
+        fade_done_fn done = c->done;
+        c->done = NULL;                         // May start a new fade from inside
+        done(ch, c->done_ctx);
+    }
+}
+
+// The engine tick - one call per timer interrupt, all channels
+void fade_tick(fade_engine_t* engine)
+{
+    engine->ticks++;
+    for (int ch = 0; ch < FADE_CHANNELS; ch++) {
+        fade_channel_t* c = &engine->channels[ch];
+        if (!c->active) continue;
+
+        if (--c->ticks_left == 0) {
+            c->duty_q16 = (uint32_t)c->target << 16;    // Land exactly on the target
+        } else if (c->curve == EASE_LINEAR) {
+            c->duty_q16 += c->increment_q16;
+        } else {
+            c->progress += c->progress_step;
+            int32_t delta = (int32_t)c->target - c->start;
+            int32_t pos = ease_lookup((ease_t)c->curve, c->progress);
+            // start * 2^16 + delta * pos * 2 needs 33 bits and may be negative
+            // on the way: work in 64 bits, multiply instead of shifting
+            c->duty_q16 = (uint32_t)((int64_t)c->start * 65536 + (int64_t)delta * pos * 2);
+        }
+
+        uint32_t duty = (c->duty_q16 + 0x8000) >> 16;
+        if (duty != c->written) {
+            c->written = duty;
+            engine->backend.write(engine->backend.ctx, ch, duty);
+        } else {
+            engine->skipped_writes++;
+        }
+
+        if (c->ticks_left == 0) fade_finished(engine, ch);
+    }
+}
+
+/*
+ * PART 4: The pattern player
+ * Replaces customPWMPattern(), which wrote each step and then delay()ed.
+ * The steps array must stay valid while it plays (use const tables).
+ */
+static void pattern_start_step(fade_engine_t* engine, int ch)
+{
+    fade_channel_t* c = &engine->channels[ch];
+    const pattern_step_t* step = &c->pattern[c->pattern_index];
+    fade_done_fn done = c->done;                // Keep the pattern's callback
+    void* ctx = c->done_ctx;
+    fade_start(engine, ch, step->duty, step->duration_ms, (ease_t)step->curve, done, ctx);
+}
+
+// repeats: how many times to play the list (0xFFFF = until replaced)
+void pattern_play(fade_engine_t* engine, int ch, const pattern_step_t* steps, uint16_t length,
+                  uint16_t repeats, fade_done_fn done, void* ctx)
+{
+    fade_channel_t* c = &engine->channels[ch];
+    c->pattern = steps;
+    c->pattern_length = length;
+    c->pattern_index = 0;
+    c->repeats_left = repeats;
+    c->done = done;
+    c->done_ctx = ctx;
+    pattern_start_step(engine, ch);
+}
+
+void fade_stop(fade_engine_t* engine, int ch)
+{
+    engine->channels[ch].active = false;
+    engine->channels[ch].pattern = NULL;
+    engine->channels[ch].done = NULL;
+}
+
+/*
+ * DEMO 1: The curves - duty along a 0 -> 255 fade
+ */
+void curves_demo(void)
+{
+    printf("=== DEMO 1: Easing Curves (0 -> 255 in 1 second) ===\n");
+    printf("%-12s", "time:");
+    for (int i = 0; i <= 10; i++) printf("%5d%%", i * 10);
+    printf("\n");
+
+    for (int e = 0; e < EASE_COUNT; e++) {
+        fade_engine_t engine;
+        ledc_sim_t sim;
+        memset(&sim, 0, sizeof(sim));
+        pwm_backend_t backend = {ledc_sim_write, &sim};
+        fade_init(&engine, backend);
+        fade_start(&engine, 0, 255, 1000, (ease_t)e, NULL, NULL);
+
+        printf("%-12s%6u", ease_names[e], sim.duty[0]);
+        for (int t = 1; t <= FADE_TICK_HZ; t++) {
+            fade_tick(&engine);
+            if (t % (FADE_TICK_HZ / 10) == 0) printf("%6u", sim.duty[0]);
+        }
+        printf("\n");
+    }
+    printf("Every curve lands exactly on 255 at the last tick.\n\n");
+}
+
+/*
+ * DEMO 2: 16 channels at once - exact end values, callbacks, patterns
+ */
+typedef struct {
+    uint32_t fired;
+    uint32_t tick;
+} done_record_t;
+
+done_record_t done_log[FADE_CHANNELS];
+fade_engine_t* demo_engine;
+
+void record_done(int channel, void* ctx)
+{
+    (void)ctx;
+    done_log[channel].fired++;
+    done_log[channel].tick = demo_engine->ticks;
+}
+
+// The old customPWMPattern() example as a queued pattern: heartbeat
+const pattern_step_t heartbeat[] = {
+    {255,  60, EASE_OUT},
+    { 40, 100, EASE_IN},
+    {200,  60, EASE_OUT},
+    {  0, 280, EASE_SINE},
+    {  0, 500, EASE_LINEAR},                // Hold (stays at 0 for 500 ms)
+};
+#define HEARTBEAT_STEPS     (int)(sizeof(heartbeat) / sizeof(heartbeat[0]))
+
+void concurrency_demo(void)
+{
+    printf("=== DEMO 2: 16 Channels, One Tick - Correctness ===\n");
+
+    static fade_engine_t engine;
+    ledc_sim_t sim;
+    memset(&sim, 0, sizeof(sim));
+    memset(done_log, 0, sizeof(done_log));
+    pwm_backend_t backend = {ledc_sim_write, &sim};
+    fade_init(&engine, backend);
+    demo_engine = &engine;
+
+    // Channels 0-11: fades with different lengths, targets and curves
+    uint32_t expected_tick[FADE_CHANNELS];
+    uint16_t expected_duty[FADE_CHANNELS];
+    for (int ch = 0; ch < 12; ch++) {
+        uint32_t ms = 100 + ch * 173;
+        uint16_t target = (uint16_t)(ch & 1 ? 65535 - ch * 1000 : 30 + ch * 17);
+        fade_start(&engine, ch, target, ms, (ease_t)(ch % EASE_COUNT), record_done, NULL);
+        expected_tick[ch] = ms_to_ticks(ms);
+        expected_duty[ch] = target;
+    }
+    // Channels 12-15: the heartbeat pattern, 3 times, started at different ticks
+    uint32_t pattern_ticks = 0;
+    for (int i = 0; i < HEARTBEAT_STEPS; i++) pattern_ticks += ms_to_ticks(heartbeat[i].duration_ms);
+
+    uint32_t total_ticks = 4 * FADE_TICK_HZ;
+    for (uint32_t t = 1; t <= total_ticks; t++) {
+        sim.tick = t;
+        if (t <= 4) {
+            int ch = 11 + (int)t;
+            pattern_play(&engine, ch, heartbeat, HEARTBEAT_STEPS, 3, record_done, NULL);
+            expected_tick[ch] = t - 1 + 3 * pattern_ticks;
+            expected_duty[ch] = 0;
+        }
+        fade_tick(&engine);
+    }
+
+    int errors = 0;
+    printf("%-4s %-12s %12s %12s %10s %10s\n", "Ch", "Curve", "Done tick", "Expected", "Duty", "Callbacks");
+    for (int ch = 0; ch < FADE_CHANNELS; ch++) {
+        bool ok = done_log[ch].fired == 1 && done_log[ch].tick == expected_tick[ch] &&
+                  sim.duty[ch] == expected_duty[ch];
+        if (!ok) errors++;
+        printf("%-4d %-12s %12u %12u %10u %10u%s\n", ch,
+               ch < 12 ? ease_names[ch % EASE_COUNT] : "heartbeat x3",
+               done_log[ch].tick, expected_tick[ch], sim.duty[ch], done_log[ch].fired, ok ? "" : "  <-- WRONG");
+    }
+    printf("Backend writes: %u, skipped (duty unchanged): %u\n", sim.writes, engine.skipped_writes);
+    printf("Pattern: %u ticks per heartbeat, no drift over 3 repeats (old way: + ledcWrite\n",
+           pattern_ticks);
+    printf("and loop overhead after every delay(), so each repeat ran a bit longer)\n");
+    printf("Result: %s\n\n", errors == 0 ? "PASS" : "FAIL");
+}
+
+/*
+ * DEMO 3: Tick timing on the real clock
+ * delay()-style: do the work, then sleep 2 ms -> the work time adds up.
+ * Deadline-style (what a hardware timer does): sleep UNTIL the next 2 ms mark.
+ */
+double nanos_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+void busy_work_us(double us)
+{
+    double end = nanos_now() + us * 1000;
+    while (nanos_now() < end) {
+    }
+}
+
+void timing_demo(void)
+{
+    printf("=== DEMO 3: Tick Timing - Relative Sleep vs Deadlines ===\n");
+
+    static fade_engine_t engine;
+    ledc_sim_t sim;
+    memset(&sim, 0, sizeof(sim));
+    pwm_backend_t backend = {ledc_sim_write, &sim};
+    const uint32_t ticks = FADE_TICK_HZ;        // One second
+    const long period_ns = 1000000000L / FADE_TICK_HZ;
+
+    for (int mode = 0; mode < 2; mode++) {
+        fade_init(&engine, backend);
+        for (int ch = 0; ch < FADE_CHANNELS; ch++) {
+            fade_start(&engine, ch, 65535, 1000, EASE_IN_OUT, NULL, NULL);
+        }
+
+        struct timespec next;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        double start = nanos_now();
+        double worst_late = 0, sum_late = 0;
+
+        for (uint32_t t = 1; t <= ticks; t++) {
+            if (mode == 0) {
+                // delay(2): sleep 2 ms from NOW
+                struct timespec d = {0, period_ns};
+                nanosleep(&d, NULL);
+            } else {
+                // Timer-style: sleep until start + t x 2 ms
+                next.tv_nsec += period_ns;
+                if (next.tv_nsec >= 1000000000L) {
+                    next.tv_nsec -= 1000000000L;
+                    next.tv_sec++;
+                }
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+            }
+            double late = (nanos_now() - start) - (double)t * period_ns;
+            if (late > worst_late) worst_late = late;
+            sum_late += late;
+
+            fade_tick(&engine);
+            busy_work_us(150);                  // The rest of the program's work
+        }
+        double total_ms = (nanos_now() - start) / 1e6;
+        printf("%-28s %u ticks in %7.1f ms (should be 1000), mean late %6.2f ms, worst %6.2f ms\n",
+               mode == 0 ? "Sleep 2 ms after the work:" : "Sleep until the next mark:",
+               ticks, total_ms, sum_late / ticks / 1e6, worst_late / 1e6);
+    }
+    printf("Relative sleeps drift: each tick adds the work time. Deadlines don't -\n");
+    printf("a late tick just shortens the next sleep. (This PC's scheduler adds some\n");
+    printf("jitter of its own; an ESP32 hardware timer is accurate to a microsecond.)\n\n");
+}
+
+/*
+ * DEMO 4: Engine cost - ticks per second with all 16 channels busy
+ */
+void throughput_demo(void)
+{
+    printf("=== DEMO 4: Engine Cost ===\n");
+
+    static fade_engine_t engine;
+    ledc_sim_t sim;
+    memset(&sim, 0, sizeof(sim));
+    pwm_backend_t backend = {ledc_sim_write, &sim};
+    fade_init(&engine, backend);
+
+    const pattern_step_t ramp[] = {        // 8-bit LED fades, like the sketch
+        {255, 1000, EASE_IN_OUT},
+        {0, 1000, EASE_LINEAR},
+    };
+    for (int ch = 0; ch < FADE_CHANNELS; ch++) {
+        pattern_play(&engine, ch, ramp, 2, 0xFFFF, NULL, NULL);
+    }
+
+    const uint32_t ticks = 5000000;
+    double start = nanos_now();
+    for (uint32_t t = 0; t < ticks; t++) {
+        fade_tick(&engine);
+    }
+    double ns_per_tick = (nanos_now() - start) / ticks;
+
+    printf("16 channels, 8-bit fades up and down: %.1f ns per tick = %.2f million ticks/s\n",
+           ns_per_tick, 1e3 / ns_per_tick);
+    printf("At %d ticks/s that is %.4f%% of this PC; about 100x more on the ESP32\n",
+           FADE_TICK_HZ, ns_per_tick * FADE_TICK_HZ / 1e7);
+    printf("- still well under 1%% of one core, with loop() completely free.\n");
+    printf("Backend writes: %u of %u channel-ticks - the rest didn't change the duty\n\n",
+           sim.writes, ticks * FADE_CHANNELS);
+}
+
+int main(void)
+{
+    printf("PWM Fade Engine - Many Channels, One Timer, No delay()\n");
+    printf("======================================================\n\n");
+
+    build_ease_tables();
+    curves_demo();
+    concurrency_demo();
+    timing_demo();
+    throughput_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. One timer tick can move every PWM channel - nothing waits in delay()\n");
+    printf("2. Keep duty x 65536: fractional steps per tick add up exactly\n");
+    printf("3. Easing curves come from a 65-point table with interpolation\n");
+    printf("4. Land on the target on the last tick - never trust accumulated error\n");
+    printf("5. Callbacks and a pattern list chain fades without the caller waiting\n");
+    printf("6. Sleep until a deadline, not for a duration - or the timing drifts\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. Blocking fades freeze everything else; tick-driven fades run side by side
+ * 2. Fixed-point increments give smooth fades even when a step is < 1 PWM count
+ * 3. Curves make LEDs and motors start and stop gently
+ * 4. Only write the hardware when the value really changes
+ * 5. Check timing on the tick counter: exact, repeatable, no real clock needed
+ * 6. A hardware timer gives deadlines for free - that's why the sketch uses one
+ *
+ * Next: A tone sequencer - melodies that play while loop() keeps running!
+ */
@@ -9,10 +9,31 @@
  * 
  * This example shows how to read from common sensors using I2C
  * Hardware needed: ESP32 + I2C sensor (like BMP280, BME280, or MPU6050)
+ * 
+ * Reads go through a small transaction engine: loop() queues "write the
+ * register address, then read N bytes" descriptors, an I2C task runs
+ * everything that is waiting as ONE bus session, and a callback hands
+ * the bytes back. Think of it like ordering by phone instead of walking
+ * to the shop for every single item.
+ * (host version with simulated BMP280/MPU6050: 05_i2c_transaction_engine.c)
+ * 
+ * setup() scans the bus ONCE and asks every device for its chip ID, so
+ * a BME280 isn't mistaken for a BMP280 (both 0x76) and a DS3231 clock
+ * isn't mistaken for an MPU6050 (both 0x68). The answers go into a
+ * device registry: "who is at 0x68?" is then one array lookup.
+ * (host version with boot-time benchmarks: 06_i2c_device_registry.c)
+ * 
+ * The sensor drivers read each measurement in ONE burst, turn the
+ * BMP280's raw counts into C and Pa with the datasheet's integer
+ * formulas, and let the MPU6050 collect 1000 samples/s in its own FIFO.
+ * A small task empties the FIFO every 20 ms, 10 samples per read.
+ * (host version with sensor models and FIFO tests: 07_sensor_drivers.c)
  */
 
 #include <Arduino.h>
 #include <Wire.h>  // I2C library for ESP32
+#include <driver/i2c.h>         // ESP-IDF command lists: many transfers, one bus session
+#include <freertos/queue.h>
 
 // Common I2C sensor addresses (these are like phone numbers)
 #define BMP280_ADDRESS    0x76  // Pressure/temperature sensor
@@ -24,99 +45,592 @@
 #define SDA_PIN 21  // Data line (think: Serial Data line)
 #define SCL_PIN 22  // Clock line (think: Serial Clock line)
 
-// Simple function to scan for I2C devices
-// This is like checking which phone numbers are active
-void scanI2CDevices() {
-    Serial.println("Scanning for I2C devices...");
-    
-    int devicesFound = 0;
-    
-    // Check all possible addresses (0 to 127)
-    for (int address = 1; address < 127; address++) {
-        Wire.beginTransmission(address);  // Try to call this address
-        int error = Wire.endTransmission(); // See if anyone answers
+// Sensor registers we read in one go (burst reads)
+#define BMP280_REG_CALIB      0x88  // 24 bytes: dig_T1..dig_P9, little-endian
+#define BMP280_REG_CTRL_MEAS  0xF4  // Mode + oversampling
+#define BMP280_REG_CONFIG     0xF5  // Standby time + filter
+#define BMP280_REG_DATA       0xF7  // press[3] + temp[3], MSB first
+#define MPU6050_REG_SMPLRT_DIV 0x19 // Sample rate = 1 kHz / (1 + div)
+#define MPU6050_REG_CONFIG    0x1A  // Low-pass filter
+#define MPU6050_REG_GYRO_CFG  0x1B  // Gyro range
+#define MPU6050_REG_ACCEL_CFG 0x1C  // Accel range
+#define MPU6050_REG_FIFO_EN   0x23  // What goes into the FIFO
+#define MPU6050_REG_DATA      0x3B  // accel[3] + temp + gyro[3], int16 MSB first
+#define MPU6050_REG_USER_CTRL 0x6A  // FIFO on / reset
+#define MPU6050_REG_PWR_MGMT  0x6B  // Sleep bit
+#define MPU6050_REG_FIFO_COUNT 0x72 // Bytes in the FIFO, uint16 MSB first
+#define MPU6050_REG_FIFO_RW   0x74  // Read here to take bytes out of the FIFO
+
+// MPU6050 FIFO: 1 KB on the chip, accel + gyro = 12 bytes per sample
+#define MPU_SAMPLE_RATE_HZ    1000
+#define MPU_FIFO_SIZE         1024
+#define MPU_FIFO_SAMPLE       12
+#define MPU_FIFO_CHUNK        10    // Samples per read (120 bytes)
+#define FIFO_DRAIN_MS         20    // 20 samples waiting - far from full (85)
+
+// Transaction engine
+#define I2C_PORT        I2C_NUM_0   // The port Wire.begin() set up
+#define I2C_QUEUE_SIZE  16          // Transactions waiting for the bus
+#define I2C_MAX_BATCH   8           // Transactions per bus session
+#define I2C_MAX_WRITE   8           // Register address + a few data bytes
+#define I2C_TIMEOUT_MS  50
+
+enum I2cStatus { I2C_OK = 0, I2C_NACK = -1, I2C_PENDING = 1 };
+
+struct I2cTxn;
+typedef void (*I2cDoneCallback)(I2cTxn *txn);  // Runs in the I2C task - keep it short
+
+// One transaction: write writeLen bytes, then (repeated START) read readLen
+struct I2cTxn {
+    uint8_t address;
+    uint8_t writeLen;
+    uint8_t readLen;
+    uint8_t writeBuf[I2C_MAX_WRITE];
+    uint8_t *readBuf;
+    I2cDoneCallback done;
+    void *ctx;
+    bool repeatable;             // Safe to run twice (plain register read, not a write or FIFO)
+    volatile int status;
+};
+
+// Device registry: what setup() found on the bus
+#define FIRST_ADDRESS   0x08        // 0x00-0x07 and 0x78-0x7F are reserved
+#define LAST_ADDRESS    0x77
+#define MAX_DEVICES     16
+
+enum DeviceType { DEV_UNKNOWN, DEV_BMP280, DEV_BME280, DEV_MPU6050, DEV_DS3231,
+                  DEV_SSD1306, DEV_AT24C32, DEVICE_TYPES };
+
+// How to recognize a chip: an ID register, a check function (chips
+// without one), or - last resort - just the address
+struct I2cDriver {
+    DeviceType type;
+    const char *name;
+    uint8_t firstAddress, lastAddress;
+    bool hasId;
+    uint8_t idReg;
+    uint8_t idValue;
+    bool (*idCheck)(uint8_t address);
+};
+
+struct RegistryEntry {
+    uint8_t address;
+    const I2cDriver *driver;        // NULL = answers, but no driver knows it
+};
+
+RegistryEntry devices[MAX_DEVICES];
+int deviceCount = 0;
+uint8_t deviceByAddress[128];       // Entry index + 1, 0 = nobody there
+uint8_t deviceByType[DEVICE_TYPES]; // First entry of each type, same encoding
+
+// BMP280 factory calibration (datasheet section 3.11.2)
+struct Bmp280Calib {
+    uint16_t t1;
+    int16_t t2, t3;
+    uint16_t p1;
+    int16_t p2, p3, p4, p5, p6, p7, p8, p9;
+};
+
+struct MpuSample {
+    int16_t accel[3];   // 16384 = 1 g (+-2 g range)
+    int16_t gyro[3];    // 131 = 1 degree/s (+-250 dps range)
+};
+
+QueueHandle_t i2cQueue = NULL;      // Holds I2cTxn pointers
+uint32_t i2cSessions = 0;
+
+// Latest sensor data, filled in by the callbacks
+uint8_t bmpData[6];
+uint8_t mpuData[14];
+I2cTxn bmpRead, mpuRead;
+const RegistryEntry *pressureSensor = NULL;  // BMP280 or BME280, if found
+const RegistryEntry *motionSensor = NULL;    // MPU6050, if found
+volatile bool bmpReady = false;
+volatile bool mpuReady = false;
+
+Bmp280Calib bmpCalib;
+int32_t bmpTFine;                   // Temperature, needed by the pressure formula
+
+// FIFO results, shared between the FIFO task and loop()
+portMUX_TYPE fifoMux = portMUX_INITIALIZER_UNLOCKED;
+uint32_t fifoSamples = 0;
+uint32_t fifoOverflows = 0;
+int64_t fifoAccelSum[3] = {0, 0, 0};
+unsigned long fifoStatsStart = 0;   // millis() at the start of the current stats period
+
+/*
+ * I2C TRANSACTION ENGINE
+ * The I2C task waits for the first transaction, takes everything else
+ * that is already queued (up to 8) and sends it as one command list:
+ * START, [addr+W, reg, (repeated START) addr+R, data...] x N, STOP.
+ */
+void i2cTxnReadRegs(I2cTxn *txn, uint8_t address, uint8_t reg, uint8_t *buf, uint8_t len,
+                    I2cDoneCallback done, void *ctx = NULL) {
+    txn->address = address;
+    txn->writeLen = 1;
+    txn->writeBuf[0] = reg;      // Set the register pointer...
+    txn->readLen = len;          // ...then read len bytes (auto-increment)
+    txn->readBuf = buf;
+    txn->done = done;
+    txn->ctx = ctx;
+    txn->repeatable = true;
+}
+
+void i2cTxnWriteReg(I2cTxn *txn, uint8_t address, uint8_t reg, uint8_t value,
+                    I2cDoneCallback done, void *ctx = NULL) {
+    txn->address = address;
+    txn->writeLen = 2;
+    txn->writeBuf[0] = reg;
+    txn->writeBuf[1] = value;
+    txn->readLen = 0;
+    txn->readBuf = NULL;
+    txn->done = done;
+    txn->ctx = ctx;
+    txn->repeatable = false;     // Writing twice can be wrong (FIFO, command registers)
+}
+
+// Queue a transaction and return at once. The transaction and its read
+// buffer must stay valid until the callback ran (use globals or statics).
+bool i2cSubmit(I2cTxn *txn) {
+    txn->status = I2C_PENDING;
+    return xQueueSend(i2cQueue, &txn, 0) == pdTRUE;
+}
+
+// Add one transaction to a command list
+void i2cAddToCommand(i2c_cmd_handle_t cmd, I2cTxn *txn) {
+    i2c_master_start(cmd);  // START, or repeated START after the first
+    if (txn->writeLen > 0 || txn->readLen == 0) {
+        i2c_master_write_byte(cmd, (txn->address << 1) | I2C_MASTER_WRITE, true);
+        i2c_master_write(cmd, txn->writeBuf, txn->writeLen, true);
+    }
+    if (txn->readLen > 0) {
+        if (txn->writeLen > 0) i2c_master_start(cmd);  // Repeated START
+        i2c_master_write_byte(cmd, (txn->address << 1) | I2C_MASTER_READ, true);
+        i2c_master_read(cmd, txn->readBuf, txn->readLen, I2C_MASTER_LAST_NACK);
+    }
+}
+
+// Run transactions as one bus session
+esp_err_t i2cRunSession(I2cTxn **batch, int count) {
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    for (int i = 0; i < count; i++) {
+        i2cAddToCommand(cmd, batch[i]);
+    }
+    i2c_master_stop(cmd);
+    esp_err_t result = i2c_master_cmd_begin(I2C_PORT, cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+    i2c_cmd_link_delete(cmd);
+    i2cSessions++;
+    return result;
+}
+
+void i2cTask(void *parameter) {
+    I2cTxn *batch[I2C_MAX_BATCH];
+    while (true) {
+        // Sleep until there is work, then take what else is waiting
+        xQueueReceive(i2cQueue, &batch[0], portMAX_DELAY);
+        int count = 1;
+        while (count < I2C_MAX_BATCH && xQueueReceive(i2cQueue, &batch[count], 0) == pdTRUE) {
+            count++;
+        }
         
-        if (error == 0) {  // Device responded!
-            Serial.print("Device found at address 0x");
-            if (address < 16) Serial.print("0");  // Add leading zero
-            Serial.print(address, HEX);
-            Serial.print(" (");
-            Serial.print(address);
-            Serial.println(")");
-            devicesFound++;
+        if (i2cRunSession(batch, count) == ESP_OK) {
+            for (int i = 0; i < count; i++) batch[i]->status = I2C_OK;
+        } else {
+            // Someone didn't answer (NACK). The driver doesn't say who, and
+            // the transactions before the NACK already ran. Plain register
+            // reads are safe to repeat, so they run again one by one - only
+            // the missing device fails. Writes and FIFO reads may have
+            // happened already: they report I2C_NACK and their caller decides.
+            // (05_i2c_transaction_engine.c sees WHERE the NACK was and needs no replay.)
+            for (int i = 0; i < count; i++) {
+                bool retry = count > 1 && batch[i]->repeatable;
+                batch[i]->status = (retry && i2cRunSession(&batch[i], 1) == ESP_OK) ? I2C_OK : I2C_NACK;
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            if (batch[i]->done) batch[i]->done(batch[i]);
         }
     }
-    
-    if (devicesFound == 0) {
-        Serial.println("No I2C devices found. Check wiring!");
-    } else {
-        Serial.print("Found ");
-        Serial.print(devicesFound);
-        Serial.println(" device(s)");
-    }
+}
+
+void startI2cEngine() {
+    i2cQueue = xQueueCreate(I2C_QUEUE_SIZE, sizeof(I2cTxn *));
+    xTaskCreate(i2cTask, "I2C", 3072, NULL, 2, NULL);
+}
+
+// For setup(): queue one transaction and wait for its callback
+void wakeWaiter(I2cTxn *txn) {
+    xTaskNotifyGive((TaskHandle_t)txn->ctx);
+}
+
+int i2cTransferBlocking(I2cTxn *txn) {
+    txn->done = wakeWaiter;
+    txn->ctx = xTaskGetCurrentTaskHandle();
+    if (!i2cSubmit(txn)) return I2C_NACK;
+    // No timeout here: txn usually lives on our stack, so we must not leave
+    // before the I2C task is done with it. The driver's own I2C_TIMEOUT_MS
+    // makes sure that it always is.
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return txn->status;
+}
+
+// Read len registers from any I2C device and wait for the answer
+bool readRegisters(uint8_t deviceAddress, uint8_t registerAddress, uint8_t *buf, uint8_t len) {
+    I2cTxn txn;
+    i2cTxnReadRegs(&txn, deviceAddress, registerAddress, buf, len, NULL);
+    return i2cTransferBlocking(&txn) == I2C_OK;
 }
 
 // Simple function to read a byte from any I2C device
-// Like asking a specific question to a specific person
+// Like asking a specific question to a specific person (and waiting for the answer)
 uint8_t readByteFromDevice(uint8_t deviceAddress, uint8_t registerAddress) {
-    Wire.beginTransmission(deviceAddress);  // Call the device
-    Wire.write(registerAddress);            // Ask about specific register
-    Wire.endTransmission(false);            // Don't hang up yet
-    
-    Wire.requestFrom(deviceAddress, (uint8_t)1);  // Ask for 1 byte answer
+    uint8_t value = 0;
     
-    if (Wire.available()) {
-        return Wire.read();  // Get the answer
+    if (readRegisters(deviceAddress, registerAddress, &value, 1)) {
+        return value;  // Got the answer
     }
-    
     return 0;  // No answer received
 }
 
-// Example: Reading WHO_AM_I register (device identification)
-// This is like asking "Who are you?" to make sure we're talking to the right device
-void checkDeviceIdentity(uint8_t deviceAddress) {
-    Serial.print("Checking device at address 0x");
-    Serial.print(deviceAddress, HEX);
-    Serial.print("... ");
+// Read from a register that changes when it is read (the MPU6050 FIFO) -
+// never repeated after a failed batch, that would lose data
+bool readFifoRegister(uint8_t deviceAddress, uint8_t registerAddress, uint8_t *buf, uint8_t len) {
+    I2cTxn txn;
+    i2cTxnReadRegs(&txn, deviceAddress, registerAddress, buf, len, NULL);
+    txn.repeatable = false;
+    return i2cTransferBlocking(&txn) == I2C_OK;
+}
+
+void writeByteToDevice(uint8_t deviceAddress, uint8_t registerAddress, uint8_t value) {
+    I2cTxn txn;
+    i2cTxnWriteReg(&txn, deviceAddress, registerAddress, value, NULL);
+    i2cTransferBlocking(&txn);
+}
+
+/*
+ * DEVICE REGISTRY
+ * Knock on every door once, ask for a name badge, write it on the board
+ * in the lobby. Identification only READS - it never writes to a chip
+ * we haven't recognized yet.
+ */
+
+// The DS3231 has no ID register: its time is BCD (no nibble above 9) and
+// status bits 4-6 always read 0. Good enough to tell it from an MPU6050.
+bool ds3231Check(uint8_t address) {
+    uint8_t r[16];
+    if (!readRegisters(address, 0x00, r, sizeof(r))) return false;
+    for (int i = 0; i < 7; i++) {
+        if ((r[i] & 0x0F) > 9) return false;
+    }
+    return r[0] < 0x60 && r[1] < 0x60 && (r[0x0F] & 0x70) == 0;
+}
+
+// Order matters: exact chip IDs first, then checks, then address-only
+const I2cDriver drivers[] = {
+    {DEV_BMP280,  "BMP280",  0x76, 0x77, true,  0xD0, 0x58, NULL},
+    {DEV_BME280,  "BME280",  0x76, 0x77, true,  0xD0, 0x60, NULL},
+    {DEV_MPU6050, "MPU6050", 0x68, 0x69, true,  0x75, 0x68, NULL},
+    {DEV_DS3231,  "DS3231",  0x68, 0x68, false, 0,    0,    ds3231Check},
+    {DEV_SSD1306, "SSD1306", 0x3C, 0x3D, false, 0,    0,    NULL},  // OLED display
+    {DEV_AT24C32, "AT24C32", 0x50, 0x57, false, 0,    0,    NULL},  // EEPROM
+};
+#define DRIVER_COUNT (int)(sizeof(drivers) / sizeof(drivers[0]))
+
+// Find the driver for a device that answered. BMP280 and BME280 share
+// the ID register - it is read once and the value kept.
+const I2cDriver *identifyDevice(uint8_t address) {
+    int cachedReg = -1;
+    uint8_t value = 0;
     
-    // Most sensors have a WHO_AM_I register at address 0x75
-    uint8_t whoAmI = readByteFromDevice(deviceAddress, 0x75);
+    for (int d = 0; d < DRIVER_COUNT; d++) {
+        const I2cDriver *drv = &drivers[d];
+        if (address < drv->firstAddress || address > drv->lastAddress) continue;
+        
+        if (drv->hasId) {
+            if (cachedReg != drv->idReg) {
+                if (!readRegisters(address, drv->idReg, &value, 1)) return NULL;
+                cachedReg = drv->idReg;
+            }
+            if (value == drv->idValue) return drv;
+        } else if (drv->idCheck) {
+            if (drv->idCheck(address)) return drv;
+        } else {
+            return drv;  // Only the address to go on
+        }
+    }
+    return NULL;
+}
+
+void registerDevice(uint8_t address, const I2cDriver *driver) {
+    if (deviceCount == MAX_DEVICES) return;
+    devices[deviceCount].address = address;
+    devices[deviceCount].driver = driver;
+    deviceCount++;
+    deviceByAddress[address] = deviceCount;
+    DeviceType type = driver ? driver->type : DEV_UNKNOWN;
+    if (deviceByType[type] == 0) deviceByType[type] = deviceCount;
+}
+
+// O(1): "who is at this address?" / "where is the first sensor of this type?"
+const RegistryEntry *findDevice(uint8_t address) {
+    uint8_t i = deviceByAddress[address & 0x7F];
+    return i ? &devices[i - 1] : NULL;
+}
+
+const RegistryEntry *findDeviceType(DeviceType type) {
+    uint8_t i = deviceByType[type];
+    return i ? &devices[i - 1] : NULL;
+}
+
+// Scan once at boot. A second bus (Wire1, the ESP32's other controller)
+// could be scanned by its own task at the same time.
+void buildDeviceRegistry() {
+    Serial.println("Scanning for I2C devices...");
+    unsigned long start = micros();
     
-    Serial.print("WHO_AM_I register: 0x");
-    Serial.println(whoAmI, HEX);
+    // This is like checking which phone numbers are active
+    for (int address = FIRST_ADDRESS; address <= LAST_ADDRESS; address++) {
+        Wire.beginTransmission(address);  // Try to call this address
+        if (Wire.endTransmission() == 0) {  // Device responded!
+            registerDevice(address, identifyDevice(address));
+        }
+    }
     
-    // Common WHO_AM_I values:
-    if (whoAmI == 0x58) {
-        Serial.println("This might be a BMP280!");
-    } else if (whoAmI == 0x60) {
-        Serial.println("This might be a BME280!");
-    } else if (whoAmI == 0x68) {
-        Serial.println("This might be an MPU6050!");
-    } else {
-        Serial.println("Unknown device or different register address");
+    for (int i = 0; i < deviceCount; i++) {
+        Serial.print("Device found at address 0x");
+        if (devices[i].address < 16) Serial.print("0");  // Add leading zero
+        Serial.print(devices[i].address, HEX);
+        Serial.print(": ");
+        Serial.println(devices[i].driver ? devices[i].driver->name : "unknown chip");
+    }
+    if (deviceCount == 0) {
+        Serial.println("No I2C devices found. Check wiring!");
     }
+    Serial.print("Registry ready in ");
+    Serial.print((micros() - start) / 1000.0);
+    Serial.println(" ms");
+}
+
+/*
+ * BMP280 DRIVER (BME280: same registers for temperature and pressure)
+ * Calibration is read once; every reading is one 6-byte burst.
+ */
+bool bmp280Begin(uint8_t address) {
+    uint8_t raw[24];
+    if (!readRegisters(address, BMP280_REG_CALIB, raw, sizeof(raw))) return false;
+    
+    uint16_t w[12];
+    for (int i = 0; i < 12; i++) w[i] = raw[2 * i] | (raw[2 * i + 1] << 8);
+    bmpCalib.t1 = w[0];
+    bmpCalib.t2 = (int16_t)w[1];
+    bmpCalib.t3 = (int16_t)w[2];
+    bmpCalib.p1 = w[3];
+    bmpCalib.p2 = (int16_t)w[4];
+    bmpCalib.p3 = (int16_t)w[5];
+    bmpCalib.p4 = (int16_t)w[6];
+    bmpCalib.p5 = (int16_t)w[7];
+    bmpCalib.p6 = (int16_t)w[8];
+    bmpCalib.p7 = (int16_t)w[9];
+    bmpCalib.p8 = (int16_t)w[10];
+    bmpCalib.p9 = (int16_t)w[11];
+    
+    writeByteToDevice(address, BMP280_REG_CONFIG, 0x00);     // 0.5 ms standby, no filter
+    writeByteToDevice(address, BMP280_REG_CTRL_MEAS, 0x27);  // x1 oversampling, normal mode
+    return true;
+}
+
+// Datasheet integer formulas: temperature in 0.01 C...
+int32_t bmp280CompensateT(int32_t adcT) {
+    const Bmp280Calib &c = bmpCalib;
+    int32_t var1 = ((((adcT >> 3) - ((int32_t)c.t1 << 1))) * (int32_t)c.t2) >> 11;
+    int32_t var2 = (((((adcT >> 4) - (int32_t)c.t1) * ((adcT >> 4) - (int32_t)c.t1)) >> 12) *
+                    (int32_t)c.t3) >> 14;
+    bmpTFine = var1 + var2;
+    return (bmpTFine * 5 + 128) >> 8;
 }
 
-// Simple temperature reading example (works with many sensors)
-float readSimpleTemperature(uint8_t deviceAddress) {
-    // This is a simplified example - real sensors need calibration
-    // Read raw temperature data (usually 2 bytes)
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(0x22);  // Temperature register (example address)
-    Wire.endTransmission(false);
+// ...and pressure in Pa * 256. Call bmp280CompensateT first (bmpTFine).
+uint32_t bmp280CompensateP(int32_t adcP) {
+    const Bmp280Calib &c = bmpCalib;
+    int64_t var1 = (int64_t)bmpTFine - 128000;
+    int64_t var2 = var1 * var1 * c.p6;
+    var2 = var2 + ((var1 * c.p5) * 131072);
+    var2 = var2 + ((int64_t)c.p4 * 34359738368LL);
+    var1 = ((var1 * var1 * c.p3) / 256) + ((var1 * c.p2) * 4096);
+    var1 = ((140737488355328LL + var1) * c.p1) >> 33;
+    if (var1 == 0) return 0;  // Avoid dividing by zero
+    int64_t p = 1048576 - adcP;
+    p = (((p * 2147483648LL) - var2) * 3125) / var1;
+    var1 = ((int64_t)c.p9 * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t)c.p8 * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + ((int64_t)c.p7 << 4);
+    return (uint32_t)p;
+}
+
+/*
+ * MPU6050 DRIVER
+ * One 14-byte burst for a snapshot, and the chip's FIFO for every sample:
+ * the chip stores them, the FIFO task takes them out in big chunks.
+ */
+void mpu6050Begin(uint8_t address) {
+    writeByteToDevice(address, MPU6050_REG_PWR_MGMT, 0x01);   // Awake, gyro X as clock
+    writeByteToDevice(address, MPU6050_REG_CONFIG, 0x01);     // Low-pass 184 Hz, 1 kHz base rate
+    writeByteToDevice(address, MPU6050_REG_SMPLRT_DIV, 1000 / MPU_SAMPLE_RATE_HZ - 1);
+    writeByteToDevice(address, MPU6050_REG_GYRO_CFG, 0x00);   // +-250 dps
+    writeByteToDevice(address, MPU6050_REG_ACCEL_CFG, 0x00);  // +-2 g
+    writeByteToDevice(address, MPU6050_REG_FIFO_EN, 0x78);    // Accel + gyro X/Y/Z
+    writeByteToDevice(address, MPU6050_REG_USER_CTRL, 0x44);  // FIFO on + reset
+}
+
+// Take up to max whole samples out of the FIFO. A full FIFO has thrown
+// away its oldest bytes and lost track of where samples start: reset it.
+// Returns -1 on overflow.
+int mpu6050FifoDrain(uint8_t address, MpuSample *out, int max) {
+    uint8_t c[2];
+    if (!readRegisters(address, MPU6050_REG_FIFO_COUNT, c, 2)) return 0;
+    int count = (c[0] << 8) | c[1];
+    if (count >= MPU_FIFO_SIZE) {
+        writeByteToDevice(address, MPU6050_REG_USER_CTRL, 0x44);
+        return -1;
+    }
     
-    Wire.requestFrom(deviceAddress, (uint8_t)2);  // Request 2 bytes
+    int n = min(count / MPU_FIFO_SAMPLE, max);
+    uint8_t buf[MPU_FIFO_CHUNK * MPU_FIFO_SAMPLE];
+    for (int done = 0; done < n; ) {
+        int chunk = min(n - done, MPU_FIFO_CHUNK);
+        // The FIFO register doesn't auto-increment: 120 bytes = 120 FIFO bytes
+        if (!readFifoRegister(address, MPU6050_REG_FIFO_RW, buf, chunk * MPU_FIFO_SAMPLE)) return done;
+        for (int i = 0; i < chunk; i++) {
+            const uint8_t *d = &buf[i * MPU_FIFO_SAMPLE];
+            for (int a = 0; a < 3; a++) {
+                out[done + i].accel[a] = (int16_t)((d[2 * a] << 8) | d[2 * a + 1]);
+                out[done + i].gyro[a] = (int16_t)((d[6 + 2 * a] << 8) | d[7 + 2 * a]);
+            }
+        }
+        done += chunk;
+    }
+    return n;
+}
+
+// Empties the FIFO every 20 ms, no matter how long loop() takes
+void fifoTask(void *parameter) {
+    uint8_t address = motionSensor->address;
+    MpuSample samples[MPU_FIFO_SIZE / MPU_FIFO_SAMPLE];
+    TickType_t lastWake = xTaskGetTickCount();
     
-    if (Wire.available() >= 2) {
-        uint16_t rawTemp = Wire.read() << 8;  // High byte first
-        rawTemp |= Wire.read();               // Add low byte
+    while (true) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(FIFO_DRAIN_MS));
+        int n = mpu6050FifoDrain(address, samples, MPU_FIFO_SIZE / MPU_FIFO_SAMPLE);
         
-        // Convert to temperature (this formula varies by sensor)
-        float temperature = (float)rawTemp / 100.0;  // Example conversion
-        return temperature;
+        int32_t sum[3] = {0, 0, 0};
+        for (int i = 0; i < n; i++) {
+            for (int a = 0; a < 3; a++) sum[a] += samples[i].accel[a];
+        }
+        portENTER_CRITICAL(&fifoMux);
+        if (n < 0) {
+            fifoOverflows++;
+        } else {
+            fifoSamples += n;
+            for (int a = 0; a < 3; a++) fifoAccelSum[a] += sum[a];
+        }
+        portEXIT_CRITICAL(&fifoMux);
+    }
+}
+
+// Sensor reading: ONE burst read per sensor, both in one bus session.
+// A burst read is also the only way to get bytes from the same sample -
+// reading MSB and LSB separately can mix an old and a new measurement.
+void onBmpData(I2cTxn *txn) {
+    bmpReady = (txn->status == I2C_OK);
+}
+
+void onMpuData(I2cTxn *txn) {
+    mpuReady = (txn->status == I2C_OK);
+}
+
+void requestSensorReadings() {
+    bmpReady = mpuReady = false;
+    // BME280 keeps pressure + temperature at the same registers as the BMP280
+    if (pressureSensor) {
+        i2cTxnReadRegs(&bmpRead, pressureSensor->address, BMP280_REG_DATA, bmpData, 6, onBmpData);
+        i2cSubmit(&bmpRead);
+    }
+    if (motionSensor) {
+        i2cTxnReadRegs(&mpuRead, motionSensor->address, MPU6050_REG_DATA, mpuData, 14, onMpuData);
+        i2cSubmit(&mpuRead);
+    }
+}
+
+void printDeviceName(const RegistryEntry *entry) {
+    Serial.print(entry->driver->name);
+    Serial.print(" at 0x");
+    Serial.print(entry->address, HEX);
+    Serial.print(": ");
+}
+
+void printSensorReadings() {
+    if (pressureSensor) printDeviceName(pressureSensor);
+    if (bmpReady) {
+        // 20-bit raw values -> 0.01 C and Pa * 256 (temperature first!)
+        int32_t rawPress = ((uint32_t)bmpData[0] << 12) | (bmpData[1] << 4) | (bmpData[2] >> 4);
+        int32_t rawTemp = ((uint32_t)bmpData[3] << 12) | (bmpData[4] << 4) | (bmpData[5] >> 4);
+        int32_t centiC = bmp280CompensateT(rawTemp);
+        uint32_t pressure = bmp280CompensateP(rawPress) / 256;
+        Serial.print(centiC / 100.0, 2);
+        Serial.print("°C, ");
+        Serial.print(pressure / 100.0, 2);
+        Serial.println(" hPa");
+    } else if (pressureSensor) {
+        Serial.println("No data");
     }
     
-    return -999.0;  // Error value
+    if (motionSensor) printDeviceName(motionSensor);
+    if (mpuReady) {
+        int16_t v[7];
+        for (int i = 0; i < 7; i++) v[i] = (int16_t)((mpuData[2 * i] << 8) | mpuData[2 * i + 1]);
+        Serial.print("accel ");
+        for (int a = 0; a < 3; a++) {
+            Serial.print((int32_t)v[a] * 1000 / 16384);  // mg
+            Serial.print(a < 2 ? "/" : " mg, gyro ");
+        }
+        for (int g = 4; g < 7; g++) {
+            Serial.print((int32_t)v[g] * 100 / 131 / 100.0, 2);  // degrees/s
+            Serial.print(g < 6 ? "/" : " dps, ");
+        }
+        int16_t rawTemp = v[3];
+        // MPU6050 datasheet: temperature = raw / 340 + 36.53 (in hundredths: integer math)
+        int32_t centiC = (int32_t)rawTemp * 100 / 340 + 3653;
+        Serial.print(centiC / 100);
+        Serial.print(".");
+        Serial.print(abs(centiC % 100) / 10);
+        Serial.println("°C");
+    } else if (motionSensor) {
+        Serial.println("No data");
+    }
+}
+
+void printFifoStats(unsigned long elapsedMs) {
+    portENTER_CRITICAL(&fifoMux);
+    uint32_t samples = fifoSamples;
+    uint32_t overflows = fifoOverflows;
+    int64_t sum[3] = {fifoAccelSum[0], fifoAccelSum[1], fifoAccelSum[2]};
+    fifoSamples = 0;
+    fifoAccelSum[0] = fifoAccelSum[1] = fifoAccelSum[2] = 0;
+    portEXIT_CRITICAL(&fifoMux);
+    
+    Serial.print("MPU6050 FIFO: ");
+    Serial.print(samples * 1000.0 / elapsedMs, 0);
+    Serial.print(" samples/s, ");
+    Serial.print(overflows);
+    Serial.print(" overflows");
+    if (samples > 0) {
+        Serial.print(", average accel ");
+        for (int a = 0; a < 3; a++) {
+            Serial.print((int32_t)(sum[a] / samples * 1000 / 16384));
+            Serial.print(a < 2 ? "/" : " mg");
+        }
+    }
+    Serial.println();
 }
 
 void setup() {
@@ -132,41 +646,43 @@ void setup() {
     Wire.setClock(100000);  // Set speed to 100kHz (standard speed)
     // Higher speeds: 400kHz (fast), 1MHz (fast+)
     
+    startI2cEngine();
+    
     delay(1000);  // Wait for devices to wake up
     
-    // Scan for devices
-    scanI2CDevices();
+    // Scan for devices - once. loop() only asks the registry.
+    buildDeviceRegistry();
+    
+    pressureSensor = findDeviceType(DEV_BMP280);
+    if (!pressureSensor) pressureSensor = findDeviceType(DEV_BME280);
+    motionSensor = findDeviceType(DEV_MPU6050);
     
-    Serial.println("\nChecking common sensor addresses:");
-    checkDeviceIdentity(BMP280_ADDRESS);
-    checkDeviceIdentity(MPU6050_ADDRESS);
+    // Both sensors start asleep: the drivers configure and wake them
+    if (pressureSensor && !bmp280Begin(pressureSensor->address)) pressureSensor = NULL;
+    if (motionSensor) {
+        mpu6050Begin(motionSensor->address);
+        fifoStatsStart = millis();
+        xTaskCreate(fifoTask, "MPU FIFO", 4096, NULL, 2, NULL);
+    }
 }
 
 void loop() {
     Serial.println("\n--- I2C Reading Example ---");
     
-    // Try to read temperature from different possible sensors
-    float temp1 = readSimpleTemperature(BMP280_ADDRESS);
-    float temp2 = readSimpleTemperature(MPU6050_ADDRESS);
+    // Ask for both sensors at once - this returns immediately, the I2C
+    // task reads them in one bus session while loop() does other things
+    requestSensorReadings();
     
-    Serial.print("Temperature from 0x76: ");
-    if (temp1 != -999.0) {
-        Serial.print(temp1);
-        Serial.println("°C");
-    } else {
-        Serial.println("No data");
-    }
+    delay(20);  // Stands in for "the rest of your program"
+    printSensorReadings();
     
-    Serial.print("Temperature from 0x68: ");
-    if (temp2 != -999.0) {
-        Serial.print(temp2);
-        Serial.println("°C");
-    } else {
-        Serial.println("No data");
+    if (motionSensor) {
+        printFifoStats(millis() - fifoStatsStart);
+        fifoStatsStart = millis();
     }
     
-    // Scan for devices periodically
-    scanI2CDevices();
+    Serial.print("I2C bus sessions so far: ");
+    Serial.println(i2cSessions);
     
     delay(5000);  // Wait 5 seconds before next reading
 }
@@ -186,12 +702,20 @@ void loop() {
  * 2. Some sensors need pull-up resistors (4.7kΩ) on SDA and SCL
  * 3. Many breakout boards have built-in pull-ups
  * 4. Connect multiple sensors to the same SDA/SCL lines
+ * 5. Wire and the I2C task share port 0 - only use Wire while no
+ *    transactions are queued (here: the scan in setup() waits for each ID read)
+ * 6. If a device NACKs in the middle of a batch, the driver doesn't say
+ *    which one. Plain register reads in that batch run again one by one;
+ *    writes and FIFO reads are reported as failed, never sent twice
  * 
  * Troubleshooting:
  * - No devices found? Check wiring and power
  * - Wrong readings? Check sensor datasheet for correct registers
  * - Communication errors? Try lower clock speed (10kHz)
  * - Multiple devices? Make sure each has unique address
+ *   (MPU6050 and DS3231 both use 0x68: tie the MPU6050's AD0 pin high
+ *   for 0x69, or put the clock on the second I2C bus)
+ * - "unknown chip"? Add it to drivers[] with its address and ID register
  * 
  * Common I2C Sensors to Try:
  * - BMP280/BME280: Temperature, pressure, humidity
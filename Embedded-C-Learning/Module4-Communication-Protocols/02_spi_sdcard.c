@@ -9,11 +9,54 @@
  * 
  * This example shows SD card reading and simple display control
  * Hardware needed: ESP32 + SD card module + SPI display (optional)
+ * 
+ * Sensor data goes into a binary log split into SEGMENTS (/log/SEG00001.BIN,
+ * SEG00002.BIN, ...) of up to 256 blocks. Every 512-byte block (one SD
+ * sector) has a header with its first/last time and a CRC-32. Records
+ * collect in a RAM block; at a sync point (every 100 records or 10 seconds)
+ * the half-full block is written in place and rewritten when it fills.
+ * A full segment gets a sparse time index at its end, so a time-range
+ * query jumps straight to the right block. At boot a recovery scan cuts
+ * off a torn tail left by a power cut and seals the segment.
+ * (host version with real files and simulated power cuts:
+ *  09_log_segments.c)
+ * 
+ * Inside a block the records are stored column by column and compressed:
+ * delta-of-delta times, Gorilla XOR temperatures, bit-packed humidity and
+ * light deltas. A block takes records until the ENCODED size reaches 496
+ * bytes - a few hundred readings instead of 49.
+ * (host version and the PC decoder for these files:
+ *  10_log_compression.c)
+ * 
+ * The SD card and the display share the bus, each with its own clock and
+ * mode (SPISettings) instead of 1 MHz for everyone. Display transfers are
+ * queued to an SPI task, which sends them in pieces of up to 4092 bytes
+ * and gives the bus back between pieces - a whole frame never makes the
+ * SD card wait.
+ * (host version with a simulated bus that counts busy time:
+ *  11_spi_bus_manager.c)
+ * 
+ * The display shows a sensor dashboard drawn into a framebuffer in RAM
+ * (8 bits per pixel). Drawing marks dirty rectangles, and only those go
+ * to the display, each through its own window - about 10 KB per frame
+ * instead of 150 KB.
+ * (host version with 1/8/16 bits per pixel and PPM frame dumps:
+ *  12_framebuffer.c)
+ * 
+ * /log/INDEX.BIN caches the name, size and time of every segment (24
+ * bytes each), updated when the log starts or seals a segment. The log
+ * folder is listed a page at a time from it - no file is opened, so
+ * 10,000 segments list as fast as 10. At boot only the newest segment
+ * needs recovering: every older one was sealed when the log rotated.
+ * (host version with a 10,000-file benchmark:
+ *  13_directory_cache.c)
  */
 
 #include <Arduino.h>
 #include <SPI.h>
 #include <SD.h>
+#include <unistd.h>   // truncate() - the SD library's File has none
+#include <freertos/queue.h>
 
 // SPI pin definitions for ESP32
 #define SCK_PIN   18  // Serial Clock (like a metronome)
@@ -21,25 +64,273 @@
 #define MOSI_PIN  23  // Master Out, Slave In (data going from ESP32)
 #define CS_SD     5   // Chip Select for SD card
 #define CS_DISPLAY 2  // Chip Select for display (if you have one)
+#define DC_DISPLAY 4  // Data/Command select for the display
+
+// Every device gets its own speed - the slowest one no longer sets the pace
+#define SD_CLOCK_HZ       20000000  // Most SD cards manage 20-25 MHz in SPI mode
+#define DISPLAY_CLOCK_HZ  40000000  // ILI9341/ST7789 writes: 40 MHz is common
+
+// SPI bus manager
+#define SPI_PIECE_BYTES   4092      // Largest piece before the bus is given back
+#define DISPLAY_WIDTH     240
+#define DISPLAY_HEIGHT    320
+#define DISPLAY_FRAME_MS  100       // Update the dashboard 10 times a second
+
+// Framebuffer: 8 bits per pixel (RGB332) = 75 KB; 16 bits would take 150 KB
+#define FB_MAX_DIRTY      8         // Dirty rectangles per frame
+#define FB_MERGE_SLACK    64        // Extra pixels worth saving a window
+#define SPI_QUEUE_SIZE    (FB_MAX_DIRTY * 3)  // A whole flush: 3 transactions per window
+
+// RGB565 colours
+#define BLACK             0x0000
+#define WHITE             0xFFFF
+#define GREEN             0x07E0
+#define RED               0xF800
+#define YELLOW            0xFFE0
+#define ORANGE            0xFD20
+#define CYAN              0x07FF
+#define GRAY              0x8410
+#define DARK_GRAY         0x2104
+#define NAVY              0x000F
+
+// Segmented sensor log
+#define LOG_DIR               "/log"
+#define LOG_MOUNT             "/sd"   // Where the SD library mounts the card (for truncate)
+#define LOG_BLOCK_SIZE        512     // One SD sector
+#define LOG_BLOCK_HEADER      16      // "LC", count[2], first time[4], last time[4], crc32[4]
+#define LOG_PAYLOAD_BITS      ((LOG_BLOCK_SIZE - LOG_BLOCK_HEADER) * 8)
+#define LOG_BLOCK_MAX_RECORDS 512     // RAM for the columns: 512 * 11 bytes
+#define LOG_FORMAT_VERSION    2       // 2 = compressed columns ("LC" blocks)
+#define LOG_V1_RECORD_SIZE    10      // Version 1 ("LB" blocks): type, time[4], temp[2], humidity, light[2]
+#define LOG_V1_MAX_RECORDS    ((LOG_BLOCK_SIZE - LOG_BLOCK_HEADER) / LOG_V1_RECORD_SIZE)  // 49
+#define LOG_SEGMENT_BLOCKS    256     // 128 KB per segment - hours of readings
+#define LOG_INDEX_EVERY       4       // One index entry (time[4], block[4]) per 4 blocks
+#define LOG_INDEX_ENTRY_SIZE  8
+#define LOG_TRAILER_SIZE      16      // "IDX1", entries[4], data blocks[4], crc32[4]
+#define LOG_INDEX_MAX         (LOG_SEGMENT_BLOCKS / LOG_INDEX_EVERY)
+
+// Directory cache for /log
+#define DIR_INDEX_PATH        LOG_DIR "/INDEX.BIN"
+#define DIR_HEADER_SIZE       16      // "DIX1", first slot[4], slots[4], crc32[4]
+#define DIR_ENTRY_SIZE        24      // name[12], size[4], time[4], crc32[4]
+#define DIR_NAME_LEN          12      // "SEG00001.BIN"
+#define LIST_PAGE_ENTRIES     20
+#define LOG_SYNC_RECORDS      100     // Sync point every 100 records...
+#define LOG_SYNC_MS           10000   // ...or every 10 seconds, whichever comes first
+#define LOG_INTERVAL_MS       100     // 10 records per second
 
 // Simple variables to track our data
 bool sdCardReady = false;
 int fileCount = 0;
 
+// One device on the shared bus: its own chip select and settings
+struct SpiDevice {
+    const char *name;
+    uint8_t csPin;
+    int8_t dcPin;               // Data/Command pin, -1 if the device has none
+    SPISettings settings;
+};
+
+// A queued transfer: an optional command byte (D/C low), then length
+// bytes, 'repeat' times in a row. rx gets the answer. With a fill
+// callback, tx is a row buffer that fill() refills before every repeat -
+// how framebuffer rows become RGB565 just before they go out.
+struct SpiTxn;
+typedef void (*SpiDoneCallback)(SpiTxn *txn);
+typedef void (*SpiFillCallback)(SpiTxn *txn, uint16_t index);
+
+struct SpiTxn {
+    SpiDevice *device;
+    int16_t command;            // Display command byte, -1 = none
+    const uint8_t *tx;
+    uint8_t *rx;                // NULL: ignore what comes back (only with repeat = 1)
+    uint32_t length;
+    uint16_t repeat;
+    SpiFillCallback fill;       // NULL: send tx as it is
+    SpiDoneCallback done;
+    void *ctx;                  // For fill() and done()
+};
+
+// A changed area of the framebuffer
+struct DirtyRect {
+    int16_t x, y, w, h;
+};
+
+// One display window: column set, page set, memory write + pixels
+struct FlushWindow {
+    DirtyRect rect;
+    uint8_t columns[4];
+    uint8_t pages[4];
+    SpiTxn columnSet;
+    SpiTxn pageSet;
+    SpiTxn memoryWrite;
+};
+
+// Bit streams for the compressed columns, MSB first.
+// A writer without a buffer only counts bits.
+struct BitWriter {
+    uint8_t* buf;
+    uint32_t bits;
+};
+
+struct BitReader {
+    const uint8_t* buf;
+    uint32_t bits;
+};
+
+// Delta-of-delta timestamps: a steady rhythm costs 1 bit per record
+struct TimeCoder {
+    uint32_t prevTime;
+    uint32_t prevDelta;
+};
+
+// Gorilla XOR floats: an unchanged value costs 1 bit
+struct XorCoder {
+    uint32_t prev;
+    int lead;                   // Leading/trailing zeros of the last window (lead < 0: none)
+    int trail;
+    bool started;
+};
+
+// The log writer: one segment file open, the current block's columns in RAM
+File logFile;
+uint32_t logSegment = 0;        // Number of the open (or last) segment
+uint32_t logBlocks = 0;         // Blocks finished in the open segment
+uint8_t logBlock[LOG_BLOCK_SIZE];
+uint16_t logCount = 0;          // Records in the RAM columns
+uint32_t colTime[LOG_BLOCK_MAX_RECORDS];
+float colTemp[LOG_BLOCK_MAX_RECORDS];
+uint32_t colHumidity[LOG_BLOCK_MAX_RECORDS];
+uint32_t colLight[LOG_BLOCK_MAX_RECORDS];
+TimeCoder sizeTime;             // Running size of the block as records arrive
+XorCoder sizeTemp;
+BitWriter sizeBits;
+int humidityWidth = 0;
+int lightWidth = 0;
+uint32_t logEncodeMicros = 0;   // Time of the last block encode
+uint32_t logLastTime = 0;
+uint32_t logSinceSync = 0;      // Records since the last sync point
+uint32_t logRecords = 0;
+uint32_t logTimeBase = 0;       // No RTC: log time = millis() + the last boot's end
+uint32_t logIndexTime[LOG_INDEX_MAX];
+uint32_t logIndexBlock[LOG_INDEX_MAX];
+uint32_t logIndexCount = 0;
+
+// Directory cache: slots [dirFirst, dirSlots) are the segments, oldest first
+File dirIndex;
+uint32_t dirFirst = 0;
+uint32_t dirSlots = 0;
+uint32_t dirLastNumber = 0;     // Newest segment in the index
+uint32_t dirLastTime = 0;       // Its time (log time, seconds)
+unsigned long lastSyncTime = 0;
+
+// The display on the shared bus, and what the SPI task has done
+SpiDevice displayDevice = {"Display", CS_DISPLAY, DC_DISPLAY,
+                           SPISettings(DISPLAY_CLOCK_HZ, MSBFIRST, SPI_MODE0)};
+QueueHandle_t spiQueue = NULL;      // Holds SpiTxn pointers
+volatile uint32_t spiBytes = 0;
+volatile uint32_t spiPieces = 0;
+volatile uint32_t spiBusyMicros = 0;
+uint32_t logWorstSyncMicros = 0;    // Slowest SD sync - does the display get in the way?
+
+// Framebuffer and its dirty rectangles
+uint8_t frameBuffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];  // RGB332 pixels
+uint16_t fbPalette[256];            // RGB332 -> RGB565, bytes already swapped for the wire
+DirtyRect fbDirty[FB_MAX_DIRTY];
+int fbDirtyCount = 0;
+FlushWindow flushWindows[FB_MAX_DIRTY];
+uint16_t flushRow[DISPLAY_WIDTH];     // One row of RGB565, filled by the SPI task
+volatile bool flushBusy = false;
+uint32_t framesFlushed = 0;
+uint32_t flushPixels = 0;
+uint8_t dotSprite[12 * 12];         // Heartbeat dot, RGB332
+
+// Latest reading, for the dashboard
+float lastTemperature = 0;
+int lastHumidity = 0;
+int lastLight = 0;
+
+// 5x7 font, one byte per column, top pixel in bit 0 - ' ' to 'Z'
+// (only the characters the dashboard needs are filled in)
+const uint8_t font5x7[59][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // space
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // !
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // "
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // #
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // $
+    {0x23, 0x13, 0x08, 0x64, 0x62},  // %
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // &
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // '
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // (
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // )
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // *
+    {0x08, 0x08, 0x3E, 0x08, 0x08},  // +
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // ,
+    {0x08, 0x08, 0x08, 0x08, 0x08},  // -
+    {0x00, 0x60, 0x60, 0x00, 0x00},  // .
+    {0x20, 0x10, 0x08, 0x04, 0x02},  // /
+    {0x3E, 0x51, 0x49, 0x45, 0x3E},  // 0
+    {0x00, 0x42, 0x7F, 0x40, 0x00},  // 1
+    {0x42, 0x61, 0x51, 0x49, 0x46},  // 2
+    {0x21, 0x41, 0x45, 0x4B, 0x31},  // 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10},  // 4
+    {0x27, 0x45, 0x45, 0x45, 0x39},  // 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x30},  // 6
+    {0x01, 0x71, 0x09, 0x05, 0x03},  // 7
+    {0x36, 0x49, 0x49, 0x49, 0x36},  // 8
+    {0x06, 0x49, 0x49, 0x29, 0x1E},  // 9
+    {0x00, 0x36, 0x36, 0x00, 0x00},  // :
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // ;
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // <
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // =
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // >
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // ?
+    {0x00, 0x00, 0x00, 0x00, 0x00},  // @
+    {0x7E, 0x11, 0x11, 0x11, 0x7E},  // A
+    {0x7F, 0x49, 0x49, 0x49, 0x36},  // B
+    {0x3E, 0x41, 0x41, 0x41, 0x22},  // C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C},  // D
+    {0x7F, 0x49, 0x49, 0x49, 0x41},  // E
+    {0x7F, 0x09, 0x09, 0x09, 0x01},  // F
+    {0x3E, 0x41, 0x49, 0x49, 0x7A},  // G
+    {0x7F, 0x08, 0x08, 0x08, 0x7F},  // H
+    {0x00, 0x41, 0x7F, 0x41, 0x00},  // I
+    {0x20, 0x40, 0x41, 0x3F, 0x01},  // J
+    {0x7F, 0x08, 0x14, 0x22, 0x41},  // K
+    {0x7F, 0x40, 0x40, 0x40, 0x40},  // L
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F},  // M
+    {0x7F, 0x04, 0x08, 0x10, 0x7F},  // N
+    {0x3E, 0x41, 0x41, 0x41, 0x3E},  // O
+    {0x7F, 0x09, 0x09, 0x09, 0x06},  // P
+    {0x3E, 0x41, 0x51, 0x21, 0x5E},  // Q
+    {0x7F, 0x09, 0x19, 0x29, 0x46},  // R
+    {0x46, 0x49, 0x49, 0x49, 0x31},  // S
+    {0x01, 0x01, 0x7F, 0x01, 0x01},  // T
+    {0x3F, 0x40, 0x40, 0x40, 0x3F},  // U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F},  // V
+    {0x3F, 0x40, 0x38, 0x40, 0x3F},  // W
+    {0x63, 0x14, 0x08, 0x14, 0x63},  // X
+    {0x07, 0x08, 0x70, 0x08, 0x07},  // Y
+    {0x61, 0x51, 0x49, 0x45, 0x43},  // Z
+};
+
+// CRC-32 lookup table (1 KB) for checking log records
+// Think of it as a fingerprint on every line - a flipped bit changes the fingerprint
+uint32_t crc32Table[256];
+
 // Function to initialize SPI communication
 // Think of this as setting up the phone system
 void initializeSPI() {
     Serial.println("Setting up SPI communication...");
     
-    // Start SPI with default settings
+    // Start SPI - no bus-wide speed: every device brings its own settings
+    // (clock, mode, bit order) and they are switched in with each
+    // beginTransaction(). Like dialing rules per extension.
     SPI.begin(SCK_PIN, MISO_PIN, MOSI_PIN);  // ESP32 specific pins
     // For Arduino Uno, just use: SPI.begin();
     
-    // Set SPI settings (like dialing rules)
-    SPI.setFrequency(1000000);    // 1MHz - start slow for reliability
-    SPI.setDataMode(SPI_MODE0);   // Clock polarity and phase
-    SPI.setBitOrder(MSBFIRST);    // Most significant bit first
-    
+    initDisplay();
+    startSpiManager();
     Serial.println("SPI ready!");
 }
 
@@ -49,7 +340,7 @@ bool initializeSDCard() {
     Serial.print("Initializing SD card... ");
     
     // Try to begin SD card communication
-    if (!SD.begin(CS_SD)) {
+    if (!SD.begin(CS_SD, SPI, SD_CLOCK_HZ)) {
         Serial.println("FAILED!");
         Serial.println("Check SD card and wiring");
         return false;
@@ -141,10 +432,11 @@ void readFile(const char* filename) {
     File file = SD.open(filename);
     
     if (file) {
-        // Read and print each line
-        while (file.available()) {
-            String line = file.readStringUntil('\n');  // Read until newline
-            Serial.println(line);
+        // Read in chunks - no String per line, no heap churn
+        uint8_t chunk[64];
+        size_t n;
+        while ((n = file.read(chunk, sizeof(chunk))) > 0) {
+            Serial.write(chunk, n);
         }
         
         file.close();
@@ -153,52 +445,1210 @@ void readFile(const char* filename) {
     }
 }
 
-// Simple function to send data to SPI display (if you have one)
-// Think of this as writing on a whiteboard
-void sendToDisplay(uint8_t data) {
-    // Select the display (pick up the right phone)
-    digitalWrite(CS_DISPLAY, LOW);
+/*
+ * SPI BUS MANAGER
+ * Display transfers are queued and sent by the SPI task. Each piece
+ * (at most 4092 bytes) is one beginTransaction()/endTransaction():
+ * the display's settings go on the bus, CS goes low, the bytes go out,
+ * CS goes high, and the bus lock is released. The SD library takes the
+ * same lock for every sector, so a log write waits for one piece at most
+ * - not a whole 150 KB frame. (The display keeps its place in a memory
+ * write while CS is high.)
+ */
+
+// Function to send one transaction in pieces
+void spiRun(SpiTxn *txn) {
+    SpiDevice *dev = txn->device;
+    uint32_t total = txn->length * txn->repeat;
+    uint32_t done = 0;
+    bool first = true;
+    
+    while (first || done < total) {
+        uint32_t piece = min(total - done, (uint32_t)SPI_PIECE_BYTES);
+        unsigned long start = micros();
+        SPI.beginTransaction(dev->settings);
+        digitalWrite(dev->csPin, LOW);
+        if (first && txn->command >= 0) {
+            digitalWrite(dev->dcPin, LOW);    // The command byte
+            SPI.transfer((uint8_t)txn->command);
+        }
+        if (dev->dcPin >= 0) digitalWrite(dev->dcPin, HIGH);
+        first = false;
+        
+        uint32_t sent = 0;
+        while (sent < piece) {
+            uint32_t at = (done + sent) % txn->length;  // Position in the (repeated) buffer
+            if (at == 0 && txn->fill) txn->fill(txn, (done + sent) / txn->length);
+            uint32_t n = min(piece - sent, txn->length - at);
+            if (txn->rx && txn->repeat == 1) {
+                SPI.transferBytes(&txn->tx[at], &txn->rx[at], n);
+            } else {
+                SPI.writeBytes(&txn->tx[at], n);
+            }
+            sent += n;
+        }
+        
+        digitalWrite(dev->csPin, HIGH);
+        SPI.endTransaction();
+        spiBusyMicros += micros() - start;
+        spiBytes += piece;
+        spiPieces++;
+        done += piece;
+        taskYIELD();  // Let a task waiting for the bus (the SD card) go first
+    }
+}
+
+void spiTask(void *parameter) {
+    SpiTxn *txn;
+    while (true) {
+        xQueueReceive(spiQueue, &txn, portMAX_DELAY);
+        spiRun(txn);
+        if (txn->done) txn->done(txn);
+    }
+}
+
+void startSpiManager() {
+    spiQueue = xQueueCreate(SPI_QUEUE_SIZE, sizeof(SpiTxn *));
+    xTaskCreate(spiTask, "SPI", 3072, NULL, 1, NULL);  // Same priority as loop()
+}
+
+// Queue a transaction and return at once. It and its buffers must stay
+// valid until it is done (use globals or statics).
+bool spiSubmit(SpiTxn *txn) {
+    return xQueueSend(spiQueue, &txn, 0) == pdTRUE;
+}
+
+/*
+ * FRAMEBUFFER AND DIRTY RECTANGLES
+ * The dashboard is drawn into frameBuffer. Every drawing call marks the
+ * area it touched; displayFlush() sends only those areas, each through a
+ * display window. Rectangles that overlap or nearly touch are merged -
+ * a window costs 11 bytes and 3 transactions, about 700 pixels' worth.
+ */
+
+// RGB565 -> RGB332: the top 3 bits of red and green, 2 of blue
+uint8_t colorToPixel(uint16_t color) {
+    return ((color >> 13) << 5) | (((color >> 8) & 7) << 2) | ((color >> 3) & 3);
+}
+
+void initFramebuffer() {
+    for (int i = 0; i < 256; i++) {
+        uint8_t r = i >> 5, g = (i >> 2) & 7, b = i & 3;
+        uint16_t color = ((r << 2 | r >> 1) << 11) | ((g << 3 | g) << 5) | (b << 3 | b << 1 | b >> 1);
+        fbPalette[i] = (color >> 8) | (color << 8);  // The display wants the high byte first
+    }
     
-    // Send the data
-    SPI.transfer(data);
+    // A round red dot, drawn once and copied in with fbBlit()
+    for (int y = 0; y < 12; y++) {
+        for (int x = 0; x < 12; x++) {
+            int d = (2 * x - 11) * (2 * x - 11) + (2 * y - 11) * (2 * y - 11);
+            dotSprite[y * 12 + x] = colorToPixel(d < 121 ? RED : BLACK);
+        }
+    }
+}
+
+bool clipRect(int &x, int &y, int &w, int &h) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > DISPLAY_WIDTH) w = DISPLAY_WIDTH - x;
+    if (y + h > DISPLAY_HEIGHT) h = DISPLAY_HEIGHT - y;
+    return w > 0 && h > 0;
+}
+
+uint32_t rectArea(const DirtyRect &r) {
+    return (uint32_t)r.w * r.h;
+}
+
+DirtyRect rectUnion(const DirtyRect &a, const DirtyRect &b) {
+    int16_t x0 = min(a.x, b.x), y0 = min(a.y, b.y);
+    int16_t x1 = max(a.x + a.w, b.x + b.w), y1 = max(a.y + a.h, b.y + b.h);
+    return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+}
+
+// Function to remember a changed area
+void fbMark(int x, int y, int w, int h) {
+    if (!clipRect(x, y, w, h)) return;
+    DirtyRect r = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+    
+    // Merge with every rectangle where the union is nearly free
+    int i = 0;
+    while (i < fbDirtyCount) {
+        DirtyRect u = rectUnion(fbDirty[i], r);
+        if (rectArea(u) <= rectArea(fbDirty[i]) + rectArea(r) + FB_MERGE_SLACK) {
+            r = u;
+            fbDirty[i] = fbDirty[--fbDirtyCount];  // Grown: check the others again
+            i = 0;
+        } else {
+            i++;
+        }
+    }
     
-    // Deselect the display (hang up the phone)
-    digitalWrite(CS_DISPLAY, HIGH);
+    // List full: join the rectangle that grows the least
+    if (fbDirtyCount == FB_MAX_DIRTY) {
+        int best = 0;
+        uint32_t bestGrowth = UINT32_MAX;
+        for (i = 0; i < fbDirtyCount; i++) {
+            uint32_t growth = rectArea(rectUnion(fbDirty[i], r)) - rectArea(fbDirty[i]);
+            if (growth < bestGrowth) {
+                bestGrowth = growth;
+                best = i;
+            }
+        }
+        r = rectUnion(fbDirty[best], r);
+        fbDirty[best] = fbDirty[--fbDirtyCount];
+    }
+    fbDirty[fbDirtyCount++] = r;
+}
+
+// Fill without marking - a memset per row
+void fbFill(int x, int y, int w, int h, uint8_t pixel) {
+    if (!clipRect(x, y, w, h)) return;
+    for (int row = y; row < y + h; row++) memset(&frameBuffer[row][x], pixel, w);
+}
+
+void fbFillRect(int x, int y, int w, int h, uint16_t color) {
+    fbFill(x, y, w, h, colorToPixel(color));
+    fbMark(x, y, w, h);
+}
+
+// Function to copy a sprite (RGB332, w x h) into the framebuffer
+void fbBlit(int x, int y, const uint8_t *sprite, int w, int h) {
+    int sx = 0, sy = 0, spriteWidth = w;
+    if (x < 0) sx = -x;
+    if (y < 0) sy = -y;
+    if (!clipRect(x, y, w, h)) return;
+    for (int row = 0; row < h; row++) {
+        memcpy(&frameBuffer[y + row][x], &sprite[(sy + row) * spriteWidth + sx], w);
+    }
+    fbMark(x, y, w, h);
+}
+
+// Function to draw text: the box is cleared in one fill, then each glyph
+// row is drawn as runs ("###" is one fill). A character is 6x8 * scale.
+int fbText(int x, int y, const char *text, uint16_t fg, uint16_t bg, int scale) {
+    int len = strlen(text);
+    int w = len * 6 * scale, h = 8 * scale;
+    uint8_t on = colorToPixel(fg);
+    fbFill(x, y, w, h, colorToPixel(bg));
+    
+    for (int i = 0; i < len; i++) {
+        char c = text[i];
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        const uint8_t *glyph = font5x7[(c < ' ' || c > 'Z') ? 0 : c - ' '];
+        int gx = x + i * 6 * scale;
+        for (int row = 0; row < 7; row++) {
+            int col = 0;
+            while (col < 5) {
+                if (!((glyph[col] >> row) & 1)) {
+                    col++;
+                    continue;
+                }
+                int start = col;
+                while (col < 5 && ((glyph[col] >> row) & 1)) col++;
+                fbFill(gx + start * scale, y + row * scale, (col - start) * scale, scale, on);
+            }
+        }
+    }
+    fbMark(x, y, w, h);
+    return w;
+}
+
+// Runs in the SPI task right before each row goes out: RGB332 -> RGB565
+void fillFlushRow(SpiTxn *txn, uint16_t index) {
+    DirtyRect *r = (DirtyRect *)txn->ctx;
+    const uint8_t *src = &frameBuffer[r->y + index][r->x];
+    uint16_t *dst = flushRow;
+    for (int i = 0; i < r->w; i++) dst[i] = fbPalette[src[i]];
+}
+
+void onFlushDone(SpiTxn *txn) {
+    framesFlushed++;
+    flushBusy = false;
+}
+
+// Function to send the dirty rectangles: 3 queued transactions each.
+// Drawing may go on while they are sent - whatever changes is marked
+// again and goes out with the next flush.
+void displayFlush() {
+    if (flushBusy || fbDirtyCount == 0) return;  // Last flush still going, or nothing to do
+    flushBusy = true;
+    
+    int count = fbDirtyCount;
+    for (int i = 0; i < count; i++) {
+        FlushWindow *win = &flushWindows[i];
+        DirtyRect r = fbDirty[i];
+        int16_t x1 = r.x + r.w - 1, y1 = r.y + r.h - 1;
+        win->rect = r;
+        win->columns[0] = r.x >> 8;
+        win->columns[1] = r.x & 0xFF;
+        win->columns[2] = x1 >> 8;
+        win->columns[3] = x1 & 0xFF;
+        win->pages[0] = r.y >> 8;
+        win->pages[1] = r.y & 0xFF;
+        win->pages[2] = y1 >> 8;
+        win->pages[3] = y1 & 0xFF;
+        win->columnSet = {&displayDevice, 0x2A, win->columns, NULL, 4, 1, NULL, NULL, NULL};
+        win->pageSet = {&displayDevice, 0x2B, win->pages, NULL, 4, 1, NULL, NULL, NULL};
+        win->memoryWrite = {&displayDevice, 0x2C, (const uint8_t *)flushRow, NULL, (uint32_t)r.w * 2, (uint16_t)r.h,
+                            fillFlushRow, i == count - 1 ? onFlushDone : NULL, &win->rect};
+        // The queue holds a whole flush and the last one is done: these fit
+        spiSubmit(&win->columnSet);
+        spiSubmit(&win->pageSet);
+        spiSubmit(&win->memoryWrite);
+        flushPixels += rectArea(r);
+    }
+    fbDirtyCount = 0;
+}
+
+// Function to wake the display up (ILI9341 / ST7789) - before the SPI
+// task gets any work, so it can call spiRun() and wait in between
+void initDisplay() {
+    static const uint8_t pixelFormat[1] = {0x55};  // 16 bits per pixel on the wire
+    SpiTxn reset = {&displayDevice, 0x01, NULL, NULL, 0, 1, NULL, NULL, NULL};
+    SpiTxn wake = {&displayDevice, 0x11, NULL, NULL, 0, 1, NULL, NULL, NULL};
+    SpiTxn format = {&displayDevice, 0x3A, pixelFormat, NULL, 1, 1, NULL, NULL, NULL};
+    SpiTxn on = {&displayDevice, 0x29, NULL, NULL, 0, 1, NULL, NULL, NULL};
+    spiRun(&reset);
+    delay(150);
+    spiRun(&wake);
+    delay(150);
+    spiRun(&format);
+    spiRun(&on);
+    
+    initFramebuffer();
+    drawDashboardLayout();
+}
+
+// The parts of the dashboard that never change
+void drawDashboardLayout() {
+    fbFillRect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, BLACK);
+    fbFillRect(0, 0, DISPLAY_WIDTH, 26, NAVY);
+    fbText(8, 5, "SENSOR LOGGER", WHITE, NAVY, 2);
+    fbText(8, 34, "UPTIME", GRAY, BLACK, 1);
+    fbText(8, 74, "TEMPERATURE", GRAY, BLACK, 1);
+    fbText(8, 134, "HUMIDITY", GRAY, BLACK, 1);
+    fbText(8, 194, "LIGHT", GRAY, BLACK, 1);
+    fbFillRect(7, 249, 226, 62, DARK_GRAY);
+    fbFillRect(8, 250, 224, 60, BLACK);
+}
+
+// Function to update the dashboard - only what changed gets drawn
+void drawDashboard() {
+    static uint32_t frame = 0;
+    static uint32_t lastSecond = 0xFFFFFFFF;
+    static float shownTemperature = -100;
+    static int shownHumidity = -1;
+    static int shownLevel = -1;
+    char text[16];
+    frame++;
+    
+    // Light bar: yellow part and grey rest
+    int level = constrain(lastLight, 0, 1000) * 224 / 1000;
+    if (level != shownLevel) {
+        fbFillRect(8, 206, level, 20, YELLOW);
+        fbFillRect(8 + level, 206, 224 - level, 20, DARK_GRAY);
+        shownLevel = level;
+    }
+    
+    // Heartbeat dot
+    if (frame % 10 == 0) fbBlit(218, 34, dotSprite, 12, 12);
+    if (frame % 10 == 5) fbFillRect(218, 34, 12, 12, BLACK);
+    
+    // Once a second: uptime, and one column of the light chart
+    uint32_t second = millis() / 1000;
+    if (second != lastSecond) {
+        lastSecond = second;
+        snprintf(text, sizeof(text), "%02lu:%02lu:%02lu", (unsigned long)(second / 3600),
+                 (unsigned long)(second / 60 % 60), (unsigned long)(second % 60));
+        fbText(8, 46, text, WHITE, BLACK, 2);
+        int x = 8 + second % 224;
+        fbFillRect(x, 250, 1, 60, BLACK);
+        fbFillRect(x, 308 - level * 58 / 224, 1, 2, GREEN);
+    }
+    
+    if (lastTemperature != shownTemperature) {
+        shownTemperature = lastTemperature;
+        snprintf(text, sizeof(text), "%5.1fC", lastTemperature);
+        fbText(8, 86, text, ORANGE, BLACK, 4);
+    }
+    if (lastHumidity != shownHumidity) {
+        shownHumidity = lastHumidity;
+        snprintf(text, sizeof(text), "%3d%%", lastHumidity);
+        fbText(8, 146, text, CYAN, BLACK, 4);
+    }
+}
+
+// Function to build the CRC-32 lookup table (same CRC as ZIP/PNG files)
+// Each entry is what 8 bit-by-bit CRC steps do to one byte value
+void initCRC32Table() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+        crc32Table[i] = crc;
+    }
+}
+
+// Function to compute CRC-32 with one table lookup per byte
+// Start with crc = 0; pass the result back in to continue over more data
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    while (length--) {
+        crc = (crc >> 8) ^ crc32Table[(crc ^ *data++) & 0xFF];
+    }
+    return ~crc;
+}
+
+// Little-endian helpers: the same byte order on every machine that reads the log
+void putU16(uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+void putU32(uint8_t* p, uint32_t v) { putU16(p, v); putU16(p + 2, v >> 16); }
+uint16_t getU16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+uint32_t getU32(const uint8_t* p) { return getU16(p) | ((uint32_t)getU16(p + 2) << 16); }
+
+// Log time in milliseconds: keeps counting across reboots, so segments
+// and queries stay in order even though millis() starts at 0 every boot
+uint32_t logTime() {
+    return logTimeBase + millis();
+}
+
+void logSegmentPath(char* path, uint32_t number) {
+    sprintf(path, LOG_DIR "/SEG%05lu.BIN", (unsigned long)number);
+}
+
+uint32_t logBlockOffset(uint32_t block) {
+    return (block + 1) * LOG_BLOCK_SIZE;  // Block 0 of the file is the segment header
+}
+
+bool readAt(File& file, uint32_t offset, uint8_t* buf, size_t length) {
+    return file.seek(offset) && file.read(buf, length) == length;
+}
+
+void putBits(BitWriter& w, uint32_t value, int n) {
+    if (!w.buf) {
+        w.bits += n;
+        return;
+    }
+    while (n > 0) {
+        int freeBits = 8 - (w.bits & 7);
+        int take = min(n, freeBits);
+        uint32_t chunk = (value >> (n - take)) & ((1u << take) - 1);
+        w.buf[w.bits >> 3] |= chunk << (freeBits - take);
+        w.bits += take;
+        n -= take;
+    }
+}
+
+uint32_t getBits(BitReader& r, int n) {
+    uint32_t value = 0;
+    while (n > 0) {
+        int left = 8 - (r.bits & 7);
+        int take = min(n, left);
+        uint32_t chunk = (r.buf[r.bits >> 3] >> (left - take)) & ((1u << take) - 1);
+        value = (take == 32) ? chunk : (value << take) | chunk;
+        r.bits += take;
+        n -= take;
+    }
+    return value;
+}
+
+// Function to encode one timestamp as a delta-of-delta
+// 0 -> '0', small -> '10'/'110'/'1110' + 7/9/12 bits, else '1111' + 32 bits
+void timeEncode(TimeCoder& c, BitWriter& w, uint32_t t) {
+    uint32_t delta = t - c.prevTime;
+    int32_t dod = (int32_t)(delta - c.prevDelta);
+    if (dod == 0) {
+        putBits(w, 0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        putBits(w, 0x2, 2);
+        putBits(w, dod + 63, 7);
+    } else if (dod >= -255 && dod <= 256) {
+        putBits(w, 0x6, 3);
+        putBits(w, dod + 255, 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        putBits(w, 0xE, 4);
+        putBits(w, dod + 2047, 12);
+    } else {
+        putBits(w, 0xF, 4);
+        putBits(w, (uint32_t)dod, 32);
+    }
+    c.prevDelta = delta;
+    c.prevTime = t;
+}
+
+uint32_t timeDecode(TimeCoder& c, BitReader& r) {
+    int32_t dod;
+    if (getBits(r, 1) == 0) dod = 0;
+    else if (getBits(r, 1) == 0) dod = (int32_t)getBits(r, 7) - 63;
+    else if (getBits(r, 1) == 0) dod = (int32_t)getBits(r, 9) - 255;
+    else if (getBits(r, 1) == 0) dod = (int32_t)getBits(r, 12) - 2047;
+    else dod = (int32_t)getBits(r, 32);
+    c.prevDelta += dod;
+    c.prevTime += c.prevDelta;
+    return c.prevTime;
+}
+
+// Function to encode one float against the last one (Gorilla XOR)
+// Same -> '0', inside the last window -> '10' + bits,
+// else '11' + 5 bits leading zeros + 5 bits length-1 + bits
+void xorEncode(XorCoder& c, BitWriter& w, float value) {
+    uint32_t v;
+    memcpy(&v, &value, 4);
+    if (!c.started) {
+        putBits(w, v, 32);
+        c.started = true;
+        c.lead = -1;
+        c.prev = v;
+        return;
+    }
+    uint32_t x = v ^ c.prev;
+    c.prev = v;
+    if (x == 0) {
+        putBits(w, 0, 1);
+        return;
+    }
+    int lead = __builtin_clz(x);
+    int trail = __builtin_ctz(x);
+    if (c.lead >= 0 && lead >= c.lead && trail >= c.trail) {
+        putBits(w, 0x2, 2);
+        putBits(w, x >> c.trail, 32 - c.lead - c.trail);
+    } else {
+        int length = 32 - lead - trail;
+        putBits(w, 0x3, 2);
+        putBits(w, lead, 5);
+        putBits(w, length - 1, 5);
+        putBits(w, x >> trail, length);
+        c.lead = lead;
+        c.trail = trail;
+    }
+}
+
+float xorDecode(XorCoder& c, BitReader& r) {
+    if (!c.started) {
+        c.started = true;
+        c.lead = -1;
+        c.prev = getBits(r, 32);
+    } else if (getBits(r, 1) == 1) {
+        if (getBits(r, 1) == 1) {
+            c.lead = getBits(r, 5);
+            c.trail = 32 - c.lead - ((int)getBits(r, 5) + 1);
+        }
+        c.prev ^= getBits(r, 32 - c.lead - c.trail) << c.trail;
+    }
+    float value;
+    memcpy(&value, &c.prev, 4);
+    return value;
+}
+
+// Zigzag: small negative and positive deltas both become small numbers
+uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+int bitWidth(uint32_t v) { return v == 0 ? 0 : 32 - __builtin_clz(v); }
+
+// Function to bit-pack an integer column: first value, one width for the
+// block, then every delta at that width
+void packedEncode(BitWriter& w, const uint32_t* values, uint32_t count, int valueBits) {
+    int width = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        width = max(width, bitWidth(zigzag(values[i] - values[i - 1])));
+    }
+    putBits(w, values[0], valueBits);
+    putBits(w, width, 5);
+    for (uint32_t i = 1; i < count; i++) {
+        putBits(w, zigzag(values[i] - values[i - 1]), width);
+    }
+}
+
+void packedDecode(BitReader& r, uint32_t* values, uint32_t count, int valueBits) {
+    values[0] = getBits(r, valueBits);
+    int width = getBits(r, 5);
+    for (uint32_t i = 1; i < count; i++) {
+        values[i] = values[i - 1] + unzigzag(getBits(r, width));
+    }
+}
+
+// Function to take one reading into the RAM columns - if the encoded
+// block still fits with it. The running coder states make this O(1).
+bool logBlockAdd(uint32_t time, float temp, uint8_t humidity, uint16_t light) {
+    if (logCount == LOG_BLOCK_MAX_RECORDS) return false;
+    
+    TimeCoder t = sizeTime;
+    XorCoder x = sizeTemp;
+    BitWriter bits = sizeBits;
+    int hw = humidityWidth;
+    int lw = lightWidth;
+    if (logCount == 0) {
+        t.prevTime = time;  // The first time goes in the block header
+        t.prevDelta = 0;
+    } else {
+        timeEncode(t, bits, time);
+        hw = max(hw, bitWidth(zigzag(humidity - colHumidity[logCount - 1])));
+        lw = max(lw, bitWidth(zigzag(light - colLight[logCount - 1])));
+    }
+    xorEncode(x, bits, temp);
+    // + humidity: 8 + 5 + deltas, light: 16 + 5 + deltas
+    uint32_t total = bits.bits + 13 + logCount * hw + 21 + logCount * lw;
+    if (total > LOG_PAYLOAD_BITS) return false;
+    
+    sizeTime = t;
+    sizeTemp = x;
+    sizeBits = bits;
+    humidityWidth = hw;
+    lightWidth = lw;
+    colTime[logCount] = time;
+    colTemp[logCount] = temp;
+    colHumidity[logCount] = humidity;
+    colLight[logCount] = light;
+    logCount++;
+    return true;
+}
+
+void logBlockReset() {
+    logCount = 0;
+    sizeBits = {NULL, 0};
+    sizeTemp = {0, -1, 0, false};
+    humidityWidth = 0;
+    lightWidth = 0;
+}
+
+// Encode the RAM columns into logBlock and sign it: the CRC covers all
+// 512 bytes with the CRC field as zero
+void logEncodeBlock() {
+    unsigned long start = micros();
+    memset(logBlock, 0, LOG_BLOCK_SIZE);
+    BitWriter w = {&logBlock[LOG_BLOCK_HEADER], 0};
+    
+    TimeCoder tc = {colTime[0], 0};
+    for (uint32_t i = 1; i < logCount; i++) timeEncode(tc, w, colTime[i]);
+    XorCoder xc = {0, -1, 0, false};
+    for (uint32_t i = 0; i < logCount; i++) xorEncode(xc, w, colTemp[i]);
+    packedEncode(w, colHumidity, logCount, 8);
+    packedEncode(w, colLight, logCount, 16);
+    
+    logBlock[0] = 'L';
+    logBlock[1] = 'C';
+    putU16(&logBlock[2], logCount);
+    putU32(&logBlock[4], colTime[0]);
+    putU32(&logBlock[8], colTime[logCount - 1]);
+    putU32(&logBlock[12], crc32(0, logBlock, LOG_BLOCK_SIZE));
+    logEncodeMicros = micros() - start;
+}
+
+// Both block kinds are accepted: "LC" (compressed) and "LB" (version 1
+// fixed records, still on cards written by the previous firmware)
+bool logBlockValid(uint8_t* block) {
+    uint16_t count = getU16(&block[2]);
+    uint16_t maxCount = block[1] == 'B' ? LOG_V1_MAX_RECORDS : LOG_BLOCK_MAX_RECORDS;
+    if (block[0] != 'L' || (block[1] != 'C' && block[1] != 'B') || count == 0 || count > maxCount) return false;
+    uint32_t stored = getU32(&block[12]);
+    putU32(&block[12], 0);
+    bool ok = crc32(0, block, LOG_BLOCK_SIZE) == stored;
+    putU32(&block[12], stored);
+    return ok;
+}
+
+// Function to decode a (valid) block back into columns
+uint16_t logDecodeBlock(const uint8_t* block, uint32_t* times, float* temps, uint32_t* humidity, uint32_t* light) {
+    uint16_t count = getU16(&block[2]);
+    if (block[1] == 'B') {
+        for (uint32_t i = 0; i < count; i++) {
+            const uint8_t* record = &block[LOG_BLOCK_HEADER + i * LOG_V1_RECORD_SIZE];
+            times[i] = getU32(&record[1]);
+            temps[i] = (int16_t)getU16(&record[5]) / 100.0f;
+            humidity[i] = record[7];
+            light[i] = getU16(&record[8]);
+        }
+        return count;
+    }
+    BitReader r = {&block[LOG_BLOCK_HEADER], 0};
+    
+    TimeCoder tc = {getU32(&block[4]), 0};
+    times[0] = tc.prevTime;
+    for (uint32_t i = 1; i < count; i++) times[i] = timeDecode(tc, r);
+    XorCoder xc = {0, -1, 0, false};
+    for (uint32_t i = 0; i < count; i++) temps[i] = xorDecode(xc, r);
+    packedDecode(r, humidity, count, 8);
+    packedDecode(r, light, count, 16);
+    return count;
+}
+
+// Write the block at its place in the file - whole sectors only
+void logPutBlock() {
+    logEncodeBlock();
+    logFile.seek(logBlockOffset(logBlocks));
+    logFile.write(logBlock, LOG_BLOCK_SIZE);
+}
+
+// Close a segment for good: the last block, the index and the trailer
+void logSealSegment() {
+    if (logCount > 0) {
+        logPutBlock();
+        logBlocks++;
+        logBlockReset();
+    }
+    static uint8_t index[LOG_INDEX_MAX * LOG_INDEX_ENTRY_SIZE + LOG_TRAILER_SIZE];
+    uint32_t size = logIndexCount * LOG_INDEX_ENTRY_SIZE;
+    for (uint32_t i = 0; i < logIndexCount; i++) {
+        putU32(&index[i * LOG_INDEX_ENTRY_SIZE], logIndexTime[i]);
+        putU32(&index[i * LOG_INDEX_ENTRY_SIZE + 4], logIndexBlock[i]);
+    }
+    memcpy(&index[size], "IDX1", 4);
+    putU32(&index[size + 4], logIndexCount);
+    putU32(&index[size + 8], logBlocks);
+    putU32(&index[size + 12], crc32(0, index, size + 12));
+    logFile.seek(logBlockOffset(logBlocks));
+    logFile.write(index, size + LOG_TRAILER_SIZE);
+    dirIndexUpdateLast(logSegment, logFile.size(), logLastTime / 1000);
+    logFile.close();
+}
+
+bool logStartSegment(uint32_t number, uint32_t startTime) {
+    char path[32];
+    logSegmentPath(path, number);
+    logFile = SD.open(path, "w+");  // Read/write: blocks are rewritten in place
+    if (!logFile) return false;
+    
+    uint8_t header[LOG_BLOCK_SIZE];
+    memset(header, 0xFF, sizeof(header));
+    memcpy(header, "SEG1", 4);
+    putU16(&header[4], LOG_FORMAT_VERSION);
+    putU16(&header[6], LOG_BLOCK_SIZE);
+    putU32(&header[8], number);
+    putU32(&header[12], startTime);
+    putU32(&header[16], crc32(0, header, 16));
+    logFile.write(header, sizeof(header));
+    dirIndexAppend(number, sizeof(header), startTime / 1000);
+    
+    logSegment = number;
+    logBlocks = 0;
+    logBlockReset();
+    logIndexCount = 0;
+    return true;
+}
+
+// Sync point: write the half-full block in place and make it (and the
+// file size) safe on the card. It gets rewritten when it fills up.
+void logSync() {
+    unsigned long start = micros();
+    if (logFile && logCount > 0) logPutBlock();
+    if (logFile) logFile.flush();
+    logWorstSyncMicros = max(logWorstSyncMicros, (uint32_t)(micros() - start));
+    logSinceSync = 0;
+    lastSyncTime = millis();
+}
+
+// Add one reading - like writing on the notepad, not in the notebook
+void logAppend(uint32_t time, float temp, uint8_t humidity, uint16_t light) {
+    if (!logFile && !logStartSegment(logSegment + 1, time)) return;
+    if (!logBlockAdd(time, temp, humidity, light)) {
+        logPutBlock();  // Full block: off to the card
+        logBlocks++;
+        logBlockReset();
+        if (logBlocks == LOG_SEGMENT_BLOCKS) {
+            logSealSegment();  // Rotate: this reading opens a new segment
+            if (!logStartSegment(logSegment + 1, time)) return;
+        }
+        logBlockAdd(time, temp, humidity, light);
+    }
+    if (logCount == 1 && logBlocks % LOG_INDEX_EVERY == 0) {
+        logIndexTime[logIndexCount] = time;
+        logIndexBlock[logIndexCount++] = logBlocks;
+    }
+    logLastTime = time;
+    logRecords++;
+    
+    if (++logSinceSync >= LOG_SYNC_RECORDS || millis() - lastSyncTime >= LOG_SYNC_MS) {
+        logSync();
+    }
+}
+
+// A sealed segment ends with a trailer whose CRC matches its index
+bool segmentIsSealed(File& file, uint8_t* trailer) {
+    uint32_t size = file.size();
+    if (size < LOG_BLOCK_SIZE + LOG_TRAILER_SIZE) return false;
+    if (!readAt(file, size - LOG_TRAILER_SIZE, trailer, LOG_TRAILER_SIZE)) return false;
+    if (memcmp(trailer, "IDX1", 4) != 0) return false;
+    uint32_t entries = getU32(&trailer[4]);
+    if (entries > LOG_INDEX_MAX) return false;
+    uint32_t indexSize = entries * LOG_INDEX_ENTRY_SIZE;
+    if (size != logBlockOffset(getU32(&trailer[8])) + indexSize + LOG_TRAILER_SIZE) return false;
+    
+    static uint8_t index[LOG_INDEX_MAX * LOG_INDEX_ENTRY_SIZE + 12];
+    if (!readAt(file, size - LOG_TRAILER_SIZE - indexSize, index, indexSize)) return false;
+    memcpy(&index[indexSize], trailer, 12);
+    return crc32(0, index, indexSize + 12) == getU32(&trailer[12]);
+}
+
+/*
+ * DIRECTORY CACHE
+ * Listing /log with openNextFile() opens every segment, and FAT finds a
+ * file by searching the folder from the top - so 10,000 segments take
+ * minutes. INDEX.BIN keeps one 24-byte slot per segment instead (same
+ * format as 13_directory_cache.c). It stays open, and the log
+ * updates it where segments change: a slot when one starts, its size
+ * and time when it is sealed. The header is rewritten with each change.
+ * Queries use it too: slot times only grow, so a binary search over the
+ * slots finds the first segment of a time range without opening any.
+ */
+void dirWriteHeader() {
+    uint8_t header[DIR_HEADER_SIZE];
+    memcpy(header, "DIX1", 4);
+    putU32(&header[4], dirFirst);
+    putU32(&header[8], dirSlots);
+    putU32(&header[12], crc32(0, header, 12));
+    dirIndex.seek(0);
+    dirIndex.write(header, DIR_HEADER_SIZE);
+    dirIndex.flush();
+}
+
+void dirWriteSlot(uint32_t slot, const char *name, uint32_t size, uint32_t time) {
+    uint8_t entry[DIR_ENTRY_SIZE];
+    memset(entry, 0, DIR_NAME_LEN);
+    memcpy(entry, name, min(strlen(name), (size_t)DIR_NAME_LEN));
+    putU32(&entry[12], size);
+    putU32(&entry[16], time);
+    putU32(&entry[20], crc32(0, entry, 20));
+    dirIndex.seek(DIR_HEADER_SIZE + slot * DIR_ENTRY_SIZE);
+    dirIndex.write(entry, DIR_ENTRY_SIZE);
+}
+
+bool dirReadSlot(uint32_t slot, char *name, uint32_t &size, uint32_t &time) {
+    uint8_t entry[DIR_ENTRY_SIZE];
+    if (!readAt(dirIndex, DIR_HEADER_SIZE + slot * DIR_ENTRY_SIZE, entry, DIR_ENTRY_SIZE) ||
+        getU32(&entry[20]) != crc32(0, entry, 20)) {
+        return false;
+    }
+    memcpy(name, entry, DIR_NAME_LEN);
+    name[DIR_NAME_LEN] = '\0';
+    size = getU32(&entry[12]);
+    time = getU32(&entry[16]);
+    return true;
+}
+
+// A new segment: one more slot
+void dirIndexAppend(uint32_t number, uint32_t size, uint32_t time) {
+    if (!dirIndex) return;
+    char path[32];
+    logSegmentPath(path, number);
+    dirWriteSlot(dirSlots++, strrchr(path, '/') + 1, size, time);
+    dirWriteHeader();
+    dirLastNumber = number;
+    dirLastTime = time;
+}
+
+// The newest segment was sealed: its final size and time
+void dirIndexUpdateLast(uint32_t number, uint32_t size, uint32_t time) {
+    if (!dirIndex || dirSlots == dirFirst || number != dirLastNumber) return;
+    char path[32];
+    logSegmentPath(path, number);
+    dirWriteSlot(dirSlots - 1, strrchr(path, '/') + 1, size, time);
+    dirIndex.flush();
+    dirLastTime = time;
+}
+
+// Function to rebuild the index the slow way: open every segment, once.
+// openNextFile() gives the files in directory order. FAT reuses the
+// entries of deleted files, so a new segment can come before older ones:
+// each slot is inserted at its place by number (names are fixed width).
+// Usually nothing moves; a few slots when the oldest segments were deleted.
+bool dirIndexRebuild() {
+    if (dirIndex) dirIndex.close();
+    dirIndex = SD.open(DIR_INDEX_PATH, "w+");
+    if (!dirIndex) return false;
+    Serial.println("Rebuilding " DIR_INDEX_PATH " (opens every segment once)...");
+    dirFirst = 0;
+    dirSlots = 0;
+    dirLastNumber = 0;
+    dirLastTime = 0;
+    
+    File folder = SD.open(LOG_DIR);
+    while (folder) {
+        File entry = folder.openNextFile();
+        if (!entry) break;
+        const char *name = strrchr(entry.name(), '/') ? strrchr(entry.name(), '/') + 1 : entry.name();
+        uint8_t header[16];
+        if (!entry.isDirectory() && strncmp(name, "SEG", 3) == 0 && readAt(entry, 0, header, 16) &&
+            memcmp(header, "SEG1", 4) == 0) {
+            uint32_t number = getU32(&header[8]);
+            uint32_t start = getU32(&header[12]) / 1000;  // Sealed ones: the start time will do
+            uint32_t at = dirSlots;
+            char slotName[DIR_NAME_LEN + 1];
+            uint32_t slotSize, slotTime;
+            while (at > 0 && dirReadSlot(at - 1, slotName, slotSize, slotTime) &&
+                   strncmp(slotName, name, DIR_NAME_LEN) > 0) {
+                dirWriteSlot(at, slotName, slotSize, slotTime);  // Make room: one slot up
+                at--;
+            }
+            dirWriteSlot(at, name, entry.size(), start);
+            dirSlots++;
+            if (number > dirLastNumber) {  // The newest is the highest number, not the last listed
+                dirLastNumber = number;
+                dirLastTime = start;
+            }
+        }
+        entry.close();
+    }
+    folder.close();
+    dirWriteHeader();
+    return true;
+}
+
+// Function to open the index at boot. A power cut can stop the log
+// between changing a segment and updating the index, so check its ends:
+// is the oldest segment still there, has the newest one grown, were
+// segments started after the last update? A few lookups, not 10,000.
+// (Deleted or copied segments on the PC? Delete INDEX.BIN - it is rebuilt.)
+bool dirIndexOpen() {
+    if (dirIndex) dirIndex.close();
+    uint8_t header[DIR_HEADER_SIZE];
+    dirIndex = SD.exists(DIR_INDEX_PATH) ? SD.open(DIR_INDEX_PATH, "r+") : File();
+    if (!dirIndex || !readAt(dirIndex, 0, header, DIR_HEADER_SIZE) || memcmp(header, "DIX1", 4) != 0 ||
+        getU32(&header[12]) != crc32(0, header, 12)) {
+        return dirIndexRebuild();
+    }
+    dirFirst = getU32(&header[4]);
+    dirSlots = getU32(&header[8]);
+    if (dirSlots == dirFirst) return dirIndexRebuild();
+    
+    char name[DIR_NAME_LEN + 1];
+    char path[32];
+    uint32_t size, time;
+    if (!dirReadSlot(dirFirst, name, size, time)) return dirIndexRebuild();
+    sprintf(path, LOG_DIR "/%s", name);
+    if (!SD.exists(path)) return dirIndexRebuild();
+    
+    if (!dirReadSlot(dirSlots - 1, name, size, time)) return dirIndexRebuild();
+    sprintf(path, LOG_DIR "/%s", name);
+    File last = SD.open(path);
+    if (!last) return dirIndexRebuild();
+    if (last.size() != size) dirWriteSlot(dirSlots - 1, name, last.size(), time);
+    last.close();
+    dirLastNumber = strtoul(name + 3, NULL, 10);
+    dirLastTime = time;
+    
+    while (true) {
+        logSegmentPath(path, dirLastNumber + 1);
+        if (!SD.exists(path)) break;
+        File next = SD.open(path);
+        uint8_t segmentHeader[16];
+        if (!next) break;
+        if (!readAt(next, 0, segmentHeader, 16)) {
+            next.close();
+            break;
+        }
+        dirLastNumber++;
+        dirLastTime = getU32(&segmentHeader[12]) / 1000;
+        dirWriteSlot(dirSlots++, strrchr(path, '/') + 1, next.size(), dirLastTime);
+        next.close();
+    }
+    dirWriteHeader();
+    return true;
+}
+
+// Function to find the first slot whose segment can hold readings at or
+// after t0 (ms). A segment ends before the next one starts, and a slot's
+// time is between its segment's start and end - so slot s can be skipped
+// when slot s + 1 already has a time before t0. Returns dirSlots if a
+// slot can't be read.
+uint32_t dirFindSlot(uint32_t t0) {
+    char name[DIR_NAME_LEN + 1];
+    uint32_t size, time;
+    uint32_t lo = dirFirst + 1;
+    uint32_t hi = dirSlots;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (!dirReadSlot(mid, name, size, time)) return dirSlots;
+        if ((uint64_t)time * 1000 + 999 < t0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo - 1;
+}
+
+uint32_t logPageCount() {
+    return (dirSlots - dirFirst + LIST_PAGE_ENTRIES - 1) / LIST_PAGE_ENTRIES;
+}
+
+// Function to list one page of the log folder - one read of the index,
+// wherever the page is
+void listLogPage(uint32_t page) {
+    uint32_t count = dirSlots - dirFirst;
+    uint32_t start = page * LIST_PAGE_ENTRIES;
+    Serial.print("\nLog segments (page ");
+    Serial.print(page + 1);
+    Serial.print(" of ");
+    Serial.print(logPageCount());
+    Serial.print(", ");
+    Serial.print(count);
+    Serial.println(" segments):");
+    if (!dirIndex || start >= count) return;
+    
+    static uint8_t entries[LIST_PAGE_ENTRIES * DIR_ENTRY_SIZE];
+    uint32_t n = min(count - start, (uint32_t)LIST_PAGE_ENTRIES);
+    if (!readAt(dirIndex, DIR_HEADER_SIZE + (dirFirst + start) * DIR_ENTRY_SIZE, entries, n * DIR_ENTRY_SIZE)) {
+        return;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t *entry = &entries[i * DIR_ENTRY_SIZE];
+        if (getU32(&entry[20]) != crc32(0, entry, 20)) {
+            Serial.println("Damaged index slot - delete " DIR_INDEX_PATH " to rebuild it");
+            return;
+        }
+        char name[DIR_NAME_LEN + 1];
+        memcpy(name, entry, DIR_NAME_LEN);
+        name[DIR_NAME_LEN] = '\0';
+        Serial.print(start + i + 1);
+        Serial.print(". ");
+        Serial.print(name);
+        Serial.print(" - ");
+        Serial.print(getU32(&entry[12]));
+        Serial.print(" bytes, log time ");
+        Serial.print(getU32(&entry[16]));
+        Serial.println(" s");
+    }
+}
+
+// Function to check one segment after a reboot
+// Sealed: nothing to do. Open (power cut): walk the blocks to the first
+// bad one, cut the torn tail off there, rebuild the index and seal it.
+// Only segments of THIS format version are repaired - an open segment
+// from older firmware is left exactly as it is (queries still read it).
+bool recoverSegment(uint32_t number) {
+    char path[32];
+    logSegmentPath(path, number);
+    if (!SD.exists(path)) return false;
+    logFile = SD.open(path, "r+");
+    if (!logFile) return false;
+    
+    uint8_t header[16];
+    uint8_t trailer[LOG_TRAILER_SIZE];
+    if (!readAt(logFile, 0, header, sizeof(header)) || memcmp(header, "SEG1", 4) != 0) {
+        logFile.close();
+        return false;
+    }
+    uint16_t version = getU16(&header[4]);
+    if (version != LOG_FORMAT_VERSION && !segmentIsSealed(logFile, trailer)) {
+        // Find where log time got to, without changing a byte
+        uint32_t size = logFile.size();
+        for (uint32_t b = 0; logBlockOffset(b) + LOG_BLOCK_SIZE <= size &&
+                             readAt(logFile, logBlockOffset(b), logBlock, LOG_BLOCK_SIZE) &&
+                             logBlockValid(logBlock); b++) {
+            logLastTime = getU32(&logBlock[8]);
+        }
+        Serial.print(path);
+        Serial.print(": format version ");
+        Serial.print(version);
+        Serial.println(", left as it is");
+        logFile.close();
+        return true;
+    }
+    
+    if (segmentIsSealed(logFile, trailer)) {
+        // Remember where log time got to: the last block's last time
+        uint32_t blocks = getU32(&trailer[8]);
+        if (blocks > 0 && readAt(logFile, logBlockOffset(blocks - 1), logBlock, LOG_BLOCK_SIZE)) {
+            logLastTime = getU32(&logBlock[8]);
+        }
+        logFile.close();
+        return true;
+    }
+    
+    uint32_t size = logFile.size();
+    logBlocks = 0;
+    logBlockReset();
+    logIndexCount = 0;
+    while (logBlockOffset(logBlocks) + LOG_BLOCK_SIZE <= size &&
+           readAt(logFile, logBlockOffset(logBlocks), logBlock, LOG_BLOCK_SIZE) &&
+           logBlockValid(logBlock)) {
+        if (logBlocks % LOG_INDEX_EVERY == 0) {
+            logIndexTime[logIndexCount] = getU32(&logBlock[4]);
+            logIndexBlock[logIndexCount++] = logBlocks;
+        }
+        logLastTime = getU32(&logBlock[8]);
+        logBlocks++;
+    }
+    
+    Serial.print("Recovering ");
+    Serial.print(path);
+    Serial.print(": ");
+    Serial.print(logBlocks);
+    Serial.print(" good blocks, cutting ");
+    Serial.print(size - logBlockOffset(logBlocks));
+    Serial.println(" bytes");
+    
+    // Cut the torn tail, then write the index at the new end
+    logSegment = number;  // So the seal updates the right directory slot
+    logFile.close();
+    char fullPath[40];
+    sprintf(fullPath, LOG_MOUNT "%s", path);
+    truncate(fullPath, logBlockOffset(logBlocks));
+    logFile = SD.open(path, "r+");
+    if (!logFile) return false;
+    logSealSegment();
+    return true;
+}
+
+// Function to open the log at boot: check the newest segment, continue
+// after it. Every boot starts a new segment. (Without an index, e.g. the
+// first boot with this version, the rebuild opens every segment once to
+// read its header - recovery still only checks the newest one.)
+bool openSensorLog() {
+    SD.mkdir(LOG_DIR);
+    dirIndexOpen();
+    
+    // Every segment before the newest was sealed when the log rotated
+    uint32_t segments = dirLastNumber > 0 ? dirLastNumber - 1 : 0;
+    uint32_t checked = 0;
+    logLastTime = dirLastTime * 1000;  // In case the newest segment has no blocks yet
+    while (recoverSegment(segments + 1)) {
+        segments++;
+        checked++;
+    }
+    
+    logSegment = segments;
+    logTimeBase = logLastTime + 1;  // Log time carries on where the last boot stopped
+    logFile = File();
+    logBlockReset();
+    logSinceSync = 0;
+    lastSyncTime = millis();
+    
+    Serial.print("Sensor log: ");
+    Serial.print(dirSlots - dirFirst);
+    Serial.print(" segments, ");
+    Serial.print(checked);
+    Serial.println(" checked");
+    return true;
+}
+
+// Function to find the first block of a segment that may hold time t0
+// Sealed: one read of the index. Open: binary search on the blocks.
+uint32_t findStartBlock(File& file, uint32_t t0) {
+    uint8_t trailer[LOG_TRAILER_SIZE];
+    if (segmentIsSealed(file, trailer)) {
+        uint32_t entries = getU32(&trailer[4]);
+        uint32_t at = file.size() - LOG_TRAILER_SIZE - entries * LOG_INDEX_ENTRY_SIZE;
+        static uint8_t index[LOG_INDEX_MAX * LOG_INDEX_ENTRY_SIZE];
+        if (!readAt(file, at, index, entries * LOG_INDEX_ENTRY_SIZE)) return 0;
+        uint32_t start = 0;
+        for (uint32_t i = 0; i < entries && getU32(&index[i * LOG_INDEX_ENTRY_SIZE]) <= t0; i++) {
+            start = getU32(&index[i * LOG_INDEX_ENTRY_SIZE + 4]);
+        }
+        return start;
+    }
+    uint8_t block[LOG_BLOCK_SIZE];
+    uint32_t lo = 0;
+    uint32_t hi = (file.size() - LOG_BLOCK_SIZE) / LOG_BLOCK_SIZE;
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+        if (readAt(file, logBlockOffset(mid), block, LOG_BLOCK_SIZE) && logBlockValid(block) &&
+            getU32(&block[4]) <= t0) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Function to read the records between two log times
+// Like opening the right diary at the right page, instead of reading
+// every diary from the first page
+void querySensorLog(uint32_t t0, uint32_t t1) {
+    uint32_t found = 0;
+    uint32_t blocksRead = 0;
+    float minTemp = INFINITY;
+    float maxTemp = -INFINITY;
+    uint8_t block[LOG_BLOCK_SIZE];
+    static uint32_t times[LOG_BLOCK_MAX_RECORDS];
+    static float temps[LOG_BLOCK_MAX_RECORDS];
+    static uint32_t humidity[LOG_BLOCK_MAX_RECORDS];
+    static uint32_t light[LOG_BLOCK_MAX_RECORDS];
+    
+    if (!dirIndex) {
+        Serial.println("Query: no " DIR_INDEX_PATH);
+        return;
+    }
+    
+    // The index finds the first segment; SD.exists() per segment number
+    // would search the folder from the top every time
+    bool pastEnd = false;
+    for (uint32_t slot = dirFindSlot(t0); slot < dirSlots && !pastEnd; slot++) {
+        char name[DIR_NAME_LEN + 1];
+        char path[32];
+        uint32_t size, time;
+        if (!dirReadSlot(slot, name, size, time)) break;
+        sprintf(path, LOG_DIR "/%s", name);
+        
+        bool openSegment = (logFile && strtoul(name + 3, NULL, 10) == logSegment);  // Still being written: use its handle
+        File file = openSegment ? logFile : SD.open(path);
+        if (!file) continue;
+        if (!readAt(file, 0, block, 16) || memcmp(block, "SEG1", 4) != 0 || getU32(&block[12]) > t1) {
+            if (!openSegment) file.close();
+            break;
+        }
+        for (uint32_t b = findStartBlock(file, t0); ; b++) {
+            if (!readAt(file, logBlockOffset(b), block, LOG_BLOCK_SIZE) || !logBlockValid(block)) break;
+            blocksRead++;
+            if (getU32(&block[4]) > t1) {
+                pastEnd = true;  // Later segments start later still
+                break;
+            }
+            uint16_t count = logDecodeBlock(block, times, temps, humidity, light);
+            for (uint16_t i = 0; i < count; i++) {
+                if (times[i] < t0 || times[i] > t1) continue;
+                minTemp = min(minTemp, temps[i]);
+                maxTemp = max(maxTemp, temps[i]);
+                found++;
+            }
+        }
+        if (!openSegment) file.close();
+    }
+    
+    Serial.print("Query ");
+    Serial.print(t0 / 1000);
+    Serial.print("-");
+    Serial.print(t1 / 1000);
+    Serial.print(" s: ");
+    Serial.print(found);
+    Serial.print(" records from ");
+    Serial.print(blocksRead);
+    Serial.print(" blocks");
+    if (found > 0) {
+        Serial.print(", temperature ");
+        Serial.print(minTemp);
+        Serial.print(" to ");
+        Serial.print(maxTemp);
+        Serial.print(" C");
+    }
+    Serial.println();
 }
 
 // Function to write sensor data to SD card
 // Like keeping a logbook of measurements
 void logSensorData() {
-    // Simulate some sensor readings
-    float temperature = 23.5 + (random(-50, 50) / 10.0);  // Random temp around 23.5°C
-    int humidity = 45 + random(-10, 10);                   // Random humidity around 45%
-    int lightLevel = random(0, 1024);                      // Random light level
-    
-    Serial.println("\nLogging sensor data...");
-    
-    File dataFile = SD.open("/sensors.csv", FILE_APPEND);  // Append to file
-    
-    if (dataFile) {
-        // Write CSV format data (easy to open in Excel)
-        dataFile.print(millis());        // Time
-        dataFile.print(",");
-        dataFile.print(temperature);     // Temperature
-        dataFile.print(",");
-        dataFile.print(humidity);        // Humidity
-        dataFile.print(",");
-        dataFile.println(lightLevel);    // Light level
-        
-        dataFile.close();
-        
-        Serial.print("Logged: T=");
-        Serial.print(temperature);
-        Serial.print("°C, H=");
-        Serial.print(humidity);
-        Serial.print("%, Light=");
-        Serial.println(lightLevel);
-    } else {
-        Serial.println("Error opening data file");
+    // Simulate some sensor readings that behave like real ones: a DHT22
+    // gives a new value every 2 seconds, the light level drifts with noise.
+    // (Pure random numbers would not compress - real readings do.)
+    static float temperature = 23.5;
+    static int humidity = 45;
+    static int lightBase = 512;
+    static unsigned long lastDhtRead = 0;
+    if (millis() - lastDhtRead >= 2000) {
+        lastDhtRead = millis();
+        temperature = constrain(temperature + random(-1, 2) / 10.0, 18.5, 28.5);
+        humidity = constrain(humidity + (int)random(-1, 2), 35, 55);
+        lightBase = constrain(lightBase + (int)random(-20, 21), 0, 1000);
     }
+    int lightLevel = lightBase + random(-2, 3);
+    lastTemperature = temperature;
+    lastHumidity = humidity;
+    lastLight = lightLevel;
+    
+    // Time, Temperature (°C), Humidity, Light level - about 1 byte per
+    // reading once compressed, instead of a ~25 character CSV line
+    logAppend(logTime(), temperature, humidity, lightLevel);
 }
 
 void setup() {
@@ -206,9 +1656,10 @@ void setup() {
     Serial.println("SPI Communication Example");
     Serial.println("=========================");
     
-    // Set up chip select pins as outputs
+    // Set up chip select pins (and the display's D/C pin) as outputs
     pinMode(CS_SD, OUTPUT);
     pinMode(CS_DISPLAY, OUTPUT);
+    pinMode(DC_DISPLAY, OUTPUT);
     
     // Make sure devices are not selected initially
     digitalWrite(CS_SD, HIGH);      // SD card not selected
@@ -217,6 +1668,9 @@ void setup() {
     // Initialize SPI
     initializeSPI();
     
+    // Build the CRC table used to protect log records
+    initCRC32Table();
+    
     // Try to initialize SD card
     sdCardReady = initializeSDCard();
     
@@ -230,40 +1684,85 @@ void setup() {
         // Read the test file back
         readFile("/test.txt");
         
-        // Create CSV header for sensor data
-        File dataFile = SD.open("/sensors.csv", FILE_WRITE);
-        if (dataFile && dataFile.size() == 0) {  // If file is empty
-            dataFile.println("Time,Temperature,Humidity,Light");  // CSV header
-            dataFile.close();
-        }
+        // Check the log segments, repair a torn tail from a power cut
+        openSensorLog();
     }
 }
 
 void loop() {
     if (sdCardReady) {
-        Serial.println("\n--- SPI Operations ---");
+        // Log sensor data 10 times per second. logAppend() sizes the reading's
+        // delta-of-delta and XOR codes and stores it in the block's columns -
+        // integer work only; the card sees one write per full block
+        static unsigned long lastLogTime = 0;
+        if (millis() - lastLogTime >= LOG_INTERVAL_MS) {
+            lastLogTime = millis();
+            logSensorData();
+        }
         
-        // Log some sensor data every 10 seconds
-        logSensorData();
+        // Update the dashboard; the SPI task sends the changes in pieces
+        static unsigned long lastFrameTime = 0;
+        if (millis() - lastFrameTime >= DISPLAY_FRAME_MS) {
+            lastFrameTime = millis();
+            drawDashboard();
+            displayFlush();
+        }
+        
+        // Every 10 seconds: report
+        static unsigned long lastReportTime = 0;
+        if (millis() - lastReportTime >= 10000) {
+            lastReportTime = millis();
+            Serial.println("\n--- SPI Operations ---");
+            Serial.print("Logged ");
+            Serial.print(logRecords);
+            Serial.print(" records, segment ");
+            Serial.print(logSegment);
+            Serial.print(", block ");
+            Serial.print(logBlocks);
+            Serial.print(" (");
+            Serial.print(logCount);
+            Serial.print(" readings, encoded in ");
+            Serial.print(logEncodeMicros);
+            Serial.println(" us)");
+            
+            // Display traffic, and how long the slowest SD sync took next to it
+            static uint32_t lastBusyMicros = 0;
+            uint32_t busy = spiBusyMicros;
+            Serial.print("Display: ");
+            Serial.print(framesFlushed);
+            Serial.print(" frames, ");
+            Serial.print(framesFlushed ? flushPixels * 2 / framesFlushed : 0);
+            Serial.print(" bytes/frame (whole screen: 153600), ");
+            Serial.print(spiBytes / 1024);
+            Serial.print(" KB in ");
+            Serial.print(spiPieces);
+            Serial.print(" pieces, bus ");
+            Serial.print((busy - lastBusyMicros) / 100000.0, 1);  // us per 10 s -> %
+            Serial.print("% busy. Slowest SD sync: ");
+            Serial.print(logWorstSyncMicros / 1000.0, 1);
+            Serial.println(" ms");
+            lastBusyMicros = busy;
+        }
         
         // Show updated file list every 30 seconds
         static unsigned long lastListTime = 0;
         if (millis() - lastListTime > 30000) {
+            logSync();  // So the list and the query see everything
             listSDCardFiles();
+            listLogPage(max(logPageCount(), (uint32_t)1) - 1);  // The newest segments
+            
+            // The last minute, straight from the index - not a full scan
+            uint32_t now = logTime();
+            querySensorLog(now > 60000 ? now - 60000 : 0, now);
             lastListTime = millis();
         }
-        
-        // If you have an SPI display, send some data to it
-        static uint8_t displayData = 0;
-        sendToDisplay(displayData++);
-        
-        delay(10000);  // Wait 10 seconds
     } else {
         Serial.println("SD card not ready - check wiring!");
         delay(5000);
         
         // Try to reinitialize
         sdCardReady = initializeSDCard();
+        if (sdCardReady) openSensorLog();
     }
 }
 
@@ -295,7 +1794,15 @@ void loop() {
  * 2. Each device needs its own CS (Chip Select) pin
  * 3. All devices share SCK, MOSI, and MISO lines
  * 4. Always set CS HIGH when not using a device
- * 5. SD cards can be picky about timing - start with low speeds
+ * 5. SD cards can be picky about timing - if 20 MHz fails, try 10 or 4 MHz
+ *    (SD_CLOCK_HZ) - only the SD card slows down, not the display
+ * 6. Give every device its own SPISettings and wrap each transfer in
+ *    beginTransaction()/endTransaction() - that is what lets devices
+ *    with different speeds and modes share the bus
+ * 7. Send big transfers in pieces and release the bus in between, or one
+ *    150 KB frame blocks the SD card for 30 ms
+ * 8. Draw into a framebuffer and send only the dirty rectangles - a
+ *    dashboard changes a few percent of the screen per frame
  * 
  * Troubleshooting:
  * - SD card not detected? Check power (3.3V vs 5V)
@@ -306,8 +1813,25 @@ void loop() {
  * 
  * File System Tips:
  * - Use short filenames (8.3 format: FILENAME.TXT)
- * - Always close files after use
+ * - Always close files after use - except a log you write all the time:
+ *   keep it open and flush() at sync points instead
  * - Check if file opened successfully before writing
  * - Use FILE_APPEND to add data to existing files
- * - CSV format is great for data logging
+ * - CSV is easy to read, but a binary log is 3x smaller and much faster;
+ *   convert it on the PC
+ * - Write in whole sectors (512 bytes): every smaller write makes the card
+ *   read, change and rewrite a full sector
+ * - Add a CRC to every block - SD cards can corrupt data on power loss,
+ *   and a CRC per block means one bad sector costs one block (a few hundred
+ *   compressed readings), not the file
+ * - Split logs into segments: a time query only opens the segments it
+ *   needs, and when the card fills up you delete the oldest segment whole
+ * - Compress by column: times, then temperatures, ... Neighbouring values
+ *   are alike, so their differences take a few bits. Decode the files on
+ *   the PC with 10_log_compression.c
+ * - truncate() needs the full VFS path ("/sd/log/..."): the SD library
+ *   has no truncate of its own
+ * - Don't list big folders with openNextFile(): it opens every file, and
+ *   each open searches the folder from the top. Keep an index of the
+ *   files you create (like /log/INDEX.BIN) and page through that
  */
\ No newline at end of file
@@ -41,16 +41,59 @@ struct GPSData {
 GPSData currentGPS = {false, 0, 0, 0, 0, 0, "00:00:00"};
 
 // Buffer for incoming data (like a mailbox for messages)
-String gpsBuffer = "";
+char gpsLine[128];           // The sentence being put together
+size_t gpsLineLength = 0;
 String sensorBuffer = "";
 
+// DMA-style receive with two buckets (ping-pong buffers)
+// Think of it like two mail trays: the UART fills one while we read the other.
+// The UART driver calls onGPSReceive() when its FIFO holds 120 bytes or when
+// no byte arrived for RX_IDLE_SYMBOLS characters (the line went quiet).
+#define RX_BUFFER_SIZE      256     // Size of EACH tray
+#define RX_IDLE_SYMBOLS     10      // Quiet for 10 characters = hand over the tray
+#define UART_FIFO_FULL      120     // onReceive() also fires at this FIFO level
+
+struct RxPingPong {
+    uint8_t buffers[2][RX_BUFFER_SIZE];
+    volatile uint16_t length[2];
+    volatile bool ready[2];   // true = tray is full, waiting for loop()
+    uint8_t fillIndex;        // Tray the UART callback fills
+    uint8_t parseIndex;       // Tray loop() reads next
+    bool flushPending;        // Line went quiet while loop() had the other tray
+    uint32_t overruns;        // Both trays full - data dropped
+};
+
+RxPingPong gpsRx = {};
+portMUX_TYPE gpsRxMux = portMUX_INITIALIZER_UNLOCKED;  // Callback and loop() both hand over trays
+
+// Function prototypes (the Arduino IDE writes these for us, but listing
+// them lets this sketch also build with Host-Emulator on a PC)
+void initializeUART();
+uint64_t load8(const char *p, const char *end);
+unsigned swarDigitCount(uint64_t v);
+uint32_t swarDigitsValue(uint64_t v, unsigned n);
+size_t parseU32(const char *s, size_t len, uint32_t *out);
+size_t parseFixed(const char *s, size_t len, int decimals, int32_t *out);
+bool parseGPSData(const char *text, size_t length);
+void onGPSReceive();
+bool handOverGPSBuffer();
+void consumeGPSBytes(const uint8_t* data, size_t length);
+void processGPSData();
+void displayGPSInfo();
+void sendSensorCommand(String command);
+void demonstrateSensorProtocol();
+void logDataOverUART();
+
 // Function to initialize UART communication
 // Think of this as setting up the mail system
 void initializeUART() {
     Serial.println("Setting up UART communication...");
     
     // Start GPS communication (9600 baud is standard for most GPS modules)
+    gpsSerial.setRxBufferSize(1024);               // Driver buffer behind the FIFO
     gpsSerial.begin(9600, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
+    gpsSerial.setRxTimeout(RX_IDLE_SYMBOLS);       // Idle-line detection
+    gpsSerial.onReceive(onGPSReceive, false);      // Called on FIFO full AND idle
     Serial.println("GPS UART started at 9600 baud");
     
     // Start sensor communication (you can use different speeds)
@@ -67,12 +110,91 @@ void initializeUART() {
     Serial.println("UART initialization complete!");
 }
 
+// Fast number parsing (host version with exhaustive tests and benchmark:
+// Module3 09_fast_number_conversion.c). Instead of checking one character at
+// a time, 8 characters are loaded into one 64-bit number and checked and
+// converted together ("SWAR") - like counting coins in stacks of 8.
+const uint32_t pow10Table[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+uint64_t load8(const char *p, const char *end) {
+    uint64_t v = 0;
+    size_t avail = end - p;
+    memcpy(&v, p, avail < 8 ? avail : 8);  // Past the end reads as 0 (not a digit)
+    return v;
+}
+
+// How many of the 8 characters, from the first, are '0'..'9'
+unsigned swarDigitCount(uint64_t v) {
+    uint64_t high = v & 0xF0F0F0F0F0F0F0F0ull;                           // Digits: 0x3_
+    uint64_t plus6 = (v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull; // Still 0x3_ after +6
+    uint64_t bad = (high ^ 0x3030303030303030ull) | (plus6 ^ 0x3030303030303030ull);
+    return bad ? __builtin_ctzll(bad) / 8 : 8;
+}
+
+// Value of the first n (1..8) digits: pairs, then groups of 4, then all 8
+uint32_t swarDigitsValue(uint64_t v, unsigned n) {
+    if (n < 8) v <<= 8 * (8 - n);
+    v = ((v & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+    v = ((v & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+    return ((v & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32;
+}
+
+// Returns characters used (0 = no digits or too big)
+size_t parseU32(const char *s, size_t len, uint32_t *out) {
+    const char *p = s;
+    const char *end = s + len;
+    uint64_t value = 0;
+    for (;;) {
+        uint64_t chunk = load8(p, end);
+        unsigned n = swarDigitCount(chunk);
+        if (n == 0) break;
+        value = value * pow10Table[n] + swarDigitsValue(chunk, n);
+        if (value > UINT32_MAX) return 0;
+        p += n;
+        if (n < 8) break;
+    }
+    *out = value;
+    return p - s;
+}
+
+// "4807.03800" with decimals = 5 -> 480703800. Extra digits are rounded.
+// Returns characters used (0 = no number or doesn't fit in 32 bits).
+size_t parseFixed(const char *s, size_t len, int decimals, int32_t *out) {
+    const char *p = s;
+    const char *end = s + len;
+    bool negative = (p < end && *p == '-');
+    if (negative) p++;
+    
+    uint32_t whole = 0;
+    size_t n = parseU32(p, end - p, &whole);
+    if (n == 0 && !(p < end && *p == '.')) return 0;
+    p += n;
+    
+    uint64_t value = (uint64_t)whole * pow10Table[decimals];
+    if (p < end && *p == '.') {
+        p++;
+        uint64_t chunk = load8(p, end);
+        unsigned digits = swarDigitCount(chunk);
+        if (digits == 8) {
+            while (p + digits < end && p[digits] >= '0' && p[digits] <= '9') digits++;
+        }
+        if (n == 0 && digits == 0) return 0;
+        unsigned use = digits < (unsigned)decimals ? digits : decimals;
+        if (use > 0) value += (uint64_t)swarDigitsValue(chunk, use) * pow10Table[decimals - use];
+        if (digits > (unsigned)decimals && p[decimals] >= '5') value++;
+        p += digits;
+    }
+    if (value > (uint64_t)INT32_MAX) return 0;
+    *out = negative ? -(int32_t)value : (int32_t)value;
+    return p - s;
+}
+
 // Function to parse GPS NMEA sentences
 // NMEA is like a standard format for GPS messages
 // Think of it as a template that all GPS devices use
-bool parseGPSData(String nmeaSentence) {
+bool parseGPSData(const char *text, size_t length) {
     // We're looking for GPGGA sentences (Global Positioning System Fix Data)
-    if (!nmeaSentence.startsWith("$GPGGA") && !nmeaSentence.startsWith("$GNGGA")) {
+    if (length < 6 || (strncmp(text, "$GPGGA", 6) != 0 && strncmp(text, "$GNGGA", 6) != 0)) {
         return false;  // Not the sentence we want
     }
     
@@ -81,8 +203,8 @@ bool parseGPSData(String nmeaSentence) {
     int commaCount = 0;
     
     // Find all the commas
-    for (int i = 0; i < nmeaSentence.length() && commaCount < 15; i++) {
-        if (nmeaSentence.charAt(i) == ',') {
+    for (size_t i = 0; i < length && commaCount < 15; i++) {
+        if (text[i] == ',') {
             commaIndex[commaCount] = i;
             commaCount++;
         }
@@ -91,79 +213,163 @@ bool parseGPSData(String nmeaSentence) {
     if (commaCount < 10) return false;  // Not enough data
     
     // Extract time (field 1)
-    String timeStr = nmeaSentence.substring(commaIndex[0] + 1, commaIndex[1]);
-    if (timeStr.length() >= 6) {
+    const char *timeStr = text + commaIndex[0] + 1;
+    if (commaIndex[1] - commaIndex[0] - 1 >= 6) {
         // Convert HHMMSS to HH:MM:SS
         snprintf(currentGPS.timeString, sizeof(currentGPS.timeString), 
                 "%c%c:%c%c:%c%c", 
                 timeStr[0], timeStr[1], timeStr[2], timeStr[3], timeStr[4], timeStr[5]);
     }
     
+    // Numbers are parsed straight out of the sentence - no substring(), no toFloat()
     // Extract latitude (fields 2 and 3)
-    String latStr = nmeaSentence.substring(commaIndex[1] + 1, commaIndex[2]);
-    String latDir = nmeaSentence.substring(commaIndex[2] + 1, commaIndex[3]);
-    
-    if (latStr.length() > 0) {
-        float lat = latStr.toFloat();
-        // Convert from DDMM.MMMMM to DD.DDDDDD
-        int degrees = (int)(lat / 100);
-        float minutes = lat - (degrees * 100);
-        currentGPS.latitude = degrees + (minutes / 60.0);
-        if (latDir == "S") currentGPS.latitude = -currentGPS.latitude;
+    // DDMM.MMMMM is read as a whole number of 0.00001 minutes: exact, unlike a float
+    const char *latStr = text + commaIndex[1] + 1;
+    size_t latLength = commaIndex[2] - commaIndex[1] - 1;
+    int32_t latFixed;
+    
+    if (latLength > 0 && parseFixed(latStr, latLength, 5, &latFixed) == latLength) {
+        int32_t degrees = latFixed / 10000000;            // DD
+        int32_t minutesE5 = latFixed % 10000000;          // MM.MMMMM x 100000
+        currentGPS.latitude = degrees + (minutesE5 / 6000000.0);
+        if (text[commaIndex[2] + 1] == 'S') currentGPS.latitude = -currentGPS.latitude;
     }
     
     // Extract longitude (fields 4 and 5)
-    String lonStr = nmeaSentence.substring(commaIndex[3] + 1, commaIndex[4]);
-    String lonDir = nmeaSentence.substring(commaIndex[4] + 1, commaIndex[5]);
+    const char *lonStr = text + commaIndex[3] + 1;
+    size_t lonLength = commaIndex[4] - commaIndex[3] - 1;
+    int32_t lonFixed;
     
-    if (lonStr.length() > 0) {
-        float lon = lonStr.toFloat();
+    if (lonLength > 0 && parseFixed(lonStr, lonLength, 5, &lonFixed) == lonLength) {
         // Convert from DDDMM.MMMMM to DDD.DDDDDD
-        int degrees = (int)(lon / 100);
-        float minutes = lon - (degrees * 100);
-        currentGPS.longitude = degrees + (minutes / 60.0);
-        if (lonDir == "W") currentGPS.longitude = -currentGPS.longitude;
+        int32_t degrees = lonFixed / 10000000;
+        int32_t minutesE5 = lonFixed % 10000000;
+        currentGPS.longitude = degrees + (minutesE5 / 6000000.0);
+        if (text[commaIndex[4] + 1] == 'W') currentGPS.longitude = -currentGPS.longitude;
     }
     
     // Extract fix quality and satellites (fields 6 and 7)
-    String fixStr = nmeaSentence.substring(commaIndex[5] + 1, commaIndex[6]);
-    String satStr = nmeaSentence.substring(commaIndex[6] + 1, commaIndex[7]);
-    
-    int fixQuality = fixStr.toInt();
+    uint32_t fixQuality = 0;
+    uint32_t satellites = 0;
+    parseU32(text + commaIndex[5] + 1, commaIndex[6] - commaIndex[5] - 1, &fixQuality);
+    parseU32(text + commaIndex[6] + 1, commaIndex[7] - commaIndex[6] - 1, &satellites);
     currentGPS.valid = (fixQuality > 0);  // 0 = no fix, 1+ = valid fix
-    currentGPS.satellites = satStr.toInt();
+    currentGPS.satellites = satellites;
     
-    // Extract altitude (field 9)
-    String altStr = nmeaSentence.substring(commaIndex[8] + 1, commaIndex[9]);
-    if (altStr.length() > 0) {
-        currentGPS.altitude = altStr.toFloat();
+    // Extract altitude (field 9), in centimetres
+    size_t altLength = commaIndex[9] - commaIndex[8] - 1;
+    int32_t altitudeCm;
+    if (altLength > 0 && parseFixed(text + commaIndex[8] + 1, altLength, 2, &altitudeCm) > 0) {
+        currentGPS.altitude = altitudeCm / 100.0;
     }
     
     return currentGPS.valid;
 }
 
-// Function to read and process GPS data
-// Like checking the mailbox for GPS messages
-void processGPSData() {
-    while (gpsSerial.available()) {
-        char c = gpsSerial.read();
+// Function called by the UART driver (not by us!) when data is waiting
+// Like the mail carrier filling a tray - it moves ALL waiting bytes at once
+void onGPSReceive() {
+    size_t received = 0;
+    int available;
+    
+    portENTER_CRITICAL(&gpsRxMux);
+    gpsRx.flushPending = false;  // We're here now - the idle check below covers it
+    portEXIT_CRITICAL(&gpsRxMux);
+    
+    while ((available = gpsSerial.available()) > 0) {
+        uint8_t index = gpsRx.fillIndex;
+        uint16_t used = gpsRx.length[index];
+        size_t space = RX_BUFFER_SIZE - used;
+        size_t n = gpsSerial.readBytes(&gpsRx.buffers[index][used],
+                                       (size_t)available < space ? available : space);
+        gpsRx.length[index] = used + n;
+        received += n;
+        
+        if (gpsRx.length[index] == RX_BUFFER_SIZE) {
+            portENTER_CRITICAL(&gpsRxMux);
+            handOverGPSBuffer();  // Tray full
+            portEXIT_CRITICAL(&gpsRxMux);
+        }
+    }
+    
+    // Fewer bytes than the FIFO level means the line went idle:
+    // hand over a half-full tray so a short sentence isn't left waiting.
+    // If loop() still has the other tray, no more bytes may come to call us
+    // again - so processGPSData() hands this one over when it is done.
+    if (received < UART_FIFO_FULL && gpsRx.length[gpsRx.fillIndex] > 0) {
+        portENTER_CRITICAL(&gpsRxMux);
+        if (!handOverGPSBuffer()) {
+            gpsRx.flushPending = true;
+        }
+        portEXIT_CRITICAL(&gpsRxMux);
+    }
+}
+
+// Function to give the tray being filled to loop()
+// Returns false if loop() still has the other tray. Call with gpsRxMux held.
+bool handOverGPSBuffer() {
+    uint8_t next = gpsRx.fillIndex ^ 1;
+    if (gpsRx.ready[next]) {
+        // loop() hasn't emptied the other tray yet - keep filling this one,
+        // and only drop it when it is full
+        if (gpsRx.length[gpsRx.fillIndex] == RX_BUFFER_SIZE) {
+            gpsRx.overruns++;
+            gpsRx.length[gpsRx.fillIndex] = 0;
+        }
+        return false;
+    }
+    gpsRx.ready[gpsRx.fillIndex] = true;
+    gpsRx.fillIndex = next;
+    return true;
+}
+
+// Function to split a whole buffer into NMEA sentences
+// memchr() jumps straight to the next '\n' - no per-character loop
+void consumeGPSBytes(const uint8_t* data, size_t length) {
+    while (length > 0) {
+        const uint8_t* newline = (const uint8_t*)memchr(data, '\n', length);
+        size_t chunk = newline ? (size_t)(newline - data) : length;
+        
+        if (gpsLineLength + chunk < sizeof(gpsLine)) {
+            memcpy(&gpsLine[gpsLineLength], data, chunk);
+            gpsLineLength += chunk;
+        } else {
+            gpsLineLength = 0;  // Prevent buffer overflow - drop the sentence
+        }
+        
+        if (!newline) break;  // The rest arrives in the next buffer
         
-        if (c == '\n') {  // End of sentence
-            if (gpsBuffer.length() > 0) {
-                // Try to parse this sentence
-                if (parseGPSData(gpsBuffer)) {
-                    Serial.println("GPS data updated!");
-                }
-                gpsBuffer = "";  // Clear for next sentence
-            }
-        } else if (c != '\r') {  // Ignore carriage returns
-            gpsBuffer += c;
+        if (gpsLineLength > 0 && gpsLine[gpsLineLength - 1] == '\r') {
+            gpsLineLength--;  // Ignore carriage returns
+        }
+        gpsLine[gpsLineLength] = '\0';
+        if (gpsLineLength > 0 && parseGPSData(gpsLine, gpsLineLength)) {
+            Serial.println("GPS data updated!");
         }
+        gpsLineLength = 0;
+        
+        data += chunk + 1;
+        length -= chunk + 1;
+    }
+}
+
+// Function to read and process GPS data
+// Like checking the mail trays for GPS messages
+void processGPSData() {
+    while (gpsRx.ready[gpsRx.parseIndex]) {
+        uint8_t index = gpsRx.parseIndex;
+        consumeGPSBytes(gpsRx.buffers[index], gpsRx.length[index]);
         
-        // Prevent buffer overflow
-        if (gpsBuffer.length() > 200) {
-            gpsBuffer = "";
+        // Give the tray back to the UART callback
+        portENTER_CRITICAL(&gpsRxMux);
+        gpsRx.length[index] = 0;
+        gpsRx.ready[index] = false;
+        gpsRx.parseIndex = index ^ 1;
+        if (gpsRx.flushPending) {  // The quiet-line handover the callback couldn't do
+            gpsRx.flushPending = false;
+            handOverGPSBuffer();
         }
+        portEXIT_CRITICAL(&gpsRxMux);
     }
 }
 
@@ -346,7 +552,7 @@ void loop() {
  * - Garbled data? Verify voltage levels and connections
  * - GPS not getting fix? Try outdoors with clear sky
  * - UART errors? Add delays between transmissions
- * - Buffer overflow? Process data more frequently
+ * - Buffer overflow? Process data more frequently (watch gpsRx.overruns)
  * 
  * NMEA Sentence Types:
  * - GPGGA: Global Positioning System Fix Data
@@ -34,6 +34,23 @@ float temperature = 23.5;
 int lightLevel = 512;
 bool ledState = false;
 
+// JSON writer for /api/status - writes straight into a fixed buffer, no heap
+// One bit per nesting level remembers where the next comma goes
+#define STATUS_BUFFER_SIZE 384
+#define JSON_MAX_DEPTH 8
+
+struct JsonWriter {
+    char *buf;
+    size_t size;
+    size_t used;
+    uint32_t hasItems;                      // Bit n: level n needs a comma before the next item
+    uint8_t depth;
+    bool afterKey;                          // A key was written - its value needs no comma
+    bool overflow;                          // Something didn't fit - the answer is invalid
+};
+
+char statusJson[STATUS_BUFFER_SIZE];
+
 // Function to initialize WiFi connection
 // Think of this as connecting to the internet
 void initializeWiFi() {
@@ -80,52 +97,243 @@ void initializeBluetooth() {
     }
 }
 
-// Function to create the main web page
-// Think of this as creating a poster that people can read
-String createWebPage() {
-    String html = "<!DOCTYPE html><html><head>";
-    html += "<title>ESP32 Learning Server</title>";
-    html += "<style>body{font-family:Arial;margin:40px;background:#f0f0f0;}";
-    html += ".container{background:white;padding:20px;border-radius:10px;box-shadow:0 2px 10px rgba(0,0,0,0.1);}";
-    html += ".sensor{background:#e8f4fd;padding:15px;margin:10px 0;border-left:4px solid #2196F3;}";
-    html += ".button{background:#4CAF50;color:white;padding:10px 20px;text-decoration:none;border-radius:5px;margin:5px;}";
-    html += ".button:hover{background:#45a049;}";
-    html += "</style></head><body>";
-    
-    html += "<div class='container'>";
-    html += "<h1>🔧 ESP32 Learning Dashboard</h1>";
-    html += "<p>Welcome to your ESP32 web server! Visitor #" + String(webVisitorCount) + "</p>";
-    
+// Function to print a sensor value with a fixed number of decimals
+// String(float) goes through the big printf/dtoa code - this is just integer math
+// (host version with benchmark: Module3-Real-Hardware/09_fast_number_conversion.c)
+// digitPairs is a copy of the table in Module3 02_uart_communication.c (sketches
+// don't share files)
+const char digitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+size_t formatFixed(char *out, float value, int decimals) {
+    static const uint32_t scale[] = {1, 10, 100, 1000, 10000};
+    if (value != value) { memcpy(out, "nan", 4); return 3; }
+
+    char *p = out;
+    if (value < 0) { *p++ = '-'; value = -value; }
+    if (decimals < 0) decimals = 0;
+    if (decimals > 4) decimals = 4;
+
+    float scaled = value * scale[decimals] + 0.5f;  // Round half away from zero
+    if (scaled >= 4294967295.0f) { memcpy(p, "ovf", 4); return (p - out) + 3; }
+    uint32_t fixed = (uint32_t)scaled;
+
+    uint32_t whole = fixed / scale[decimals];
+    uint32_t fraction = fixed % scale[decimals];
+
+    // Write digits backwards: the fraction (zero padded), then the whole part two at a time
+    char tmp[16];
+    char *end = tmp + sizeof(tmp);
+    char *q = end;
+    for (int i = 0; i < decimals; i++) {
+        *--q = '0' + fraction % 10;
+        fraction /= 10;
+    }
+    if (decimals > 0) *--q = '.';
+    while (whole >= 100) {
+        uint32_t pair = whole % 100;
+        whole /= 100;
+        *--q = digitPairs[pair * 2 + 1];
+        *--q = digitPairs[pair * 2];
+    }
+    if (whole >= 10) {
+        *--q = digitPairs[whole * 2 + 1];
+        *--q = digitPairs[whole * 2];
+    } else {
+        *--q = '0' + whole;
+    }
+
+    size_t length = end - q;
+    memcpy(p, q, length);
+    p[length] = '\0';
+    return (p - out) + length;
+}
+
+// Function to print a whole number (same digit pairs as formatFixed)
+size_t formatInt(char *out, long value) {
+    char tmp[12];
+    char *end = tmp + sizeof(tmp);
+    char *q = end;
+    unsigned long whole = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    while (whole >= 100) {
+        unsigned long pair = whole % 100;
+        whole /= 100;
+        *--q = digitPairs[pair * 2 + 1];
+        *--q = digitPairs[pair * 2];
+    }
+    if (whole >= 10) {
+        *--q = digitPairs[whole * 2 + 1];
+        *--q = digitPairs[whole * 2];
+    } else {
+        *--q = '0' + whole;
+    }
+    if (value < 0) *--q = '-';
+
+    size_t length = end - q;
+    memcpy(out, q, length);
+    out[length] = '\0';
+    return length;
+}
+
+// The main web page as a template
+// Think of this as a pre-printed form: the text never changes, only the blanks
+// The page text is a constant (it stays in flash), {{NAME}} marks a value.
+// It is split into parts once at start-up; every visit then streams the parts
+// through one small buffer with chunked transfer encoding - no String +=, no
+// page-sized block of heap (host version with benchmark: 14_html_template.c)
+#define PAGE_CHUNK_SIZE 512                 // The only RAM a page needs
+#define PAGE_MAX_PARTS 32
+
+enum PageSlot {
+    SLOT_NONE = -1,
+    SLOT_VISITORS,
+    SLOT_TEMPERATURE,
+    SLOT_LIGHT,
+    SLOT_LED,
+    SLOT_RSSI,
+    SLOT_WEB_COMMAND,
+    SLOT_BT_MESSAGE,
+    SLOT_BT_COUNT,
+    SLOT_COUNT
+};
+
+const char* const pageSlotNames[SLOT_COUNT] = {
+    "VISITORS", "TEMPERATURE", "LIGHT", "LED", "RSSI", "WEB_COMMAND", "BT_MESSAGE", "BT_COUNT"
+};
+
+struct PagePart {
+    const char *text;                       // Points into pageTemplate - nothing copied
+    uint16_t length;
+    int8_t slot;                            // SLOT_NONE: static text
+};
+
+PagePart pageParts[PAGE_MAX_PARTS];
+int pagePartCount = 0;
+char pageChunk[PAGE_CHUNK_SIZE];
+size_t pageChunkUsed = 0;
+
+const char pageTemplate[] PROGMEM =
+    "<!DOCTYPE html><html><head>"
+    "<title>ESP32 Learning Server</title>"
+    "<style>body{font-family:Arial;margin:40px;background:#f0f0f0;}"
+    ".container{background:white;padding:20px;border-radius:10px;box-shadow:0 2px 10px rgba(0,0,0,0.1);}"
+    ".sensor{background:#e8f4fd;padding:15px;margin:10px 0;border-left:4px solid #2196F3;}"
+    ".button{background:#4CAF50;color:white;padding:10px 20px;text-decoration:none;border-radius:5px;margin:5px;}"
+    ".button:hover{background:#45a049;}"
+    "</style></head><body>"
+    "<div class='container'>"
+    "<h1>🔧 ESP32 Learning Dashboard</h1>"
+    "<p>Welcome to your ESP32 web server! Visitor #{{VISITORS}}</p>"
     // Show sensor data
-    html += "<div class='sensor'>";
-    html += "<h3>📊 Sensor Readings</h3>";
-    html += "<p>🌡️ Temperature: " + String(temperature) + "°C</p>";
-    html += "<p>💡 Light Level: " + String(lightLevel) + "/1023</p>";
-    html += "<p>🔆 LED Status: " + String(ledState ? "ON" : "OFF") + "</p>";
-    html += "</div>";
-    
+    "<div class='sensor'>"
+    "<h3>📊 Sensor Readings</h3>"
+    "<p>🌡️ Temperature: {{TEMPERATURE}}°C</p>"
+    "<p>💡 Light Level: {{LIGHT}}/1023</p>"
+    "<p>🔆 LED Status: {{LED}}</p>"
+    "</div>"
     // Show communication status
-    html += "<div class='sensor'>";
-    html += "<h3>📡 Communication Status</h3>";
-    html += "<p>📶 WiFi Signal: " + String(WiFi.RSSI()) + " dBm</p>";
-    html += "<p>📧 Last Web Command: " + lastWebCommand + "</p>";
-    html += "<p>📱 Last Bluetooth Message: " + lastBluetoothMessage + "</p>";
-    html += "<p>💬 Bluetooth Messages: " + String(bluetoothMessageCount) + "</p>";
-    html += "</div>";
-    
+    "<div class='sensor'>"
+    "<h3>📡 Communication Status</h3>"
+    "<p>📶 WiFi Signal: {{RSSI}} dBm</p>"
+    "<p>📧 Last Web Command: {{WEB_COMMAND}}</p>"
+    "<p>📱 Last Bluetooth Message: {{BT_MESSAGE}}</p>"
+    "<p>💬 Bluetooth Messages: {{BT_COUNT}}</p>"
+    "</div>"
     // Control buttons
-    html += "<h3>🎛️ Controls</h3>";
-    html += "<a href='/led_on' class='button'>💡 Turn LED ON</a>";
-    html += "<a href='/led_off' class='button'>💤 Turn LED OFF</a>";
-    html += "<a href='/refresh' class='button'>🔄 Refresh Data</a>";
-    
-    html += "<h3>📱 Try Bluetooth</h3>";
-    html += "<p>Connect to 'ESP32-Learning' via Bluetooth and send messages!</p>";
-    html += "<p>Try sending: 'LED ON', 'LED OFF', 'STATUS', or 'HELLO'</p>";
-    
-    html += "</div></body></html>";
-    
-    return html;
+    "<h3>🎛️ Controls</h3>"
+    "<a href='/led_on' class='button'>💡 Turn LED ON</a>"
+    "<a href='/led_off' class='button'>💤 Turn LED OFF</a>"
+    "<a href='/refresh' class='button'>🔄 Refresh Data</a>"
+    "<h3>📱 Try Bluetooth</h3>"
+    "<p>Connect to 'ESP32-Learning' via Bluetooth and send messages!</p>"
+    "<p>Try sending: 'LED ON', 'LED OFF', 'STATUS', or 'HELLO'</p>"
+    "</div></body></html>";
+
+// Function to split the template into text parts and value slots (once, in setup)
+// Returns false for an unknown {{NAME}} or too many parts
+bool compilePageTemplate(const char *source) {
+    pagePartCount = 0;
+    const char *p = source;
+    while (*p) {
+        const char *open = strstr(p, "{{");
+        const char *end = open ? open : p + strlen(p);
+        if (end > p) {
+            if (pagePartCount == PAGE_MAX_PARTS) return false;
+            pageParts[pagePartCount++] = {p, (uint16_t)(end - p), SLOT_NONE};
+        }
+        if (!open) break;
+
+        const char *close = strstr(open, "}}");
+        if (!close) return false;
+        int slot = SLOT_NONE;
+        for (int i = 0; i < SLOT_COUNT; i++) {
+            size_t n = strlen(pageSlotNames[i]);
+            if ((size_t)(close - open - 2) == n && memcmp(open + 2, pageSlotNames[i], n) == 0) slot = i;
+        }
+        if (slot == SLOT_NONE || pagePartCount == PAGE_MAX_PARTS) return false;
+        pageParts[pagePartCount++] = {NULL, 0, (int8_t)slot};
+        p = close + 2;
+    }
+    return true;
+}
+
+// Function to send what is in the page buffer as one chunk
+void pageFlush() {
+    if (pageChunkUsed > 0) webServer.sendContent(pageChunk, pageChunkUsed);
+    pageChunkUsed = 0;
+}
+
+// Function to add text to the page - a part bigger than the buffer (the CSS)
+// goes out straight from flash
+void pagePut(const char *text, size_t length) {
+    if (pageChunkUsed + length > sizeof(pageChunk)) {
+        pageFlush();
+        if (length >= sizeof(pageChunk)) {
+            webServer.sendContent(text, length);
+            return;
+        }
+    }
+    memcpy(pageChunk + pageChunkUsed, text, length);
+    pageChunkUsed += length;
+}
+
+// Function to add text that came from outside (Bluetooth, web commands)
+// Anyone nearby can send "<script>..." - it must show up as text, not run
+void pagePutEscaped(const char *text) {
+    const char *run = text;
+    for (const char *p = text; ; p++) {
+        const char *entity = NULL;
+        switch (*p) {
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '&': entity = "&amp;"; break;
+            case '\'': entity = "&#39;"; break;
+            case '"': entity = "&quot;"; break;
+        }
+        if (entity || *p == '\0') {
+            pagePut(run, p - run);          // The plain text before it, in one go
+            if (*p == '\0') return;
+            pagePut(entity, strlen(entity));
+            run = p + 1;
+        }
+    }
+}
+
+// Function to fill in one blank of the form
+void pagePutSlot(int slot) {
+    char number[16];
+    switch (slot) {
+        case SLOT_VISITORS:    pagePut(number, formatInt(number, webVisitorCount)); break;
+        case SLOT_TEMPERATURE: pagePut(number, formatFixed(number, temperature, 1)); break;
+        case SLOT_LIGHT:       pagePut(number, formatInt(number, lightLevel)); break;
+        case SLOT_LED:         pagePut(ledState ? "ON" : "OFF", ledState ? 2 : 3); break;
+        case SLOT_RSSI:        pagePut(number, formatInt(number, WiFi.RSSI())); break;
+        case SLOT_WEB_COMMAND: pagePutEscaped(lastWebCommand.c_str()); break;
+        case SLOT_BT_MESSAGE:  pagePutEscaped(lastBluetoothMessage.c_str()); break;
+        case SLOT_BT_COUNT:    pagePut(number, formatInt(number, bluetoothMessageCount)); break;
+    }
 }
 
 // Function to handle web page requests
@@ -134,8 +342,205 @@ void handleWebRoot() {
     webVisitorCount++;  // Count visitors
     Serial.println("Web page requested by: " + webServer.client().remoteIP().toString());
     
-    String page = createWebPage();
-    webServer.send(200, "text/html", page);  // Send the web page
+    // Length not known in advance: chunked transfer, ended by an empty chunk
+    webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    webServer.send(200, "text/html", "");
+    
+    pageChunkUsed = 0;
+    for (int i = 0; i < pagePartCount; i++) {
+        if (pageParts[i].slot == SLOT_NONE) pagePut(pageParts[i].text, pageParts[i].length);
+        else pagePutSlot(pageParts[i].slot);
+    }
+    pageFlush();
+    webServer.sendContent("");
+}
+
+// Functions for the JSON writer
+// (host version with benchmark: 15_json_status_api.c)
+void jsonBegin(JsonWriter &w, char *buf, size_t size) {
+    w.buf = buf;
+    w.size = size;
+    w.used = 0;
+    w.hasItems = 0;
+    w.depth = 0;
+    w.afterKey = false;
+    w.overflow = false;
+}
+
+void jsonPut(JsonWriter &w, const char *text, size_t length) {
+    if (w.overflow) return;
+    if (w.used + length + 1 > w.size) {     // Keep one byte for the '\0'
+        w.overflow = true;
+        return;
+    }
+    memcpy(w.buf + w.used, text, length);
+    w.used += length;
+}
+
+// Every key and every value starts here: a comma if needed
+void jsonItem(JsonWriter &w) {
+    if (w.afterKey) {
+        w.afterKey = false;
+        return;
+    }
+    if (w.hasItems & (1UL << w.depth)) jsonPut(w, ",", 1);
+    w.hasItems |= 1UL << w.depth;
+}
+
+void jsonObjectStart(JsonWriter &w) {
+    jsonItem(w);
+    jsonPut(w, "{", 1);
+    if (w.depth + 1 >= JSON_MAX_DEPTH) {
+        w.overflow = true;
+        return;
+    }
+    w.depth++;
+    w.hasItems &= ~(1UL << w.depth);
+}
+
+void jsonObjectEnd(JsonWriter &w) {
+    if (w.depth > 0) w.depth--;
+    jsonPut(w, "}", 1);
+}
+
+// Quotes, backslashes and control characters must not end the string early
+void jsonPutString(JsonWriter &w, const char *text) {
+    static const char hex[] = "0123456789abcdef";
+    jsonPut(w, "\"", 1);
+    const char *run = text;
+    for (const char *p = text; ; p++) {
+        unsigned char c = *p;
+        if (c == '\0' || c == '"' || c == '\\' || c < 0x20) {
+            jsonPut(w, run, p - run);       // The plain text before it, in one go
+            if (c == '\0') break;
+            char escaped[6] = {'\\', (char)c};
+            size_t length = 2;
+            if (c == '\n') escaped[1] = 'n';
+            else if (c == '\r') escaped[1] = 'r';
+            else if (c == '\t') escaped[1] = 't';
+            else if (c < 0x20) {
+                memcpy(escaped, "\\u00", 4);
+                escaped[4] = hex[c >> 4];
+                escaped[5] = hex[c & 15];
+                length = 6;
+            }
+            jsonPut(w, escaped, length);
+            run = p + 1;
+        }
+    }
+    jsonPut(w, "\"", 1);
+}
+
+void jsonKey(JsonWriter &w, const char *key) {
+    jsonItem(w);
+    jsonPutString(w, key);
+    jsonPut(w, ":", 1);
+    w.afterKey = true;
+}
+
+void jsonString(JsonWriter &w, const char *value) {
+    jsonItem(w);
+    jsonPutString(w, value);
+}
+
+void jsonInt(JsonWriter &w, long value) {
+    char number[16];
+    size_t length = formatInt(number, value);
+    jsonItem(w);
+    jsonPut(w, number, length);
+}
+
+void jsonFixed(JsonWriter &w, float value, int decimals) {
+    char number[24];
+    size_t length = formatFixed(number, value, decimals);
+    jsonItem(w);
+    jsonPut(w, number, length);
+}
+
+void jsonBool(JsonWriter &w, bool value) {
+    jsonItem(w);
+    jsonPut(w, value ? "true" : "false", value ? 4 : 5);
+}
+
+// Length of the finished JSON, or 0 if it didn't fit
+size_t jsonFinish(JsonWriter &w) {
+    if (w.overflow || w.depth != 0) return 0;
+    w.buf[w.used] = '\0';
+    return w.used;
+}
+
+// Function to write the status as JSON into statusJson
+// The same values as the web page - a few hundred bytes instead of the whole page
+size_t buildStatusJson() {
+    JsonWriter w;
+    jsonBegin(w, statusJson, sizeof(statusJson));
+    jsonObjectStart(w);
+    jsonKey(w, "sensors");
+    jsonObjectStart(w);
+    jsonKey(w, "temperature");
+    jsonFixed(w, temperature, 1);
+    jsonKey(w, "light");
+    jsonInt(w, lightLevel);
+    jsonObjectEnd(w);
+    jsonKey(w, "led");
+    jsonBool(w, ledState);
+    jsonKey(w, "wifi");
+    jsonObjectStart(w);
+    jsonKey(w, "rssi");
+    jsonInt(w, WiFi.RSSI());
+    jsonKey(w, "visitors");
+    jsonInt(w, webVisitorCount);
+    jsonKey(w, "lastCommand");
+    jsonString(w, lastWebCommand.c_str());
+    jsonObjectEnd(w);
+    jsonKey(w, "bluetooth");
+    jsonObjectStart(w);
+    jsonKey(w, "messages");
+    jsonInt(w, bluetoothMessageCount);
+    jsonKey(w, "lastMessage");
+    jsonString(w, lastBluetoothMessage.c_str());
+    jsonObjectEnd(w);
+    jsonObjectEnd(w);
+    return jsonFinish(w);
+}
+
+// Function to make an ETag - a fingerprint of the answer (FNV-1a, 8 hex digits in quotes)
+// Same JSON, same ETag - whatever changed it
+void makeEtag(char *out, const char *data, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= 16777619UL;
+    }
+    out[0] = '"';
+    for (int i = 0; i < 8; i++) out[1 + i] = hex[(hash >> (28 - 4 * i)) & 15];
+    out[9] = '"';
+    out[10] = '\0';
+}
+
+// Function to handle /api/status - the numbers without the page, for apps and scripts
+// A client that sends back the ETag it got gets "304 Not Modified" (no body) until
+// something changes - polling costs a few header bytes
+void handleApiStatus() {
+    size_t length = buildStatusJson();
+    if (length == 0) {
+        webServer.send(500, "application/json", "{\"error\":\"status too big\"}");
+        return;
+    }
+    
+    char etag[11];
+    makeEtag(etag, statusJson, length);
+    webServer.sendHeader("ETag", etag);
+    webServer.sendHeader("Cache-Control", "no-cache");  // Always ask - the answer may be 304
+    
+    if (webServer.header("If-None-Match") == etag) {
+        webServer.send(304);
+        return;
+    }
+    webServer.setContentLength(length);
+    webServer.send(200, "application/json", "");
+    webServer.sendContent(statusJson, length);
 }
 
 // Function to handle LED ON command from web
@@ -177,10 +582,19 @@ void handleRefresh() {
 // Function to set up web server routes
 // Think of this as making a map of what happens when people visit different pages
 void setupWebServer() {
+    if (!compilePageTemplate(pageTemplate)) {
+        Serial.println("Page template error - check the {{NAMES}}!");
+    }
+    
     webServer.on("/", handleWebRoot);          // Main page
     webServer.on("/led_on", handleLEDOn);      // LED on command
     webServer.on("/led_off", handleLEDOff);    // LED off command
     webServer.on("/refresh", handleRefresh);    // Refresh data
+    webServer.on("/api/status", handleApiStatus);  // Just the numbers, as JSON
+    
+    // WebServer only keeps the request headers it is asked to keep
+    static const char *headerKeys[] = {"If-None-Match"};
+    webServer.collectHeaders(headerKeys, 1);
     
     // Handle page not found
     webServer.onNotFound([]() {
@@ -214,8 +628,10 @@ void processBluetoothMessages() {
             bluetooth.println("LED turned OFF! ❌");
             
         } else if (message.equalsIgnoreCase("STATUS")) {
+            char temperatureText[16];
+            formatFixed(temperatureText, temperature, 1);
             bluetooth.println("📊 ESP32 Status Report:");
-            bluetooth.println("🌡️ Temperature: " + String(temperature) + "°C");
+            bluetooth.println("🌡️ Temperature: " + String(temperatureText) + "°C");
             bluetooth.println("💡 Light: " + String(lightLevel) + "/1023");
             bluetooth.println("🔆 LED: " + String(ledState ? "ON" : "OFF"));
             bluetooth.println("📶 WiFi: " + String(WiFi.RSSI()) + " dBm");
@@ -231,8 +647,10 @@ void processBluetoothMessages() {
             // Simulate new sensor readings
             temperature = 20.0 + random(0, 100) / 10.0;
             lightLevel = random(0, 1024);
+            char temperatureText[16];
+            formatFixed(temperatureText, temperature, 1);
             bluetooth.println("📊 Fresh sensor readings:");
-            bluetooth.println("🌡️ " + String(temperature) + "°C");
+            bluetooth.println("🌡️ " + String(temperatureText) + "°C");
             bluetooth.println("💡 " + String(lightLevel) + "/1023");
             
         } else {
@@ -334,6 +752,9 @@ void loop() {
  * ✅ Visitor counter
  * ✅ Communication status
  * ✅ Responsive design
+ * ✅ /api/status - the same data as JSON, e.g.:
+ *    curl -i http://<ip>/api/status
+ *    curl -i -H 'If-None-Match: "<etag>"' http://<ip>/api/status  (304 if unchanged)
  * 
  * Bluetooth Commands to Try:
  * - "LED ON" / "LED OFF" - Control LED
@@ -360,6 +781,11 @@ void loop() {
  * - Try accessing from same network only
  * - Use IP address, not device name
  * - Refresh page if it seems stuck
+ * - "Page template error" at start-up: a {{NAME}} in pageTemplate that
+ *   isn't in pageSlotNames, or more than PAGE_MAX_PARTS parts
+ * - /api/status answers 500 "status too big": long messages no longer
+ *   fit in STATUS_BUFFER_SIZE - make it bigger
+ * - Never a 304? The client must send back the ETag exactly, quotes included
  * 
  * Advanced Features You Could Add:
  * 1. Password protection for web interface
@@ -376,4 +802,6 @@ void loop() {
  * - Add authentication for real projects
  * - Use HTTPS for sensitive data
  * - Be careful with Bluetooth - anyone nearby can connect
+ * - Messages are HTML-escaped before they go into the page - never put
+ *   text from outside into HTML as it is
  */
\ No newline at end of file
@@ -0,0 +1,685 @@
+/*
+ * MODULE 4 - LESSON 5: I2C Transaction Engine - Queue, Burst, Batch
+ *
+ * What you'll learn:
+ * - What one Wire.beginTransmission/endTransmission/requestFrom really
+ *   costs on the bus (bits, START/STOP, driver calls)
+ * - Transactions as descriptors: "write these bytes, then read N back"
+ * - Burst reads: one register address, many bytes - and why it is the
+ *   ONLY safe way to read a 16/20-bit sensor value (no torn samples)
+ * - A request queue with completion callbacks: loop() asks, gets called back
+ * - Batching: several sensors' reads in ONE bus session (repeated START)
+ * - What happens when a device doesn't answer (NACK) in the middle of a batch
+ *
+ * Think of it like a delivery driver:
+ * - The old way: drive to the shop for ONE item, drive home, drive back
+ *   for the next item - the road (bus) is mostly empty trips
+ * - Burst read: take the whole shelf in one trip
+ * - Batching: one round trip, stopping at several shops on the way
+ * - Callbacks: the driver rings your doorbell when your order arrives,
+ *   you don't stand at the window waiting
+ *
+ * I2C costs, roughly: every byte is 9 clocks (8 data + ACK), START and
+ * STOP about one clock each. At 100 kHz one clock is 10 us; at 400 kHz
+ * 2.5 us. On top of that every call into the ESP32 I2C driver costs time
+ * (locking, setting up the hardware command list, waiting for the ISR).
+ * We ASSUME 25 us per driver call here - measure it on your own board.
+ *
+ * This program runs on Linux. A simulated I2C bus with a BMP280 and an
+ * MPU6050 model (register maps, auto-increment, sample updates, burst
+ * shadowing) stands in for the real wires:
+ *   gcc -O2 -o i2c_engine 05_i2c_transaction_engine.c -lm && ./i2c_engine
+ *
+ * The same engine drives the sensors in Module 4 (01_i2c_sensors.c):
+ * an I2C task runs each batch as one ESP-IDF command list.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define I2C_QUEUE_SIZE          16          // Transactions waiting for the bus
+#define I2C_MAX_BATCH           8           // Transactions per bus session
+#define I2C_MAX_WRITE           8           // Register address + a few data bytes
+#define DRIVER_CALL_US          25.0        // Assumed cost of one driver call
+
+#define BMP280_ADDRESS          0x76
+#define MPU6050_ADDRESS         0x68
+
+/*
+ * PART 1: Transactions and the engine
+ * A transaction = write write_len bytes, then (repeated START) read
+ * read_len bytes. Either part may be empty. The engine takes up to
+ * I2C_MAX_BATCH queued transactions and hands them to the bus as one
+ * session: START ... repeated START ... STOP.
+ */
+typedef enum {
+    I2C_OK = 0,
+    I2C_NACK = -1,                          // Nobody answered the address
+    I2C_QUEUE_FULL = -2,
+    I2C_PENDING = 1
+} i2c_status_t;
+
+typedef struct i2c_txn i2c_txn_t;
+typedef void (*i2c_done_fn)(i2c_txn_t* txn, void* ctx);
+
+struct i2c_txn {
+    uint8_t address;
+    uint8_t write_len;
+    uint8_t read_len;
+    uint8_t write_buf[I2C_MAX_WRITE];
+    uint8_t* read_buf;
+    i2c_done_fn done;
+    void* ctx;
+    int status;
+};
+
+// Runs one session. Returns the index of the transaction that got a NACK
+// (the bus sent STOP right there), or count if all were acknowledged.
+typedef struct {
+    int (*session)(void* ctx, i2c_txn_t* const* txns, int count);
+    void* ctx;
+} i2c_backend_t;
+
+typedef struct {
+    i2c_txn_t* queue[I2C_QUEUE_SIZE];
+    int head;
+    int count;
+    i2c_backend_t backend;
+    uint32_t sessions;
+    uint32_t completed;
+    uint32_t failed;
+} i2c_engine_t;
+
+void i2c_engine_init(i2c_engine_t* engine, i2c_backend_t backend)
+{
+    memset(engine, 0, sizeof(*engine));
+    engine->backend = backend;
+}
+
+// "Read len registers starting at reg" - the common case, as a descriptor
+void i2c_txn_read_regs(i2c_txn_t* txn, uint8_t address, uint8_t reg, uint8_t* buf, uint8_t len,
+                       i2c_done_fn done, void* ctx)
+{
+    txn->address = address;
+    txn->write_len = 1;
+    txn->write_buf[0] = reg;
+    txn->read_len = len;
+    txn->read_buf = buf;
+    txn->done = done;
+    txn->ctx = ctx;
+    txn->status = I2C_PENDING;
+}
+
+void i2c_txn_write_reg(i2c_txn_t* txn, uint8_t address, uint8_t reg, uint8_t value,
+                       i2c_done_fn done, void* ctx)
+{
+    txn->address = address;
+    txn->write_len = 2;
+    txn->write_buf[0] = reg;
+    txn->write_buf[1] = value;
+    txn->read_len = 0;
+    txn->read_buf = NULL;
+    txn->done = done;
+    txn->ctx = ctx;
+    txn->status = I2C_PENDING;
+}
+
+// Queue a transaction. It (and its read buffer) must stay valid until the
+// callback ran.
+int i2c_submit(i2c_engine_t* engine, i2c_txn_t* txn)
+{
+    if (engine->count == I2C_QUEUE_SIZE) return I2C_QUEUE_FULL;
+    engine->queue[(engine->head + engine->count) % I2C_QUEUE_SIZE] = txn;
+    engine->count++;
+    txn->status = I2C_PENDING;
+    return I2C_OK;
+}
+
+void i2c_complete(i2c_engine_t* engine, i2c_txn_t* txn, int status)
+{
+    txn->status = status;
+    if (status == I2C_OK) engine->completed++;
+    else engine->failed++;
+    if (txn->done) txn->done(txn, txn->ctx);
+}
+
+// Run ONE session with up to max_batch queued transactions. A NACK ends
+// the session at that transaction: the ones before it are done, it fails,
+// the ones after it stay queued for the next session.
+// Returns the number of transactions finished (ok or failed).
+int i2c_engine_run_once(i2c_engine_t* engine, int max_batch)
+{
+    if (engine->count == 0) return 0;
+    if (max_batch > I2C_MAX_BATCH) max_batch = I2C_MAX_BATCH;
+
+    i2c_txn_t* batch[I2C_MAX_BATCH];
+    int n = engine->count < max_batch ? engine->count : max_batch;
+    for (int i = 0; i < n; i++) batch[i] = engine->queue[(engine->head + i) % I2C_QUEUE_SIZE];
+
+    int acked = engine->backend.session(engine->backend.ctx, batch, n);
+    engine->sessions++;
+
+    int finished = acked < n ? acked + 1 : n;
+    engine->head = (engine->head + finished) % I2C_QUEUE_SIZE;
+    engine->count -= finished;
+
+    // Callbacks after the queue is updated, so they may submit new work
+    for (int i = 0; i < acked; i++) i2c_complete(engine, batch[i], I2C_OK);
+    if (acked < n) i2c_complete(engine, batch[acked], I2C_NACK);
+    return finished;
+}
+
+// Drain the queue (the I2C task's main loop on the ESP32)
+void i2c_engine_run(i2c_engine_t* engine, int max_batch)
+{
+    while (engine->count > 0) {
+        i2c_engine_run_once(engine, max_batch);
+    }
+}
+
+/*
+ * PART 2: The simulated bus and sensors
+ * Devices are register maps with an auto-incrementing register pointer.
+ * Sensors make a new sample every sample_ns of BUS time. Like the real
+ * chips, a burst read is "shadowed": the sample is frozen from the first
+ * byte to the STOP/repeated START, so all its bytes belong together.
+ */
+#define SAMPLE_HISTORY          64
+
+typedef struct sim_device sim_device_t;
+
+struct sim_device {
+    const char* name;
+    uint8_t address;
+    uint8_t regs[256];
+    uint8_t pointer;
+    uint8_t data_reg, data_len;             // Where the measurement lives
+    double sample_ns;
+    double next_sample_ns;
+    uint32_t sample_count;
+    uint8_t history[SAMPLE_HISTORY][14];    // Recent samples, to spot torn reads
+    void (*make_sample)(sim_device_t* dev, uint32_t k);
+    bool (*running)(const sim_device_t* dev);
+};
+
+typedef struct {
+    sim_device_t* devices[4];
+    int device_count;
+    uint32_t clock_hz;
+    double now_ns;                          // Bus time
+    uint32_t bytes;                         // Bytes on the wire (address + data)
+    uint32_t sessions;
+    uint32_t driver_calls;
+} sim_bus_t;
+
+void sim_device_update(sim_device_t* dev, double now_ns)
+{
+    if (!dev->running(dev)) {
+        dev->next_sample_ns = now_ns + dev->sample_ns;
+        return;
+    }
+    while (now_ns >= dev->next_sample_ns) {
+        dev->make_sample(dev, dev->sample_count);
+        memcpy(dev->history[dev->sample_count % SAMPLE_HISTORY], &dev->regs[dev->data_reg], dev->data_len);
+        dev->sample_count++;
+        dev->next_sample_ns += dev->sample_ns;
+    }
+}
+
+// Did these bytes ever exist together as one sample?
+bool sim_device_is_real_sample(const sim_device_t* dev, const uint8_t* data)
+{
+    uint32_t n = dev->sample_count < SAMPLE_HISTORY ? dev->sample_count : SAMPLE_HISTORY;
+    for (uint32_t i = 0; i < n; i++) {
+        if (memcmp(dev->history[i], data, dev->data_len) == 0) return true;
+    }
+    return false;
+}
+
+sim_device_t* sim_find(sim_bus_t* bus, uint8_t address)
+{
+    for (int i = 0; i < bus->device_count; i++) {
+        if (bus->devices[i]->address == address) return bus->devices[i];
+    }
+    return NULL;
+}
+
+void sim_clocks(sim_bus_t* bus, uint32_t clocks)
+{
+    bus->now_ns += clocks * 1e9 / bus->clock_hz;
+    for (int i = 0; i < bus->device_count; i++) sim_device_update(bus->devices[i], bus->now_ns);
+}
+
+int sim_session(void* ctx, i2c_txn_t* const* txns, int count)
+{
+    sim_bus_t* bus = (sim_bus_t*)ctx;
+    bus->sessions++;
+    bus->driver_calls++;
+    bus->now_ns += DRIVER_CALL_US * 1000;
+    sim_clocks(bus, 1);                     // START
+
+    for (int t = 0; t < count; t++) {
+        i2c_txn_t* txn = txns[t];
+        sim_device_t* dev = sim_find(bus, txn->address);
+        if (t > 0) sim_clocks(bus, 1);      // Repeated START
+
+        if (txn->write_len > 0 || txn->read_len == 0) {
+            sim_clocks(bus, 9);             // Address + W
+            bus->bytes++;
+            if (!dev) {
+                sim_clocks(bus, 1);         // STOP after the NACK
+                return t;
+            }
+            for (int i = 0; i < txn->write_len; i++) {
+                sim_clocks(bus, 9);
+                bus->bytes++;
+                if (i == 0) {
+                    dev->pointer = txn->write_buf[0];
+                } else {
+                    dev->regs[dev->pointer++] = txn->write_buf[i];
+                }
+            }
+        }
+        if (txn->read_len > 0) {
+            if (txn->write_len > 0) sim_clocks(bus, 1);   // Repeated START
+            sim_clocks(bus, 9);             // Address + R
+            bus->bytes++;
+            if (!dev) {
+                sim_clocks(bus, 1);
+                return t;
+            }
+            // Shadowing: take the sample as it is NOW, for the whole burst
+            uint8_t shadow[256];
+            memcpy(shadow, dev->regs, sizeof(shadow));
+            for (int i = 0; i < txn->read_len; i++) {
+                sim_clocks(bus, 9);
+                bus->bytes++;
+                txn->read_buf[i] = shadow[dev->pointer++];
+            }
+        }
+    }
+    sim_clocks(bus, 1);                     // STOP
+    return count;
+}
+
+/*
+ * The BMP280 model: chip ID 0x58 at 0xD0, the datasheet's example
+ * calibration at 0x88, ctrl_meas at 0xF4 (sleep after reset), and the
+ * 20-bit pressure + temperature at 0xF7..0xFC (MSB first).
+ */
+void bmp280_make_sample(sim_device_t* dev, uint32_t k)
+{
+    uint32_t raw_press = 415148 + (k * 1237) % 30000;
+    uint32_t raw_temp = 519888 + (k * 911) % 40000;
+    dev->regs[0xF7] = (uint8_t)(raw_press >> 12);
+    dev->regs[0xF8] = (uint8_t)(raw_press >> 4);
+    dev->regs[0xF9] = (uint8_t)((raw_press & 15) << 4);
+    dev->regs[0xFA] = (uint8_t)(raw_temp >> 12);
+    dev->regs[0xFB] = (uint8_t)(raw_temp >> 4);
+    dev->regs[0xFC] = (uint8_t)((raw_temp & 15) << 4);
+}
+
+bool bmp280_running(const sim_device_t* dev)
+{
+    return (dev->regs[0xF4] & 3) == 3;      // Normal mode
+}
+
+void bmp280_init(sim_device_t* dev)
+{
+    static const uint16_t calib[12] = {
+        27504, 26435, (uint16_t)-1000, 36477, (uint16_t)-10685, 3024,
+        2855, 140, (uint16_t)-7, 15500, (uint16_t)-14600, 6000
+    };
+    memset(dev, 0, sizeof(*dev));
+    dev->name = "BMP280";
+    dev->address = BMP280_ADDRESS;
+    dev->regs[0xD0] = 0x58;
+    for (int i = 0; i < 12; i++) {          // Little-endian, like the chip
+        dev->regs[0x88 + 2 * i] = (uint8_t)calib[i];
+        dev->regs[0x89 + 2 * i] = (uint8_t)(calib[i] >> 8);
+    }
+    dev->regs[0xF7] = 0x80;                 // Reset value: "no measurement yet"
+    dev->regs[0xFA] = 0x80;
+    dev->data_reg = 0xF7;
+    dev->data_len = 6;
+    dev->sample_ns = 6.4e6;                 // x1 oversampling + 0.5 ms standby
+    dev->make_sample = bmp280_make_sample;
+    dev->running = bmp280_running;
+}
+
+/*
+ * The MPU6050 model: WHO_AM_I 0x68 at 0x75, PWR_MGMT_1 at 0x6B (asleep
+ * after reset), accel/temp/gyro as 7 big-endian int16 at 0x3B..0x48.
+ */
+void mpu6050_make_sample(sim_device_t* dev, uint32_t k)
+{
+    int16_t v[7] = {
+        (int16_t)(k * 7), (int16_t)(k * 13), (int16_t)(16384 - (k % 64)),
+        (int16_t)(-521 + (int)(k % 50)),    // Temperature: -521 = 35.0 C
+        (int16_t)(k * 3), (int16_t)(-(int)(k * 5)), (int16_t)(k * 11)
+    };
+    for (int i = 0; i < 7; i++) {
+        dev->regs[0x3B + 2 * i] = (uint8_t)((uint16_t)v[i] >> 8);
+        dev->regs[0x3C + 2 * i] = (uint8_t)v[i];
+    }
+}
+
+bool mpu6050_running(const sim_device_t* dev)
+{
+    return (dev->regs[0x6B] & 0x40) == 0;   // SLEEP bit clear
+}
+
+void mpu6050_init(sim_device_t* dev)
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->name = "MPU6050";
+    dev->address = MPU6050_ADDRESS;
+    dev->regs[0x75] = 0x68;
+    dev->regs[0x6B] = 0x40;                 // Asleep after power-on
+    dev->data_reg = 0x3B;
+    dev->data_len = 14;
+    dev->sample_ns = 1e6;                   // 1 kHz sample rate
+    dev->make_sample = mpu6050_make_sample;
+    dev->running = mpu6050_running;
+}
+
+typedef struct {
+    sim_bus_t bus;
+    sim_device_t bmp;
+    sim_device_t mpu;
+    i2c_engine_t engine;
+} rig_t;
+
+void rig_init(rig_t* rig, uint32_t clock_hz)
+{
+    memset(&rig->bus, 0, sizeof(rig->bus));
+    bmp280_init(&rig->bmp);
+    mpu6050_init(&rig->mpu);
+    rig->bus.devices[0] = &rig->bmp;
+    rig->bus.devices[1] = &rig->mpu;
+    rig->bus.device_count = 2;
+    rig->bus.clock_hz = clock_hz;
+    i2c_backend_t backend = {sim_session, &rig->bus};
+    i2c_engine_init(&rig->engine, backend);
+
+    // Wake both sensors: BMP280 normal mode, MPU6050 out of sleep
+    i2c_txn_t wake[2];
+    i2c_txn_write_reg(&wake[0], BMP280_ADDRESS, 0xF4, 0x27, NULL, NULL);
+    i2c_txn_write_reg(&wake[1], MPU6050_ADDRESS, 0x6B, 0x00, NULL, NULL);
+    i2c_submit(&rig->engine, &wake[0]);
+    i2c_submit(&rig->engine, &wake[1]);
+    i2c_engine_run(&rig->engine, I2C_MAX_BATCH);
+    sim_clocks(&rig->bus, (uint32_t)(rig->bus.clock_hz / 50));     // Let both make samples (20 ms)
+}
+
+/*
+ * PART 3: Three ways to read both sensors
+ * Old: readByteFromDevice() per register - Wire makes TWO driver calls
+ * (endTransmission + requestFrom) per byte.
+ * Burst: one write-then-read per sensor, one session each.
+ * Batched: both burst reads in ONE session.
+ */
+void read_old_way(rig_t* rig, uint8_t* bmp, uint8_t* mpu)
+{
+    i2c_txn_t txn;
+    for (int i = 0; i < 6; i++) {
+        i2c_txn_read_regs(&txn, BMP280_ADDRESS, (uint8_t)(0xF7 + i), &bmp[i], 1, NULL, NULL);
+        i2c_submit(&rig->engine, &txn);
+        i2c_engine_run(&rig->engine, 1);
+        rig->bus.now_ns += DRIVER_CALL_US * 1000;   // The second Wire call
+        rig->bus.driver_calls++;
+    }
+    for (int i = 0; i < 14; i++) {
+        i2c_txn_read_regs(&txn, MPU6050_ADDRESS, (uint8_t)(0x3B + i), &mpu[i], 1, NULL, NULL);
+        i2c_submit(&rig->engine, &txn);
+        i2c_engine_run(&rig->engine, 1);
+        rig->bus.now_ns += DRIVER_CALL_US * 1000;
+        rig->bus.driver_calls++;
+    }
+}
+
+void read_burst(rig_t* rig, uint8_t* bmp, uint8_t* mpu, int max_batch)
+{
+    i2c_txn_t txn[2];
+    i2c_txn_read_regs(&txn[0], BMP280_ADDRESS, 0xF7, bmp, 6, NULL, NULL);
+    i2c_txn_read_regs(&txn[1], MPU6050_ADDRESS, 0x3B, mpu, 14, NULL, NULL);
+    i2c_submit(&rig->engine, &txn[0]);
+    i2c_submit(&rig->engine, &txn[1]);
+    i2c_engine_run(&rig->engine, max_batch);
+}
+
+/*
+ * DEMO 1: Bus cost and torn samples
+ * 500 sample sets (BMP280 pressure+temperature, MPU6050 accel+temp+gyro)
+ * read each way. A "torn" read mixes bytes of two different samples -
+ * e.g. the MSB of the old temperature with the LSB of the new one.
+ */
+void compare_demo(uint32_t clock_hz)
+{
+    const char* names[3] = {"Register by register", "Burst, 1 session each", "Burst, batched"};
+    printf("%-24s %9s %9s %9s %10s %9s\n", "Method", "Sessions", "Calls", "Bytes", "us/set", "Torn");
+
+    for (int method = 0; method < 3; method++) {
+        static rig_t rig;
+        rig_init(&rig, clock_hz);
+        uint32_t sessions0 = rig.bus.sessions, calls0 = rig.bus.driver_calls, bytes0 = rig.bus.bytes;
+        double t0 = rig.bus.now_ns;
+
+        const int sets = 500;
+        int torn = 0;
+        for (int s = 0; s < sets; s++) {
+            uint8_t bmp[6], mpu[14];
+            if (method == 0) read_old_way(&rig, bmp, mpu);
+            else read_burst(&rig, bmp, mpu, method == 1 ? 1 : I2C_MAX_BATCH);
+            if (!sim_device_is_real_sample(&rig.bmp, bmp)) torn++;
+            if (!sim_device_is_real_sample(&rig.mpu, mpu)) torn++;
+            sim_clocks(&rig.bus, clock_hz / 1000);      // 1 ms of other work
+        }
+        double us = (rig.bus.now_ns - t0) / 1000.0 / sets - 1000.0;
+        printf("%-24s %9.1f %9.1f %9.1f %10.1f %8.1f%%\n", names[method],
+               (rig.bus.sessions - sessions0) / (double)sets, (rig.bus.driver_calls - calls0) / (double)sets,
+               (rig.bus.bytes - bytes0) / (double)sets, us, torn * 100.0 / (2 * sets));
+    }
+}
+
+void cost_demo(void)
+{
+    printf("=== DEMO 1: Reading BMP280 (6 bytes) + MPU6050 (14 bytes) ===\n");
+    printf("(assuming %.0f us per I2C driver call)\n\n", DRIVER_CALL_US);
+    printf("100 kHz:\n");
+    compare_demo(100000);
+    printf("\n400 kHz:\n");
+    compare_demo(400000);
+    printf("\nByte by byte, the sensors make new samples DURING the read: the bytes\n");
+    printf("don't belong together. A burst read is shadowed by the chip - never torn.\n\n");
+}
+
+/*
+ * DEMO 2: Queue, callbacks, NACK handling - correctness
+ * Three "users" (like three parts of loop()) queue reads; one asks for a
+ * device that isn't there (0x77). Every callback must fire exactly once,
+ * in order, with data identical to the device registers.
+ */
+typedef struct {
+    int calls;
+    int order;
+    int status;
+} callback_log_t;
+
+int callback_counter;
+
+void log_done(i2c_txn_t* txn, void* ctx)
+{
+    callback_log_t* log = (callback_log_t*)ctx;
+    log->calls++;
+    log->order = callback_counter++;
+    log->status = txn->status;
+}
+
+void queue_demo(void)
+{
+    printf("=== DEMO 2: Queue, Callbacks and a Missing Device ===\n");
+
+    static rig_t rig;
+    rig_init(&rig, 400000);
+    // Stop the sensors so the registers hold still for the comparison
+    rig.bmp.regs[0xF4] = 0;
+    rig.mpu.regs[0x6B] = 0x40;
+
+    enum { N = 12 };
+    i2c_txn_t txn[N];
+    uint8_t buf[N][32];
+    callback_log_t log[N];
+    memset(log, 0, sizeof(log));
+    memset(buf, 0, sizeof(buf));
+    callback_counter = 0;
+
+    struct {
+        uint8_t address, reg, len;
+        const char* what;
+    } plan[N] = {
+        {0x76, 0xD0, 1, "BMP280 chip ID"},
+        {0x76, 0x88, 24, "BMP280 calibration"},
+        {0x68, 0x75, 1, "MPU6050 WHO_AM_I"},
+        {0x76, 0xF7, 6, "BMP280 data"},
+        {0x77, 0xD0, 1, "second BMP280 (absent)"},
+        {0x68, 0x3B, 14, "MPU6050 data"},
+        {0x68, 0x6B, 1, "MPU6050 power"},
+        {0x76, 0xF4, 2, "BMP280 ctrl+config"},
+        {0x68, 0x3B, 6, "MPU6050 accel only"},
+        {0x76, 0xFA, 3, "BMP280 temperature"},
+        {0x77, 0xF7, 6, "second BMP280 data"},
+        {0x68, 0x41, 2, "MPU6050 temperature"},
+    };
+    for (int i = 0; i < N; i++) {
+        i2c_txn_read_regs(&txn[i], plan[i].address, plan[i].reg, buf[i], plan[i].len, log_done, &log[i]);
+        if (i2c_submit(&rig.engine, &txn[i]) != I2C_OK) printf("Queue full at %d!\n", i);
+    }
+    uint32_t sessions_before = rig.engine.sessions;
+    i2c_engine_run(&rig.engine, I2C_MAX_BATCH);
+
+    int errors = 0;
+    printf("%-3s %-24s %5s %8s %6s %s\n", "#", "Read", "Addr", "Status", "Order", "Data check");
+    for (int i = 0; i < N; i++) {
+        sim_device_t* dev = sim_find(&rig.bus, plan[i].address);
+        bool expect_ok = dev != NULL;
+        bool data_ok = !expect_ok || memcmp(buf[i], &dev->regs[plan[i].reg], plan[i].len) == 0;
+        bool ok = log[i].calls == 1 && log[i].order == i &&
+                  (log[i].status == I2C_OK) == expect_ok && data_ok;
+        if (!ok) errors++;
+        printf("%-3d %-24s 0x%02X %8s %6d %s\n", i + 1, plan[i].what, plan[i].address,
+               log[i].status == I2C_OK ? "OK" : "NACK", log[i].order + 1,
+               !expect_ok ? "(no device)" : data_ok ? "matches registers" : "WRONG");
+    }
+    printf("Sessions: %u for %d transactions (max %d per batch; a NACK ends a session)\n",
+           rig.engine.sessions - sessions_before, N, I2C_MAX_BATCH);
+    printf("Result: %s\n\n", errors == 0 ? "PASS" : "FAIL");
+}
+
+/*
+ * DEMO 3: Throughput
+ * How many complete sample sets per second fit on the bus, and what the
+ * engine itself costs in CPU time (simulated bus with zero-time backend).
+ */
+double nanos_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int null_session(void* ctx, i2c_txn_t* const* txns, int count)
+{
+    (void)txns;
+    (*(uint32_t*)ctx) += (uint32_t)count;
+    return count;
+}
+
+void count_done(i2c_txn_t* txn, void* ctx)
+{
+    (void)txn;
+    (*(uint32_t*)ctx)++;
+}
+
+void throughput_demo(void)
+{
+    printf("=== DEMO 3: Throughput ===\n");
+
+    for (int clock = 0; clock < 2; clock++) {
+        uint32_t hz = clock ? 400000 : 100000;
+        for (int method = 0; method < 3; method++) {
+            static rig_t rig;
+            rig_init(&rig, hz);
+            double t0 = rig.bus.now_ns;
+            const int sets = 200;
+            for (int s = 0; s < sets; s++) {
+                uint8_t bmp[6], mpu[14];
+                if (method == 0) read_old_way(&rig, bmp, mpu);
+                else read_burst(&rig, bmp, mpu, method == 1 ? 1 : I2C_MAX_BATCH);
+            }
+            double sets_per_s = sets / ((rig.bus.now_ns - t0) / 1e9);
+            printf("%3u kHz %-22s %7.0f sample sets/s\n", hz / 1000,
+                   method == 0 ? "register by register" : method == 1 ? "burst" : "burst + batched",
+                   sets_per_s);
+        }
+    }
+
+    // Engine overhead on this PC: submit + batch + callback
+    static i2c_engine_t engine;
+    uint32_t segments = 0, callbacks = 0;
+    i2c_backend_t backend = {null_session, &segments};
+    i2c_engine_init(&engine, backend);
+    static i2c_txn_t txns[I2C_MAX_BATCH];
+    static uint8_t buf[I2C_MAX_BATCH][14];
+
+    const int rounds = 2000000;
+    double t0 = nanos_now();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < I2C_MAX_BATCH; i++) {
+            i2c_txn_read_regs(&txns[i], MPU6050_ADDRESS, 0x3B, buf[i], 14, count_done, &callbacks);
+            i2c_submit(&engine, &txns[i]);
+        }
+        i2c_engine_run(&engine, I2C_MAX_BATCH);
+    }
+    double ns = (nanos_now() - t0) / ((double)rounds * I2C_MAX_BATCH);
+    printf("Engine overhead: %.1f ns per transaction (%u callbacks) - the bus is the\n", ns, callbacks);
+    printf("limit, not the queue: one 14-byte read is ~%.0f us on the wire at 400 kHz.\n\n",
+           (1 + 9 + 9 + 1 + 9 + 14 * 9 + 1) * 2.5);
+}
+
+int main(void)
+{
+    printf("I2C Transaction Engine - Fewer, Fuller Bus Sessions\n");
+    printf("===================================================\n\n");
+
+    cost_demo();
+    queue_demo();
+    throughput_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. Per-register reads pay START, address and driver overhead for every byte\n");
+    printf("2. Burst reads use the sensor's auto-increment: one address, many bytes\n");
+    printf("3. Only a burst read gives bytes from ONE sample - single reads get torn\n");
+    printf("4. Descriptors + a queue + callbacks: loop() never waits on the bus\n");
+    printf("5. Batching several devices into one session saves driver calls\n");
+    printf("6. A NACK only fails its own transaction; the rest run in the next session\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. Count the bus cost: 9 clocks per byte, plus START/STOP and driver calls
+ * 2. Sensors are built for burst reads - use them for every multi-byte value
+ * 3. A transaction descriptor says everything: address, write, read, callback
+ * 4. The queue decouples "I want this data" from "the bus is free now"
+ * 5. Repeated START lets one session talk to several devices
+ * 6. Simulated devices with real register maps make bus code testable on a PC
+ *
+ * Next: Find every device once at boot - an I2C device registry!
+ */
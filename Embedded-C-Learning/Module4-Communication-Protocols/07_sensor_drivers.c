@@ -0,0 +1,796 @@
+/*
+ * MODULE 4 - LESSON 7: Sensor Drivers - Burst Reads, Compensation, FIFO
+ *
+ * What you'll learn:
+ * - A real driver's job: check the chip ID, configure, read, convert
+ * - BMP280: read the factory calibration ONCE (24 bytes, one burst),
+ *   read pressure + temperature in ONE 6-byte burst, then run the
+ *   datasheet's integer compensation (no floats needed)
+ * - MPU6050: accel + temperature + gyro as ONE 14-byte burst
+ * - The MPU6050's 1 KB FIFO: the chip collects samples by itself and
+ *   you fetch many at once - no sample lost when loop() is late
+ * - How to notice a FIFO overflow and get back in step
+ *
+ * Think of it like a mailbox:
+ * - Polling the data registers = standing at the door waiting for the
+ *   postman. Step away for a moment and you miss a letter; come back
+ *   twice and you read the same letter again
+ * - The FIFO = a mailbox. The postman drops letters in, you empty it
+ *   whenever you pass by - every letter, in order, exactly once
+ * - Overflow = the mailbox is stuffed; the oldest letters fall out. Empty
+ *   it, say how many are gone, and start counting again
+ *
+ * Bus costs are modelled as in lesson 5: 9 clocks per byte, START/STOP,
+ * and an ASSUMED 25 us per driver call.
+ *
+ * This program runs on Linux. Register-level BMP280 and MPU6050 models
+ * (calibration, sample timing, FIFO with overflow) on a simulated bus
+ * stand in for the real chips:
+ *   gcc -O2 -o sensor_drivers 07_sensor_drivers.c -lm && ./sensor_drivers
+ *
+ * The same drivers run in Module 4 (01_i2c_sensors.c).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#define DRIVER_CALL_US          25.0        // Assumed cost of one driver call
+#define BUS_CLOCK_HZ            400000
+
+#define BMP280_ADDRESS          0x76
+#define BMP280_REG_CALIB        0x88        // 24 bytes: dig_T1..dig_P9, little-endian
+#define BMP280_REG_ID           0xD0
+#define BMP280_REG_CTRL_MEAS    0xF4
+#define BMP280_REG_CONFIG       0xF5
+#define BMP280_REG_DATA         0xF7        // press[3] + temp[3], MSB first
+
+#define MPU6050_ADDRESS         0x68
+#define MPU6050_REG_SMPLRT_DIV  0x19
+#define MPU6050_REG_CONFIG      0x1A
+#define MPU6050_REG_GYRO_CONFIG 0x1B
+#define MPU6050_REG_ACCEL_CONFIG 0x1C
+#define MPU6050_REG_FIFO_EN     0x23
+#define MPU6050_REG_DATA        0x3B        // accel[3] + temp + gyro[3], int16 MSB first
+#define MPU6050_REG_USER_CTRL   0x6A
+#define MPU6050_REG_PWR_MGMT    0x6B
+#define MPU6050_REG_FIFO_COUNT  0x72        // uint16 MSB first
+#define MPU6050_REG_FIFO_RW     0x74
+#define MPU6050_REG_WHO_AM_I    0x75
+
+#define MPU6050_FIFO_SIZE       1024
+#define MPU6050_FIFO_SAMPLE     12          // accel[3] + gyro[3] per sample
+#define MPU6050_FIFO_CHUNK      10          // Samples per read (120 bytes)
+
+/*
+ * PART 1: The simulated bus
+ * A device is a register map with an auto-incrementing pointer, plus
+ * optional hooks for "live" registers (the FIFO). A transaction runs
+ * atomically at the current bus time, then the time moves on.
+ */
+typedef struct sim_device sim_device_t;
+
+struct sim_device {
+    uint8_t address;
+    uint8_t regs[256];
+    uint8_t pointer;
+    int hold_reg;                           // Burst reads stay on this register (FIFO)
+    void (*update)(sim_device_t* dev, double now_ns);
+    bool (*read)(sim_device_t* dev, uint8_t reg, uint8_t* value);   // false = plain register
+    void (*write)(sim_device_t* dev, uint8_t reg, uint8_t value);
+};
+
+typedef struct {
+    sim_device_t* devices[4];
+    int count;
+    uint32_t clock_hz;
+    double now_ns;
+    double busy_ns;                         // Time the bus (and the CPU in the driver) was busy
+    uint32_t driver_calls;
+    uint32_t bytes;
+} sim_bus_t;
+
+void sim_advance(sim_bus_t* bus, double ns)
+{
+    bus->now_ns += ns;
+    for (int i = 0; i < bus->count; i++) bus->devices[i]->update(bus->devices[i], bus->now_ns);
+}
+
+void sim_charge(sim_bus_t* bus, uint32_t clocks)
+{
+    double ns = DRIVER_CALL_US * 1000 + clocks * 1e9 / bus->clock_hz;
+    bus->driver_calls++;
+    bus->busy_ns += ns;
+    sim_advance(bus, ns);
+}
+
+sim_device_t* sim_find(sim_bus_t* bus, uint8_t address)
+{
+    for (int i = 0; i < bus->count; i++) {
+        if (bus->devices[i]->address == address) return bus->devices[i];
+    }
+    return NULL;
+}
+
+// Write the register address, repeated START, read len bytes
+bool i2c_read(sim_bus_t* bus, uint8_t address, uint8_t reg, uint8_t* buf, int len)
+{
+    sim_device_t* dev = sim_find(bus, address);
+    if (!dev) {
+        sim_charge(bus, 1 + 9 + 1);
+        return false;
+    }
+    dev->pointer = reg;
+    for (int i = 0; i < len; i++) {
+        if (!dev->read || !dev->read(dev, dev->pointer, &buf[i])) buf[i] = dev->regs[dev->pointer];
+        if (dev->pointer != dev->hold_reg) dev->pointer++;
+    }
+    bus->bytes += 3 + len;
+    sim_charge(bus, 1 + 9 + 9 + 1 + 9 + 9 * len + 1);
+    return true;
+}
+
+bool i2c_write_reg(sim_bus_t* bus, uint8_t address, uint8_t reg, uint8_t value)
+{
+    sim_device_t* dev = sim_find(bus, address);
+    if (!dev) {
+        sim_charge(bus, 1 + 9 + 1);
+        return false;
+    }
+    if (dev->write) dev->write(dev, reg, value);
+    else dev->regs[reg] = value;
+    bus->bytes += 3;
+    sim_charge(bus, 1 + 9 + 9 + 9 + 1);
+    return true;
+}
+
+/*
+ * The BMP280 model: the datasheet's example calibration, a new
+ * measurement every 6.4 ms in normal mode, raw values that wander
+ * through a realistic range (sample k is known, so tests can check it).
+ */
+static const uint16_t bmp280_example_calib[12] = {
+    27504, 26435, (uint16_t)-1000, 36477, (uint16_t)-10685, 3024,
+    2855, 140, (uint16_t)-7, 15500, (uint16_t)-14600, 6000
+};
+
+typedef struct {
+    sim_device_t dev;
+    double next_ns;
+    uint32_t samples;
+} bmp280_model_t;
+
+void bmp280_model_raw(uint32_t k, int32_t* adc_t, int32_t* adc_p)
+{
+    *adc_t = 480000 + (int32_t)((k * 7919) % 80000);    // About 10..35 C
+    *adc_p = 330000 + (int32_t)((k * 104729) % 160000); // About 85..115 kPa
+}
+
+void bmp280_model_update(sim_device_t* dev, double now_ns)
+{
+    bmp280_model_t* m = (bmp280_model_t*)dev;
+    if ((dev->regs[BMP280_REG_CTRL_MEAS] & 3) != 3) {   // Not in normal mode
+        m->next_ns = now_ns + 6.4e6;
+        return;
+    }
+    while (now_ns >= m->next_ns) {
+        int32_t t, p;
+        bmp280_model_raw(m->samples++, &t, &p);
+        dev->regs[0xF7] = (uint8_t)(p >> 12);
+        dev->regs[0xF8] = (uint8_t)(p >> 4);
+        dev->regs[0xF9] = (uint8_t)((p & 15) << 4);
+        dev->regs[0xFA] = (uint8_t)(t >> 12);
+        dev->regs[0xFB] = (uint8_t)(t >> 4);
+        dev->regs[0xFC] = (uint8_t)((t & 15) << 4);
+        m->next_ns += 6.4e6;
+    }
+}
+
+void bmp280_model_init(bmp280_model_t* m)
+{
+    memset(m, 0, sizeof(*m));
+    m->dev.address = BMP280_ADDRESS;
+    m->dev.hold_reg = -1;
+    m->dev.update = bmp280_model_update;
+    m->dev.regs[BMP280_REG_ID] = 0x58;
+    for (int i = 0; i < 12; i++) {
+        m->dev.regs[BMP280_REG_CALIB + 2 * i] = (uint8_t)bmp280_example_calib[i];
+        m->dev.regs[BMP280_REG_CALIB + 1 + 2 * i] = (uint8_t)(bmp280_example_calib[i] >> 8);
+    }
+    m->dev.regs[0xF7] = 0x80;               // Reset value: "no measurement yet"
+    m->dev.regs[0xFA] = 0x80;
+}
+
+/*
+ * The MPU6050 model: samples at 1 kHz / (1 + SMPLRT_DIV) (DLPF on),
+ * data registers always hold the newest sample, and with USER_CTRL
+ * FIFO_EN set every sample's accel + gyro (12 bytes) go into a 1024-byte
+ * FIFO. When it is full the OLDEST bytes are dropped - the sample
+ * boundaries are lost, so the driver must reset it. Every value of
+ * sample k is a known function of k, so the tests can check each one.
+ */
+typedef struct {
+    sim_device_t dev;
+    uint8_t fifo[MPU6050_FIFO_SIZE];
+    int fifo_head, fifo_count;
+    uint16_t count_latch;                   // FIFO_COUNT_L belongs to the same read as _H
+    double next_ns;
+    uint32_t samples;
+    uint32_t overflowed_bytes;
+} mpu6050_model_t;
+
+void mpu6050_model_values(uint32_t k, int16_t v[7])
+{
+    v[0] = (int16_t)k;                      // Accel X counts up - easy to check order
+    v[1] = (int16_t)(k * 3 + 100);
+    v[2] = (int16_t)(16384 - (int)(k % 97));
+    v[3] = (int16_t)(-521 + (int)(k % 50)); // Temperature around 35 C
+    v[4] = (int16_t)(k * 7);
+    v[5] = (int16_t)(-(int)(k % 1000));
+    v[6] = (int16_t)(k * 13);
+}
+
+void mpu6050_model_fifo_push(mpu6050_model_t* m, uint8_t byte)
+{
+    if (m->fifo_count == MPU6050_FIFO_SIZE) {   // Full: the oldest byte falls out
+        m->fifo_head = (m->fifo_head + 1) % MPU6050_FIFO_SIZE;
+        m->fifo_count--;
+        m->overflowed_bytes++;
+        m->dev.regs[0x3A] |= 0x10;          // INT_STATUS: FIFO_OFLOW
+    }
+    m->fifo[(m->fifo_head + m->fifo_count) % MPU6050_FIFO_SIZE] = byte;
+    m->fifo_count++;
+}
+
+void mpu6050_model_update(sim_device_t* dev, double now_ns)
+{
+    mpu6050_model_t* m = (mpu6050_model_t*)dev;
+    double period_ns = 1e6 * (1 + dev->regs[MPU6050_REG_SMPLRT_DIV]);
+    if (dev->regs[MPU6050_REG_PWR_MGMT] & 0x40) {   // Asleep
+        m->next_ns = now_ns + period_ns;
+        return;
+    }
+    while (now_ns >= m->next_ns) {
+        int16_t v[7];
+        mpu6050_model_values(m->samples++, v);
+        for (int i = 0; i < 7; i++) {
+            dev->regs[MPU6050_REG_DATA + 2 * i] = (uint8_t)((uint16_t)v[i] >> 8);
+            dev->regs[MPU6050_REG_DATA + 1 + 2 * i] = (uint8_t)v[i];
+        }
+        // FIFO_EN 0x78 = accel + gyro X/Y/Z: 12 bytes, temperature skipped
+        if ((dev->regs[MPU6050_REG_USER_CTRL] & 0x40) && dev->regs[MPU6050_REG_FIFO_EN] == 0x78) {
+            for (int i = 0; i < 7; i++) {
+                if (i == 3) continue;
+                mpu6050_model_fifo_push(m, (uint8_t)((uint16_t)v[i] >> 8));
+                mpu6050_model_fifo_push(m, (uint8_t)v[i]);
+            }
+        }
+        m->next_ns += period_ns;
+    }
+}
+
+bool mpu6050_model_read(sim_device_t* dev, uint8_t reg, uint8_t* value)
+{
+    mpu6050_model_t* m = (mpu6050_model_t*)dev;
+    switch (reg) {
+    case MPU6050_REG_FIFO_COUNT:
+        m->count_latch = (uint16_t)m->fifo_count;
+        *value = (uint8_t)(m->count_latch >> 8);
+        return true;
+    case MPU6050_REG_FIFO_COUNT + 1:
+        *value = (uint8_t)m->count_latch;
+        return true;
+    case MPU6050_REG_FIFO_RW:
+        if (m->fifo_count == 0) {
+            *value = 0xFF;
+        } else {
+            *value = m->fifo[m->fifo_head];
+            m->fifo_head = (m->fifo_head + 1) % MPU6050_FIFO_SIZE;
+            m->fifo_count--;
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+void mpu6050_model_write(sim_device_t* dev, uint8_t reg, uint8_t value)
+{
+    mpu6050_model_t* m = (mpu6050_model_t*)dev;
+    if (reg == MPU6050_REG_USER_CTRL && (value & 0x04)) {   // FIFO_RESET, clears itself
+        m->fifo_head = m->fifo_count = 0;
+        value &= (uint8_t)~0x04;
+    }
+    dev->regs[reg] = value;
+}
+
+void mpu6050_model_init(mpu6050_model_t* m)
+{
+    memset(m, 0, sizeof(*m));
+    m->dev.address = MPU6050_ADDRESS;
+    m->dev.hold_reg = MPU6050_REG_FIFO_RW;
+    m->dev.update = mpu6050_model_update;
+    m->dev.read = mpu6050_model_read;
+    m->dev.write = mpu6050_model_write;
+    m->dev.regs[MPU6050_REG_WHO_AM_I] = 0x68;
+    m->dev.regs[MPU6050_REG_PWR_MGMT] = 0x40;   // Asleep after power-on
+}
+
+/*
+ * PART 2: The BMP280 driver
+ * begin: chip ID, calibration (one 24-byte burst), normal mode.
+ * read: one 6-byte burst, then the datasheet's integer compensation:
+ * temperature in 0.01 C (int32), pressure in Pa as Q24.8 (int64 math).
+ * BME280 uses the same registers and formulas for these two values.
+ */
+typedef struct {
+    uint16_t t1;
+    int16_t t2, t3;
+    uint16_t p1;
+    int16_t p2, p3, p4, p5, p6, p7, p8, p9;
+} bmp280_calib_t;
+
+typedef struct {
+    sim_bus_t* bus;
+    uint8_t address;
+    bmp280_calib_t calib;
+    int32_t t_fine;                         // Temperature, shared with the pressure formula
+} bmp280_t;
+
+bool bmp280_begin(bmp280_t* b, sim_bus_t* bus, uint8_t address)
+{
+    uint8_t id, raw[24];
+    b->bus = bus;
+    b->address = address;
+    if (!i2c_read(bus, address, BMP280_REG_ID, &id, 1) || (id != 0x58 && id != 0x60)) return false;
+    if (!i2c_read(bus, address, BMP280_REG_CALIB, raw, sizeof(raw))) return false;
+
+    uint16_t w[12];
+    for (int i = 0; i < 12; i++) w[i] = (uint16_t)(raw[2 * i] | (raw[2 * i + 1] << 8));
+    b->calib.t1 = w[0];
+    b->calib.t2 = (int16_t)w[1];
+    b->calib.t3 = (int16_t)w[2];
+    b->calib.p1 = w[3];
+    b->calib.p2 = (int16_t)w[4];
+    b->calib.p3 = (int16_t)w[5];
+    b->calib.p4 = (int16_t)w[6];
+    b->calib.p5 = (int16_t)w[7];
+    b->calib.p6 = (int16_t)w[8];
+    b->calib.p7 = (int16_t)w[9];
+    b->calib.p8 = (int16_t)w[10];
+    b->calib.p9 = (int16_t)w[11];
+
+    i2c_write_reg(bus, address, BMP280_REG_CONFIG, 0x00);      // 0.5 ms standby, no filter
+    return i2c_write_reg(bus, address, BMP280_REG_CTRL_MEAS, 0x27);  // x1/x1, normal mode
+}
+
+// Datasheet 3.11.3: returns 0.01 C, sets t_fine
+int32_t bmp280_compensate_t(bmp280_t* b, int32_t adc_t)
+{
+    const bmp280_calib_t* c = &b->calib;
+    int32_t var1 = ((((adc_t >> 3) - ((int32_t)c->t1 << 1))) * (int32_t)c->t2) >> 11;
+    int32_t var2 = (((((adc_t >> 4) - (int32_t)c->t1) * ((adc_t >> 4) - (int32_t)c->t1)) >> 12) *
+                    (int32_t)c->t3) >> 14;
+    b->t_fine = var1 + var2;
+    return (b->t_fine * 5 + 128) >> 8;
+}
+
+// Datasheet 3.11.3: returns Pa in Q24.8 (value / 256 = Pa). Needs t_fine.
+uint32_t bmp280_compensate_p(const bmp280_t* b, int32_t adc_p)
+{
+    const bmp280_calib_t* c = &b->calib;
+    int64_t var1 = (int64_t)b->t_fine - 128000;
+    int64_t var2 = var1 * var1 * c->p6;
+    var2 = var2 + ((var1 * c->p5) * 131072);
+    var2 = var2 + ((int64_t)c->p4 * 34359738368LL);
+    var1 = ((var1 * var1 * c->p3) / 256) + ((var1 * c->p2) * 4096);
+    var1 = ((140737488355328LL + var1) * c->p1) >> 33;
+    if (var1 == 0) return 0;                // Avoid dividing by zero
+    int64_t p = 1048576 - adc_p;
+    p = (((p * 2147483648LL) - var2) * 3125) / var1;
+    var1 = ((int64_t)c->p9 * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t)c->p8 * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + ((int64_t)c->p7 << 4);
+    return (uint32_t)p;
+}
+
+// One burst, both values from the same measurement
+bool bmp280_read(bmp280_t* b, int32_t* centi_c, uint32_t* pa_q8)
+{
+    uint8_t d[6];
+    if (!i2c_read(b->bus, b->address, BMP280_REG_DATA, d, sizeof(d))) return false;
+    int32_t adc_p = (int32_t)((d[0] << 12) | (d[1] << 4) | (d[2] >> 4));
+    int32_t adc_t = (int32_t)((d[3] << 12) | (d[4] << 4) | (d[5] >> 4));
+    *centi_c = bmp280_compensate_t(b, adc_t);  // Temperature first: it sets t_fine
+    *pa_q8 = bmp280_compensate_p(b, adc_p);
+    return true;
+}
+
+/*
+ * PART 3: The MPU6050 driver
+ * begin: WHO_AM_I, wake up on the gyro clock, DLPF on (1 kHz base rate),
+ * +-2 g / +-250 dps, and optionally the FIFO with accel + gyro.
+ * read: one 14-byte burst. drain: FIFO count, then whole samples in
+ * chunks - many samples per driver call.
+ */
+typedef struct {
+    int16_t accel[3];                       // Raw counts, 16384 = 1 g
+    int16_t temp;                           // Raw, only from the data registers
+    int16_t gyro[3];                        // Raw counts, 131 = 1 dps
+} mpu6050_sample_t;
+
+typedef struct {
+    sim_bus_t* bus;
+    uint8_t address;
+    uint32_t overflows;
+} mpu6050_t;
+
+bool mpu6050_begin(mpu6050_t* m, sim_bus_t* bus, uint8_t address, uint16_t rate_hz, bool use_fifo)
+{
+    uint8_t id;
+    m->bus = bus;
+    m->address = address;
+    m->overflows = 0;
+    if (!i2c_read(bus, address, MPU6050_REG_WHO_AM_I, &id, 1) || id != 0x68) return false;
+    i2c_write_reg(bus, address, MPU6050_REG_PWR_MGMT, 0x01);     // Awake, gyro X clock
+    i2c_write_reg(bus, address, MPU6050_REG_CONFIG, 0x01);       // DLPF 184 Hz -> 1 kHz base
+    i2c_write_reg(bus, address, MPU6050_REG_SMPLRT_DIV, (uint8_t)(1000 / rate_hz - 1));
+    i2c_write_reg(bus, address, MPU6050_REG_GYRO_CONFIG, 0x00);  // +-250 dps
+    i2c_write_reg(bus, address, MPU6050_REG_ACCEL_CONFIG, 0x00); // +-2 g
+    if (use_fifo) {
+        i2c_write_reg(bus, address, MPU6050_REG_FIFO_EN, 0x78);  // Accel + gyro X/Y/Z
+        i2c_write_reg(bus, address, MPU6050_REG_USER_CTRL, 0x44); // FIFO on + reset
+    }
+    return true;
+}
+
+void mpu6050_parse(const uint8_t* d, mpu6050_sample_t* s, bool with_temp)
+{
+    int i = 0;
+    for (int a = 0; a < 3; a++, i += 2) s->accel[a] = (int16_t)((d[i] << 8) | d[i + 1]);
+    if (with_temp) {
+        s->temp = (int16_t)((d[i] << 8) | d[i + 1]);
+        i += 2;
+    } else {
+        s->temp = 0;
+    }
+    for (int g = 0; g < 3; g++, i += 2) s->gyro[g] = (int16_t)((d[i] << 8) | d[i + 1]);
+}
+
+bool mpu6050_read(mpu6050_t* m, mpu6050_sample_t* s)
+{
+    uint8_t d[14];
+    if (!i2c_read(m->bus, m->address, MPU6050_REG_DATA, d, sizeof(d))) return false;
+    mpu6050_parse(d, s, true);
+    return true;
+}
+
+// Fetch up to max whole samples from the FIFO. A full FIFO has dropped
+// bytes and lost its sample boundaries: reset it and count an overflow
+// (no separate INT_STATUS read needed - the count says it all).
+int mpu6050_fifo_drain(mpu6050_t* m, mpu6050_sample_t* out, int max)
+{
+    uint8_t c[2];
+    if (!i2c_read(m->bus, m->address, MPU6050_REG_FIFO_COUNT, c, 2)) return -1;
+    int count = (c[0] << 8) | c[1];
+    if (count >= MPU6050_FIFO_SIZE) {
+        i2c_write_reg(m->bus, m->address, MPU6050_REG_USER_CTRL, 0x44);
+        m->overflows++;
+        return 0;
+    }
+
+    int n = count / MPU6050_FIFO_SAMPLE;
+    if (n > max) n = max;
+    uint8_t buf[MPU6050_FIFO_CHUNK * MPU6050_FIFO_SAMPLE];
+    for (int done = 0; done < n; ) {
+        int chunk = n - done < MPU6050_FIFO_CHUNK ? n - done : MPU6050_FIFO_CHUNK;
+        if (!i2c_read(m->bus, m->address, MPU6050_REG_FIFO_RW, buf, chunk * MPU6050_FIFO_SAMPLE)) return done;
+        for (int i = 0; i < chunk; i++) mpu6050_parse(&buf[i * MPU6050_FIFO_SAMPLE], &out[done + i], false);
+        done += chunk;
+    }
+    return n;
+}
+
+// Units for printing: mg, 0.01 dps, 0.01 C - integer math only
+int32_t mpu6050_accel_mg(int16_t raw)   { return (int32_t)raw * 1000 / 16384; }
+int32_t mpu6050_gyro_cdps(int16_t raw)  { return (int32_t)raw * 100 / 131; }
+int32_t mpu6050_temp_centi(int16_t raw) { return (int32_t)raw * 100 / 340 + 3653; }
+
+/*
+ * DEMO 1: BMP280 compensation - correctness
+ * The datasheet's floating-point formulas are the reference. The integer
+ * version must match them over the whole range, and the driver must give
+ * the same answers when the data comes over the (simulated) bus.
+ */
+void bmp280_reference(const bmp280_calib_t* c, int32_t adc_t, int32_t adc_p, double* t, double* p)
+{
+    double var1 = (adc_t / 16384.0 - c->t1 / 1024.0) * c->t2;
+    double var2 = (adc_t / 131072.0 - c->t1 / 8192.0) * (adc_t / 131072.0 - c->t1 / 8192.0) * c->t3;
+    double t_fine = var1 + var2;
+    *t = t_fine / 5120.0;
+
+    var1 = t_fine / 2.0 - 64000.0;
+    var2 = var1 * var1 * c->p6 / 32768.0;
+    var2 = var2 + var1 * c->p5 * 2.0;
+    var2 = var2 / 4.0 + c->p4 * 65536.0;
+    var1 = (c->p3 * var1 * var1 / 524288.0 + c->p2 * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * c->p1;
+    double pa = 1048576.0 - adc_p;
+    pa = (pa - var2 / 4096.0) * 6250.0 / var1;
+    var1 = c->p9 * pa * pa / 2147483648.0;
+    var2 = pa * c->p8 / 32768.0;
+    *p = pa + (var1 + var2 + c->p7) / 16.0;
+}
+
+void bmp280_demo(void)
+{
+    printf("=== DEMO 1: BMP280 Integer Compensation ===\n");
+
+    static sim_bus_t bus;
+    static bmp280_model_t model;
+    memset(&bus, 0, sizeof(bus));
+    bus.clock_hz = BUS_CLOCK_HZ;
+    bmp280_model_init(&model);
+    bus.devices[bus.count++] = &model.dev;
+
+    bmp280_t bmp;
+    uint32_t calls0 = bus.driver_calls;
+    bool found = bmp280_begin(&bmp, &bus, BMP280_ADDRESS);
+    printf("begin: %s, %u bus transactions (ID, 24-byte calibration, 2 writes)\n",
+           found ? "BMP280 found" : "NOT FOUND", bus.driver_calls - calls0);
+
+    // The datasheet's worked example
+    int32_t t = bmp280_compensate_t(&bmp, 519888);
+    uint32_t p = bmp280_compensate_p(&bmp, 415148);
+    bool example_ok = t == 2508 && p / 256 == 100653;
+    printf("Datasheet example: %d.%02d C, %u.%02u Pa (expected 25.08 C, 100653 Pa) %s\n",
+           t / 100, t % 100, p / 256, (p % 256) * 100 / 256, example_ok ? "OK" : "WRONG");
+
+    // The whole range against the floating-point reference
+    double worst_t = 0, worst_p = 0;
+    for (int32_t adc_t = 400000; adc_t <= 600000; adc_t += 1999) {
+        for (int32_t adc_p = 250000; adc_p <= 550000; adc_p += 2999) {
+            double ref_t, ref_p;
+            bmp280_reference(&bmp.calib, adc_t, adc_p, &ref_t, &ref_p);
+            double dt = fabs(bmp280_compensate_t(&bmp, adc_t) / 100.0 - ref_t);
+            double dp = fabs(bmp280_compensate_p(&bmp, adc_p) / 256.0 - ref_p);
+            if (dt > worst_t) worst_t = dt;
+            if (dp > worst_p) worst_p = dp;
+        }
+    }
+    printf("Integer vs float over the range: worst %.4f C, %.3f Pa\n", worst_t, worst_p);
+
+    // Over the bus: every reading must be one real measurement, compensated right
+    int errors = 0;
+    sim_advance(&bus, 20e6);
+    for (int i = 0; i < 200; i++) {
+        int32_t centi_c;
+        uint32_t pa_q8;
+        uint32_t k = model.samples - 1;     // The measurement in the registers now
+        bmp280_read(&bmp, &centi_c, &pa_q8);
+        int32_t adc_t, adc_p;
+        bmp280_model_raw(k, &adc_t, &adc_p);
+        double ref_t, ref_p;
+        bmp280_reference(&bmp.calib, adc_t, adc_p, &ref_t, &ref_p);
+        if (fabs(centi_c / 100.0 - ref_t) > 0.01 || fabs(pa_q8 / 256.0 - ref_p) > 1.0) errors++;
+        sim_advance(&bus, 7e6);
+    }
+    printf("200 reads over the bus: %d wrong\n", errors);
+
+    const int rounds = 5000000;
+    volatile uint32_t sink = 0;
+    double t0 = (double)clock();
+    for (int i = 0; i < rounds; i++) {
+        sink += (uint32_t)bmp280_compensate_t(&bmp, 500000 + (i & 1023));
+        sink += bmp280_compensate_p(&bmp, 400000 + (i & 4095));
+    }
+    double ns = ((double)clock() - t0) / CLOCKS_PER_SEC * 1e9 / rounds;
+    printf("Compensation cost on this PC: %.1f ns per reading\n", ns);
+    printf("Result: %s\n\n", found && example_ok && worst_t < 0.01 && worst_p < 1.0 && errors == 0 ? "PASS" : "FAIL");
+}
+
+/*
+ * DEMO 2: MPU6050 burst read and FIFO - correctness
+ * Drain the FIFO at different intervals: every sample must arrive once,
+ * in order, with the right values. Then be late on purpose (overflow):
+ * the driver must notice, reset, and carry on with clean samples.
+ */
+bool sample_matches(const mpu6050_sample_t* s, uint32_t k)
+{
+    int16_t v[7];
+    mpu6050_model_values(k, v);
+    return s->accel[0] == v[0] && s->accel[1] == v[1] && s->accel[2] == v[2] &&
+           s->gyro[0] == v[4] && s->gyro[1] == v[5] && s->gyro[2] == v[6];
+}
+
+void mpu6050_rig(sim_bus_t* bus, mpu6050_model_t* model, mpu6050_t* mpu, bool use_fifo)
+{
+    memset(bus, 0, sizeof(*bus));
+    bus->clock_hz = BUS_CLOCK_HZ;
+    mpu6050_model_init(model);
+    bus->devices[bus->count++] = &model->dev;
+    mpu6050_begin(mpu, bus, MPU6050_ADDRESS, 1000, use_fifo);
+}
+
+void fifo_demo(void)
+{
+    printf("=== DEMO 2: MPU6050 Burst Read and FIFO ===\n");
+
+    static sim_bus_t bus;
+    static mpu6050_model_t model;
+    static mpu6050_sample_t samples[200];
+    mpu6050_t mpu;
+    int errors = 0;
+
+    // Burst read: all 7 values from the same sample
+    mpu6050_rig(&bus, &model, &mpu, false);
+    sim_advance(&bus, 5e6);
+    mpu6050_sample_t s;
+    mpu6050_read(&mpu, &s);
+    int16_t v[7];
+    mpu6050_model_values(model.samples - 1, v);
+    bool burst_ok = sample_matches(&s, model.samples - 1) && s.temp == v[3];
+    if (!burst_ok) errors++;
+    printf("14-byte burst: accel %d/%d/%d mg, gyro %d/%d/%d cdps, %d.%02d C %s\n",
+           mpu6050_accel_mg(s.accel[0]), mpu6050_accel_mg(s.accel[1]), mpu6050_accel_mg(s.accel[2]),
+           mpu6050_gyro_cdps(s.gyro[0]), mpu6050_gyro_cdps(s.gyro[1]), mpu6050_gyro_cdps(s.gyro[2]),
+           mpu6050_temp_centi(s.temp) / 100, mpu6050_temp_centi(s.temp) % 100, burst_ok ? "OK" : "WRONG");
+
+    // FIFO at 1 kHz, drained every 5, 20 and 60 ms
+    static const int intervals_ms[3] = {5, 20, 60};
+    printf("%-16s %8s %8s %9s %s\n", "Drain every", "Samples", "Reads", "Overflows", "Order/values");
+    for (int i = 0; i < 3; i++) {
+        mpu6050_rig(&bus, &model, &mpu, true);
+        uint32_t first_k = model.samples;
+        uint32_t expect_k = first_k, got = 0, calls0 = bus.driver_calls;
+        bool in_order = true;
+        while (bus.now_ns < 1e9) {
+            sim_advance(&bus, intervals_ms[i] * 1e6);
+            int n = mpu6050_fifo_drain(&mpu, samples, 200);
+            for (int j = 0; j < n; j++) {
+                if (!sample_matches(&samples[j], expect_k)) in_order = false;
+                expect_k++;
+            }
+            got += (uint32_t)(n > 0 ? n : 0);
+        }
+        if (!in_order || mpu.overflows) errors++;
+        char label[24];
+        snprintf(label, sizeof(label), "%d ms", intervals_ms[i]);
+        printf("%-16s %8u %8u %9u %s\n", label, got, bus.driver_calls - calls0, mpu.overflows,
+               in_order ? "all in order" : "WRONG");
+    }
+
+    // Late on purpose: 150 ms without draining = 1800 bytes into 1024
+    mpu6050_rig(&bus, &model, &mpu, true);
+    sim_advance(&bus, 150e6);
+    int n = mpu6050_fifo_drain(&mpu, samples, 200);
+    uint32_t lost_before = model.samples;
+    sim_advance(&bus, 10e6);
+    int n2 = mpu6050_fifo_drain(&mpu, samples, 200);
+    bool clean = n2 > 0;
+    for (int j = 0; j < n2; j++) {
+        if (!sample_matches(&samples[j], lost_before + (uint32_t)j)) clean = false;
+    }
+    bool overflow_ok = n == 0 && mpu.overflows == 1 && clean;
+    if (!overflow_ok) errors++;
+    printf("150 ms late: overflow %s, FIFO reset, next drain %d clean samples %s\n",
+           mpu.overflows ? "detected" : "MISSED", n2, overflow_ok ? "OK" : "WRONG");
+    printf("Result: %s\n\n", errors == 0 ? "PASS" : "FAIL");
+}
+
+/*
+ * DEMO 3: High-rate sampling - polling vs FIFO
+ * 1 kHz for one second. loop() also does other work, so its period
+ * jitters between 0.5 and 3 ms (a pseudo-random but repeatable pattern).
+ */
+uint32_t jitter_state;
+
+double next_jitter_ns(void)
+{
+    jitter_state = jitter_state * 1664525u + 1013904223u;
+    return 0.5e6 + (jitter_state >> 8) % 2500000;
+}
+
+void rate_demo(void)
+{
+    printf("=== DEMO 3: 1 kHz Sampling With a Jittery loop() (400 kHz bus) ===\n");
+    printf("(assuming %.0f us per I2C driver call)\n", DRIVER_CALL_US);
+    printf("%-32s %7s %7s %5s %7s %9s %10s\n", "Method", "Unique", "Missed", "Dups", "Calls", "Bus ms/s",
+           "us/sample");
+
+    static sim_bus_t bus;
+    static mpu6050_model_t model;
+    static mpu6050_sample_t samples[200];
+    static bool seen[2000];
+    mpu6050_t mpu;
+
+    for (int method = 0; method < 3; method++) {
+        mpu6050_rig(&bus, &model, &mpu, method > 0);
+        memset(seen, 0, sizeof(seen));
+        jitter_state = 12345;
+        uint32_t k0 = model.samples, calls0 = bus.driver_calls, unique = 0, reads = 0;
+        double busy0 = bus.busy_ns, start = bus.now_ns, next_drain = start;
+
+        while (bus.now_ns - start < 1e9) {
+            sim_advance(&bus, next_jitter_ns());
+            if (method == 0) {
+                // Poll the data registers once per loop()
+                mpu6050_sample_t s;
+                mpu6050_read(&mpu, &s);
+                reads++;
+                uint32_t k = (uint16_t)s.accel[0];
+                if (k >= k0 && k - k0 < 2000 && !seen[k - k0]) {
+                    seen[k - k0] = true;
+                    unique++;
+                }
+            } else if (bus.now_ns >= next_drain) {
+                // FIFO: drain every 20 ms; method 2 fetches one sample per read
+                int n;
+                if (method == 1) {
+                    n = mpu6050_fifo_drain(&mpu, samples, 200);
+                } else {
+                    n = 0;
+                    int one;
+                    while ((one = mpu6050_fifo_drain(&mpu, &samples[n], 1)) > 0) n += one;
+                }
+                for (int j = 0; j < n; j++) {
+                    uint32_t k = (uint16_t)samples[j].accel[0];
+                    reads++;
+                    if (k >= k0 && k - k0 < 2000 && !seen[k - k0]) {
+                        seen[k - k0] = true;
+                        unique++;
+                    }
+                }
+                next_drain += 20e6;
+            }
+        }
+        // Samples still waiting in the FIFO aren't missed - the next drain gets them
+        uint32_t made = model.samples - k0 - (uint32_t)(model.fifo_count / MPU6050_FIFO_SAMPLE);
+        double seconds = (bus.now_ns - start) / 1e9;
+        const char* names[3] = {"Poll 14-byte burst each loop", "FIFO, chunks of 10, every 20 ms",
+                                "FIFO, count + 1 sample per read"};
+        printf("%-32s %7u %7u %5u %7u %9.1f %10.0f\n", names[method], unique, made - unique,
+               reads - unique, bus.driver_calls - calls0, (bus.busy_ns - busy0) / 1e6 / seconds,
+               (bus.busy_ns - busy0) / 1e3 / unique);
+    }
+    printf("\nPolling can't keep up with a late loop() and reads some samples twice.\n");
+    printf("The FIFO gets every sample, and big chunks make each one cheapest: 12 bytes\n");
+    printf("on the wire and a tenth of a driver call instead of a whole read.\n\n");
+}
+
+int main(void)
+{
+    printf("Sensor Drivers - Burst Reads, Compensation and the MPU6050 FIFO\n");
+    printf("===============================================================\n\n");
+
+    bmp280_demo();
+    fifo_demo();
+    rate_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. Read calibration once at begin(), keep it in the driver struct\n");
+    printf("2. One burst per measurement: all bytes belong to the same sample\n");
+    printf("3. The BMP280 integer formulas match the float ones - no FPU needed\n");
+    printf("4. Polling misses samples when loop() is late and repeats them when early\n");
+    printf("5. The FIFO collects samples on the chip; drain them in big chunks\n");
+    printf("6. A full FIFO has lost its sample boundaries: reset and count it\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. A driver = ID check + configuration + burst read + conversion
+ * 2. Calibration data turns raw ADC counts into real units - read it once
+ * 3. Integer compensation: same answers as float, runs on any MCU
+ * 4. The sensor's own FIFO decouples its sample rate from your loop()
+ * 5. Bulk reads: 120 bytes in one driver call instead of 10 calls
+ * 6. Models with known sample values make driver bugs visible on a PC
+ *
+ * Next: Logging those samples to the SD card - a binary, sector-buffered log!
+ */
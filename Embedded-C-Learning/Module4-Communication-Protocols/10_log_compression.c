@@ -0,0 +1,757 @@
+/*
+ * MODULE 4 - LESSON 10: Squeezing the Log - Columnar Compression
+ *
+ * What you'll learn:
+ * - Storing a block COLUMN by column (all times, then all temperatures,
+ *   ...) instead of record by record: neighbours in a column look alike
+ * - Delta-of-delta timestamps: a steady 100 ms rhythm costs 1 bit
+ * - Gorilla XOR floats: a value equal to the last one costs 1 bit, a
+ *   close one only its changed middle bits
+ * - Bit-packed integer deltas: one bit width per block, as narrow as the
+ *   biggest change needs
+ * - Filling a block until the ENCODED size hits 512 bytes - tracked as
+ *   records arrive, so the block never overflows
+ * - Why honest numbers need honest data: noise does not compress
+ *
+ * Think of it like a weather diary:
+ * - Record by record: "10:00:00.0, 23.5 C, 45 %, 512 / 10:00:00.1, 23.5
+ *   C, 45 %, 514 / ..." - the same things written again and again
+ * - Column by column: "from 10:00, every 0.1 s. Temperature 23.5, same,
+ *   same, same... Humidity 45, same... Light 512, +2, -1, ..."
+ * - The second diary is ten times thinner - and says exactly the same
+ *
+ * Block layout (512 bytes, same header and CRC as lesson 9, magic "LC"):
+ *   header     "LC", count[2], first time[4], last time[4], CRC[4]
+ *   time       delta-of-delta per record after the first (the first is
+ *              in the header):  0 -> '0'   |d|<=64 -> '10'+7 bits
+ *              |d|<=256 -> '110'+9   |d|<=2048 -> '1110'+12   '1111'+32
+ *   temp       float, Gorilla XOR: first value 32 bits, then
+ *              same -> '0'   fits the last window -> '10'+bits
+ *              else '11' + 5 bits leading zeros + 5 bits length-1 + bits
+ *   humidity   first value 8 bits, width 5 bits, count-1 zigzag deltas
+ *   light      first value 16 bits, width 5 bits, count-1 zigzag deltas
+ * Segments, index and recovery are unchanged (segment header version 2).
+ *
+ * ASSUMPTIONS: the "day trace" is synthetic, shaped like the sketch's
+ * sensors - a DHT22 that updates every 2 s read 10 times a second, and
+ * an LDR on the ADC with a few counts of noise. SD write timing as in
+ * lesson 8 (0.5 ms per sector write command, SPI at 20 MHz).
+ *
+ * This program is also the HOST DECODER for logs from the sketch: copy
+ * the /log folder off the SD card and run it with segment files:
+ *   gcc -O2 -o log_compression 10_log_compression.c -lm
+ *   ./log_compression                     (lesson demos)
+ *   ./log_compression SEG00001.BIN ...    (CSV on stdout)
+ *
+ * The same encoder runs in the sensor logger in Module 4
+ * (02_spi_sdcard.c).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#define BLOCK_SIZE              512
+#define BLOCK_HEADER_SIZE       16
+#define PAYLOAD_BITS            ((BLOCK_SIZE - BLOCK_HEADER_SIZE) * 8)   // 3968
+#define BLOCK_MAX_RECORDS       512         // RAM for one block: 512 * 11 bytes
+#define BINARY_PER_BLOCK        49          // Lesson 9: 10-byte records, 49 per block
+#define SYNC_RECORDS            100
+
+#define DAY_RECORDS             864000      // 24 hours at 10 per second
+
+typedef struct {
+    uint32_t time_ms;
+    float temperature;
+    uint8_t humidity;
+    uint16_t light;
+} sensor_record_t;
+
+/*
+ * PART 1: CRC and byte helpers (as in lesson 9)
+ */
+uint32_t crc32_table[256];
+
+void crc32_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & (0 - (crc & 1)));
+        crc32_table[i] = crc;
+    }
+}
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length)
+{
+    crc = ~crc;
+    while (length--) crc = (crc >> 8) ^ crc32_table[(crc ^ *data++) & 0xFF];
+    return ~crc;
+}
+
+void put_u16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+void put_u32(uint8_t* p, uint32_t v) { put_u16(p, (uint16_t)v); put_u16(p + 2, (uint16_t)(v >> 16)); }
+uint16_t get_u16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+uint32_t get_u32(const uint8_t* p) { return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16); }
+
+uint32_t float_bits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, 4);
+    return u;
+}
+
+float bits_float(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, 4);
+    return f;
+}
+
+/*
+ * PART 2: Bit streams
+ * MSB first. A writer with no buffer only counts - the same encoder
+ * code tells us the size without writing anything.
+ */
+typedef struct {
+    uint8_t* buf;                           // NULL: count only
+    uint32_t bits;
+} bit_writer_t;
+
+void put_bits(bit_writer_t* w, uint32_t value, int n)
+{
+    if (w->buf) {
+        while (n > 0) {
+            int free_bits = 8 - (int)(w->bits & 7);
+            int take = n < free_bits ? n : free_bits;
+            uint32_t chunk = (value >> (n - take)) & ((1u << take) - 1);
+            w->buf[w->bits >> 3] |= (uint8_t)(chunk << (free_bits - take));
+            w->bits += (uint32_t)take;
+            n -= take;
+        }
+    } else {
+        w->bits += (uint32_t)n;
+    }
+}
+
+typedef struct {
+    const uint8_t* buf;
+    uint32_t bits;
+} bit_reader_t;
+
+uint32_t get_bits(bit_reader_t* r, int n)
+{
+    uint32_t value = 0;
+    while (n > 0) {
+        int left = 8 - (int)(r->bits & 7);
+        int take = n < left ? n : left;
+        uint32_t chunk = (r->buf[r->bits >> 3] >> (left - take)) & ((1u << take) - 1);
+        value = (take == 32) ? chunk : (value << take) | chunk;
+        r->bits += (uint32_t)take;
+        n -= take;
+    }
+    return value;
+}
+
+/*
+ * PART 3: The three column encoders
+ * Each keeps a little state between values, so it can run as records
+ * arrive (counting) and again over the whole block (writing).
+ */
+
+// Timestamps: delta-of-delta. Arithmetic is modulo 2^32, so gaps, reboots
+// and wrap-around all round-trip; they just cost more bits.
+typedef struct {
+    uint32_t prev_time;
+    uint32_t prev_delta;
+} time_coder_t;
+
+void time_encode(time_coder_t* c, bit_writer_t* w, uint32_t t)
+{
+    uint32_t delta = t - c->prev_time;
+    int32_t dod = (int32_t)(delta - c->prev_delta);
+    if (dod == 0) {
+        put_bits(w, 0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        put_bits(w, 0x2, 2);
+        put_bits(w, (uint32_t)(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        put_bits(w, 0x6, 3);
+        put_bits(w, (uint32_t)(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        put_bits(w, 0xE, 4);
+        put_bits(w, (uint32_t)(dod + 2047), 12);
+    } else {
+        put_bits(w, 0xF, 4);
+        put_bits(w, (uint32_t)dod, 32);
+    }
+    c->prev_delta = delta;
+    c->prev_time = t;
+}
+
+uint32_t time_decode(time_coder_t* c, bit_reader_t* r)
+{
+    int32_t dod;
+    if (get_bits(r, 1) == 0) dod = 0;
+    else if (get_bits(r, 1) == 0) dod = (int32_t)get_bits(r, 7) - 63;
+    else if (get_bits(r, 1) == 0) dod = (int32_t)get_bits(r, 9) - 255;
+    else if (get_bits(r, 1) == 0) dod = (int32_t)get_bits(r, 12) - 2047;
+    else dod = (int32_t)get_bits(r, 32);
+    c->prev_delta += (uint32_t)dod;
+    c->prev_time += c->prev_delta;
+    return c->prev_time;
+}
+
+// Floats: Gorilla XOR. Lossless - NaN, -0.0 and infinities come back
+// bit for bit.
+typedef struct {
+    uint32_t prev;
+    int lead, trail;                        // Last window; lead < 0: none yet
+    bool started;
+} xor_coder_t;
+
+void xor_encode(xor_coder_t* c, bit_writer_t* w, float value)
+{
+    uint32_t v = float_bits(value);
+    if (!c->started) {
+        put_bits(w, v, 32);
+        c->started = true;
+        c->lead = -1;
+        c->prev = v;
+        return;
+    }
+    uint32_t x = v ^ c->prev;
+    c->prev = v;
+    if (x == 0) {
+        put_bits(w, 0, 1);
+        return;
+    }
+    int lead = __builtin_clz(x);
+    int trail = __builtin_ctz(x);
+    if (c->lead >= 0 && lead >= c->lead && trail >= c->trail) {
+        put_bits(w, 0x2, 2);                // Fits the last window
+        put_bits(w, x >> c->trail, 32 - c->lead - c->trail);
+    } else {
+        int length = 32 - lead - trail;
+        put_bits(w, 0x3, 2);
+        put_bits(w, (uint32_t)lead, 5);
+        put_bits(w, (uint32_t)(length - 1), 5);
+        put_bits(w, x >> trail, length);
+        c->lead = lead;
+        c->trail = trail;
+    }
+}
+
+float xor_decode(xor_coder_t* c, bit_reader_t* r)
+{
+    if (!c->started) {
+        c->started = true;
+        c->lead = -1;
+        c->prev = get_bits(r, 32);
+    } else if (get_bits(r, 1) == 1) {
+        if (get_bits(r, 1) == 1) {
+            c->lead = (int)get_bits(r, 5);
+            int length = (int)get_bits(r, 5) + 1;
+            c->trail = 32 - c->lead - length;
+        }
+        int length = 32 - c->lead - c->trail;
+        c->prev ^= get_bits(r, length) << c->trail;
+    }
+    return bits_float(c->prev);
+}
+
+// Integers: zigzag deltas (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) packed
+// at one width for the whole block
+uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+int32_t unzigzag(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+int bit_width(uint32_t v)
+{
+    return v == 0 ? 0 : 32 - __builtin_clz(v);
+}
+
+void packed_encode(bit_writer_t* w, const uint32_t* values, uint32_t count, int value_bits)
+{
+    int width = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        int b = bit_width(zigzag((int32_t)(values[i] - values[i - 1])));
+        if (b > width) width = b;
+    }
+    put_bits(w, values[0], value_bits);
+    put_bits(w, (uint32_t)width, 5);
+    for (uint32_t i = 1; i < count; i++) {
+        put_bits(w, zigzag((int32_t)(values[i] - values[i - 1])), width);
+    }
+}
+
+void packed_decode(bit_reader_t* r, uint32_t* values, uint32_t count, int value_bits)
+{
+    values[0] = get_bits(r, value_bits);
+    int width = (int)get_bits(r, 5);
+    for (uint32_t i = 1; i < count; i++) {
+        values[i] = values[i - 1] + (uint32_t)unzigzag(get_bits(r, width));
+    }
+}
+
+/*
+ * PART 4: The column block
+ * Records wait in RAM column by column. Before a record is taken, the
+ * encoded size WITH it is worked out from the running coder states and
+ * the widest delta so far - O(1) per record. If it would not fit in 496
+ * bytes, the block is finished first. At a sync point (and when full)
+ * the whole block is encoded - a few hundred records, a few microseconds.
+ */
+typedef struct {
+    uint32_t time[BLOCK_MAX_RECORDS];
+    float temperature[BLOCK_MAX_RECORDS];
+    uint32_t humidity[BLOCK_MAX_RECORDS];
+    uint32_t light[BLOCK_MAX_RECORDS];
+    uint32_t count;
+    // Size tracking
+    time_coder_t time_size;
+    xor_coder_t temp_size;
+    bit_writer_t stream_size;               // Time + temperature bits so far
+    int humidity_width, light_width;
+} column_block_t;
+
+// Per-column bit counts, for the compression table
+typedef struct {
+    double time, temperature, humidity, light;
+} column_bits_t;
+
+void column_block_reset(column_block_t* b)
+{
+    b->count = 0;
+    b->stream_size.buf = NULL;
+    b->stream_size.bits = 0;
+    b->humidity_width = 0;
+    b->light_width = 0;
+    memset(&b->temp_size, 0, sizeof(b->temp_size));
+}
+
+uint32_t packed_bits(uint32_t count, int width, int value_bits)
+{
+    return (uint32_t)value_bits + 5 + (count - 1) * (uint32_t)width;
+}
+
+// Take the record if the block still fits with it
+bool column_block_add(column_block_t* b, const sensor_record_t* r)
+{
+    if (b->count == BLOCK_MAX_RECORDS) return false;
+
+    time_coder_t t = b->time_size;
+    xor_coder_t x = b->temp_size;
+    bit_writer_t s = b->stream_size;
+    int hw = b->humidity_width, lw = b->light_width;
+    if (b->count == 0) {
+        t.prev_time = r->time_ms;           // The first time goes in the header
+        t.prev_delta = 0;
+    } else {
+        time_encode(&t, &s, r->time_ms);
+        int dh = bit_width(zigzag((int32_t)(r->humidity - b->humidity[b->count - 1])));
+        int dl = bit_width(zigzag((int32_t)(r->light - b->light[b->count - 1])));
+        if (dh > hw) hw = dh;
+        if (dl > lw) lw = dl;
+    }
+    xor_encode(&x, &s, r->temperature);
+
+    uint32_t n = b->count + 1;
+    if (s.bits + packed_bits(n, hw, 8) + packed_bits(n, lw, 16) > PAYLOAD_BITS) return false;
+
+    b->time_size = t;
+    b->temp_size = x;
+    b->stream_size = s;
+    b->humidity_width = hw;
+    b->light_width = lw;
+    b->time[b->count] = r->time_ms;
+    b->temperature[b->count] = r->temperature;
+    b->humidity[b->count] = r->humidity;
+    b->light[b->count] = r->light;
+    b->count++;
+    return true;
+}
+
+// Encode into a signed 512-byte block. 'bits' (optional) gets the split.
+void column_block_encode(const column_block_t* b, uint8_t* block, column_bits_t* bits)
+{
+    memset(block, 0, BLOCK_SIZE);
+    bit_writer_t w = {block + BLOCK_HEADER_SIZE, 0};
+
+    time_coder_t tc = {b->time[0], 0};
+    for (uint32_t i = 1; i < b->count; i++) time_encode(&tc, &w, b->time[i]);
+    uint32_t after_time = w.bits;
+    xor_coder_t xc;
+    memset(&xc, 0, sizeof(xc));
+    for (uint32_t i = 0; i < b->count; i++) xor_encode(&xc, &w, b->temperature[i]);
+    uint32_t after_temp = w.bits;
+    packed_encode(&w, b->humidity, b->count, 8);
+    uint32_t after_humidity = w.bits;
+    packed_encode(&w, b->light, b->count, 16);
+
+    if (bits) {
+        bits->time += after_time;
+        bits->temperature += after_temp - after_time;
+        bits->humidity += after_humidity - after_temp;
+        bits->light += w.bits - after_humidity;
+    }
+
+    block[0] = 'L';
+    block[1] = 'C';
+    put_u16(&block[2], (uint16_t)b->count);
+    put_u32(&block[4], b->time[0]);
+    put_u32(&block[8], b->time[b->count - 1]);
+    put_u32(&block[12], crc32(0, block, BLOCK_SIZE));
+}
+
+bool column_block_valid(const uint8_t* block)
+{
+    if (block[0] != 'L' || block[1] != 'C') return false;
+    uint16_t count = get_u16(&block[2]);
+    if (count == 0 || count > BLOCK_MAX_RECORDS) return false;
+    uint8_t copy[BLOCK_SIZE];
+    memcpy(copy, block, BLOCK_SIZE);
+    put_u32(&copy[12], 0);
+    return crc32(0, copy, BLOCK_SIZE) == get_u32(&block[12]);
+}
+
+// Decode a (valid) block. Returns the number of records.
+uint32_t column_block_decode(const uint8_t* block, sensor_record_t* out)
+{
+    static uint32_t column[BLOCK_MAX_RECORDS];
+    uint32_t count = get_u16(&block[2]);
+    bit_reader_t r = {block + BLOCK_HEADER_SIZE, 0};
+
+    time_coder_t tc = {get_u32(&block[4]), 0};
+    out[0].time_ms = tc.prev_time;
+    for (uint32_t i = 1; i < count; i++) out[i].time_ms = time_decode(&tc, &r);
+    xor_coder_t xc;
+    memset(&xc, 0, sizeof(xc));
+    for (uint32_t i = 0; i < count; i++) out[i].temperature = xor_decode(&xc, &r);
+    packed_decode(&r, column, count, 8);
+    for (uint32_t i = 0; i < count; i++) out[i].humidity = (uint8_t)column[i];
+    packed_decode(&r, column, count, 16);
+    for (uint32_t i = 0; i < count; i++) out[i].light = (uint16_t)column[i];
+    return count;
+}
+
+/*
+ * PART 5: The host decoder - segment files from the SD card to CSV
+ * Layout as in lesson 9: header block, data blocks, then (if sealed)
+ * index + trailer. Reading stops at the first block that fails its CRC.
+ */
+int decode_segment_file(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return 1;
+    }
+    uint8_t block[BLOCK_SIZE];
+    if (fread(block, 1, BLOCK_SIZE, f) != BLOCK_SIZE || memcmp(block, "SEG1", 4) != 0 || get_u16(&block[4]) != 2) {
+        fprintf(stderr, "%s: not a version 2 log segment\n", path);
+        fclose(f);
+        return 1;
+    }
+    static sensor_record_t records[BLOCK_MAX_RECORDS];
+    uint32_t blocks = 0, total = 0;
+    while (fread(block, 1, BLOCK_SIZE, f) == BLOCK_SIZE && column_block_valid(block)) {
+        uint32_t n = column_block_decode(block, records);
+        for (uint32_t i = 0; i < n; i++) {
+            printf("%u,%.2f,%u,%u\n", records[i].time_ms, records[i].temperature, records[i].humidity,
+                   records[i].light);
+        }
+        blocks++;
+        total += n;
+    }
+    fprintf(stderr, "%s: %u blocks, %u records\n", path, blocks, total);
+    fclose(f);
+    return 0;
+}
+
+/*
+ * Test data
+ */
+uint32_t rng_state = 7;
+
+uint32_t rng_next(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+int rng_range(int lo, int hi)              // Like Arduino's random(lo, hi)
+{
+    return lo + (int)(rng_next() % (uint32_t)(hi - lo));
+}
+
+// What the sketch logs today: independent random values every 100 ms
+void make_sketch_demo(sensor_record_t* r, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        r[i].time_ms = 5000 + i * 100;
+        r[i].temperature = 23.5f + rng_range(-50, 50) / 10.0f;
+        r[i].humidity = (uint8_t)(45 + rng_range(-10, 10));
+        r[i].light = (uint16_t)rng_range(0, 1024);
+    }
+}
+
+// A day of real-shaped readings: loop jitter, a DHT22 that only updates
+// every 2 s (0.1 C / 0.1 % steps, humidity logged as whole %), an LDR
+// following the sun and the clouds with +-2 counts of ADC noise
+void make_day_trace(sensor_record_t* r, uint32_t n)
+{
+    uint32_t t = 5000;
+    float temp = 21.3f;
+    uint8_t humidity = 52;
+    double cloud = 1.0;
+    for (uint32_t i = 0; i < n; i++) {
+        t += 100 + (rng_next() % 10 == 0 ? 1 : 0);  // loop() sometimes runs 1 ms late
+        double hours = t / 3600000.0;
+        if (i % 20 == 0) {                  // New DHT22 reading
+            double target = 21.0 + 4.0 * sin((hours - 9) / 24 * 2 * M_PI);
+            temp = roundf((float)(target + (rng_next() % 3 - 1) * 0.1) * 10) / 10;
+            double target_h = 50 - 8 * sin((hours - 9) / 24 * 2 * M_PI);
+            if (humidity < target_h - 0.5) humidity++;
+            if (humidity > target_h + 0.5) humidity--;
+        }
+        if (i % 600 == 0) cloud = 0.6 + (rng_next() % 40) / 100.0;
+        double sun = sin((hours - 6) / 12 * M_PI);
+        int light = 40 + (sun > 0 ? (int)(900 * sun * cloud) : 0) + (int)(rng_next() % 5) - 2;
+        r[i].time_ms = t;
+        r[i].temperature = temp;
+        r[i].humidity = humidity;
+        r[i].light = (uint16_t)light;
+    }
+}
+
+// Everything the format must survive: reboot gaps, time wrap-around,
+// NaN / -0.0 / infinities / tiny numbers, full-range integers
+void make_edge_cases(sensor_record_t* r, uint32_t n)
+{
+    const float specials[] = {NAN, -0.0f, INFINITY, -INFINITY, 1e-42f, -273.15f, 3.4e38f, 0.0f};
+    uint32_t t = 0xFFFF0000u;               // Wraps past 2^32 on the way
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t kind = rng_next() % 16;
+        if (kind == 0) t += rng_next();     // Reboot or long gap
+        else if (kind == 1) t += 1 + rng_next() % 5000;
+        else t += 100;
+        r[i].time_ms = t;
+        r[i].temperature = (kind < 4) ? specials[rng_next() % 8] : bits_float(rng_next() * 2654435761u);
+        r[i].humidity = (uint8_t)rng_next();
+        r[i].light = (uint16_t)(kind < 8 ? rng_next() : 512);
+    }
+}
+
+bool record_equal(const sensor_record_t* a, const sensor_record_t* b)
+{
+    return a->time_ms == b->time_ms && float_bits(a->temperature) == float_bits(b->temperature) &&
+           a->humidity == b->humidity && a->light == b->light;
+}
+
+double nanos_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Encode a whole data set into blocks, as the logger would
+typedef struct {
+    uint32_t blocks;
+    uint32_t records;
+    column_bits_t bits;
+    uint8_t* image;                         // All blocks, back to back
+} encoded_t;
+
+static column_block_t cb;
+
+void encode_all(const sensor_record_t* r, uint32_t n, encoded_t* e)
+{
+    e->blocks = 0;
+    e->records = n;
+    memset(&e->bits, 0, sizeof(e->bits));
+    column_block_reset(&cb);
+    for (uint32_t i = 0; i < n; i++) {
+        if (!column_block_add(&cb, &r[i])) {
+            column_block_encode(&cb, e->image + (size_t)e->blocks++ * BLOCK_SIZE, &e->bits);
+            column_block_reset(&cb);
+            column_block_add(&cb, &r[i]);
+        }
+    }
+    if (cb.count > 0) column_block_encode(&cb, e->image + (size_t)e->blocks++ * BLOCK_SIZE, &e->bits);
+}
+
+uint32_t decode_all(const encoded_t* e, sensor_record_t* out)
+{
+    uint32_t n = 0;
+    for (uint32_t b = 0; b < e->blocks; b++) {
+        const uint8_t* block = e->image + (size_t)b * BLOCK_SIZE;
+        if (!column_block_valid(block)) break;
+        n += column_block_decode(block, &out[n]);
+    }
+    return n;
+}
+
+// Bytes the old sketch wrote per record: one CSV line
+uint32_t csv_bytes(const sensor_record_t* r, uint32_t n)
+{
+    char line[64];
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        total += (uint32_t)snprintf(line, sizeof(line), "%u,%.1f,%u,%u\n", r[i].time_ms, r[i].temperature,
+                                    r[i].humidity, r[i].light);
+    }
+    return total;
+}
+
+static sensor_record_t data[DAY_RECORDS];
+static sensor_record_t decoded[DAY_RECORDS + BLOCK_MAX_RECORDS];
+
+/*
+ * DEMO 1: Round trip - every bit must come back
+ */
+void round_trip_demo(encoded_t* e)
+{
+    printf("=== DEMO 1: Round Trip ===\n");
+
+    const char* names[3] = {"Day trace", "Sketch demo data", "Edge cases"};
+    int errors = 0;
+    for (int set = 0; set < 3; set++) {
+        uint32_t n = (set == 2) ? 200000 : DAY_RECORDS;
+        if (set == 0) make_day_trace(data, n);
+        if (set == 1) make_sketch_demo(data, n);
+        if (set == 2) make_edge_cases(data, n);
+        encode_all(data, n, e);
+        uint32_t got = decode_all(e, decoded);
+        uint32_t wrong = 0;
+        for (uint32_t i = 0; i < n && i < got; i++) {
+            if (!record_equal(&data[i], &decoded[i])) wrong++;
+        }
+        if (got != n || wrong) errors++;
+        printf("%-18s %7u records -> %5u blocks, decoded %7u, %u wrong\n", names[set], n, e->blocks, got, wrong);
+    }
+    printf("(floats compared bit for bit, NaN and -0.0 included)\n");
+    printf("Result: %s\n\n", errors == 0 ? "PASS" : "FAIL");
+}
+
+/*
+ * DEMO 2: How small? Bits per record, column by column
+ */
+void ratio_demo(encoded_t* e)
+{
+    printf("=== DEMO 2: Bits per Record, Column by Column ===\n");
+    printf("%-18s %6s %6s %6s %6s %10s %8s %8s\n", "Data", "time", "temp", "hum", "light",
+           "bytes/rec", "vs CSV", "vs bin");
+
+    const char* names[2] = {"Day trace", "Sketch demo data"};
+    for (int set = 0; set < 2; set++) {
+        if (set == 0) make_day_trace(data, DAY_RECORDS);
+        if (set == 1) make_sketch_demo(data, DAY_RECORDS);
+        encode_all(data, DAY_RECORDS, e);
+        double per_record = (double)e->blocks * BLOCK_SIZE / DAY_RECORDS;    // Incl. headers and slack
+        double csv = (double)csv_bytes(data, DAY_RECORDS) / DAY_RECORDS;
+        double binary = (double)BLOCK_SIZE / BINARY_PER_BLOCK;
+        printf("%-18s %6.2f %6.2f %6.2f %6.2f %10.2f %7.1fx %7.1fx\n", names[set],
+               e->bits.time / DAY_RECORDS, e->bits.temperature / DAY_RECORDS,
+               e->bits.humidity / DAY_RECORDS, e->bits.light / DAY_RECORDS,
+               per_record, csv / per_record, binary / per_record);
+    }
+    printf("(CSV: the old sketch's text lines; bin: lesson 9's 10-byte records, %.2f bytes each)\n",
+           (double)BLOCK_SIZE / BINARY_PER_BLOCK);
+    printf("Random values stay random: the demo data's temperature and light are pure\n");
+    printf("noise, so only the timestamps shrink. Real sensors change slowly - that is\n");
+    printf("what delta and XOR coding feed on.\n\n");
+}
+
+/*
+ * DEMO 3: Speed, and what the card sees in a day
+ * Every block costs one sector write when it fills, and the tail block
+ * is rewritten at every sync point - with both formats.
+ */
+void speed_demo(encoded_t* e)
+{
+    printf("=== DEMO 3: Encode / Decode Speed and a Day of Card Writes ===\n");
+
+    make_day_trace(data, DAY_RECORDS);
+    double t0 = nanos_now();
+    encode_all(data, DAY_RECORDS, e);
+    double encode_ns = (nanos_now() - t0) / DAY_RECORDS;
+    t0 = nanos_now();
+    decode_all(e, decoded);
+    double decode_ns = (nanos_now() - t0) / DAY_RECORDS;
+    double records_per_block = (double)DAY_RECORDS / e->blocks;
+    printf("Encode: %.0f ns/record (incl. the size check per record)\n", encode_ns);
+    printf("Decode: %.0f ns/record, %.0f records per block\n\n", decode_ns, records_per_block);
+
+    printf("One day at 10 records/s (day trace):\n");
+    printf("%-12s %6s %10s %14s %14s\n", "Format", "Sync", "Card bytes", "Sector writes", "Card busy (s)");
+    for (int sync = 100; sync <= 1000; sync *= 10) {
+        for (int format = 0; format < 2; format++) {
+            double per_block = format == 0 ? BINARY_PER_BLOCK : records_per_block;
+            double full_blocks = DAY_RECORDS / per_block;
+            double syncs = (double)DAY_RECORDS / sync;
+            double writes = full_blocks + syncs;
+            double busy = writes * (0.5e-3 + BLOCK_SIZE * 8 / 20e6);   // Lesson 8's SD timing
+            printf("%-12s %6d %9.1fM %14.0f %14.1f\n", format == 0 ? "Binary" : "Columnar", sync,
+                   full_blocks * BLOCK_SIZE / 1e6, writes, busy);
+        }
+    }
+    printf("With fewer, fuller blocks the sync points become most of the writes:\n");
+    printf("syncing less often now saves more than squeezing harder.\n\n");
+}
+
+int main(int argc, char** argv)
+{
+    crc32_init();
+
+    // Host tool: decode segment files to CSV
+    if (argc > 1) {
+        int errors = 0;
+        printf("time_ms,temperature,humidity,light\n");
+        for (int i = 1; i < argc; i++) errors += decode_segment_file(argv[i]);
+        return errors ? 1 : 0;
+    }
+
+    printf("Squeezing the Log - Columnar Compression\n");
+    printf("========================================\n\n");
+
+    encoded_t e;
+    e.image = malloc((size_t)DAY_RECORDS * BLOCK_SIZE / 8);    // >= 8 records per block
+    round_trip_demo(&e);
+    ratio_demo(&e);
+    speed_demo(&e);
+    free(e.image);
+
+    printf("=== What You Learned ===\n");
+    printf("1. Store columns, not rows: neighbours in a column look alike\n");
+    printf("2. Delta-of-delta: a steady sample rate costs 1 bit per timestamp\n");
+    printf("3. Gorilla XOR: repeated floats cost 1 bit, lossless for every value\n");
+    printf("4. Bit-pack integer deltas at the block's widest width\n");
+    printf("5. Track the encoded size as records arrive - blocks never overflow\n");
+    printf("6. Measure on real-shaped data: noise does not compress\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. A block is a good unit for compression: big enough, still independent
+ * 2. The same coder code can count bits or write them
+ * 3. Modulo-2^32 deltas make gaps and reboots just cost bits, not break
+ * 4. A smaller log means fewer sector writes - until the syncs dominate
+ * 5. The CRC, index and recovery of lesson 9 do not care what is inside
+ * 6. Ship the decoder with the format: a log you can't read is no log
+ *
+ * Next: Many devices on one SPI bus - a queue, DMA and transaction batching!
+ */
@@ -0,0 +1,708 @@
+/*
+ * MODULE 4 - LESSON 13: Listing 10,000 Files - A Directory Cache
+ *
+ * What you'll learn:
+ * - Why listing a big folder on an SD card is slow: every file is
+ *   OPENED just to ask its size, and opening by name searches the
+ *   directory from the start
+ * - A metadata cache: name, size and time of every file in one small
+ *   index file, 24 bytes per file
+ * - Keeping the cache up to date where the files change (the log's
+ *   rotation) instead of scanning for changes
+ * - Paging: entry N is at offset 16 + 24*N - page 400 costs the same as
+ *   page 0
+ * - Dropping the oldest file without rewriting the index ("first"
+ *   pointer + occasional compaction)
+ * - Trusting a cache, but checking its ends after a power cut
+ *
+ * Think of it like a library:
+ * - The old way: to see what's on the shelves, walk along them and take
+ *   every book down to read its cover - and for book 5000, start walking
+ *   from the door again
+ * - The cache: the card catalogue at the entrance. One drawer per letter,
+ *   one card per book, new cards added when books arrive
+ * - The librarian adds the card when shelving a book - nobody needs to
+ *   walk the shelves to keep the catalogue right
+ *
+ * Index file (INDEX.BIN in the same folder, little endian):
+ *   header  "DIX1", first slot[4], slots[4], CRC-32 of the 12 bytes[4]
+ *   slot    name[12] (8.3, zero padded), size[4], time[4], CRC-32[4]
+ * Slots before "first" belong to files that were deleted (the oldest
+ * log segments). Slots are sorted by name - the log creates segments in
+ * name order, a rebuild sorts.
+ *
+ * SD costs, ASSUMED (FAT with 8.3 names, no long file names):
+ * - 16 directory entries per 512-byte sector, 0.3 ms per sector read
+ * - opening or checking a file by name scans the directory from its
+ *   start (FatFs keeps no name cache): file k costs k/16 + 1 sectors
+ * - a directory walk (readdir) reads each directory sector once
+ * The Linux times below are real, on ./dircache_demo/log/ - Linux
+ * caches its directories, so they only show the amount of work.
+ *
+ *   gcc -O2 -o directory_cache 13_directory_cache.c && ./directory_cache
+ *
+ * The Module 4 sketch (02_spi_sdcard.c) keeps /log/INDEX.BIN up to date
+ * at every segment rotation and lists the log folder page by page.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define DEMO_DIR                "dircache_demo"
+#define LOG_DIR                 DEMO_DIR "/log"
+#define INDEX_NAME              "INDEX.BIN"
+
+#define NAME_LEN                12          // "SEG00001.BIN"
+#define HEADER_SIZE             16
+#define ENTRY_SIZE              24
+#define PAGE_ENTRIES            20          // One screen of the listing
+#define COMPACT_MIN             64          // Dropped slots before compaction is worth it
+
+#define SECTOR_SIZE             512
+#define FAT_ENTRIES_PER_SECTOR  16
+#define SECTOR_READ_MS          0.3
+
+#define BENCH_FILES             10000
+
+/*
+ * PART 1: Entries, CRCs and the SD cost model
+ */
+typedef struct {
+    char name[NAME_LEN + 1];
+    uint32_t size;
+    uint32_t mtime;                         // Seconds (the sketch: log time)
+} dir_entry_t;
+
+uint32_t crc32_table[256];
+
+void crc32_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & (0 - (crc & 1)));
+        crc32_table[i] = crc;
+    }
+}
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length)
+{
+    crc = ~crc;
+    while (length--) crc = (crc >> 8) ^ crc32_table[(crc ^ *data++) & 0xFF];
+    return ~crc;
+}
+
+void put_u32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+uint32_t get_u32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+void entry_encode(uint8_t* p, const dir_entry_t* e)
+{
+    memset(p, 0, NAME_LEN);
+    memcpy(p, e->name, strlen(e->name));
+    put_u32(&p[12], e->size);
+    put_u32(&p[16], e->mtime);
+    put_u32(&p[20], crc32(0, p, 20));
+}
+
+bool entry_decode(const uint8_t* p, dir_entry_t* e)
+{
+    if (get_u32(&p[20]) != crc32(0, p, 20)) return false;
+    memcpy(e->name, p, NAME_LEN);
+    e->name[NAME_LEN] = '\0';
+    e->size = get_u32(&p[12]);
+    e->mtime = get_u32(&p[16]);
+    return true;
+}
+
+// Sectors to find file number k by name (the scan starts at the top)
+uint64_t fat_lookup_sectors(uint32_t k)
+{
+    return k / FAT_ENTRIES_PER_SECTOR + 1;
+}
+
+// Sectors touched by reading length bytes at offset
+uint64_t sectors_touched(uint32_t offset, uint32_t length)
+{
+    return length ? (offset + length - 1) / SECTOR_SIZE - offset / SECTOR_SIZE + 1 : 0;
+}
+
+bool is_listed(const char* name)
+{
+    return name[0] != '.' && strcmp(name, INDEX_NAME) != 0 && strlen(name) <= NAME_LEN;
+}
+
+/*
+ * PART 2: The old way - walk the folder, open every file
+ * This is listSDCardFiles(): openNextFile() returns an open File, so
+ * every entry is opened (a name lookup) just to print its size. Page N
+ * means walking - and opening - everything before it.
+ */
+typedef struct {
+    uint32_t opens;
+    uint64_t sectors;
+    uint32_t printed;
+    char out[PAGE_ENTRIES * 48];
+} old_list_t;
+
+void old_list(const char* dir, uint32_t skip, uint32_t max, old_list_t* r)
+{
+    memset(r, 0, sizeof(*r));
+    DIR* d = opendir(dir);
+    if (!d) return;
+    struct dirent* de;
+    uint32_t k = 0, used = 0;
+    char path[256];
+    while ((de = readdir(d)) != NULL && r->printed < max) {
+        if (!is_listed(de->d_name)) continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+        struct stat st;
+        int fd = open(path, O_RDONLY);
+        if (fd >= 0) {
+            fstat(fd, &st);
+            close(fd);
+        }
+        r->opens++;
+        r->sectors += fat_lookup_sectors(k);
+        if (k >= skip) {
+            used += snprintf(r->out + used % (sizeof(r->out) - 48), 48, "%u. %s - %lu bytes\n", k + 1,
+                             de->d_name, (unsigned long)st.st_size);
+            r->printed++;
+        }
+        k++;
+    }
+    r->sectors += k / FAT_ENTRIES_PER_SECTOR + 1;        // The walk itself
+    closedir(d);
+}
+
+/*
+ * PART 3: The cache
+ * Slots [first, slots) are the files, sorted by name. Every change is
+ * one slot write plus the 16-byte header.
+ */
+typedef struct {
+    char dir[128];
+    int fd;
+    uint32_t first;
+    uint32_t slots;
+    uint64_t sectors_read;
+    uint64_t sectors_written;
+    uint32_t lookups;                       // Files checked by name
+    uint32_t rebuilds;
+} dir_cache_t;
+
+static bool header_write(dir_cache_t* c)
+{
+    uint8_t h[HEADER_SIZE];
+    memcpy(h, "DIX1", 4);
+    put_u32(&h[4], c->first);
+    put_u32(&h[8], c->slots);
+    put_u32(&h[12], crc32(0, h, 12));
+    c->sectors_written++;
+    return pwrite(c->fd, h, HEADER_SIZE, 0) == HEADER_SIZE;
+}
+
+static bool slot_write(dir_cache_t* c, uint32_t slot, const dir_entry_t* e)
+{
+    uint8_t p[ENTRY_SIZE];
+    entry_encode(p, e);
+    uint32_t offset = HEADER_SIZE + slot * ENTRY_SIZE;
+    c->sectors_written += sectors_touched(offset, ENTRY_SIZE);
+    return pwrite(c->fd, p, ENTRY_SIZE, offset) == ENTRY_SIZE;
+}
+
+static bool slot_read(dir_cache_t* c, uint32_t slot, dir_entry_t* e)
+{
+    uint8_t p[ENTRY_SIZE];
+    uint32_t offset = HEADER_SIZE + slot * ENTRY_SIZE;
+    c->sectors_read += sectors_touched(offset, ENTRY_SIZE);
+    return pread(c->fd, p, ENTRY_SIZE, offset) == ENTRY_SIZE && entry_decode(p, e);
+}
+
+uint32_t dircache_count(const dir_cache_t* c)
+{
+    return c->slots - c->first;
+}
+
+static int compare_entries(const void* a, const void* b)
+{
+    return strcmp(((const dir_entry_t*)a)->name, ((const dir_entry_t*)b)->name);
+}
+
+// Check a file by name (a directory search on the card)
+static bool file_stat(dir_cache_t* c, const char* name, uint32_t position, dir_entry_t* e)
+{
+    char path[256];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", c->dir, name);
+    c->lookups++;
+    c->sectors_read += fat_lookup_sectors(position);
+    if (stat(path, &st) != 0) return false;
+    snprintf(e->name, sizeof(e->name), "%s", name);
+    e->size = st.st_size;
+    e->mtime = st.st_mtime;
+    return true;
+}
+
+// Walk the folder once and write a fresh index
+bool dircache_rebuild(dir_cache_t* c)
+{
+    DIR* d = opendir(c->dir);
+    if (!d) return false;
+    uint32_t capacity = 1024, n = 0;
+    dir_entry_t* list = malloc(capacity * sizeof(*list));
+    struct dirent* de;
+    char path[256];
+    while (list && (de = readdir(d)) != NULL) {
+        if (!is_listed(de->d_name)) continue;
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", c->dir, de->d_name);
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        if (n == capacity) list = realloc(list, (capacity *= 2) * sizeof(*list));
+        if (!list) break;
+        snprintf(list[n].name, sizeof(list[n].name), "%s", de->d_name);
+        list[n].size = st.st_size;
+        list[n].mtime = st.st_mtime;
+        n++;
+    }
+    closedir(d);
+    if (!list) return false;
+    // The walk reads every directory sector once; FatFs reads the size
+    // and time from the directory entry itself - no file is opened
+    c->sectors_read += n / FAT_ENTRIES_PER_SECTOR + 1;
+    qsort(list, n, sizeof(*list), compare_entries);
+
+    uint8_t* image = malloc((size_t)n * ENTRY_SIZE + 1);
+    for (uint32_t i = 0; i < n; i++) entry_encode(image + (size_t)i * ENTRY_SIZE, &list[i]);
+    c->first = 0;
+    c->slots = n;
+    bool ok = ftruncate(c->fd, 0) == 0 && header_write(c) &&
+              pwrite(c->fd, image, (size_t)n * ENTRY_SIZE, HEADER_SIZE) == (ssize_t)n * ENTRY_SIZE;
+    c->sectors_written += sectors_touched(HEADER_SIZE, n * ENTRY_SIZE);
+    c->rebuilds++;
+    free(image);
+    free(list);
+    return ok;
+}
+
+// Next name in the log's numbering: SEG00041.BIN -> SEG00042.BIN
+static bool next_segment_name(const char* name, char* next)
+{
+    unsigned number;
+    if (sscanf(name, "SEG%05u.BIN", &number) != 1) return false;
+    snprintf(next, NAME_LEN + 1, "SEG%05u.BIN", number + 1);
+    return true;
+}
+
+/*
+ * Open the cache. Rebuild it if it is missing or damaged. Otherwise
+ * check only its ends - a power cut can stop the log between changing a
+ * file and updating the index:
+ *   the first file still there?      (deleted, index not updated)
+ *   the last file's size and time?   (written since the last update)
+ *   a file after the last one?       (rotated, index not updated)
+ * Three lookups instead of opening every file. (Change the folder on the
+ * PC? Delete INDEX.BIN and it is rebuilt.)
+ */
+bool dircache_open(dir_cache_t* c, const char* dir)
+{
+    memset(c, 0, sizeof(*c));
+    snprintf(c->dir, sizeof(c->dir), "%s", dir);
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", dir, INDEX_NAME);
+    c->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (c->fd < 0) return false;
+
+    uint8_t h[HEADER_SIZE];
+    c->sectors_read++;
+    if (pread(c->fd, h, HEADER_SIZE, 0) != HEADER_SIZE || memcmp(h, "DIX1", 4) != 0 ||
+        get_u32(&h[12]) != crc32(0, h, 12)) {
+        return dircache_rebuild(c);
+    }
+    c->first = get_u32(&h[4]);
+    c->slots = get_u32(&h[8]);
+    if (dircache_count(c) == 0) return dircache_rebuild(c);
+
+    dir_entry_t cached, real;
+    uint32_t count = dircache_count(c);
+    if (!slot_read(c, c->first, &cached) || !file_stat(c, cached.name, 0, &real)) return dircache_rebuild(c);
+    if (!slot_read(c, c->slots - 1, &cached) || !file_stat(c, cached.name, count - 1, &real)) {
+        return dircache_rebuild(c);
+    }
+    if (real.size != cached.size || real.mtime != cached.mtime) {
+        if (!slot_write(c, c->slots - 1, &real)) return false;
+    }
+
+    char next[NAME_LEN + 1];
+    while (next_segment_name(real.name, next) && file_stat(c, next, dircache_count(c), &real)) {
+        if (!slot_write(c, c->slots++, &real)) return false;
+    }
+    return header_write(c);
+}
+
+void dircache_close(dir_cache_t* c)
+{
+    if (c->fd >= 0) close(c->fd);
+    c->fd = -1;
+}
+
+// A new file at the end (the log started a segment)
+bool dircache_append(dir_cache_t* c, const dir_entry_t* e)
+{
+    if (!slot_write(c, c->slots, e)) return false;
+    c->slots++;
+    return header_write(c);
+}
+
+// The newest file changed (the log sealed or synced it)
+bool dircache_update_last(dir_cache_t* c, uint32_t size, uint32_t mtime)
+{
+    dir_entry_t e;
+    if (dircache_count(c) == 0 || !slot_read(c, c->slots - 1, &e)) return false;
+    e.size = size;
+    e.mtime = mtime;
+    return slot_write(c, c->slots - 1, &e);
+}
+
+// The oldest file was deleted: move "first" on. When more than half of
+// the index is dropped slots, move the live ones to the front once.
+bool dircache_drop_oldest(dir_cache_t* c)
+{
+    if (dircache_count(c) == 0) return false;
+    c->first++;
+    if (c->first >= COMPACT_MIN && c->first > c->slots / 2) {
+        uint32_t n = dircache_count(c);
+        uint8_t* live = malloc((size_t)n * ENTRY_SIZE + 1);
+        if (!live) return false;
+        bool ok = pread(c->fd, live, (size_t)n * ENTRY_SIZE, HEADER_SIZE + (off_t)c->first * ENTRY_SIZE) ==
+                  (ssize_t)n * ENTRY_SIZE;
+        ok = ok && pwrite(c->fd, live, (size_t)n * ENTRY_SIZE, HEADER_SIZE) == (ssize_t)n * ENTRY_SIZE;
+        c->sectors_read += sectors_touched(HEADER_SIZE + c->first * ENTRY_SIZE, n * ENTRY_SIZE);
+        c->sectors_written += sectors_touched(HEADER_SIZE, n * ENTRY_SIZE);
+        free(live);
+        if (!ok) return false;
+        c->first = 0;
+        c->slots = n;
+        if (!header_write(c)) return false;
+        return ftruncate(c->fd, HEADER_SIZE + (off_t)n * ENTRY_SIZE) == 0;
+    }
+    return header_write(c);
+}
+
+/*
+ * PART 4: Paging - one read, wherever the page is
+ * Returns the entries read, -1 if a slot is damaged (rebuild).
+ */
+int dircache_page(dir_cache_t* c, uint32_t page, uint32_t per_page, dir_entry_t* out)
+{
+    uint32_t start = c->first + page * per_page;
+    if (start >= c->slots) return 0;
+    uint32_t n = c->slots - start < per_page ? c->slots - start : per_page;
+    uint8_t buf[PAGE_ENTRIES * ENTRY_SIZE];
+    if (n > PAGE_ENTRIES) n = PAGE_ENTRIES;
+    uint32_t offset = HEADER_SIZE + start * ENTRY_SIZE;
+    c->sectors_read += sectors_touched(offset, n * ENTRY_SIZE);
+    if (pread(c->fd, buf, n * ENTRY_SIZE, offset) != (ssize_t)(n * ENTRY_SIZE)) return -1;
+    for (uint32_t i = 0; i < n; i++) {
+        if (!entry_decode(buf + i * ENTRY_SIZE, &out[i])) return -1;
+    }
+    return n;
+}
+
+/*
+ * PART 5: A pretend log that rotates segments
+ * Files get a size (sparse - no data written) and a time, like the
+ * sketch's segments. update_cache = false is the power cut: the file
+ * changed, the index didn't.
+ */
+typedef struct {
+    dir_cache_t* cache;
+    uint32_t next_number;
+    uint32_t oldest;
+    uint32_t clock;
+} log_sim_t;
+
+static bool set_file(const char* name, uint32_t size, uint32_t mtime, bool create)
+{
+    char path[256];
+    snprintf(path, sizeof(path), LOG_DIR "/%s", name);
+    int fd = open(path, O_WRONLY | (create ? O_CREAT | O_TRUNC : 0), 0644);
+    if (fd < 0) return false;
+    bool ok = ftruncate(fd, size) == 0;
+    struct timespec times[2] = {{mtime, 0}, {mtime, 0}};
+    ok = ok && futimens(fd, times) == 0;
+    close(fd);
+    return ok;
+}
+
+void log_rotate(log_sim_t* log, bool update_cache)
+{
+    dir_entry_t e;
+    snprintf(e.name, sizeof(e.name), "SEG%05u.BIN", log->next_number++);
+    e.size = 1024;                          // Header + first block
+    e.mtime = ++log->clock;
+    set_file(e.name, e.size, e.mtime, true);
+    if (update_cache) dircache_append(log->cache, &e);
+}
+
+void log_grow(log_sim_t* log, uint32_t size, bool update_cache)
+{
+    char name[NAME_LEN + 1];
+    snprintf(name, sizeof(name), "SEG%05u.BIN", log->next_number - 1);
+    log->clock++;
+    set_file(name, size, log->clock, false);
+    if (update_cache) dircache_update_last(log->cache, size, log->clock);
+}
+
+void log_drop_oldest(log_sim_t* log, bool update_cache)
+{
+    char path[256];
+    snprintf(path, sizeof(path), LOG_DIR "/SEG%05u.BIN", log->oldest++);
+    remove(path);
+    if (update_cache) dircache_drop_oldest(log->cache);
+}
+
+void clear_log_dir(void)
+{
+    mkdir(DEMO_DIR, 0755);
+    mkdir(LOG_DIR, 0755);
+    DIR* d = opendir(LOG_DIR);
+    if (!d) return;
+    struct dirent* de;
+    char path[256];
+    while ((de = readdir(d)) != NULL) {
+        if (de->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), LOG_DIR "/%.200s", de->d_name);
+        remove(path);
+    }
+    closedir(d);
+}
+
+double nanos_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Differences between the cache and the real folder (sorted walk)
+uint32_t cache_differences(dir_cache_t* c)
+{
+    dir_cache_t truth;
+    memset(&truth, 0, sizeof(truth));
+    snprintf(truth.dir, sizeof(truth.dir), "%s", c->dir);
+    truth.fd = open(DEMO_DIR "/truth.bin", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    dircache_rebuild(&truth);
+
+    uint32_t wrong = 0;
+    uint32_t n = dircache_count(c) > dircache_count(&truth) ? dircache_count(c) : dircache_count(&truth);
+    if (dircache_count(c) != dircache_count(&truth)) wrong++;
+    dir_entry_t a[PAGE_ENTRIES], b[PAGE_ENTRIES];
+    for (uint32_t page = 0; page * PAGE_ENTRIES < n; page++) {
+        int got = dircache_page(c, page, PAGE_ENTRIES, a);
+        int want = dircache_page(&truth, page, PAGE_ENTRIES, b);
+        if (got != want) {
+            wrong++;
+            continue;
+        }
+        for (int i = 0; i < got; i++) {
+            if (strcmp(a[i].name, b[i].name) != 0 || a[i].size != b[i].size || a[i].mtime != b[i].mtime) wrong++;
+        }
+    }
+    dircache_close(&truth);
+    remove(DEMO_DIR "/truth.bin");
+    return wrong;
+}
+
+/*
+ * DEMO 1: Does the cache always match the folder?
+ * 3000 log events: rotations, growing segments, deleting the oldest -
+ * and every 50 events a power cut that skips one index update, then a
+ * reboot (close and open the cache).
+ */
+void correctness_demo(void)
+{
+    printf("=== DEMO 1: Correctness - 3000 Log Events, 60 Power Cuts ===\n");
+    crc32_init();
+    clear_log_dir();
+
+    dir_cache_t cache;
+    dircache_open(&cache, LOG_DIR);
+    log_sim_t log = {&cache, 1, 1, 1000000};
+    srand(7);
+    uint32_t checks = 0, wrong = 0, cuts = 0, rebuilds = 0;
+    for (int event = 0; event < 3000; event++) {
+        bool cut = event % 50 == 49;
+        int kind = rand() % 10;
+        uint32_t files = log.next_number - log.oldest;
+        if (files == 0 || kind < 3) {
+            log_rotate(&log, !cut);
+        } else if (kind < 8) {
+            log_grow(&log, 1024 + (rand() % 255) * 512, !cut);
+        } else if (files > 1) {
+            log_drop_oldest(&log, !cut);
+        }
+        if (cut) {
+            cuts++;
+            rebuilds += cache.rebuilds;
+            dircache_close(&cache);
+            dircache_open(&cache, LOG_DIR);
+        }
+        if (event % 100 == 99) {
+            wrong += cache_differences(&cache);
+            checks++;
+        }
+    }
+    printf("%u files at the end, %u checks, %u power cuts, %u rebuilds, %u wrong entries\n",
+           dircache_count(&cache), checks, cuts, rebuilds + cache.rebuilds, wrong);
+    printf("Index: %u slots, first live slot %u (compacted as it goes)\n", cache.slots, cache.first);
+    printf("Result: %s\n\n", wrong == 0 ? "PASS" : "FAIL");
+    dircache_close(&cache);
+}
+
+/*
+ * DEMO 2: 10,000 segments
+ */
+void benchmark_demo(void)
+{
+    printf("=== DEMO 2: A Folder with %d Files ===\n", BENCH_FILES);
+    clear_log_dir();
+    {
+        char path[256];
+        snprintf(path, sizeof(path), LOG_DIR "/" INDEX_NAME);
+        remove(path);
+    }
+
+    dir_cache_t cache;
+    dircache_open(&cache, LOG_DIR);
+    log_sim_t log = {&cache, 1, 1, 1000000};
+    double t0 = nanos_now();
+    for (int i = 0; i < BENCH_FILES; i++) {
+        log_rotate(&log, true);
+        log_grow(&log, 131584, true);       // 256 blocks + index
+    }
+    double create_ms = (nanos_now() - t0) / 1e6;
+    printf("Created with the index kept up to date: %.0f ms (%.1f index sectors written per rotation)\n\n",
+           create_ms, (double)cache.sectors_written / BENCH_FILES);
+    dircache_close(&cache);
+
+    printf("%-34s %10s %8s %12s %12s\n", "Operation", "Linux (ms)", "Opens", "SD sectors", "SD est.");
+    const uint32_t pages = BENCH_FILES / PAGE_ENTRIES;
+    static old_list_t old;
+    double ms;
+
+    t0 = nanos_now();
+    old_list(LOG_DIR, 0, UINT32_MAX, &old);
+    ms = (nanos_now() - t0) / 1e6;
+    printf("%-34s %10.2f %8u %12llu %11.0fs\n", "Old: list all (open every file)", ms, old.opens,
+           (unsigned long long)old.sectors, old.sectors * SECTOR_READ_MS / 1000);
+
+    const uint32_t probe_pages[2] = {0, pages / 2};
+    for (int p = 0; p < 2; p++) {
+        t0 = nanos_now();
+        old_list(LOG_DIR, probe_pages[p] * PAGE_ENTRIES, PAGE_ENTRIES, &old);
+        ms = (nanos_now() - t0) / 1e6;
+        char name[40];
+        snprintf(name, sizeof(name), "Old: page %u of %u", probe_pages[p] + 1, pages);
+        printf("%-34s %10.2f %8u %12llu %11.1fs\n", name, ms, old.opens, (unsigned long long)old.sectors,
+               old.sectors * SECTOR_READ_MS / 1000);
+    }
+
+    struct {
+        const char* name;
+        int what;
+    } rows[5] = {
+        {"Cache: rebuild (once)", 0},
+        {"Cache: open + check the ends", 1},
+        {"Cache: page 1", 2},
+        {"Cache: page 251", 3},
+        {"Cache: list all (500 pages)", 4},
+    };
+    dir_entry_t page[PAGE_ENTRIES];
+    for (int r = 0; r < 5; r++) {
+        dircache_open(&cache, LOG_DIR);
+        cache.sectors_read = 0;
+        cache.lookups = 0;
+        t0 = nanos_now();
+        if (rows[r].what == 0) dircache_rebuild(&cache);
+        if (rows[r].what == 1) {
+            dircache_close(&cache);
+            dircache_open(&cache, LOG_DIR);
+        }
+        if (rows[r].what == 2) dircache_page(&cache, 0, PAGE_ENTRIES, page);
+        if (rows[r].what == 3) dircache_page(&cache, pages / 2, PAGE_ENTRIES, page);
+        if (rows[r].what == 4) {
+            for (uint32_t p = 0; p < pages; p++) dircache_page(&cache, p, PAGE_ENTRIES, page);
+        }
+        ms = (nanos_now() - t0) / 1e6;
+        printf("%-34s %10.3f %8u %12llu %11.2fs\n", rows[r].name, ms, cache.lookups,
+               (unsigned long long)cache.sectors_read, cache.sectors_read * SECTOR_READ_MS / 1000);
+        dircache_close(&cache);
+    }
+    printf("(Opens: files opened or looked up by name. SD est. = sectors x %.1f ms.\n", SECTOR_READ_MS);
+    printf(" The old way's cost grows with the square of the file count; a page\n");
+    printf(" from the cache is 1-2 sector reads wherever it is.)\n\n");
+}
+
+/*
+ * DEMO 3: What a listing costs as the folder grows
+ */
+void growth_demo(void)
+{
+    printf("=== DEMO 3: List One Page (the newest files) as the Folder Grows ===\n");
+    printf("%8s %16s %16s %14s\n", "Files", "Old: SD est.", "Cache: SD est.", "Index (KB)");
+    const uint32_t sizes[4] = {100, 1000, 5000, BENCH_FILES};
+    for (int s = 0; s < 4; s++) {
+        uint32_t n = sizes[s];
+        // Old: walk and open all n files to reach the last page
+        uint64_t old_sectors = n / FAT_ENTRIES_PER_SECTOR + 1;
+        for (uint32_t k = 0; k < n; k++) old_sectors += fat_lookup_sectors(k);
+        // Cache: header + the last page's slots
+        uint32_t last_page = (n - 1) / PAGE_ENTRIES;
+        uint64_t cache_sectors = 1 + sectors_touched(HEADER_SIZE + last_page * PAGE_ENTRIES * ENTRY_SIZE,
+                                                     (n - last_page * PAGE_ENTRIES) * ENTRY_SIZE);
+        printf("%8u %15.1fs %15.4fs %14.1f\n", n, old_sectors * SECTOR_READ_MS / 1000,
+               cache_sectors * SECTOR_READ_MS / 1000, (HEADER_SIZE + n * ENTRY_SIZE) / 1024.0);
+    }
+    printf("(the sketch shows the newest page every 30 s - with the cache that\n");
+    printf(" stays under a millisecond whatever the card holds)\n\n");
+}
+
+int main(void)
+{
+    printf("Directory Cache - Listing 10,000 Files Page by Page\n");
+    printf("===================================================\n\n");
+
+    correctness_demo();
+    benchmark_demo();
+    growth_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. Listing by opening every file costs a name search per file\n");
+    printf("2. Keep name, size and time in one index file - 24 bytes per file\n");
+    printf("3. Update the index where the files change, not by scanning\n");
+    printf("4. Fixed-size slots make any page one read\n");
+    printf("5. Drop old entries by moving a pointer; compact now and then\n");
+    printf("6. After a power cut, check the cache's ends - rebuild only if needed\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. Opening a file by name on FAT scans the directory - O(n) per file
+ * 2. A listing that opens every file is O(n^2): seconds, then minutes
+ * 3. A cache is only as good as its updates - put them next to the change
+ * 4. Fixed-size records = random access = paging for free
+ * 5. Deleting from the front doesn't have to move everything
+ * 6. Every cache needs a cheap "is this still true?" check
+ *
+ * Next: A web page built in pieces - streaming HTML without a big String!
+ */
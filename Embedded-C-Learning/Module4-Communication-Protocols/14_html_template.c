@@ -0,0 +1,632 @@
+/*
+ * MODULE 4 - LESSON 14: Streaming Web Pages from a Template
+ *
+ * What you'll learn:
+ * - What String += really does: a new, exactly-sized heap block for
+ *   almost every piece of the page, and temporaries for every "a" +
+ *   String(x) + "b"
+ * - A template: the page as one constant text (in flash on the ESP32)
+ *   with {{SLOTS}} for the values, split into parts ONCE at start-up
+ * - Streaming: the page goes out in chunks while it is being built -
+ *   the only RAM it needs is one small buffer
+ * - HTTP chunked transfer encoding: sending a page without knowing its
+ *   length in advance
+ * - Escaping text that came from outside (a Bluetooth message) before
+ *   it goes into HTML
+ * - Counting heap use with a wrapper around malloc
+ *
+ * Think of it like a print shop making a certificate:
+ * - The String way: copy the whole certificate by hand, word by word,
+ *   onto ever larger sheets of paper - and then post it in one piece
+ * - The template way: a pre-printed form with blanks. Fill in the name,
+ *   tear off a strip, post it, fill in the next blank, post it...
+ * - The form never changes, so it is printed once (flash), not every time
+ *
+ * String costs here follow the Arduino String class: concat() grows the
+ * buffer to EXACTLY the new length (a realloc per +=), and "a" +
+ * String(x) builds a temporary String (a malloc per literal and per
+ * value). Heap use is measured with counting wrappers, so it is real -
+ * the time is host time, so compare the two ways with each other only.
+ *
+ *   gcc -O2 -o html_template 14_html_template.c && ./html_template
+ *
+ * The same template code serves the dashboard in Module 4
+ * (04_wifi_bluetooth.c) with WebServer's sendContent().
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define CHUNK_BUFFER_SIZE       512         // The only RAM the streamed page needs
+#define TEMPLATE_MAX_PARTS      32
+#define BENCH_PAGES             200000
+
+/*
+ * PART 1: A counting heap
+ * Every allocation carries its size in front, so free() and realloc()
+ * know how much heap they give back. A moving realloc holds the old and
+ * the new block at the same time - that counts towards the peak.
+ */
+typedef struct {
+    size_t live;
+    size_t peak;
+    uint32_t allocs;
+    uint32_t frees;
+} heap_stats_t;
+
+static heap_stats_t heap;
+
+void* heap_malloc(size_t size)
+{
+    size_t* p = malloc(sizeof(size_t) + size);
+    if (!p) return NULL;
+    *p = size;
+    heap.live += size;
+    heap.allocs++;
+    if (heap.live > heap.peak) heap.peak = heap.live;
+    return p + 1;
+}
+
+void heap_free(void* ptr)
+{
+    if (!ptr) return;
+    size_t* p = (size_t*)ptr - 1;
+    heap.live -= *p;
+    heap.frees++;
+    free(p);
+}
+
+void* heap_realloc(void* ptr, size_t size)
+{
+    if (!ptr) return heap_malloc(size);
+    size_t old = ((size_t*)ptr)[-1];
+    void* fresh = heap_malloc(size);
+    if (!fresh) return NULL;
+    memcpy(fresh, ptr, old < size ? old : size);
+    heap_free(ptr);
+    return fresh;
+}
+
+/*
+ * PART 2: The String way (what createWebPage() does)
+ * str_t behaves like Arduino's String: exact-size buffers, a realloc
+ * for every concat that doesn't fit.
+ */
+typedef struct {
+    char* buf;
+    size_t len;
+    size_t capacity;
+} str_t;
+
+void str_init(str_t* s, const char* text)
+{
+    s->len = strlen(text);
+    s->capacity = s->len;
+    s->buf = heap_malloc(s->capacity + 1);
+    memcpy(s->buf, text, s->len + 1);
+}
+
+void str_cat(str_t* s, const char* text)
+{
+    size_t n = strlen(text);
+    if (s->len + n > s->capacity) {
+        s->capacity = s->len + n;           // Exactly what is needed - no spare room
+        s->buf = heap_realloc(s->buf, s->capacity + 1);
+    }
+    memcpy(s->buf + s->len, text, n + 1);
+    s->len += n;
+}
+
+void str_free(str_t* s)
+{
+    heap_free(s->buf);
+    s->buf = NULL;
+}
+
+// html += "a" + String(value) + "b"; - two temporaries, three copies
+void str_cat_sum(str_t* html, const char* a, const char* value, const char* b)
+{
+    str_t sum, v;
+    str_init(&sum, a);
+    str_init(&v, value);
+    str_cat(&sum, v.buf);
+    str_cat(&sum, b);
+    str_cat(html, sum.buf);
+    str_free(&v);
+    str_free(&sum);
+}
+
+typedef struct {
+    int visitors;
+    float temperature;
+    int light;
+    bool led;
+    int rssi;
+    const char* web_command;
+    const char* bt_message;
+    int bt_count;
+} page_values_t;
+
+// Digits for the values (both ways use the same, so only the page
+// building is compared)
+size_t format_int(char* out, int v)
+{
+    char tmp[12];
+    char* p = tmp + sizeof(tmp);
+    uint32_t u = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+    do {
+        *--p = '0' + u % 10;
+        u /= 10;
+    } while (u);
+    if (v < 0) *--p = '-';
+    size_t n = tmp + sizeof(tmp) - p;
+    memcpy(out, p, n);
+    out[n] = '\0';
+    return n;
+}
+
+size_t format_fixed1(char* out, float value)
+{
+    int tenths = (int)(value * 10 + (value < 0 ? -0.5f : 0.5f));
+    size_t n = 0;
+    if (tenths < 0) {
+        out[n++] = '-';
+        tenths = -tenths;
+    }
+    n += format_int(out + n, tenths / 10);
+    out[n++] = '.';
+    out[n++] = '0' + tenths % 10;
+    out[n] = '\0';
+    return n;
+}
+
+// The sketch's createWebPage(), piece for piece
+void string_page(str_t* html, const page_values_t* v)
+{
+    char number[16];
+    str_init(html, "<!DOCTYPE html><html><head>");
+    str_cat(html, "<title>ESP32 Learning Server</title>");
+    str_cat(html, "<style>body{font-family:Arial;margin:40px;background:#f0f0f0;}");
+    str_cat(html, ".container{background:white;padding:20px;border-radius:10px;box-shadow:0 2px 10px rgba(0,0,0,0.1);}");
+    str_cat(html, ".sensor{background:#e8f4fd;padding:15px;margin:10px 0;border-left:4px solid #2196F3;}");
+    str_cat(html, ".button{background:#4CAF50;color:white;padding:10px 20px;text-decoration:none;border-radius:5px;margin:5px;}");
+    str_cat(html, ".button:hover{background:#45a049;}");
+    str_cat(html, "</style></head><body>");
+
+    str_cat(html, "<div class='container'>");
+    str_cat(html, "<h1>🔧 ESP32 Learning Dashboard</h1>");
+    format_int(number, v->visitors);
+    str_cat_sum(html, "<p>Welcome to your ESP32 web server! Visitor #", number, "</p>");
+
+    format_fixed1(number, v->temperature);
+    str_cat(html, "<div class='sensor'>");
+    str_cat(html, "<h3>📊 Sensor Readings</h3>");
+    str_cat_sum(html, "<p>🌡️ Temperature: ", number, "°C</p>");
+    format_int(number, v->light);
+    str_cat_sum(html, "<p>💡 Light Level: ", number, "/1023</p>");
+    str_cat_sum(html, "<p>🔆 LED Status: ", v->led ? "ON" : "OFF", "</p>");
+    str_cat(html, "</div>");
+
+    str_cat(html, "<div class='sensor'>");
+    str_cat(html, "<h3>📡 Communication Status</h3>");
+    format_int(number, v->rssi);
+    str_cat_sum(html, "<p>📶 WiFi Signal: ", number, " dBm</p>");
+    str_cat_sum(html, "<p>📧 Last Web Command: ", v->web_command, "</p>");
+    str_cat_sum(html, "<p>📱 Last Bluetooth Message: ", v->bt_message, "</p>");
+    format_int(number, v->bt_count);
+    str_cat_sum(html, "<p>💬 Bluetooth Messages: ", number, "</p>");
+    str_cat(html, "</div>");
+
+    str_cat(html, "<h3>🎛️ Controls</h3>");
+    str_cat(html, "<a href='/led_on' class='button'>💡 Turn LED ON</a>");
+    str_cat(html, "<a href='/led_off' class='button'>💤 Turn LED OFF</a>");
+    str_cat(html, "<a href='/refresh' class='button'>🔄 Refresh Data</a>");
+
+    str_cat(html, "<h3>📱 Try Bluetooth</h3>");
+    str_cat(html, "<p>Connect to 'ESP32-Learning' via Bluetooth and send messages!</p>");
+    str_cat(html, "<p>Try sending: 'LED ON', 'LED OFF', 'STATUS', or 'HELLO'</p>");
+
+    str_cat(html, "</div></body></html>");
+}
+
+/*
+ * PART 3: The template
+ * One constant text; {{NAME}} marks a value. template_compile() splits
+ * it into parts once - (text, length) pointing INTO the constant, or a
+ * slot number. Nothing is copied, nothing allocated.
+ */
+typedef enum {
+    SLOT_NONE = -1,
+    SLOT_VISITORS,
+    SLOT_TEMPERATURE,
+    SLOT_LIGHT,
+    SLOT_LED,
+    SLOT_RSSI,
+    SLOT_WEB_COMMAND,
+    SLOT_BT_MESSAGE,
+    SLOT_BT_COUNT,
+    SLOT_COUNT
+} slot_id_t;
+
+static const char* const slot_names[SLOT_COUNT] = {
+    "VISITORS", "TEMPERATURE", "LIGHT", "LED", "RSSI", "WEB_COMMAND", "BT_MESSAGE", "BT_COUNT",
+};
+
+typedef struct {
+    const char* text;
+    uint16_t length;
+    int8_t slot;                            // SLOT_NONE: static text
+} template_part_t;
+
+typedef struct {
+    template_part_t parts[TEMPLATE_MAX_PARTS];
+    int count;
+} html_template_t;
+
+static const char page_template[] =
+    "<!DOCTYPE html><html><head>"
+    "<title>ESP32 Learning Server</title>"
+    "<style>body{font-family:Arial;margin:40px;background:#f0f0f0;}"
+    ".container{background:white;padding:20px;border-radius:10px;box-shadow:0 2px 10px rgba(0,0,0,0.1);}"
+    ".sensor{background:#e8f4fd;padding:15px;margin:10px 0;border-left:4px solid #2196F3;}"
+    ".button{background:#4CAF50;color:white;padding:10px 20px;text-decoration:none;border-radius:5px;margin:5px;}"
+    ".button:hover{background:#45a049;}"
+    "</style></head><body>"
+    "<div class='container'>"
+    "<h1>🔧 ESP32 Learning Dashboard</h1>"
+    "<p>Welcome to your ESP32 web server! Visitor #{{VISITORS}}</p>"
+    "<div class='sensor'>"
+    "<h3>📊 Sensor Readings</h3>"
+    "<p>🌡️ Temperature: {{TEMPERATURE}}°C</p>"
+    "<p>💡 Light Level: {{LIGHT}}/1023</p>"
+    "<p>🔆 LED Status: {{LED}}</p>"
+    "</div>"
+    "<div class='sensor'>"
+    "<h3>📡 Communication Status</h3>"
+    "<p>📶 WiFi Signal: {{RSSI}} dBm</p>"
+    "<p>📧 Last Web Command: {{WEB_COMMAND}}</p>"
+    "<p>📱 Last Bluetooth Message: {{BT_MESSAGE}}</p>"
+    "<p>💬 Bluetooth Messages: {{BT_COUNT}}</p>"
+    "</div>"
+    "<h3>🎛️ Controls</h3>"
+    "<a href='/led_on' class='button'>💡 Turn LED ON</a>"
+    "<a href='/led_off' class='button'>💤 Turn LED OFF</a>"
+    "<a href='/refresh' class='button'>🔄 Refresh Data</a>"
+    "<h3>📱 Try Bluetooth</h3>"
+    "<p>Connect to 'ESP32-Learning' via Bluetooth and send messages!</p>"
+    "<p>Try sending: 'LED ON', 'LED OFF', 'STATUS', or 'HELLO'</p>"
+    "</div></body></html>";
+
+// Returns false for an unknown slot name or too many parts
+bool template_compile(html_template_t* t, const char* source)
+{
+    t->count = 0;
+    const char* p = source;
+    while (*p) {
+        const char* open = strstr(p, "{{");
+        const char* end = open ? open : p + strlen(p);
+        if (end > p) {
+            if (t->count == TEMPLATE_MAX_PARTS) return false;
+            t->parts[t->count++] = (template_part_t){p, (uint16_t)(end - p), SLOT_NONE};
+        }
+        if (!open) break;
+        const char* close = strstr(open, "}}");
+        if (!close) return false;
+        int slot = SLOT_NONE;
+        for (int i = 0; i < SLOT_COUNT; i++) {
+            size_t n = strlen(slot_names[i]);
+            if ((size_t)(close - open - 2) == n && memcmp(open + 2, slot_names[i], n) == 0) slot = i;
+        }
+        if (slot == SLOT_NONE || t->count == TEMPLATE_MAX_PARTS) return false;
+        t->parts[t->count++] = (template_part_t){NULL, 0, (int8_t)slot};
+        p = close + 2;
+    }
+    return true;
+}
+
+/*
+ * PART 4: Streaming
+ * Parts are collected in one 512-byte buffer; when it is full, it goes
+ * out as one chunk. A static part bigger than the buffer (the CSS) is
+ * sent straight from flash - after whatever is already in the buffer.
+ */
+typedef void (*chunk_sink_fn)(void* ctx, const char* data, size_t length);
+
+typedef struct {
+    char buf[CHUNK_BUFFER_SIZE];
+    size_t used;
+    chunk_sink_fn sink;
+    void* ctx;
+} page_writer_t;
+
+static void writer_flush(page_writer_t* w)
+{
+    if (w->used) w->sink(w->ctx, w->buf, w->used);
+    w->used = 0;
+}
+
+static void writer_put(page_writer_t* w, const char* text, size_t n)
+{
+    if (w->used + n > sizeof(w->buf)) {
+        writer_flush(w);
+        if (n >= sizeof(w->buf)) {          // Big enough to be a chunk of its own
+            w->sink(w->ctx, text, n);
+            return;
+        }
+    }
+    memcpy(w->buf + w->used, text, n);
+    w->used += n;
+}
+
+// Text from outside (a Bluetooth message, a command) must not become HTML
+static void writer_put_escaped(page_writer_t* w, const char* text)
+{
+    const char* run = text;
+    for (const char* p = text; ; p++) {
+        const char* entity = NULL;
+        switch (*p) {
+        case '<': entity = "&lt;"; break;
+        case '>': entity = "&gt;"; break;
+        case '&': entity = "&amp;"; break;
+        case '\'': entity = "&#39;"; break;
+        case '"': entity = "&quot;"; break;
+        }
+        if (entity || *p == '\0') {
+            writer_put(w, run, p - run);    // The plain run before it, in one go
+            if (*p == '\0') return;
+            writer_put(w, entity, strlen(entity));
+            run = p + 1;
+        }
+    }
+}
+
+void render_slot(page_writer_t* w, int slot, const page_values_t* v)
+{
+    char number[16];
+    switch (slot) {
+    case SLOT_VISITORS:    writer_put(w, number, format_int(number, v->visitors)); break;
+    case SLOT_TEMPERATURE: writer_put(w, number, format_fixed1(number, v->temperature)); break;
+    case SLOT_LIGHT:       writer_put(w, number, format_int(number, v->light)); break;
+    case SLOT_LED:         writer_put(w, v->led ? "ON" : "OFF", v->led ? 2 : 3); break;
+    case SLOT_RSSI:        writer_put(w, number, format_int(number, v->rssi)); break;
+    case SLOT_WEB_COMMAND: writer_put_escaped(w, v->web_command); break;
+    case SLOT_BT_MESSAGE:  writer_put_escaped(w, v->bt_message); break;
+    case SLOT_BT_COUNT:    writer_put(w, number, format_int(number, v->bt_count)); break;
+    }
+}
+
+void template_render(const html_template_t* t, const page_values_t* v, chunk_sink_fn sink, void* ctx)
+{
+    static page_writer_t w;                 // Static: not on the stack, not on the heap
+    w.used = 0;
+    w.sink = sink;
+    w.ctx = ctx;
+    for (int i = 0; i < t->count; i++) {
+        const template_part_t* part = &t->parts[i];
+        if (part->slot == SLOT_NONE) writer_put(&w, part->text, part->length);
+        else render_slot(&w, part->slot, v);
+    }
+    writer_flush(&w);
+}
+
+/*
+ * PART 5: The wire - chunked transfer encoding
+ * Each chunk: its length in hex, CRLF, the bytes, CRLF. A zero-length
+ * chunk ends the page. (WebServer does this in sendContent() after
+ * setContentLength(CONTENT_LENGTH_UNKNOWN).) The pretend socket keeps
+ * the page with the framing removed, to compare the two ways.
+ */
+typedef struct {
+    char page[8192];
+    size_t page_len;
+    uint64_t wire_bytes;
+    uint32_t chunks;
+} socket_t;
+
+void socket_chunk(void* ctx, const char* data, size_t length)
+{
+    socket_t* s = ctx;
+    char header[12];
+    int n = snprintf(header, sizeof(header), "%zx\r\n", length);
+    s->wire_bytes += n + length + 2;
+    s->chunks++;
+    if (s->page_len + length <= sizeof(s->page)) memcpy(s->page + s->page_len, data, length);
+    s->page_len += length;
+}
+
+void socket_end(socket_t* s)
+{
+    s->wire_bytes += 5;                     // "0\r\n\r\n"
+}
+
+void socket_reset(socket_t* s)
+{
+    s->page_len = 0;
+    s->wire_bytes = 0;
+    s->chunks = 0;
+}
+
+double nanos_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static html_template_t page;
+static socket_t sock;
+
+static const page_values_t demo_values = {
+    42, 23.5f, 512, true, -61, "Data refreshed", "LED ON", 7,
+};
+
+/*
+ * DEMO 1: Same page, both ways?
+ */
+void correctness_demo(void)
+{
+    printf("=== DEMO 1: Does the Template Make the Same Page? ===\n");
+    int errors = 0;
+    if (!template_compile(&page, page_template)) {
+        printf("Template did not compile!\n");
+        errors++;
+    }
+    int slots = 0;
+    for (int i = 0; i < page.count; i++) slots += page.parts[i].slot != SLOT_NONE;
+    printf("Template: %zu bytes of constant text, %d parts (%d slots), %zu bytes of part table\n",
+           sizeof(page_template) - 1, page.count, slots, page.count * sizeof(template_part_t));
+
+    srand(3);
+    uint32_t different = 0;
+    for (int i = 0; i < 1000; i++) {
+        page_values_t v = demo_values;
+        v.visitors = rand() % 100000;
+        v.temperature = (rand() % 4001 - 2000) / 10.0f;
+        v.light = rand() % 1024;
+        v.led = rand() & 1;
+        v.rssi = -(rand() % 100);
+        v.bt_count = rand();
+
+        str_t html;
+        string_page(&html, &v);
+        socket_reset(&sock);
+        template_render(&page, &v, socket_chunk, &sock);
+        if (sock.page_len != html.len || memcmp(sock.page, html.buf, html.len) != 0) different++;
+        str_free(&html);
+    }
+    printf("1000 pages with random values: %u different\n", different);
+    if (different) errors++;
+
+    // A Bluetooth message is typed by whoever is nearby
+    page_values_t v = demo_values;
+    v.bt_message = "<script>alert('hi')</script>";
+    str_t html;
+    string_page(&html, &v);
+    socket_reset(&sock);
+    template_render(&page, &v, socket_chunk, &sock);
+    sock.page[sock.page_len < sizeof(sock.page) ? sock.page_len : sizeof(sock.page) - 1] = '\0';
+    bool string_unsafe = strstr(html.buf, "<script>") != NULL;
+    bool template_safe = strstr(sock.page, "<script>") == NULL && strstr(sock.page, "&lt;script&gt;") != NULL;
+    printf("Bluetooth message \"%s\":\n", v.bt_message);
+    printf("  String page:   %s\n", string_unsafe ? "runs the script in the visitor's browser" : "safe");
+    printf("  Template page: %s\n", template_safe ? "shows it as text (&lt;script&gt;...)" : "NOT escaped");
+    if (!template_safe) errors++;
+    str_free(&html);
+    printf("Result: %s\n\n", errors == 0 ? "PASS" : "FAIL");
+}
+
+/*
+ * DEMO 2: Pages per second and heap
+ */
+void benchmark_demo(void)
+{
+    printf("=== DEMO 2: %d Pages Each Way ===\n", BENCH_PAGES);
+    printf("%-22s %12s %12s %12s %10s %10s %11s\n", "Method", "Pages/s", "Peak heap", "Allocs/page",
+           "RAM used", "Chunks", "Wire bytes");
+
+    page_values_t v = demo_values;
+
+    // String: build it all, then send it in one piece
+    memset(&heap, 0, sizeof(heap));
+    double t0 = nanos_now();
+    size_t page_len = 0;
+    for (int i = 0; i < BENCH_PAGES; i++) {
+        v.visitors = i;
+        str_t html;
+        string_page(&html, &v);
+        socket_reset(&sock);
+        memcpy(sock.page, html.buf, html.len);          // Content-Length known: no chunk framing
+        sock.page_len = html.len;
+        sock.wire_bytes = html.len;
+        page_len = html.len;
+        str_free(&html);
+    }
+    double string_s = (nanos_now() - t0) / 1e9;
+    heap_stats_t string_heap = heap;
+    printf("%-22s %12.0f %11zuB %12.1f %9zuB %10u %11llu\n", "String += , send()", BENCH_PAGES / string_s,
+           string_heap.peak, (double)string_heap.allocs / BENCH_PAGES, string_heap.peak, 1,
+           (unsigned long long)sock.wire_bytes);
+
+    // Template: stream it through one 512-byte buffer
+    memset(&heap, 0, sizeof(heap));
+    t0 = nanos_now();
+    for (int i = 0; i < BENCH_PAGES; i++) {
+        v.visitors = i;
+        socket_reset(&sock);
+        template_render(&page, &v, socket_chunk, &sock);
+        socket_end(&sock);
+    }
+    double template_s = (nanos_now() - t0) / 1e9;
+    printf("%-22s %12.0f %11zuB %12.1f %9dB %10u %11llu\n", "Template, chunked", BENCH_PAGES / template_s,
+           heap.peak, (double)heap.allocs / BENCH_PAGES, CHUNK_BUFFER_SIZE, sock.chunks,
+           (unsigned long long)sock.wire_bytes);
+
+    printf("Page: %zu bytes. String: %u mallocs+reallocs per page, peak = the page\n", page_len,
+           string_heap.allocs / BENCH_PAGES);
+    printf("plus the temporaries. The template needs %.1fx less RAM and is %.1fx faster;\n",
+           (double)string_heap.peak / CHUNK_BUFFER_SIZE, string_s / template_s);
+    printf("chunk framing costs %llu bytes on the wire.\n\n",
+           (unsigned long long)(sock.wire_bytes - page_len));
+}
+
+/*
+ * DEMO 3: Buffer size - RAM against chunks
+ */
+void buffer_demo(void)
+{
+    printf("=== DEMO 3: Does the Page Fit in RAM? ===\n");
+    printf("The String page needs one free block as big as the page. After hours\n");
+    printf("of Strings coming and going, the ESP32 heap is in pieces - the biggest\n");
+    printf("free block can be much smaller than the free total:\n");
+    printf("%-28s %14s %14s\n", "Largest free block", "String page", "Template");
+    page_values_t v = demo_values;
+    str_t html;
+    memset(&heap, 0, sizeof(heap));
+    string_page(&html, &v);
+    size_t need = heap.peak;
+    str_free(&html);
+    const size_t blocks[4] = {16384, 4096, 2048, 1024};
+    for (int i = 0; i < 4; i++) {
+        printf("%26zu B %14s %14s\n", blocks[i], blocks[i] >= need ? "ok" : "FAILS",
+               blocks[i] >= CHUNK_BUFFER_SIZE ? "ok" : "FAILS");
+    }
+    printf("(the template's buffer is static - it is reserved at boot and never\n");
+    printf(" has to be found again)\n\n");
+}
+
+int main(void)
+{
+    printf("Streaming Web Pages - A Template Instead of String +=\n");
+    printf("=====================================================\n\n");
+
+    correctness_demo();
+    benchmark_demo();
+    buffer_demo();
+
+    printf("=== What You Learned ===\n");
+    printf("1. String += reallocates to the exact size - once per piece\n");
+    printf("2. Keep the page as constant text with {{SLOTS}}, split it once\n");
+    printf("3. Stream: fill a small buffer, send it, fill it again\n");
+    printf("4. Chunked encoding sends a page of unknown length\n");
+    printf("5. Escape text from outside before it goes into HTML\n");
+    printf("6. Peak RAM = one buffer, not one page plus its copies\n");
+
+    return 0;
+}
+
+/*
+ * What did we learn?
+ *
+ * 1. A String page needs the whole page - and a bit more - in one block
+ * 2. Constant text belongs in flash, not copied into RAM for every visitor
+ * 3. A template compiled once turns page building into a list of parts
+ * 4. Sending while building keeps RAM flat, whatever the page size
+ * 5. Bigger chunks mean fewer sends; 512 bytes is a good TCP-sized start
+ * 6. Anything a user can type must be escaped - the template does it once
+ *
+ * Next: A JSON API - /api/status with ETags and "304 Not Modified"!
+ */
@@ -42,6 +42,24 @@ unsigned long freeMemory = 0;
 float cpuUsage = 0.0;
 int alarmCount = 0;
 
+// Buffered serial output (host benchmark: Module3 08_buffered_serial_writer.c)
+// The summary used to be ~20 Serial.print() calls. Now each line is built in
+// a stack buffer and sent with ONE write into a 1 KB TX ring buffer, which
+// the UART interrupt drains while loop() goes back to checking timer flags.
+#define LOG_RECORD_MAX      128   // Longest single record
+#define SERIAL_TX_BUFFER    1024  // Driver TX ring buffer for Serial
+#define LOG_MAX_DECIMALS    4
+
+struct LogRecord {
+    char text[LOG_RECORD_MAX];
+    uint16_t length;
+    bool truncated;                  // Text didn't fit - the line was cut short
+};
+
+unsigned long serialRecords = 0;     // Records sent
+unsigned long serialDropped = 0;     // TX buffer full - record skipped
+unsigned long serialBlockedUs = 0;   // Time loop() spent inside Serial.write()
+
 // Timer interrupt functions (ISRs - Interrupt Service Routines)
 // These run EXACTLY when the timer expires, interrupting whatever else is happening
 // Keep these functions SHORT and SIMPLE!
@@ -164,43 +182,195 @@ void calculateSensorStats(float *average, float *minimum, float *maximum) {
     *maximum = max;
 }
 
+// Record builder: text goes straight into the buffer, no snprintf/String.
+// The same code is in Module3 02_uart_communication.c and Module5
+// 02_hardware_timers.c (sketches don't share files) - keep them identical.
+
+// "00" "01" ... "99": two digits per division halves the divides
+const char digitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+const uint32_t pow10Table[LOG_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000 };
+
+void recordReset(LogRecord* r) {
+    r->length = 0;
+    r->truncated = false;
+}
+
+void recordAppend(LogRecord* r, const char* s, size_t n) {
+    // Always keep room for \r\n (length can't pass LOG_RECORD_MAX - 2 here)
+    size_t room = r->length < LOG_RECORD_MAX - 2 ? (LOG_RECORD_MAX - 2) - r->length : 0;
+    if(n > room) {
+        n = room;
+        r->truncated = true;
+    }
+    memcpy(r->text + r->length, s, n);
+    r->length += n;
+}
+
+void recordText(LogRecord* r, const char* s) {
+    recordAppend(r, s, strlen(s));
+}
+
+void recordChar(LogRecord* r, char c) {
+    recordAppend(r, &c, 1);
+}
+
+// Writes the digits of v so they END at 'end'; returns where they start
+char* u32ToDigits(uint32_t v, char* end) {
+    char* p = end;
+    while(v >= 100) {
+        uint32_t pair = (v % 100) * 2;
+        v /= 100;
+        *--p = digitPairs[pair + 1];
+        *--p = digitPairs[pair];
+    }
+    if(v >= 10) {
+        *--p = digitPairs[v * 2 + 1];
+        *--p = digitPairs[v * 2];
+    } else {
+        *--p = '0' + v;
+    }
+    return p;
+}
+
+void recordU32(LogRecord* r, uint32_t v) {
+    char buf[10];
+    char* start = u32ToDigits(v, buf + sizeof(buf));
+    recordAppend(r, start, buf + sizeof(buf) - start);
+}
+
+void recordI32(LogRecord* r, int32_t v) {
+    if(v < 0) {
+        recordChar(r, '-');
+        recordU32(r, 0u - (uint32_t)v);
+    } else {
+        recordU32(r, v);
+    }
+}
+
+// Same text as Serial.print(value, decimals), without the float printing code.
+// No double math - the ESP32 FPU only does float, doubles run in software.
+// The whole part and the fraction of a float are both exact, and the fraction
+// is scaled with integers (32.32 fixed point), so rounding matches exactly.
+void recordFixed(LogRecord* r, float value, uint8_t decimals) {
+    if(isnan(value)) { recordText(r, "nan"); return; }
+    if(isinf(value)) { recordText(r, "inf"); return; }
+    if(decimals > LOG_MAX_DECIMALS) decimals = LOG_MAX_DECIMALS;
+    
+    float magnitude = fabsf(value);
+    if(magnitude > 4294967040.0f) { recordText(r, "ovf"); return; }  // Same limit as Print
+    
+    uint32_t scale = pow10Table[decimals];
+    uint32_t whole = (uint32_t)magnitude;
+    uint32_t frac32 = (uint32_t)((magnitude - (float)whole) * 4294967296.0f);
+    uint32_t fraction = (uint32_t)(((uint64_t)frac32 * scale + 0x80000000u) >> 32);  // Round half away from zero
+    if(fraction == scale) {                         // 0.99996 -> "1.0000"
+        fraction = 0;
+        whole++;
+    }
+    
+    char buf[16];
+    char* end = buf + sizeof(buf);
+    char* p = end;
+    if(decimals > 0) {
+        char* frac_end = p;
+        p = u32ToDigits(fraction, p);
+        while(frac_end - p < decimals) *--p = '0';  // 0.05 -> "05"
+        *--p = '.';
+    }
+    p = u32ToDigits(whole, p);
+    if(value < 0 && (whole | fraction) != 0) *--p = '-';  // No "-0.00"
+    recordAppend(r, p, end - p);
+}
+
+// A record can hold several lines: the next \r\n must still fit
+void recordEnd(LogRecord* r) {
+    if(r->length > LOG_RECORD_MAX - 2) {
+        r->length = LOG_RECORD_MAX - 2;
+        r->truncated = true;
+    }
+    r->text[r->length++] = '\r';
+    r->text[r->length++] = '\n';
+}
+
+// One write per record; if the TX buffer can't take all of it, skip and count
+void serialSend(LogRecord *r) {
+    if (Serial.availableForWrite() < r->length) {
+        serialDropped++;
+        return;
+    }
+    unsigned long start = micros();
+    Serial.write((const uint8_t *)r->text, r->length);
+    serialBlockedUs += micros() - start;
+    serialRecords++;
+}
+
 // Function to log data summary
 // This is called when Timer 2 sets the flag
 void logDataSummary() {
-    Serial.println("\n📈 === Data Logging Summary ===");
-    
     float average, minimum, maximum;
     calculateSensorStats(&average, &minimum, &maximum);
-    
-    Serial.print("Total readings: ");
-    Serial.println(totalReadings);
-    
-    Serial.print("Average voltage: ");
-    Serial.print(average, 3);
-    Serial.println("V");
-    
-    Serial.print("Minimum voltage: ");
-    Serial.print(minimum, 3);
-    Serial.println("V");
-    
-    Serial.print("Maximum voltage: ");
-    Serial.print(maximum, 3);
-    Serial.println("V");
-    
-    Serial.print("Voltage range: ");
-    Serial.print(maximum - minimum, 3);
-    Serial.println("V");
-    
-    Serial.print("Alarm count: ");
-    Serial.println(alarmCount);
-    
+
+    LogRecord r;
+    recordReset(&r);
+    recordText(&r, "\r\n📈 === Data Logging Summary ===");
+    recordEnd(&r);
+    recordText(&r, "Total readings: ");
+    recordU32(&r, totalReadings);
+    recordEnd(&r);
+    serialSend(&r);
+
+    recordReset(&r);
+    recordText(&r, "Average voltage: ");
+    recordFixed(&r, average, 3);
+    recordText(&r, "V");
+    recordEnd(&r);
+    recordText(&r, "Minimum voltage: ");
+    recordFixed(&r, minimum, 3);
+    recordText(&r, "V");
+    recordEnd(&r);
+    recordText(&r, "Maximum voltage: ");
+    recordFixed(&r, maximum, 3);
+    recordText(&r, "V");
+    recordEnd(&r);
+    serialSend(&r);
+
+    recordReset(&r);
+    recordText(&r, "Voltage range: ");
+    recordFixed(&r, maximum - minimum, 3);
+    recordText(&r, "V");
+    recordEnd(&r);
+    recordText(&r, "Alarm count: ");
+    recordU32(&r, alarmCount);
+    recordEnd(&r);
+    serialSend(&r);
+
     // Calculate data rate
     float dataRate = (float)totalReadings / (millis() / 1000.0);
-    Serial.print("Data rate: ");
-    Serial.print(dataRate, 2);
-    Serial.println(" readings/second");
-    
-    Serial.println("==============================\n");
+    recordReset(&r);
+    recordText(&r, "Data rate: ");
+    recordFixed(&r, dataRate, 2);
+    recordText(&r, " readings/second");
+    recordEnd(&r);
+    serialSend(&r);
+
+    // How much the serial output itself is costing us
+    recordReset(&r);
+    recordText(&r, "Serial: ");
+    recordU32(&r, serialRecords);
+    recordText(&r, " records, ");
+    recordU32(&r, serialDropped);
+    recordText(&r, " dropped, ");
+    recordU32(&r, serialBlockedUs);
+    recordText(&r, " us blocked");
+    recordEnd(&r);
+    recordText(&r, "==============================");
+    recordEnd(&r);
+    recordEnd(&r);
+    serialSend(&r);
 }
 
 // Function to check system health
@@ -296,6 +466,7 @@ void demonstrateTimerControl() {
 }
 
 void setup() {
+    Serial.setTxBufferSize(SERIAL_TX_BUFFER);  // Must be set before begin()
     Serial.begin(115200);
     Serial.println("Hardware Timer Control Example");
     Serial.println("==============================");
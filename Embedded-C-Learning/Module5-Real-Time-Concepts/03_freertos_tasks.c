@@ -52,13 +52,31 @@ typedef struct {
     unsigned long timestamp;
 } ButtonEvent;
 
+// Sensor filters (host version with benchmark: Module3-Real-Hardware/11_digital_filters.c)
+// A median of the last 5 readings throws spikes away, then an EMA smooths the
+// noise. Unlike sum / count, the EMA forgets old readings and follows changes.
+#define MEDIAN_WINDOW   5
+#define TEMP_EMA_ALPHA  0.25f   // Each reading moves the average 25% of the way
+
+typedef struct {
+    float history[MEDIAN_WINDOW];
+    int count;
+    int pos;
+} MedianFilter;
+
+typedef struct {
+    float alpha;
+    float value;
+    bool primed;              // First reading sets the value - no slow climb from 0
+} EmaFilter;
+
 // Global system state (protected by tasks)
 typedef struct {
     bool systemRunning;
     int ledMode;              // 0=off, 1=slow, 2=fast, 3=rainbow
     int sensorSamples;        // Total sensor readings
     int buttonPresses;        // Total button presses
-    float averageTemp;        // Running average temperature
+    float averageTemp;        // Filtered temperature (median + EMA)
     bool alarmActive;         // System alarm state
 } SystemState;
 
@@ -87,6 +105,36 @@ void safePrintln(const char* message) {
     }
 }
 
+// Filter one temperature reading: median first (spikes), then EMA (noise)
+float medianFilterUpdate(MedianFilter *filter, float x) {
+    filter->history[filter->pos] = x;
+    filter->pos = (filter->pos + 1) % MEDIAN_WINDOW;
+    if (filter->count < MEDIAN_WINDOW) filter->count++;
+    
+    // Insertion sort of a copy - with 5 values that's only a few compares
+    float sorted[MEDIAN_WINDOW];
+    for (int i = 0; i < filter->count; i++) {
+        float v = filter->history[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    return sorted[(filter->count - 1) / 2];
+}
+
+float emaFilterUpdate(EmaFilter *filter, float x) {
+    if (!filter->primed) {
+        filter->value = x;
+        filter->primed = true;
+    } else {
+        filter->value += filter->alpha * (x - filter->value);
+    }
+    return filter->value;
+}
+
 // Task 1: LED Control Task (Priority: 1 - Low)
 // This task controls different LED patterns based on system state
 void taskLEDControl(void *parameter) {
@@ -165,7 +213,8 @@ void taskSensorReading(void *parameter) {
     safePrintln("📊 Sensor Reading Task Started");
     
     TickType_t lastWakeTime = xTaskGetTickCount();
-    float tempSum = 0.0;
+    MedianFilter tempMedian = {{0}, 0, 0};
+    EmaFilter tempEma = {TEMP_EMA_ALPHA, 0.0, false};
     
     while (systemState.systemRunning) {
         SensorData data;
@@ -184,12 +233,13 @@ void taskSensorReading(void *parameter) {
         data.timestamp = millis();
         
         // Update system statistics
+        // (sum / count since power-on would stop following the temperature after a while)
         systemState.sensorSamples++;
-        tempSum += data.temperature;
-        systemState.averageTemp = tempSum / systemState.sensorSamples;
+        float filteredTemp = emaFilterUpdate(&tempEma, medianFilterUpdate(&tempMedian, data.temperature));
+        systemState.averageTemp = filteredTemp;
         
-        // Check for alarm conditions
-        if (data.temperature > 50.0 || data.temperature < -10.0) {
+        // Check for alarm conditions on the filtered value - one spike can't trigger it
+        if (filteredTemp > 50.0 || filteredTemp < -10.0) {
             systemState.alarmActive = true;
             systemState.ledMode = 2;  // Switch to warning mode
         } else {
@@ -344,7 +394,7 @@ void taskDisplay(void *parameter) {
                 Serial.println(systemState.sensorSamples);
                 Serial.print("Button Presses: ");
                 Serial.println(systemState.buttonPresses);
-                Serial.print("Average Temperature: ");
+                Serial.print("Filtered Temperature: ");
                 Serial.print(systemState.averageTemp, 1);
                 Serial.println("°C");
                 Serial.print("Alarm Active: ");